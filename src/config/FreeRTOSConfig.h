@@ -150,14 +150,12 @@ to exclude the API function. */
   }
 */
 
-// Queue monitoring
-#ifdef DEBUG_QUEUE_MONITOR
-    #undef traceQUEUE_SEND
-    #undef traceQUEUE_SEND_FAILED
-    #define traceQUEUE_SEND(xQueue) qm_traceQUEUE_SEND(xQueue)
-    void qm_traceQUEUE_SEND(void* xQueue);
-    #define traceQUEUE_SEND_FAILED(xQueue) qm_traceQUEUE_SEND_FAILED(xQueue)
-    void qm_traceQUEUE_SEND_FAILED(void* xQueue);
-#endif // DEBUG_QUEUE_MONITOR
+// Queue monitoring, always on for the system load monitor
+#undef traceQUEUE_SEND
+#undef traceQUEUE_SEND_FAILED
+#define traceQUEUE_SEND(xQueue) qm_traceQUEUE_SEND(xQueue)
+void qm_traceQUEUE_SEND(void* xQueue);
+#define traceQUEUE_SEND_FAILED(xQueue) qm_traceQUEUE_SEND_FAILED(xQueue)
+void qm_traceQUEUE_SEND_FAILED(void* xQueue);
 
 #endif /* FREERTOS_CONFIG_H */
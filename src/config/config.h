@@ -85,6 +85,11 @@
 #define USDWRITE_TASK_PRI       0
 #define PCA9685_TASK_PRI        3
 #define CMD_HIGH_LEVEL_TASK_PRI 2
+#define CONSOLE_DEFERRED_TASK_PRI 0
+#define VIBRATION_TASK_PRI      0
+#define KALMAN_TASK_PRI         (STABILIZER_TASK_PRI - 1)
+#define THERMAL_TASK_PRI        1
+#define RANGE_MAP_TASK_PRI      1
 
 #define SYSLINK_TASK_PRI        3
 #define USBLINK_TASK_PRI        3
@@ -123,6 +128,11 @@
 #define PCA9685_TASK_NAME       "PCA9685"
 #define CMD_HIGH_LEVEL_TASK_NAME "CMDHL"
 #define MULTIRANGER_TASK_NAME   "MR"
+#define CONSOLE_DEFERRED_TASK_NAME "CONSOLE"
+#define VIBRATION_TASK_NAME     "VIBRATION"
+#define KALMAN_TASK_NAME        "KALMAN"
+#define THERMAL_TASK_NAME       "THERMAL"
+#define RANGE_MAP_TASK_NAME     "RANGEMAP"
 
 /* guojun: add screen task */
 #define SCREEN_TASK_NAME        "SCREEN"
@@ -156,6 +166,11 @@
 #define PCA9685_TASK_STACKSIZE        (2 * configMINIMAL_STACK_SIZE)
 #define CMD_HIGH_LEVEL_TASK_STACKSIZE configMINIMAL_STACK_SIZE
 #define MULTIRANGER_TASK_STACKSIZE    (2 * configMINIMAL_STACK_SIZE)
+#define CONSOLE_DEFERRED_TASK_STACKSIZE configMINIMAL_STACK_SIZE
+#define VIBRATION_TASK_STACKSIZE      (2 * configMINIMAL_STACK_SIZE)
+#define KALMAN_TASK_STACKSIZE         (3 * configMINIMAL_STACK_SIZE)
+#define THERMAL_TASK_STACKSIZE        (2 * configMINIMAL_STACK_SIZE)
+#define RANGE_MAP_TASK_STACKSIZE      (2 * configMINIMAL_STACK_SIZE)
 
 //The radio channel. From 0 to 125
 #define RADIO_CHANNEL 80
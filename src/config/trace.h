@@ -27,6 +27,8 @@
 #ifndef __TRACE_H__
 #define __TRACE_H__
 
+#include <stdint.h>
+
 #define configUSE_TRACE_FACILITY	1
 
 // ITM useful macros
@@ -38,7 +40,12 @@
 #endif
 
 // Send 4 first chatacters of task name to ITM port 1
-#define traceTASK_SWITCHED_IN() ITM_SEND(1, *((uint32_t*)pxCurrentTCB->pcTaskName))
+// and count the switch for the system load monitor. The count is kept in the
+// trace number of the task, sysload.c reads it with uxTaskGetTaskNumber()
+#define traceTASK_SWITCHED_IN() do { \
+  ITM_SEND(1, *((uint32_t*)pxCurrentTCB->pcTaskName)); \
+  pxCurrentTCB->uxTaskNumber++; \
+  } while (0)
 
 // Systick value on port 2
 #define traceTASK_INCREMENT_TICK(xTickCount) ITM_SEND(2, xTickCount)
@@ -0,0 +1,198 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * amg8833deck.c - Hot spot detection with an AMG8833 thermal sensor
+ *
+ * The sensor is read at its full 10 Hz frame rate and the frames are
+ * processed on board, only the detections are published as log variables.
+ * There is no deck memory on the sensor boards, the driver must be forced
+ * with DECK_FORCE=amg8833
+ */
+
+#define DEBUG_MODULE "AMG"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "config.h"
+#include "deck.h"
+#include "system.h"
+#include "debug.h"
+#include "log.h"
+#include "param.h"
+#include "usec_time.h"
+
+#include "i2cdev.h"
+#include "amg8833.h"
+#include "thermal_detect.h"
+
+#define THERMAL_FRAME_PERIOD_MS 100
+#define THERMAL_MAX_DETECTIONS 3
+
+// The sensor range is -20 to 80 degrees C, no excess can be larger
+#define THERMAL_MAX_THRESHOLD 100.0f
+
+static bool isInit = false;
+static AMG8833_Dev_t dev;
+static thermalDetector_t detector;
+
+// Settings
+static float threshold = 2.0f;
+static uint8_t minArea = 1;
+static uint8_t backgroundRate = 4;
+
+// Published detections, hottest first
+typedef struct {
+  float x;
+  float y;
+  float peak;
+  uint8_t area;
+} detection_t;
+
+static detection_t published[THERMAL_MAX_DETECTIONS];
+static uint8_t detectionCount;
+static uint8_t blobCount;
+static uint32_t processingTimeUs;
+static uint32_t readErrors;
+
+static void publish(const thermalDetection_t* detections, const int count) {
+  for (int i = 0; i < THERMAL_MAX_DETECTIONS; i++) {
+    if (i < count) {
+      published[i].x = (float)detections[i].centroidX / (1 << THERMAL_FRACTION_BITS);
+      published[i].y = (float)detections[i].centroidY / (1 << THERMAL_FRACTION_BITS);
+      published[i].peak = (float)detections[i].peak / THERMAL_UNITS_PER_DEGREE;
+      published[i].area = detections[i].area;
+    } else {
+      published[i].area = 0;
+    }
+  }
+  detectionCount = count;
+  blobCount = detector.blobCount;
+}
+
+// The settings are parameters, keep them in the range the detector handles
+static void applySettings() {
+  if (threshold < 0.0f) {
+    threshold = 0.0f;
+  } else if (threshold > THERMAL_MAX_THRESHOLD) {
+    threshold = THERMAL_MAX_THRESHOLD;
+  }
+
+  if (backgroundRate > THERMAL_MAX_BACKGROUND_RATE) {
+    backgroundRate = THERMAL_MAX_BACKGROUND_RATE;
+  }
+
+  detector.threshold = threshold * THERMAL_UNITS_PER_DEGREE;
+  detector.minArea = minArea;
+  detector.backgroundRate = backgroundRate;
+}
+
+static void amg8833Task(void* arg) {
+  systemWaitStart();
+
+  TickType_t lastWakeTime = xTaskGetTickCount();
+  while (1) {
+    vTaskDelayUntil(&lastWakeTime, M2T(THERMAL_FRAME_PERIOD_MS));
+
+    int16_t image[THERMAL_PIXELS];
+    if (!readPixelsRaw(&dev, image)) {
+      readErrors++;
+      continue;
+    }
+
+    const uint64_t start = usecTimestamp();
+
+    applySettings();
+
+    thermalDetection_t detections[THERMAL_MAX_DETECTIONS];
+    const int count = thermalDetectorUpdate(&detector, image, detections, THERMAL_MAX_DETECTIONS);
+    publish(detections, count);
+
+    processingTimeUs = usecTimestamp() - start;
+  }
+}
+
+static void amg8833DeckInit(DeckInfo* info) {
+  if (isInit) {
+    return;
+  }
+
+  if (begin(&dev, I2C1_DEV)) {
+    DEBUG_PRINT("AMG8833 [OK]\n");
+  } else {
+    DEBUG_PRINT("AMG8833 [FAIL]\n");
+    return;
+  }
+
+  thermalDetectorInit(&detector, 0, 0, 0);
+  applySettings();
+  xTaskCreate(amg8833Task, THERMAL_TASK_NAME, THERMAL_TASK_STACKSIZE, NULL, THERMAL_TASK_PRI, NULL);
+
+  isInit = true;
+}
+
+static bool amg8833DeckTest(void) {
+  return isInit;
+}
+
+static const DeckDriver amg8833_deck = {
+  .vid = 0x00,
+  .pid = 0x00,
+  .name = "amg8833",
+
+  .usedGpio = DECK_USING_SDA | DECK_USING_SCL,
+
+  .init = amg8833DeckInit,
+  .test = amg8833DeckTest,
+};
+
+DECK_DRIVER(amg8833_deck);
+
+PARAM_GROUP_START(deck)
+PARAM_ADD(PARAM_UINT8 | PARAM_RONLY, amg8833, &isInit)
+PARAM_GROUP_STOP(deck)
+
+PARAM_GROUP_START(thermal)
+PARAM_ADD(PARAM_FLOAT, threshold, &threshold)
+PARAM_ADD(PARAM_UINT8, minArea, &minArea)
+PARAM_ADD(PARAM_UINT8, bgRate, &backgroundRate)
+PARAM_GROUP_STOP(thermal)
+
+LOG_GROUP_START(thermal)
+LOG_ADD(LOG_UINT8, count, &detectionCount)
+LOG_ADD(LOG_UINT8, blobs, &blobCount)
+LOG_ADD(LOG_FLOAT, x0, &published[0].x)
+LOG_ADD(LOG_FLOAT, y0, &published[0].y)
+LOG_ADD(LOG_FLOAT, peak0, &published[0].peak)
+LOG_ADD(LOG_UINT8, area0, &published[0].area)
+LOG_ADD(LOG_FLOAT, x1, &published[1].x)
+LOG_ADD(LOG_FLOAT, y1, &published[1].y)
+LOG_ADD(LOG_FLOAT, peak1, &published[1].peak)
+LOG_ADD(LOG_UINT8, area1, &published[1].area)
+LOG_ADD(LOG_FLOAT, x2, &published[2].x)
+LOG_ADD(LOG_FLOAT, y2, &published[2].y)
+LOG_ADD(LOG_FLOAT, peak2, &published[2].peak)
+LOG_ADD(LOG_UINT8, area2, &published[2].area)
+LOG_ADD(LOG_UINT32, procUs, &processingTimeUs)
+LOG_ADD(LOG_UINT32, readErrors, &readErrors)
+LOG_GROUP_STOP(thermal)
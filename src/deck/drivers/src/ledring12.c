@@ -43,6 +43,8 @@
 #include "param.h"
 #include "pm.h"
 #include "log.h"
+#include "led_timeline.h"
+#include "crtp_commander_high_level.h"
 
 static bool isInit = false;
 
@@ -754,6 +756,33 @@ static void locSrvStatus(uint8_t buffer[][3], bool reset)
   }
 }
 
+/**
+ * Light show uploaded through the memory subsystem, see led_timeline.h. The
+ * ring is black until an uploaded trajectory is started with the high-level
+ * commander, the timeline is then evaluated against the trajectory time.
+ * Playback restarts from the first segment when the timeline is uploaded.
+ */
+static void timelineEffect(uint8_t buffer[][3], bool reset)
+{
+  static ledTimelineCursor_t cursor;
+  static uint32_t memoryWriteCount;
+  uint8_t color[3] = BLACK;
+  float trajectoryTime;
+
+  if (reset || memoryWriteCount != ledTimelineMemoryWriteCount()) {
+    ledTimelineCursorReset(&cursor);
+    memoryWriteCount = ledTimelineMemoryWriteCount();
+  }
+
+  if (crtpCommanderHighLevelGetTrajectoryTime(&trajectoryTime) && trajectoryTime >= 0.0f) {
+    ledTimelineEvaluate(ledTimelineMemory, sizeof(ledTimelineMemory), &cursor, (uint32_t)(trajectoryTime * 1000.0f), color);
+  }
+
+  for (int i = 0; i < NBR_LEDS; i++) {
+    COPY_COLOR(buffer[i], color);
+  }
+}
+
 /**************** Effect list ***************/
 
 
@@ -776,6 +805,7 @@ Ledring12Effect effectsFct[] =
   fadeColorEffect,
   rssiEffect,
   locSrvStatus,
+  timelineEffect,
 };
 
 /********** Ring init and switching **********/
@@ -783,14 +813,29 @@ static xTimerHandle timer;
 
 
 
+// Many effects are static or change slowly, the frame is only encoded and
+// sent to the ring when it differs from the last one sent
+static void sendIfChanged(uint8_t (*buffer)[3], uint8_t (*sentBuffer)[3], bool* isSent)
+{
+  if (*isSent && memcmp(buffer, sentBuffer, NBR_LEDS * 3) == 0) {
+    return;
+  }
+
+  memcpy(sentBuffer, buffer, NBR_LEDS * 3);
+  *isSent = true;
+  ws2812Send(buffer, NBR_LEDS);
+}
+
 void ledring12Worker(void * data)
 {
   static int current_effect = 0;
   static uint8_t buffer[NBR_LEDS][3];
+  static uint8_t sentBuffer[NBR_LEDS][3];
+  static bool isSent = false;
   bool reset = true;
 
   if (/*!pmIsDischarging() ||*/ (effect > neffect)) {
-    ws2812Send(black, NBR_LEDS);
+    sendIfChanged(black, sentBuffer, &isSent);
     return;
   }
 
@@ -802,7 +847,7 @@ void ledring12Worker(void * data)
   current_effect = effect;
 
   effectsFct[current_effect](buffer, reset);
-  ws2812Send(buffer, NBR_LEDS);
+  sendIfChanged(buffer, sentBuffer, &isSent);
 }
 
 static void ledring12Timer(xTimerHandle timer)
@@ -33,6 +33,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "system.h"
 #include "deck.h"
@@ -119,6 +120,8 @@ static float frameRate = 0.0;
 static float cycleRate = 0.0;
 static float positionRate = 0.0;
 
+static uint32_t droppedFrameCount = 0;
+
 static uint16_t pulseWidth[PULSE_PROCESSOR_N_SENSORS];
 
 static uint32_t latestStatsTimeMs = 0;
@@ -133,18 +136,6 @@ typedef union frame_u {
   char data[7];
 } __attribute__((packed)) frame_t;
 
-static bool getFrame(frame_t *frame)
-{
-  int syncCounter = 0;
-  for(int i=0; i<7; i++) {
-    uart1Getchar(&frame->data[i]);
-    if (frame->data[i] != 0) {
-      syncCounter += 1;
-    }
-  }
-  return (frame->sync == 0 || (syncCounter==7));
-}
-
 static void resetStats() {
   serialFrameCount = 0;
   frameCount = 0;
@@ -162,120 +153,232 @@ static void calculateStats(uint32_t nowMs) {
   resetStats();
 }
 
-static vec3d position;
+// Lower limit of the standard deviation passed to the estimator [m]
+#define LIGHTHOUSE_MIN_STD_DEV 0.005f
+
 static positionMeasurement_t ext_pos;
 static float deltaLog;
 
-static void estimatePosition(pulseProcessorResult_t angles[]) {
-  memset(&ext_pos, 0, sizeof(ext_pos));
-  int sensorsUsed = 0;
-  float delta;
+// Sensor positions on the deck relative to the center, in the Crazyflie body
+// frame (x forward, y left) [m]
+static const float sensorDeckPositions[PULSE_PROCESSOR_N_SENSORS][3] = {
+  {-0.015f, 0.0075f, 0.0f},
+  {-0.015f, -0.0075f, 0.0f},
+  {0.015f, 0.0075f, 0.0f},
+  {0.015f, -0.0075f, 0.0f},
+};
 
-  // Average over all sensors with valid data
-  for (size_t sensor = 0; sensor < PULSE_PROCESSOR_N_SENSORS; sensor++) {
-      if (angles[sensor].validCount == 4) {
-        lighthouseGeometryGetPosition(lighthouseBaseStationsGeometry, (void*)angles[sensor].correctedAngles, position, &delta);
+#define DEG_TO_RAD (3.14159265f / 180.0f)
 
-        deltaLog = delta;
+static int idYaw;
 
-        ext_pos.x -= position[2];
-        ext_pos.y -= position[0];
-        ext_pos.z += position[1];
-        sensorsUsed++;
+// The solver works in the lighthouse coordinate system
+static vec3d sensorPositions[PULSE_PROCESSOR_N_SENSORS];
+static lighthouseGeometryPrepared_t preparedGeometry;
+static baseStationGeometry_t preparedFrom[2];
+static bool isGeometryPrepared = false;
 
-        positionCount++;
-      }
+static void prepareGeometry() {
+  // The geometry can be updated through the memory subsystem at any time
+  if (isGeometryPrepared && memcmp(preparedFrom, lighthouseBaseStationsGeometry, sizeof(preparedFrom)) == 0) {
+    return;
   }
 
-  ext_pos.x /= sensorsUsed;
-  ext_pos.y /= sensorsUsed;
-  ext_pos.z /= sensorsUsed;
+  memcpy(preparedFrom, lighthouseBaseStationsGeometry, sizeof(preparedFrom));
+  lighthouseGeometryPrepare(preparedFrom, &preparedGeometry);
+
+  isGeometryPrepared = true;
+}
+
+// Rotate the sensor positions by the estimated yaw. The deck is assumed to be
+// level, roll and pitch are small in flight and the sensors are close to the
+// center.
+static void updateSensorPositions() {
+  const float yaw = logGetFloat(idYaw) * DEG_TO_RAD;
+  const float cosYaw = cosf(yaw);
+  const float sinYaw = sinf(yaw);
+
+  for (int sensor = 0; sensor < PULSE_PROCESSOR_N_SENSORS; sensor++) {
+    const float x = cosYaw * sensorDeckPositions[sensor][0] - sinYaw * sensorDeckPositions[sensor][1];
+    const float y = sinYaw * sensorDeckPositions[sensor][0] + cosYaw * sensorDeckPositions[sensor][1];
+    const float z = sensorDeckPositions[sensor][2];
+
+    sensorPositions[sensor][0] = -y;
+    sensorPositions[sensor][1] = z;
+    sensorPositions[sensor][2] = -x;
+  }
+}
+
+static void estimatePosition(pulseProcessorResult_t angles[]) {
+  float sensorAngles[PULSE_PROCESSOR_N_SENSORS][2][2];
+  bool isValid[PULSE_PROCESSOR_N_SENSORS];
+  lighthouseSolution_t solution;
+
+  prepareGeometry();
+  updateSensorPositions();
+
+  for (size_t sensor = 0; sensor < PULSE_PROCESSOR_N_SENSORS; sensor++) {
+    isValid[sensor] = (angles[sensor].validCount == 4);
+    memcpy(sensorAngles[sensor], angles[sensor].correctedAngles, sizeof(sensorAngles[sensor]));
+  }
+
+  // One least squares solution from all sensors and both base stations
+  if (!lighthouseGeometrySolve(&preparedGeometry, sensorAngles, isValid, sensorPositions, PULSE_PROCESSOR_N_SENSORS, &solution)) {
+    return;
+  }
+
+  deltaLog = solution.residual;
+  positionCount++;
+
+  ext_pos.x = -solution.position[2];
+  ext_pos.y = -solution.position[0];
+  ext_pos.z = solution.position[1];
 
   // Make sure we feed sane data into the estimator
   if (!isfinite(ext_pos.pos[0]) || !isfinite(ext_pos.pos[1]) || !isfinite(ext_pos.pos[2])) {
     return;
   }
-  ext_pos.stdDev = 0.01;
+
+  // The estimator takes one standard deviation for all axes
+  const float variance = (solution.covariance[0][0] + solution.covariance[1][1] + solution.covariance[2][2]) / 3.0f;
+  ext_pos.stdDev = sqrtf(variance);
+  if (!isfinite(ext_pos.stdDev) || ext_pos.stdDev < LIGHTHOUSE_MIN_STD_DEV) {
+    ext_pos.stdDev = LIGHTHOUSE_MIN_STD_DEV;
+  }
   estimatorEnqueuePosition(&ext_pos);
 }
 
-static void lighthouseTask(void *param)
-{
-  bool synchronized = false;
-  int syncCounter = 0;
-  char c;
-  static frame_t frame;
-  static pulseProcessor_t ppState = {};
+// Serial stream parser state
+static bool synchronized = false;
+static int syncCounter = 0;
+static frame_t partialFrame;
+static size_t partialFrameSize = 0;
 
+static void processFrame(pulseProcessor_t *ppState, const frame_t *frame)
+{
   int basestation;
   int axis;
 
-  systemWaitStart();
+  serialFrameCount++;
 
-#ifdef LH_FLASH_DECK
-  // Flash deck bootloader using SPI (factory and recovery flashing)
-  lhflashInit();
-  lhflashFlashBootloader();
-#endif
+  pulseWidth[frame->sensor] = frame->width;
 
-  // Boot the deck firmware
-  checkVersionAndBoot();
+  if (pulseProcessorProcessPulse(ppState, frame->sensor, frame->timestamp, frame->width, angles, &basestation, &axis)) {
+    frameCount++;
+    if (basestation == 1 && axis == 1) {
+      cycleCount++;
 
-  while(1) {
-    // Synchronize
-    syncCounter = 0;
-    while (!synchronized) {
+      pulseProcessorApplyCalibration(ppState, angles);
 
-      uart1Getchar(&c);
-      if (c != 0) {
+      estimatePosition(angles);
+      for (size_t sensor = 0; sensor < PULSE_PROCESSOR_N_SENSORS; sensor++) {
+        angles[sensor].validCount = 0;
+      }
+    }
+  }
+}
+
+static void desynchronize()
+{
+  synchronized = false;
+  syncCounter = 0;
+  droppedFrameCount++;
+}
+
+// Process all frames in a block of data from the deck. Frames are used in
+// place in the receive buffer, only frames that are split between two blocks
+// are copied.
+static void processSerialData(pulseProcessor_t *ppState, const uint8_t *data, const size_t size)
+{
+  size_t i = 0;
+  while (i < size) {
+    if (!synchronized) {
+      // A sync frame is 7 non zero bytes
+      if (data[i] != 0) {
         syncCounter += 1;
       } else {
         syncCounter = 0;
       }
-      synchronized = syncCounter == 7;
+      i++;
+
+      if (syncCounter == 7) {
+        synchronized = true;
+        partialFrameSize = 0;
+        comSynchronized = true;
+        DEBUG_PRINT("Synchronized!\n");
+      }
+      continue;
     }
 
-    comSynchronized = true;
-    DEBUG_PRINT("Synchronized!\n");
+    const frame_t *frame;
+    if (partialFrameSize == 0 && (size - i) >= sizeof(frame_t)) {
+      frame = (const frame_t*)&data[i];
+      i += sizeof(frame_t);
+    } else {
+      while (partialFrameSize < sizeof(frame_t) && i < size) {
+        partialFrame.data[partialFrameSize++] = data[i++];
+      }
+      if (partialFrameSize < sizeof(frame_t)) {
+        break;
+      }
+      partialFrameSize = 0;
+      frame = &partialFrame;
+    }
+
+    if (frame->sync != 0) {
+      int nonZeroCount = 0;
+      for (int j = 0; j < 7; j++) {
+        if (frame->data[j] != 0) {
+          nonZeroCount += 1;
+        }
+      }
 
-    // Receive data until being desynchronized
-    synchronized = getFrame(&frame);
-    while(synchronized) {
-      if (frame.sync != 0) {
-        synchronized = getFrame(&frame);
+      if (nonZeroCount == 7) {
+        // Sync frame
         memset(pulseWidth, 0, sizeof(pulseWidth[0])*PULSE_PROCESSOR_N_SENSORS);
-        continue;
+      } else {
+        desynchronize();
       }
+      continue;
+    }
+
+    processFrame(ppState, frame);
+  }
+}
 
-      serialFrameCount++;
+static void lighthouseTask(void *param)
+{
+  static pulseProcessor_t ppState = {};
 
-      pulseWidth[frame.sensor] = frame.width;
+  systemWaitStart();
 
-      if (pulseProcessorProcessPulse(&ppState, frame.sensor, frame.timestamp, frame.width, angles, &basestation, &axis)) {
-        frameCount++;
-        if (basestation == 1 && axis == 1) {
-          cycleCount++;
+  idYaw = logGetVarId("stateEstimate", "yaw");
 
-          pulseProcessorApplyCalibration(&ppState, angles);
+#ifdef LH_FLASH_DECK
+  // Flash deck bootloader using SPI (factory and recovery flashing)
+  lhflashInit();
+  lhflashFlashBootloader();
+#endif
 
-          estimatePosition(angles);
-          for (size_t sensor = 0; sensor < PULSE_PROCESSOR_N_SENSORS; sensor++) {
-            angles[sensor].validCount = 0;
-          }
-        }
-      }
+  // Boot the deck firmware
+  checkVersionAndBoot();
 
-      uint32_t nowMs = T2M(xTaskGetTickCount());
-      if ((nowMs - latestStatsTimeMs) > 1000) {
-        calculateStats(nowMs);
-        latestStatsTimeMs = nowMs;
-      }
+  while(1) {
+    const uint8_t *data;
+    const uint32_t size = uart1DmaRxGetData(&data, M2T(100));
 
-      synchronized = getFrame(&frame);
-      if (frame.sync != 0) {
-        synchronized = getFrame(&frame);
-        continue;
-      }
+    if (uart1DidOverrun()) {
+      // Data has been lost, find the next sync frame
+      desynchronize();
+    }
+
+    processSerialData(&ppState, data, size);
+    uart1DmaRxConsume(size);
+
+    uint32_t nowMs = T2M(xTaskGetTickCount());
+    if ((nowMs - latestStatsTimeMs) > 1000) {
+      calculateStats(nowMs);
+      latestStatsTimeMs = nowMs;
     }
   }
 }
@@ -334,7 +437,7 @@ static void lighthouseInit(DeckInfo *info)
 {
   if (isInit) return;
 
-  uart1Init(230400);
+  uart1InitWithDmaRx(230400);
   lhblInit(I2C1_DEV);
 
   xTaskCreate(lighthouseTask, "LH",
@@ -393,6 +496,7 @@ LOG_ADD(LOG_FLOAT, serRt, &serialFrameRate)
 LOG_ADD(LOG_FLOAT, frmRt, &frameRate)
 LOG_ADD(LOG_FLOAT, cycleRt, &cycleRate)
 LOG_ADD(LOG_FLOAT, posRt, &positionRate)
+LOG_ADD(LOG_UINT32, frmDrop, &droppedFrameCount)
 
 LOG_ADD(LOG_UINT16, width0, &pulseWidth[0])
 #if PULSE_PROCESSOR_N_SENSORS > 1
@@ -40,6 +40,7 @@
 #include "stabilizer_types.h"
 #include "estimator.h"
 #include "cf_math.h"
+#include "sliding_median.h"
 
 #include "physicalConstants.h"
 #include "configblock.h"
@@ -97,13 +98,12 @@ typedef struct {
 static twrState_t state;
 static lpsTwrAlgoOptions_t* options = &defaultOptions;
 
-// Outlier rejection
+// Outlier rejection, based on the median and median absolute deviation of the last ranges
 #define RANGING_HISTORY_LENGTH 32
 #define OUTLIER_TH 4
-static struct {
-  float32_t history[RANGING_HISTORY_LENGTH];
-  size_t ptr;
-} rangingStats[LOCODECK_NR_OF_TWR_ANCHORS];
+#define OUTLIER_MIN_STD_DEV 0.05f
+#define OUTLIER_MIN_COUNT 5
+static medianOutlierFilter_t rangingStats[LOCODECK_NR_OF_TWR_ANCHORS];
 
 // Rangin statistics
 static uint8_t rangingPerSec[LOCODECK_NR_OF_TWR_ANCHORS];
@@ -238,20 +238,12 @@ static uint32_t rxcallback(dwDevice_t *dev) {
       state.pressures[current_anchor] = report->asl;
 
       // Outliers rejection
-      rangingStats[current_anchor].ptr = (rangingStats[current_anchor].ptr + 1) % RANGING_HISTORY_LENGTH;
-      float32_t mean;
-      float32_t stddev;
-
-      arm_std_f32(rangingStats[current_anchor].history, RANGING_HISTORY_LENGTH, &stddev);
-      arm_mean_f32(rangingStats[current_anchor].history, RANGING_HISTORY_LENGTH, &mean);
-      float32_t diff = fabsf(mean - state.distance[current_anchor]);
-
-      rangingStats[current_anchor].history[rangingStats[current_anchor].ptr] = state.distance[current_anchor];
+      const bool isInlier = medianOutlierFilterAdd(&rangingStats[current_anchor], state.distance[current_anchor]);
 
       rangingOk = true;
 
       if ((options->combinedAnchorPositionOk || options->anchorPosition[current_anchor].timestamp) &&
-          (diff < (OUTLIER_TH*stddev))) {
+          isInlier) {
         distanceMeasurement_t dist;
         dist.distance = state.distance[current_anchor];
         dist.x = options->anchorPosition[current_anchor].x;
@@ -492,6 +484,10 @@ static void twrTagInit(dwDevice_t *dev)
   memset(state.pressures, 0, sizeof(state.pressures));
   memset(state.failedRanging, 0, sizeof(state.failedRanging));
 
+  for (int i = 0; i < LOCODECK_NR_OF_TWR_ANCHORS; i++) {
+    medianOutlierFilterInit(&rangingStats[i], RANGING_HISTORY_LENGTH, OUTLIER_TH, OUTLIER_MIN_STD_DEV, OUTLIER_MIN_COUNT);
+  }
+
   dwSetReceiveWaitTimeout(dev, TWR_RECEIVE_TIMEOUT);
 
   dwCommitConfiguration(dev);
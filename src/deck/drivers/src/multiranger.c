@@ -34,6 +34,8 @@
 #include "pca95x4.h"
 #include "vl53l1x.h"
 #include "range.h"
+#include "range_map.h"
+#include "sliding_median.h"
 
 #include "i2cdev.h"
 
@@ -58,6 +60,11 @@ static VL53L1_Dev_t devUp;
 static VL53L1_Dev_t devLeft;
 static VL53L1_Dev_t devRight;
 
+// Median of the last samples of each sensor, removes single sample spikes and dropouts
+#define MR_MEDIAN_SIZE 3
+static slidingMedian_t medians[RANGE_T_END];
+static uint8_t medianEnable = 1;
+
 static uint16_t mrGetMeasurementAndRestart(VL53L1_Dev_t *dev)
 {
     VL53L1_Error status = VL53L1_ERROR_NONE;
@@ -81,6 +88,20 @@ static uint16_t mrGetMeasurementAndRestart(VL53L1_Dev_t *dev)
     return range;
 }
 
+static void mrSetRange(rangeDirection_t direction, uint16_t range)
+{
+    const float median = slidingMedianAdd(&medians[direction], range);
+
+    if (medianEnable)
+    {
+        rangeSet(direction, median / 1000.0f);
+    }
+    else
+    {
+        rangeSet(direction, range / 1000.0f);
+    }
+}
+
 static void mrTask(void *param)
 {
     VL53L1_Error status = VL53L1_ERROR_NONE;
@@ -106,11 +127,11 @@ static void mrTask(void *param)
     {
         vTaskDelayUntil(&lastWakeTime, M2T(100));
 
-        rangeSet(rangeFront, mrGetMeasurementAndRestart(&devFront)/1000.0f);
-        rangeSet(rangeBack, mrGetMeasurementAndRestart(&devBack)/1000.0f);
-        rangeSet(rangeUp, mrGetMeasurementAndRestart(&devUp)/1000.0f);
-        rangeSet(rangeLeft, mrGetMeasurementAndRestart(&devLeft)/1000.0f);
-        rangeSet(rangeRight, mrGetMeasurementAndRestart(&devRight)/1000.0f);
+        mrSetRange(rangeFront, mrGetMeasurementAndRestart(&devFront));
+        mrSetRange(rangeBack, mrGetMeasurementAndRestart(&devBack));
+        mrSetRange(rangeUp, mrGetMeasurementAndRestart(&devUp));
+        mrSetRange(rangeLeft, mrGetMeasurementAndRestart(&devLeft));
+        mrSetRange(rangeRight, mrGetMeasurementAndRestart(&devRight));
     }
 }
 
@@ -135,10 +156,17 @@ static void mrInit()
                        MR_PIN_FRONT |
                        MR_PIN_BACK);
 
+    for (int i = 0; i < RANGE_T_END; i++)
+    {
+        slidingMedianInit(&medians[i], MR_MEDIAN_SIZE);
+    }
+
     isInit = true;
 
     xTaskCreate(mrTask, MULTIRANGER_TASK_NAME, MULTIRANGER_TASK_STACKSIZE, NULL,
         MULTIRANGER_TASK_PRI, NULL);
+
+    rangeMapInit();
 }
 
 static bool mrTest()
@@ -226,3 +254,7 @@ DECK_DRIVER(multiranger_deck);
 PARAM_GROUP_START(deck)
 PARAM_ADD(PARAM_UINT8 | PARAM_RONLY, bcMultiranger, &isInit)
 PARAM_GROUP_STOP(deck)
+
+PARAM_GROUP_START(multiranger)
+PARAM_ADD(PARAM_UINT8, median, &medianEnable)
+PARAM_GROUP_STOP(multiranger)
@@ -26,6 +26,9 @@
 #ifndef __SCREEN_CFAL12864G_H__
 #define __SCREEN_CFAL12864G_H__
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define SSD1309_00_SET_LOWER_COLUMN_ADDRESS_BIT       (0x00)
 #define SSD1309_10_SET_UPPER_COLUMN_ADDRESS_BIT       (0x10)
 #define SSD1309_20_MEMORY_ADDRESSING_MODE_PREFIX      (0x20)
@@ -68,8 +71,6 @@
 #define SSD1309_16_LOCK_PARAMETER                     (0x16)
 #define SSD1309_12_UNLOCK_PARAMETER                   (0x12)
 
-#define FONT_08X08_BASE 32
-
 /* Defines for the SPI and GPIO pins used to drive the SPI Flash */
 // use transmit-only master mode
 #define CFAL12864G_SPI                     SPI3
@@ -120,14 +121,16 @@ typedef struct textContent_s {
   char ct[MAX_CONTENT_NUMBER];
 } textContent_t;
 
-typedef struct word_union_s {
-  union {
-    uint16_t as_word;
-    uint8_t as_bytes[2];
-  };
-} word_union_t;
+// Longest string in one text update, a full line with the 8x8 font
+#define SCREEN_TEXT_LENGTH 16
 
 void screenCFAL12864GInit(void);
 void screenTextSet(textContent_t *ct);
 
+/* Non blocking drawing, the updates are queued and drawn by the screen task.
+ * Return false if the queue is full. */
+bool screenPostClear(void);
+bool screenPostText(uint8_t x, uint8_t y, uint8_t fieldWidth, const char* text);
+bool screenPostHorizontalLine(uint8_t x1, uint8_t y, uint8_t x2);
+
 #endif // __SCREEN_CFAL12864G_H__
\ No newline at end of file
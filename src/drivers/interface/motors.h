@@ -227,7 +227,7 @@ extern const MotorPerifDef* motorMapIFlight[NBR_OF_MOTORS];
 /**
  * Motor driver function
  */
-void (*motorsDrive) (uint32_t id, uint16_t value);
+extern void (*motorsDrive) (uint32_t id, uint16_t value);
 
 /**
  * Test sound tones
@@ -44,6 +44,17 @@
 #define UART1_DMA_CH           DMA_Channel_4
 #define UART1_DMA_FLAG_TCIF    DMA_FLAG_TCIF3
 
+// Receive DMA, stream 1 is not used by any other driver (stream 3 and 4, the
+// alternatives for transmit, are used by SPI2 in sensors_bmi088_spi_bmp388.c)
+#define UART1_DMA_RX_IRQ       DMA1_Stream1_IRQn
+#define UART1_DMA_RX_STREAM    DMA1_Stream1
+#define UART1_DMA_RX_CH        DMA_Channel_4
+#define UART1_DMA_RX_IT_HTIF   DMA_IT_HTIF1
+#define UART1_DMA_RX_IT_TCIF   DMA_IT_TCIF1
+
+// Size of the circular receive buffer, must be a power of 2
+#define UART1_DMA_RX_BUFFER_SIZE 512
+
 #define UART1_GPIO_PERIF       RCC_AHB1Periph_GPIOC
 #define UART1_GPIO_PORT        GPIOC
 #define UART1_GPIO_TX_PIN      GPIO_Pin_10
@@ -58,6 +69,37 @@
  */
 void uart1Init(const uint32_t baudrate);
 
+/**
+ * Initialize the UART with a circular DMA receive buffer instead of the per
+ * byte receive queue. The reader is woken up when the buffer is half full,
+ * full or when the line goes idle. Received data is read with
+ * uart1DmaRxGetData() and uart1DmaRxConsume(), uart1Getchar() and
+ * uart1GetDataWithTimout() can not be used.
+ */
+void uart1InitWithDmaRx(const uint32_t baudrate);
+
+/**
+ * Get received data, when initialized with uart1InitWithDmaRx(). Waits for
+ * data if there is none.
+ *
+ * The data is not copied, it is a slice of the DMA receive buffer and is
+ * valid until consumed, as long as the reader is less than
+ * UART1_DMA_RX_BUFFER_SIZE bytes behind. If the reader falls further behind,
+ * the unread data is dropped and uart1DidOverrun() returns true.
+ *
+ * @param[out] data  Set to point to the received data
+ * @param[in] timeoutTicks  Max time to wait for data
+ * @return The number of contiguous bytes at data, 0 if timed out
+ */
+uint32_t uart1DmaRxGetData(const uint8_t** data, const uint32_t timeoutTicks);
+
+/**
+ * Release data returned by uart1DmaRxGetData().
+ *
+ * @param[in] size  Number of bytes to release
+ */
+void uart1DmaRxConsume(const uint32_t size);
+
 /**
  * Test the UART status.
  *
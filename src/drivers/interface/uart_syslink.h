@@ -43,6 +43,16 @@
 #define UARTSLK_DMA_CH           DMA_Channel_5
 #define UARTSLK_DMA_FLAG_TCIF    DMA_FLAG_TCIF7
 
+#define UARTSLK_DMA_RX_IRQ       DMA2_Stream1_IRQn
+#define UARTSLK_DMA_RX_STREAM    DMA2_Stream1
+#define UARTSLK_DMA_RX_CH        DMA_Channel_5
+#define UARTSLK_DMA_RX_IT_HTIF   DMA_IT_HTIF1
+#define UARTSLK_DMA_RX_IT_TCIF   DMA_IT_TCIF1
+
+// Must be a power of 2. Holds a few ms of data at 1 Mbaud, the syslink task
+// is woken up at half and full buffer and when the line goes idle.
+#define UARTSLK_DMA_RX_BUFFER_SIZE 256
+
 #define UARTSLK_GPIO_PERIF       RCC_AHB1Periph_GPIOC
 #define UARTSLK_GPIO_PORT        GPIOC
 #define UARTSLK_GPIO_TX_PIN      GPIO_Pin_6
@@ -79,7 +89,8 @@ bool uartslkTest(void);
 struct crtpLinkOperations * uartslkGetLink();
 
 /**
- * Get data from rx queue. Blocks until data is available.
+ * Get the next syslink packet. Packets are framed from the receive DMA buffer
+ * in the context of the caller, blocks until a complete packet is available.
  * @param[out] slp Pointer to a complete syslink packet
  */
 void uartslkGetPacketBlocking(SyslinkPacket* slp);
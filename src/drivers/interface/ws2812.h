@@ -1,6 +1,19 @@
 #ifndef __WS2812_H__
 #define __WS2812_H__
 
+#include <stdint.h>
+
+// Frames of up to this number of LEDs are encoded in full into a DMA buffer
+// and sent without any CPU interrupt. Longer frames are streamed through a
+// small buffer refilled from the DMA interrupt.
+#ifndef WS2812_FRAME_MAX_LEDS
+#ifdef LED_RING_NBR_LEDS
+#define WS2812_FRAME_MAX_LEDS LED_RING_NBR_LEDS
+#else
+#define WS2812_FRAME_MAX_LEDS 12
+#endif
+#endif
+
 void ws2812Init(void);
 void ws2812Send(uint8_t (*color)[3], uint16_t len);
 void ws2812DmaIsr(void);
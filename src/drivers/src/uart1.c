@@ -40,8 +40,10 @@
 #include "config.h"
 #include "nvicconf.h"
 
-/** This uart is conflicting with SPI2 DMA used in sensors_bmi088_spi_bmp388.c
- *  which is used in CF-Bolt. So for other products this can be enabled.
+/** The transmit DMA of this uart is conflicting with SPI2 DMA used in
+ *  sensors_bmi088_spi_bmp388.c which is used in CF-Bolt (both stream 3 and 4
+ *  are used). So for other products this can be enabled. The receive DMA uses
+ *  stream 1 and does not conflict.
  */
 //#define ENABLE_UART1_DMA
 
@@ -59,6 +61,14 @@ static bool    isUartDmaInitialized;
 static uint32_t initialDMACount;
 #endif
 
+static bool isDmaRx = false;
+static xSemaphoreHandle dmaRxDataReady;
+static uint8_t dmaRxBuffer[UART1_DMA_RX_BUFFER_SIZE];
+// Number of times the DMA has wrapped around the buffer, updated by the ISR
+static volatile uint32_t dmaRxWrapCount;
+// Total number of bytes consumed by the reader (modulo 2^32)
+static uint32_t dmaRxReadPosition;
+
 /**
   * Configures the UART DMA. Mainly used for FreeRTOS trace
   * data transfer.
@@ -101,7 +111,50 @@ static void uart1DmaInit(void) {
 #endif
 }
 
-void uart1Init(const uint32_t baudrate)
+/**
+  * Configures the circular UART receive DMA
+  */
+static void uart1DmaRxInit(void) {
+  DMA_InitTypeDef DMA_InitStructure;
+  NVIC_InitTypeDef NVIC_InitStructure;
+
+  dmaRxDataReady = xSemaphoreCreateBinary();
+  dmaRxWrapCount = 0;
+  dmaRxReadPosition = 0;
+
+  RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+
+  DMA_DeInit(UART1_DMA_RX_STREAM);
+  DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&UART1_TYPE->DR;
+  DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)dmaRxBuffer;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_BufferSize = UART1_DMA_RX_BUFFER_SIZE;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+  DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+  DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_1QuarterFull;
+  DMA_InitStructure.DMA_Channel = UART1_DMA_RX_CH;
+  DMA_Init(UART1_DMA_RX_STREAM, &DMA_InitStructure);
+
+  DMA_ITConfig(UART1_DMA_RX_STREAM, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+  NVIC_InitStructure.NVIC_IRQChannel = UART1_DMA_RX_IRQ;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_MID_PRI;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
+
+  USART_DMACmd(UART1_TYPE, USART_DMAReq_Rx, ENABLE);
+  DMA_Cmd(UART1_DMA_RX_STREAM, ENABLE);
+}
+
+static void uart1InitInternal(const uint32_t baudrate, const bool useDmaRx)
 {
 
   USART_InitTypeDef USART_InitStructure;
@@ -145,18 +198,31 @@ void uart1Init(const uint32_t baudrate)
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   NVIC_Init(&NVIC_InitStructure);
 
-  uart1queue = xQueueCreate(64, sizeof(uint8_t));
-
-  USART_ITConfig(UART1_TYPE, USART_IT_RXNE, ENABLE);
+  isDmaRx = useDmaRx;
+  if (useDmaRx) {
+    uart1DmaRxInit();
+    USART_ITConfig(UART1_TYPE, USART_IT_IDLE, ENABLE);
+  } else {
+    uart1queue = xQueueCreate(64, sizeof(uint8_t));
+    USART_ITConfig(UART1_TYPE, USART_IT_RXNE, ENABLE);
+  }
 
   //Enable UART
   USART_Cmd(UART1_TYPE, ENABLE);
-  
-  USART_ITConfig(UART1_TYPE, USART_IT_RXNE, ENABLE);
 
   isInit = true;
 }
 
+void uart1Init(const uint32_t baudrate)
+{
+  uart1InitInternal(baudrate, false);
+}
+
+void uart1InitWithDmaRx(const uint32_t baudrate)
+{
+  uart1InitInternal(baudrate, true);
+}
+
 bool uart1Test(void)
 {
   return isInit;
@@ -227,6 +293,61 @@ void uart1Getchar(char * ch)
   xQueueReceive(uart1queue, ch, portMAX_DELAY);
 }
 
+static uint32_t dmaRxWritePosition(void)
+{
+  uint32_t wrapCount;
+  uint32_t remaining;
+  do {
+    wrapCount = dmaRxWrapCount;
+    remaining = DMA_GetCurrDataCounter(UART1_DMA_RX_STREAM);
+  } while (wrapCount != dmaRxWrapCount);
+
+  return wrapCount * UART1_DMA_RX_BUFFER_SIZE + (UART1_DMA_RX_BUFFER_SIZE - remaining);
+}
+
+static uint32_t dmaRxAvailable(void)
+{
+  const int32_t available = (int32_t)(dmaRxWritePosition() - dmaRxReadPosition);
+
+  // Negative in the short window where the DMA has wrapped but the ISR has
+  // not updated the wrap count yet
+  if (available < 0) {
+    return 0;
+  }
+
+  if (available > UART1_DMA_RX_BUFFER_SIZE) {
+    // The DMA has overwritten data we have not read, skip it
+    dmaRxReadPosition += available;
+    hasOverrun = true;
+    return 0;
+  }
+
+  return available;
+}
+
+uint32_t uart1DmaRxGetData(const uint8_t** data, const uint32_t timeoutTicks)
+{
+  uint32_t available = dmaRxAvailable();
+  if (available == 0) {
+    xSemaphoreTake(dmaRxDataReady, timeoutTicks);
+    available = dmaRxAvailable();
+  }
+
+  // Only return contiguous data, the rest is returned in the next call
+  const uint32_t readIndex = dmaRxReadPosition & (UART1_DMA_RX_BUFFER_SIZE - 1);
+  if (readIndex + available > UART1_DMA_RX_BUFFER_SIZE) {
+    available = UART1_DMA_RX_BUFFER_SIZE - readIndex;
+  }
+
+  *data = &dmaRxBuffer[readIndex];
+  return available;
+}
+
+void uart1DmaRxConsume(const uint32_t size)
+{
+  dmaRxReadPosition += size;
+}
+
 bool uart1DidOverrun()
 {
   bool result = hasOverrun;
@@ -250,12 +371,37 @@ void __attribute__((used)) DMA1_Stream3_IRQHandler(void)
 }
 #endif
 
+void __attribute__((used)) DMA1_Stream1_IRQHandler(void)
+{
+  portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+  if (DMA_GetITStatus(UART1_DMA_RX_STREAM, UART1_DMA_RX_IT_TCIF)) {
+    DMA_ClearITPendingBit(UART1_DMA_RX_STREAM, UART1_DMA_RX_IT_TCIF);
+    dmaRxWrapCount++;
+  }
+
+  if (DMA_GetITStatus(UART1_DMA_RX_STREAM, UART1_DMA_RX_IT_HTIF)) {
+    DMA_ClearITPendingBit(UART1_DMA_RX_STREAM, UART1_DMA_RX_IT_HTIF);
+  }
+
+  xSemaphoreGiveFromISR(dmaRxDataReady, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
 void __attribute__((used)) USART3_IRQHandler(void)
 {
   uint8_t rxData;
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-  if (USART_GetITStatus(UART1_TYPE, USART_IT_RXNE))
+  if (isDmaRx && USART_GetITStatus(UART1_TYPE, USART_IT_IDLE))
+  {
+    // Idle line, wake up the reader to handle the end of the burst. The flag
+    // is cleared by reading SR followed by DR.
+    asm volatile ("" : "=m" (UART1_TYPE->SR) : "r" (UART1_TYPE->SR));
+    asm volatile ("" : "=m" (UART1_TYPE->DR) : "r" (UART1_TYPE->DR));
+    xSemaphoreGiveFromISR(dmaRxDataReady, &xHigherPriorityTaskWoken);
+  }
+  else if (USART_GetITStatus(UART1_TYPE, USART_IT_RXNE))
   {
     rxData = USART_ReceiveData(UART1_TYPE) & 0x00FF;
     xQueueSendFromISR(uart1queue, &rxData, &xHigherPriorityTaskWoken);
@@ -42,6 +42,7 @@
 #include "nvicconf.h"
 #include "config.h"
 #include "queuemonitor.h"
+#include "log.h"
 
 
 #define UARTSLK_DATA_TIMEOUT_MS 1000
@@ -52,7 +53,7 @@ static bool isInit = false;
 
 static xSemaphoreHandle waitUntilSendDone;
 static xSemaphoreHandle uartBusy;
-static xQueueHandle syslinkPacketDelivery;
+static xSemaphoreHandle dmaRxDataReady;
 
 static uint8_t dmaBuffer[64];
 static uint8_t *outDataIsr;
@@ -64,11 +65,24 @@ static uint32_t initialDMACount;
 static uint32_t remainingDMACount;
 static bool     dmaIsPaused;
 
-static volatile SyslinkPacket slp = {0};
-static volatile SyslinkRxState rxState = waitForFirstStart;
-static volatile uint8_t dataIndex = 0;
-static volatile uint8_t cksum[2] = {0};
-static void uartslkHandleDataFromISR(uint8_t c, BaseType_t * const pxHigherPriorityTaskWoken);
+// Number of times the DMA has wrapped around the buffer, updated by the ISR
+static volatile uint32_t dmaRxWrapCount;
+static uint32_t dmaRxOverrunCount;
+static uint32_t rxChecksumErrorCount;
+
+// The receiver is not used when the UART only outputs raw data
+#ifndef UART_OUTPUT_RAW_DATA_ONLY
+static uint8_t dmaRxBuffer[UARTSLK_DMA_RX_BUFFER_SIZE];
+// Total number of bytes parsed (modulo 2^32)
+static uint32_t dmaRxReadPosition;
+
+// Parser state, only used from the syslink task
+static SyslinkPacket slp;
+static SyslinkRxState rxState = waitForFirstStart;
+static uint8_t dataIndex = 0;
+static uint8_t cksum[2] = {0};
+static bool uartslkParseByte(const uint8_t c);
+#endif
 
 static void uartslkPauseDma();
 static void uartslkResumeDma();
@@ -109,6 +123,52 @@ void uartslkDmaInit(void)
   isUartDmaInitialized = true;
 }
 
+#ifndef UART_OUTPUT_RAW_DATA_ONLY
+/**
+  * Configures the circular receive DMA. Received bytes are framed into syslink
+  * packets by the reader, the interrupts only wake it up.
+  */
+static void uartslkDmaRxInit(void)
+{
+  DMA_InitTypeDef DMA_InitStructure;
+  NVIC_InitTypeDef NVIC_InitStructure;
+
+  dmaRxWrapCount = 0;
+  dmaRxReadPosition = 0;
+
+  RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
+
+  DMA_DeInit(UARTSLK_DMA_RX_STREAM);
+  DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&UARTSLK_TYPE->DR;
+  DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)dmaRxBuffer;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_BufferSize = UARTSLK_DMA_RX_BUFFER_SIZE;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+  DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+  DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_1QuarterFull;
+  DMA_InitStructure.DMA_Channel = UARTSLK_DMA_RX_CH;
+  DMA_Init(UARTSLK_DMA_RX_STREAM, &DMA_InitStructure);
+
+  DMA_ITConfig(UARTSLK_DMA_RX_STREAM, DMA_IT_HT | DMA_IT_TC, ENABLE);
+
+  NVIC_InitStructure.NVIC_IRQChannel = UARTSLK_DMA_RX_IRQ;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_SYSLINK_PRI;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
+
+  USART_DMACmd(UARTSLK_TYPE, USART_DMAReq_Rx, ENABLE);
+  DMA_Cmd(UARTSLK_DMA_RX_STREAM, ENABLE);
+}
+#endif
+
 void uartslkInit(void)
 {
   // initialize the FreeRTOS structures first, to prevent null pointers in interrupts
@@ -116,8 +176,7 @@ void uartslkInit(void)
   uartBusy = xSemaphoreCreateBinary(); // initialized as blocking
   xSemaphoreGive(uartBusy); // but we give it because the uart isn't busy at initialization
 
-  syslinkPacketDelivery = xQueueCreate(8, sizeof(SyslinkPacket));
-  DEBUG_QUEUE_MONITOR_REGISTER(syslinkPacketDelivery);
+  dmaRxDataReady = xSemaphoreCreateBinary();
 
   USART_InitTypeDef USART_InitStructure;
   GPIO_InitTypeDef GPIO_InitStructure;
@@ -159,15 +218,18 @@ void uartslkInit(void)
   USART_Init(UARTSLK_TYPE, &USART_InitStructure);
 
   uartslkDmaInit();
+#ifndef UART_OUTPUT_RAW_DATA_ONLY
+  uartslkDmaRxInit();
+#endif
 
-  // Configure Rx buffer not empty interrupt
+  // Configure idle line interrupt, marks the end of a burst from the NRF
   NVIC_InitStructure.NVIC_IRQChannel = UARTSLK_IRQ;
   NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_SYSLINK_PRI;
   NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
   NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
   NVIC_Init(&NVIC_InitStructure);
 
-  USART_ITConfig(UARTSLK_TYPE, USART_IT_RXNE, ENABLE);
+  USART_ITConfig(UARTSLK_TYPE, USART_IT_IDLE, ENABLE);
 
   //Setting up TXEN pin (NRF flow control)
   RCC_AHB1PeriphClockCmd(UARTSLK_TXEN_PERIF, ENABLE);
@@ -197,11 +259,80 @@ bool uartslkTest(void)
   return isInit;
 }
 
+#ifdef UART_OUTPUT_RAW_DATA_ONLY
 void uartslkGetPacketBlocking(SyslinkPacket* packet)
 {
-  xQueueReceive(syslinkPacketDelivery, packet, portMAX_DELAY);
+  // The receiver and its DMA are not set up when the UART only outputs raw
+  // data, nothing will ever be received
+  while (true)
+  {
+    xSemaphoreTake(dmaRxDataReady, portMAX_DELAY);
+  }
+}
+#else
+static uint32_t dmaRxWritePosition(void)
+{
+  uint32_t wrapCount;
+  uint32_t remaining;
+  do {
+    wrapCount = dmaRxWrapCount;
+    remaining = DMA_GetCurrDataCounter(UARTSLK_DMA_RX_STREAM);
+  } while (wrapCount != dmaRxWrapCount);
+
+  return wrapCount * UARTSLK_DMA_RX_BUFFER_SIZE + (UARTSLK_DMA_RX_BUFFER_SIZE - remaining);
 }
 
+static uint32_t dmaRxAvailable(void)
+{
+  const int32_t available = (int32_t)(dmaRxWritePosition() - dmaRxReadPosition);
+
+  // Negative in the short window where the DMA has wrapped but the ISR has
+  // not updated the wrap count yet
+  if (available < 0) {
+    return 0;
+  }
+
+  if (available > UARTSLK_DMA_RX_BUFFER_SIZE) {
+    // The DMA has overwritten data we have not parsed, skip it and resync
+    dmaRxReadPosition += available;
+    dmaRxOverrunCount++;
+    rxState = waitForFirstStart;
+    IF_DEBUG_ASSERT(0);
+    return 0;
+  }
+
+  return available;
+}
+
+void uartslkGetPacketBlocking(SyslinkPacket* packet)
+{
+  while (true)
+  {
+    uint32_t available = dmaRxAvailable();
+    if (available == 0)
+    {
+      xSemaphoreTake(dmaRxDataReady, portMAX_DELAY);
+      continue;
+    }
+
+    // Frame as many bytes as possible in one go, stop at the end of a packet
+    // and leave the rest in the buffer for the next call
+    while (available > 0)
+    {
+      const uint8_t c = dmaRxBuffer[dmaRxReadPosition & (UARTSLK_DMA_RX_BUFFER_SIZE - 1)];
+      dmaRxReadPosition++;
+      available--;
+
+      if (uartslkParseByte(c))
+      {
+        memcpy(packet, &slp, sizeof(SyslinkPacket));
+        return;
+      }
+    }
+  }
+}
+#endif
+
 void uartslkSendData(uint32_t size, uint8_t* data)
 {
   uint32_t i;
@@ -315,8 +446,15 @@ void uartslkDmaIsr(void)
   xSemaphoreGiveFromISR(waitUntilSendDone, &xHigherPriorityTaskWoken);
 }
 
-void uartslkHandleDataFromISR(uint8_t c, BaseType_t * const pxHigherPriorityTaskWoken)
+#ifndef UART_OUTPUT_RAW_DATA_ONLY
+/**
+ * Feed one received byte to the syslink framing state machine.
+ * @return true when the byte completed a valid packet, available in slp
+ */
+static bool uartslkParseByte(const uint8_t c)
 {
+  bool isComplete = false;
+
   switch (rxState)
   {
   case waitForFirstStart:
@@ -363,25 +501,19 @@ void uartslkHandleDataFromISR(uint8_t c, BaseType_t * const pxHigherPriorityTask
     else
     {
       rxState = waitForFirstStart; //Checksum error
+      rxChecksumErrorCount++;
       IF_DEBUG_ASSERT(0);
     }
     break;
   case waitForChksum2:
     if (cksum[1] == c)
     {
-      // Post the packet to the queue if there's room
-      if (!xQueueIsQueueFullFromISR(syslinkPacketDelivery))
-      {
-        xQueueSendFromISR(syslinkPacketDelivery, (void *)&slp, pxHigherPriorityTaskWoken);
-      }
-      else
-      {
-        IF_DEBUG_ASSERT(0); // Queue overflow
-      }
+      isComplete = true;
     }
     else
     {
       rxState = waitForFirstStart; //Checksum error
+      rxChecksumErrorCount++;
       IF_DEBUG_ASSERT(0);
     }
     rxState = waitForFirstStart;
@@ -390,20 +522,22 @@ void uartslkHandleDataFromISR(uint8_t c, BaseType_t * const pxHigherPriorityTask
     ASSERT(0);
     break;
   }
+
+  return isComplete;
 }
+#endif
 
 void uartslkIsr(void)
 {
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
 
-  // the following if statement replaces:
-  //   if (USART_GetITStatus(UARTSLK_TYPE, USART_IT_RXNE) == SET)
-  // we do this check as fast as possible to minimize the chance of an overrun,
-  // which occasionally cause problems and cause packet loss at high CPU usage
-  if ((UARTSLK_TYPE->SR & (1<<5)) != 0) // if the RXNE interrupt has occurred
+  // Received data is moved by the DMA, the idle line only wakes up the reader
+  // to frame the end of a burst. The flag is cleared by reading SR followed by DR.
+  if (USART_GetITStatus(UARTSLK_TYPE, USART_IT_IDLE) == SET)
   {
-    uint8_t rxDataInterrupt = (uint8_t)(UARTSLK_TYPE->DR & 0xFF);
-    uartslkHandleDataFromISR(rxDataInterrupt, &xHigherPriorityTaskWoken);
+    asm volatile ("" : "=m" (UARTSLK_TYPE->SR) : "r" (UARTSLK_TYPE->SR));
+    asm volatile ("" : "=m" (UARTSLK_TYPE->DR) : "r" (UARTSLK_TYPE->DR));
+    xSemaphoreGiveFromISR(dmaRxDataReady, &xHigherPriorityTaskWoken);
   }
   else if (USART_GetITStatus(UARTSLK_TYPE, USART_IT_TXE) == SET)
   {
@@ -461,3 +595,27 @@ void __attribute__((used)) DMA2_Stream7_IRQHandler(void)
 {
   uartslkDmaIsr();
 }
+
+void __attribute__((used)) DMA2_Stream1_IRQHandler(void)
+{
+  portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+  if (DMA_GetITStatus(UARTSLK_DMA_RX_STREAM, UARTSLK_DMA_RX_IT_TCIF))
+  {
+    DMA_ClearITPendingBit(UARTSLK_DMA_RX_STREAM, UARTSLK_DMA_RX_IT_TCIF);
+    dmaRxWrapCount++;
+  }
+
+  if (DMA_GetITStatus(UARTSLK_DMA_RX_STREAM, UARTSLK_DMA_RX_IT_HTIF))
+  {
+    DMA_ClearITPendingBit(UARTSLK_DMA_RX_STREAM, UARTSLK_DMA_RX_IT_HTIF);
+  }
+
+  xSemaphoreGiveFromISR(dmaRxDataReady, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+LOG_GROUP_START(syslink)
+LOG_ADD(LOG_UINT32, rxOverrun, &dmaRxOverrunCount)
+LOG_ADD(LOG_UINT32, rxChksumErr, &rxChecksumErrorCount)
+LOG_GROUP_STOP(syslink)
@@ -34,6 +34,9 @@
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
+
+#include "ws2812.h"
 
 //#define TIM1_CCR1_Address 0x40012C34	// physical memory address of Timer 3 CCR1 register
 
@@ -62,6 +65,16 @@ static union {
     } __attribute__((packed));
 } led_dma;
 
+// Full frame mode. A frame is encoded once into the back buffer while the
+// front buffer may still be transmitted, the DMA then runs in normal mode
+// over the whole frame and stops by itself. The trailing zero slots keep the
+// line low for the >50us reset.
+#define FRAME_RESET_SLOTS 48
+#define FRAME_BUFFER_SIZE (WS2812_FRAME_MAX_LEDS * 24 + FRAME_RESET_SLOTS)
+
+static uint16_t frameBuffer[2][FRAME_BUFFER_SIZE];
+static int frameBackBuffer = 0;
+
 void ws2812Init(void) {
 	uint16_t PrescalerValue;
 
@@ -167,12 +180,55 @@ static int current_led = 0;
 static int total_led = 0;
 static uint8_t (*color_led)[3] = NULL;
 
+static void waitForFrameDone(void) {
+  // A full frame takes less than 0.5 ms, no need for an interrupt
+  while (DMA_GetCmdStatus(DMA1_Stream5) != DISABLE) {
+    vTaskDelay(1);
+  }
+}
+
+static void ws2812SendFrame(uint8_t (*color)[3], uint16_t len) {
+  uint16_t* buffer = frameBuffer[frameBackBuffer];
+  int i;
+
+  // Encode into the back buffer while the previous frame may still be sent
+  for (i = 0; i < len; i++) {
+    fillLed(buffer + (24 * i), color[i]);
+  }
+  bzero(buffer + (24 * len), FRAME_RESET_SLOTS * sizeof(buffer[0]));
+
+  waitForFrameDone();
+
+  DMA_ITConfig(DMA1_Stream5, DMA_IT_TC | DMA_IT_HT, DISABLE);
+  DMA_ClearFlag(DMA1_Stream5, DMA_FLAG_TCIF5 | DMA_FLAG_HTIF5 | DMA_FLAG_TEIF5 | DMA_FLAG_DMEIF5 | DMA_FLAG_FEIF5);
+  DMA1_Stream5->CR &= ~DMA_SxCR_CIRC;
+  DMA1_Stream5->M0AR = (uint32_t)buffer;
+  DMA1_Stream5->NDTR = len * 24 + FRAME_RESET_SLOTS;
+
+  frameBackBuffer = 1 - frameBackBuffer;
+
+  DMA_Cmd(DMA1_Stream5, ENABLE);
+  TIM_Cmd(TIM3, ENABLE);
+}
+
 void ws2812Send(uint8_t (*color)[3], uint16_t len) {
     int i;
 	if (len < 1) return;
 
+  if (len <= WS2812_FRAME_MAX_LEDS) {
+    ws2812SendFrame(color, len);
+    return;
+  }
+
 	//Wait for previous transfer to be finished
 	xSemaphoreTake(allLedDone, portMAX_DELAY);
+	waitForFrameDone();
+
+	// Back to streaming through the circular buffer
+	DMA_ClearFlag(DMA1_Stream5, DMA_FLAG_TCIF5 | DMA_FLAG_HTIF5 | DMA_FLAG_TEIF5 | DMA_FLAG_DMEIF5 | DMA_FLAG_FEIF5);
+	DMA1_Stream5->CR |= DMA_SxCR_CIRC;
+	DMA1_Stream5->M0AR = (uint32_t)led_dma.buffer;
+	DMA_ITConfig(DMA1_Stream5, DMA_IT_TC | DMA_IT_HT, ENABLE);
 
 	// Set interrupt context ...
 	current_led = 0;
@@ -90,6 +90,7 @@ bool begin(AMG8833_Dev_t *dev, I2C_Dev *I2Cx);
 
 // Data capture
 void readPixels(AMG8833_Dev_t *dev, float *buf, uint8_t size);
+bool readPixelsRaw(AMG8833_Dev_t *dev, int16_t *buf);
 float readThermistor(AMG8833_Dev_t *dev);
 
 // Interrupts
@@ -117,6 +118,7 @@ void write(AMG8833_Dev_t *dev, uint8_t reg, uint8_t *buf, uint8_t num);
 // Supportive calculations
 float signedMag12ToFloat(uint16_t val);
 float int12ToFloat(uint16_t val);
+int16_t int12ToInt16(uint16_t val);
 uint8_t min(uint8_t a, uint8_t b);
 
 #endif /* __AMG8833_H__ */
@@ -81,6 +81,32 @@ void readPixels(AMG8833_Dev_t *dev, float *buf, uint8_t size)
   }
 }
 
+/**************************************************************************
+ Read all pixels without converting them to float
+
+ The full frame is read in one burst, which the I2C driver transfers with
+ DMA.
+
+ @param  pdev Thermal camera struct
+ @param  buf the array to place the AMG88xx_PIXEL_ARRAY_SIZE pixels in, in
+ units of 0.25 degrees C
+ @returns True on success, else false
+**************************************************************************/
+bool readPixelsRaw(AMG8833_Dev_t *dev, int16_t *buf)
+{
+  uint8_t rawArray[AMG88xx_PIXEL_ARRAY_SIZE << 1];
+  if (!i2cdevReadReg8(dev->I2Cx, dev->devAddr, AMG88xx_PIXEL_OFFSET, sizeof(rawArray), rawArray)) {
+    return false;
+  }
+
+  for (int i = 0; i < AMG88xx_PIXEL_ARRAY_SIZE; i++) {
+    uint8_t pos = i << 1;
+    buf[i] = int12ToInt16(((uint16_t) rawArray[pos + 1] << 8) | ((uint16_t) rawArray[pos]));
+  }
+
+  return true;
+}
+
 /**************************************************************************
  Read the onboard thermistor
 
@@ -290,6 +316,18 @@ float int12ToFloat(uint16_t val)
   return sVal >> 4;
 }
 
+/**************************************************************************
+ Convert a 12-bit integer two's complement value to a 16 bit integer
+
+ @param  val the 12-bit integer  two's complement value to be converted
+ @returns the sign extended value
+**************************************************************************/
+int16_t int12ToInt16(uint16_t val)
+{
+  int16_t sVal = (val << 4);
+  return sVal >> 4;
+}
+
 /**************************************************************************
  Finds the minimum value between two integers
 
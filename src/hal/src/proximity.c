@@ -35,6 +35,7 @@
 #include "system.h"
 #include "param.h"
 #include "log.h"
+#include "sliding_median.h"
 
 #include "stm32fxxx.h"
 
@@ -47,8 +48,13 @@ static uint32_t proximityDistanceAvg    = 0; /* Average distance in millimeters,
 static uint32_t proximityDistanceMedian = 0; /* Median distance in millimeters, initialized to zero. */
 static uint32_t proximityAccuracy       = 0; /* The accuracy as reported by the sensor driver for the latest sample. */
 
-/* The most recent samples in chronological order. Must be initialized before use. */
+/* The most recent samples, oldest at proximitySWinNext. Must be initialized before use. */
 static uint32_t proximitySWin[PROXIMITY_SWIN_SIZE];
+static uint8_t proximitySWinNext = 0;
+static uint64_t proximitySWinSum = 0;
+
+/* Median of the samples in the sliding window. */
+static slidingMedian_t proximityMedian;
 
 #if defined(PROXIMITY_ENABLED)
 
@@ -62,40 +68,6 @@ LOG_ADD(LOG_UINT32, accuracy, &proximityAccuracy)
 LOG_GROUP_STOP(proximity)
 #endif
 
-/**
- * This function returns the median value of an array.
- *
- * Internal sorting function by Bill Gentles Nov. 12 2010, seen
- * on http://forum.arduino.cc/index.php?topic=20920.0
- *
- * @param proximitySWin Array of chronologically sequenced samples.
- *
- * @return Median value from the array.
- */
-static uint32_t proximitySWinMedian(uint32_t *proximitySWin)
-{
-  /* The most recent samples, sorted in increasing sample value order. Must be initialized before use. */
-  uint32_t proximitySorted[PROXIMITY_SWIN_SIZE];
-
-  /* Create a copy of the chronologically sequenced buffer. */
-  memcpy(proximitySorted, proximitySWin, sizeof(uint32_t)*PROXIMITY_SWIN_SIZE);
-
-  /* Now sort this copy. */
-  uint8_t n;
-  for (n = 1; n < PROXIMITY_SWIN_SIZE; ++n) {
-    uint32_t valn = proximitySorted[n];
-    int8_t m; /* May reach value of -1 */
-    for (m = n - 1; (m >= 0) && (valn < proximitySorted[m]); m--)
-    {
-      proximitySorted[m + 1] = proximitySorted[m];
-    }
-    proximitySorted[m + 1] = valn;
-  }
-
-  /* Return the median value of the samples. */
-  return proximitySorted[PROXIMITY_SWIN_SIZE / 2];
-}
-
 /**
  * This function adds a distance measurement to the sliding window, discarding the oldest sample.
  * After having added the new sample, a new average value of the samples is calculated and returned.
@@ -106,24 +78,16 @@ static uint32_t proximitySWinMedian(uint32_t *proximitySWin)
  */
 static uint32_t proximitySWinAdd(uint32_t distance)
 {
-  /* Discard oldest sample, move remaining samples one slot to the left. */
-  memmove(&proximitySWin[0], &proximitySWin[1], (PROXIMITY_SWIN_SIZE - 1) * sizeof(uint32_t));
-
-  /* Add the new sample in the last (right-most) slot. */
-  proximitySWin[PROXIMITY_SWIN_SIZE - 1] = distance;
-
-  /**
-   * Calculate the new average distance. Sum all the samples into a uint64_t,
-   * so that we only do a single division at the end.
-   */
-  uint64_t proximityNewAvg = 0;
-  uint8_t n;
-  for (n = 0; n < PROXIMITY_SWIN_SIZE; n++) {
-    proximityNewAvg += proximitySWin[n];
-  }
-  proximityNewAvg = proximityNewAvg / PROXIMITY_SWIN_SIZE;
+  /* Replace the oldest sample and update the sum of the samples. */
+  proximitySWinSum -= proximitySWin[proximitySWinNext];
+  proximitySWin[proximitySWinNext] = distance;
+  proximitySWinSum += distance;
+  proximitySWinNext = (proximitySWinNext + 1) % PROXIMITY_SWIN_SIZE;
+
+  /* The median is updated incrementally, in O(log n) of the window size. */
+  slidingMedianAdd(&proximityMedian, (float)distance);
 
-  return (uint32_t)proximityNewAvg;
+  return (uint32_t)(proximitySWinSum / PROXIMITY_SWIN_SIZE);
 }
 
 /**
@@ -155,7 +119,7 @@ static void proximityTask(void* param)
     proximityDistanceAvg = proximitySWinAdd(proximityDistance);
 
     /* Get the latest median value calculated. */
-    proximityDistanceMedian = proximitySWinMedian(proximitySWin);
+    proximityDistanceMedian = (uint32_t)slidingMedianGet(&proximityMedian);
   }
 }
 #endif
@@ -170,6 +134,12 @@ void proximityInit(void)
 
   /* Initialise the sliding window to zero. */
   memset(&proximitySWin, 0, sizeof(uint32_t)*PROXIMITY_SWIN_SIZE);
+  proximitySWinNext = 0;
+  proximitySWinSum = 0;
+  slidingMedianInit(&proximityMedian, PROXIMITY_SWIN_SIZE);
+  for (int i = 0; i < PROXIMITY_SWIN_SIZE; i++) {
+    slidingMedianAdd(&proximityMedian, 0.0f);
+  }
 
 #if defined(PROXIMITY_ENABLED)
   /* Only start the task if the proximity subsystem is enabled in conf.h */
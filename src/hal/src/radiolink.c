@@ -44,6 +44,7 @@
 #include "queuemonitor.h"
 
 #define RADIOLINK_TX_QUEUE_SIZE (1)
+#define RADIOLINK_RX_QUEUE_SIZE (5)
 #define RADIO_ACTIVITY_TIMEOUT_MS (1000)
 
 static xQueueHandle  txQueue;
@@ -53,12 +54,14 @@ static bool isInit;
 
 static int radiolinkSendCRTPPacket(CRTPPacket *p);
 static int radiolinkSetEnable(bool enable);
-static int radiolinkReceiveCRTPPacket(CRTPPacket *p);
+static int radiolinkReceiveCRTPPacket(CRTPPacket **p);
 
 //Local RSSI variable used to enable logging of RSSI values from Radio
 static uint8_t rssi;
 static bool isConnected;
 static uint32_t lastPacketTick;
+// Packets dropped because the CRTP rx task did not keep up
+static uint32_t rxDropCount;
 
 
 static bool radiolinkIsConnected(void) {
@@ -69,7 +72,7 @@ static struct crtpLinkOperations radiolinkOp =
 {
   .setEnable         = radiolinkSetEnable,
   .sendPacket        = radiolinkSendCRTPPacket,
-  .receivePacket     = radiolinkReceiveCRTPPacket,
+  .receivePacketRef  = radiolinkReceiveCRTPPacket,
   .isConnected       = radiolinkIsConnected
 };
 
@@ -80,7 +83,7 @@ void radiolinkInit(void)
 
   txQueue = xQueueCreate(RADIOLINK_TX_QUEUE_SIZE, sizeof(SyslinkPacket));
   DEBUG_QUEUE_MONITOR_REGISTER(txQueue);
-  crtpPacketDelivery = xQueueCreate(5, sizeof(CRTPPacket));
+  crtpPacketDelivery = xQueueCreate(RADIOLINK_RX_QUEUE_SIZE, sizeof(CRTPPacket*));
   DEBUG_QUEUE_MONITOR_REGISTER(crtpPacketDelivery);
 
 
@@ -141,6 +144,26 @@ void radiolinkSetPowerDbm(int8_t powerDbm)
 }
 
 
+// Copy the CRTP part of the syslink packet to a pool buffer and hand it over
+// to the CRTP rx task by pointer. Dropped if the pool or the queue is full.
+static void deliverCrtpPacket(SyslinkPacket *slp)
+{
+  CRTPPacket* p = crtpPacketAlloc();
+  if (p == NULL)
+  {
+    return;
+  }
+
+  slp->length--; // Decrease to get CRTP size.
+  memcpy(p, &slp->length, sizeof(CRTPPacket));
+
+  if (xQueueSend(crtpPacketDelivery, &p, 0) != pdTRUE)
+  {
+    rxDropCount++;
+    crtpPacketFree(p);
+  }
+}
+
 void radiolinkSyslinkDispatch(SyslinkPacket *slp)
 {
   static SyslinkPacket txPacket;
@@ -151,8 +174,7 @@ void radiolinkSyslinkDispatch(SyslinkPacket *slp)
 
   if (slp->type == SYSLINK_RADIO_RAW)
   {
-    slp->length--; // Decrease to get CRTP size.
-    xQueueSend(crtpPacketDelivery, &slp->length, 0);
+    deliverCrtpPacket(slp);
     ledseqRun(LINK_LED, seq_linkup);
     // If a radio packet is received, one can be sent
     if (xQueueReceive(txQueue, &txPacket, 0) == pdTRUE)
@@ -162,8 +184,7 @@ void radiolinkSyslinkDispatch(SyslinkPacket *slp)
     }
   } else if (slp->type == SYSLINK_RADIO_RAW_BROADCAST)
   {
-    slp->length--; // Decrease to get CRTP size.
-    xQueueSend(crtpPacketDelivery, &slp->length, 0);
+    deliverCrtpPacket(slp);
     ledseqRun(LINK_LED, seq_linkup);
     // no ack for broadcasts
   } else if (slp->type == SYSLINK_RADIO_RSSI)
@@ -175,7 +196,7 @@ void radiolinkSyslinkDispatch(SyslinkPacket *slp)
   isConnected = radiolinkIsConnected();
 }
 
-static int radiolinkReceiveCRTPPacket(CRTPPacket *p)
+static int radiolinkReceiveCRTPPacket(CRTPPacket **p)
 {
   if (xQueueReceive(crtpPacketDelivery, p, M2T(100)) == pdTRUE)
   {
@@ -216,4 +237,5 @@ static int radiolinkSetEnable(bool enable)
 LOG_GROUP_START(radio)
 LOG_ADD(LOG_UINT8, rssi, &rssi)
 LOG_ADD(LOG_UINT8, isConnected, &isConnected)
+LOG_ADD(LOG_UINT32, rxDrop, &rxDropCount)
 LOG_GROUP_STOP(radio)
@@ -42,13 +42,17 @@
 
 #include "system.h"
 #include "configblock.h"
+#include "sensor_calib.h"
+#include "worker.h"
 #include "param.h"
 #include "log.h"
 #include "debug.h"
 #include "nvicconf.h"
 #include "ledseq.h"
 #include "sound.h"
-#include "filter.h"
+#include "filter_bank.h"
+#include "dynamic_notch.h"
+#include "power_distribution.h"
 #include "i2cdev.h"
 #include "bmi088.h"
 #include "bmp3.h"
@@ -88,6 +92,13 @@
 
 #define SENSORS_ACC_SCALE_SAMPLES  200
 
+// Limits for using the stored calibration at start up, a new calibration is
+// stored when it differs by more than half of these
+#define SENSORS_CALIB_MAX_TEMPERATURE_DIFF  5.0f   // Degrees C
+#define SENSORS_CALIB_MAX_GYRO_BIAS_DIFF    10.0f  // LSB, about 0.6 deg/s
+#define SENSORS_CALIB_MAX_GYRO_VARIANCE     ((float)GYRO_VARIANCE_BASE / SENSORS_NBR_OF_BIAS_SAMPLES)
+#define SENSORS_CALIB_MAX_ACC_SCALE_DIFF    0.02f  // g
+
 typedef struct {
   Axis3f     bias;
   Axis3f     variance;
@@ -117,6 +128,7 @@ static Axis3i16 gyroRaw;
 static Axis3i16 accelRaw;
 static BiasObj gyroBiasRunning;
 static Axis3f gyroBias;
+static Axis3f freshGyroBias;
 #if defined(SENSORS_GYRO_BIAS_CALCULATE_STDDEV) && defined (GYRO_BIAS_LIGHT_WEIGHT)
 static Axis3f gyroBiasStdDev;
 #endif
@@ -126,12 +138,36 @@ static float accScale = 1;
 static bool accScaleFound = false;
 static uint32_t accScaleSumCount = 0;
 
+// Warm start from the stored calibration
+static const sensorCalibLimits_t calibLimits = {
+  .maxTemperatureDiff = SENSORS_CALIB_MAX_TEMPERATURE_DIFF,
+  .maxGyroBiasDiff = SENSORS_CALIB_MAX_GYRO_BIAS_DIFF,
+  .maxGyroVariance = SENSORS_CALIB_MAX_GYRO_VARIANCE,
+  .maxAccScaleDiff = SENSORS_CALIB_MAX_ACC_SCALE_DIFF,
+};
+static uint8_t warmStartEnable = 1;
+static bool isStoredCalibValid = false;
+static sensorCalib_t storedCalib;
+static sensorCalibCheck_t warmStartCheck;
+static bool isWarmStartChecked = false;
+static bool isWarmStarted = false;
+static bool isCalibStored = false;
+static uint32_t calibrationTimeMs = 0;
+static uint32_t sensorsStartTick = 0;
+
 // Low Pass filtering
 #define GYRO_LPF_CUTOFF_FREQ  80
 #define ACCEL_LPF_CUTOFF_FREQ 30
-static lpf2pData accLpf[3];
-static lpf2pData gyroLpf[3];
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in);
+static filterBank_t accLpf;
+static filterBank_t gyroLpf;
+
+// Motor noise notch on the gyro, retuned at 100 Hz
+#define GYRO_FILTER_UPDATE_DIVIDER 10
+static dynamicNotch_t gyroNotch;
+static int gyroLpfSection;
+static float gyroLpfCutoff = GYRO_LPF_CUTOFF_FREQ;
+static float gyroLpfTunedCutoff = GYRO_LPF_CUTOFF_FREQ;
+static void gyroFilterUpdate(void);
 
 static bool isBarometerPresent = false;
 static uint8_t baroMeasDelayMin = SENSORS_DELAY_BARO;
@@ -148,6 +184,8 @@ static bool processGyroBiasNoBuffer(int16_t gx, int16_t gy, int16_t gz, Axis3f *
 static bool processGyroBias(int16_t gx, int16_t gy, int16_t gz,  Axis3f *gyroBiasOut);
 #endif
 static bool processAccScale(int16_t ax, int16_t ay, int16_t az);
+static void processWarmStart(void);
+static void storeCalibration(void);
 static void sensorsBiasObjInit(BiasObj* bias);
 static void sensorsCalculateVarianceAndMean(BiasObj* bias, Axis3f* varOut, Axis3f* meanOut);
 static void sensorsCalculateBiasMean(BiasObj* bias, Axis3i32* meanOut);
@@ -256,6 +294,7 @@ static void sensorsTask(void *param) {
    * this is only required by the z-ranger, since the
    * configuration will be done after system start-up */
   //vTaskDelayUntil(&lastWakeTime, M2T(1500));
+  sensorsStartTick = xTaskGetTickCount();
   while (1) {
     if (pdTRUE == xSemaphoreTake(sensorsDataReady, portMAX_DELAY)) {
       sensorData.interruptTimestamp = imuIntTimestamp;
@@ -266,25 +305,42 @@ static void sensorsTask(void *param) {
 
       /* calibrate if necessary */
 #ifdef GYRO_BIAS_LIGHT_WEIGHT
-      gyroBiasFound = processGyroBiasNoBuffer(gyroRaw.x, gyroRaw.y, gyroRaw.z, &gyroBias);
+      const bool freshGyroBiasFound = processGyroBiasNoBuffer(gyroRaw.x, gyroRaw.y, gyroRaw.z, &freshGyroBias);
 #else
-      gyroBiasFound = processGyroBias(gyroRaw.x, gyroRaw.y, gyroRaw.z, &gyroBias);
+      const bool freshGyroBiasFound = processGyroBias(gyroRaw.x, gyroRaw.y, gyroRaw.z, &freshGyroBias);
 #endif
+      if (!isWarmStartChecked && !freshGyroBiasFound) {
+        processWarmStart();
+      }
+
+      // The stored calibration is used until a fresh one has been found
+      if (freshGyroBiasFound) {
+        gyroBias = freshGyroBias;
+      }
+      if ((freshGyroBiasFound || isWarmStarted) && !gyroBiasFound) {
+        gyroBiasFound = true;
+        calibrationTimeMs = T2M(xTaskGetTickCount() - sensorsStartTick);
+      }
+
       if (gyroBiasFound) {
          processAccScale(accelRaw.x, accelRaw.y, accelRaw.z);
       }
+      if (freshGyroBiasFound && accScaleFound && !isCalibStored) {
+        storeCalibration();
+      }
       /* Gyro */
       sensorData.gyro.x =  (gyroRaw.x - gyroBias.x) * SENSORS_BMI088_DEG_PER_LSB_CFG;
       sensorData.gyro.y =  (gyroRaw.y - gyroBias.y) * SENSORS_BMI088_DEG_PER_LSB_CFG;
       sensorData.gyro.z =  (gyroRaw.z - gyroBias.z) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      applyAxis3fLpf((lpf2pData*)(&gyroLpf), &sensorData.gyro);
+      gyroFilterUpdate();
+      filterBankApply(&gyroLpf, sensorData.gyro.axis);
 
       /* Acelerometer */
       accScaled.x = accelRaw.x * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
       accScaled.y = accelRaw.y * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
       accScaled.z = accelRaw.z * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
       sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
-      applyAxis3fLpf((lpf2pData*)(&accLpf), &sensorData.acc);
+      filterBankApply(&accLpf, sensorData.acc.axis);
     }
 
     if (isBarometerPresent) {
@@ -451,10 +507,14 @@ static void sensorsDeviceInit(void) {
   }
 
   // Init second order filer for accelerometer and gyro
-  for (uint8_t i = 0; i < 3; i++) {
-    lpf2pInit(&gyroLpf[i], 1000, GYRO_LPF_CUTOFF_FREQ);
-    lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-  }
+  filterBankInit(&gyroLpf, 3);
+  dynamicNotchInit(&gyroNotch, &gyroLpf, 1000);
+  gyroLpfSection = filterBankAddLowPass(&gyroLpf, 1000, GYRO_LPF_CUTOFF_FREQ);
+  filterBankInit(&accLpf, 3);
+  filterBankAddLowPass(&accLpf, 1000, ACCEL_LPF_CUTOFF_FREQ);
+
+  isStoredCalibValid = configblockGetSensorCalib(&storedCalib) && sensorCalibIsPlausible(&storedCalib);
+  sensorCalibCheckInit(&warmStartCheck);
 
   cosPitch = cosf(configblockGetCalibPitch() * (float) M_PI / 180);
   sinPitch = sinf(configblockGetCalibPitch() * (float) M_PI / 180);
@@ -529,6 +589,11 @@ bool sensorsBmi088Bmp388Test(void) {
  */
 static bool processAccScale(int16_t ax, int16_t ay, int16_t az) {
   if (!accScaleFound) {
+    if (isWarmStarted && accScaleSumCount == 0) {
+      // Use the stored value while the new one is measured
+      accScale = storedCalib.accScale;
+    }
+
     accScaleSum += sqrtf(powf(ax * SENSORS_BMI088_G_PER_LSB_CFG, 2) + powf(ay * SENSORS_BMI088_G_PER_LSB_CFG, 2) + powf(az * SENSORS_BMI088_G_PER_LSB_CFG, 2));
     accScaleSumCount++;
 
@@ -594,7 +659,7 @@ static bool processGyroBias(int16_t gx, int16_t gy, int16_t gz, Axis3f *gyroBias
 
   if (!gyroBiasRunning.isBiasValueFound) {
     sensorsFindBiasValue(&gyroBiasRunning);
-    if (gyroBiasRunning.isBiasValueFound) {
+    if (gyroBiasRunning.isBiasValueFound && !isWarmStarted) {
       soundSetEffect(SND_CALIB);
       ledseqRun(SYS_LED, seq_calibrated);
     }
@@ -608,6 +673,67 @@ static bool processGyroBias(int16_t gx, int16_t gy, int16_t gz, Axis3f *gyroBias
 }
 #endif
 
+/**
+ * Checks if the stored calibration can be used, using the first
+ * SENSOR_CALIB_CHECK_SAMPLES samples. The platform must be still and the gyro
+ * bias, accelerometer scale and temperature must be close to the stored values.
+ * The normal calibration continues in the background and replaces the stored
+ * values when it is done.
+ */
+static void processWarmStart(void) {
+  if (!warmStartEnable || !isStoredCalibValid) {
+    isWarmStartChecked = true;
+    return;
+  }
+
+  const float accNorm = sqrtf(powf(accelRaw.x * SENSORS_BMI088_G_PER_LSB_CFG, 2) + powf(accelRaw.y * SENSORS_BMI088_G_PER_LSB_CFG, 2) + powf(accelRaw.z * SENSORS_BMI088_G_PER_LSB_CFG, 2));
+  const int16_t gyro[3] = {gyroRaw.x, gyroRaw.y, gyroRaw.z};
+  if (sensorCalibCheckAdd(&warmStartCheck, gyro, accNorm)) {
+    float temperature;
+    if (bmi088_get_sensor_temperature(&bmi088Dev, &temperature) == BMI088_OK &&
+        sensorCalibCheckMatches(&warmStartCheck, &storedCalib, temperature, &calibLimits)) {
+      gyroBias.x = storedCalib.gyroBias[0];
+      gyroBias.y = storedCalib.gyroBias[1];
+      gyroBias.z = storedCalib.gyroBias[2];
+      isWarmStarted = true;
+      soundSetEffect(SND_CALIB);
+      ledseqRun(SYS_LED, seq_calibrated);
+    }
+    isWarmStartChecked = true;
+  }
+}
+
+static void storeCalibrationWorker(void* arg) {
+  const sensorCalib_t* calib = arg;
+  if (!configblockSetSensorCalib(calib)) {
+    DEBUG_PRINT("Failed to store the sensor calibration\n");
+  }
+}
+
+/**
+ * Stores a new calibration if it differs from the stored one. Writing the
+ * eeprom is slow, it is done by the worker.
+ */
+static void storeCalibration(void) {
+  static sensorCalib_t freshCalib;
+  float temperature;
+
+  isCalibStored = true;
+  if (bmi088_get_sensor_temperature(&bmi088Dev, &temperature) != BMI088_OK) {
+    return;
+  }
+
+  freshCalib.gyroBias[0] = gyroBias.x;
+  freshCalib.gyroBias[1] = gyroBias.y;
+  freshCalib.gyroBias[2] = gyroBias.z;
+  freshCalib.accScale = accScale;
+  freshCalib.temperature = temperature;
+
+  if (!isStoredCalibValid || sensorCalibNeedsUpdate(&storedCalib, &freshCalib, &calibLimits)) {
+    workerSchedule(storeCalibrationWorker, &freshCalib);
+  }
+}
+
 static void sensorsBiasObjInit(BiasObj* bias) {
   bias->isBufferFilled = false;
   bias->bufHead = bias->buffer;
@@ -741,9 +867,8 @@ void sensorsBmi088Bmp388SetAccMode(accModes accMode) {
         DEBUG_PRINT("ACC config [FAIL]\n");
       }
 
-      for (uint8_t i = 0; i < 3; i++) {
-        lpf2pInit(&accLpf[i],  1000, 500);
-      }
+      filterBankSetLowPass(&accLpf, 0, 1000, 500);
+      filterBankReset(&accLpf);
       break;
     case ACC_MODE_FLIGHT:
     default:
@@ -755,19 +880,12 @@ void sensorsBmi088Bmp388SetAccMode(accModes accMode) {
         DEBUG_PRINT("ACC config [FAIL]\n");
       }
 
-      for (uint8_t i = 0; i < 3; i++) {
-        lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-      }
+      filterBankSetLowPass(&accLpf, 0, 1000, ACCEL_LPF_CUTOFF_FREQ);
+      filterBankReset(&accLpf);
       break;
   }
 }
 
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in) {
-  for (uint8_t i = 0; i < 3; i++) {
-    in->axis[i] = lpf2pApply(&data[i], in->axis[i]);
-  }
-}
-
 void sensorsBmi088Bmp388DataAvailableCallback(void) {
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
   imuIntTimestamp = usecTimestamp();
@@ -778,6 +896,22 @@ void sensorsBmi088Bmp388DataAvailableCallback(void) {
   }
 }
 
+static void gyroFilterUpdate(void) {
+  static uint8_t updateCount = 0;
+  if (++updateCount < GYRO_FILTER_UPDATE_DIVIDER) {
+    return;
+  }
+  updateCount = 0;
+
+  dynamicNotchUpdate(&gyroNotch, &gyroLpf, powerDistributionGetMotorRatio());
+
+  // The low pass cutoff can be raised when the notch takes care of the motor noise
+  if (gyroLpfCutoff != gyroLpfTunedCutoff) {
+    filterBankSetLowPass(&gyroLpf, gyroLpfSection, 1000, gyroLpfCutoff);
+    gyroLpfTunedCutoff = gyroLpfCutoff;
+  }
+}
+
 #ifdef GYRO_ADD_RAW_AND_VARIANCE_LOG_VALUES
 LOG_GROUP_START(gyro)
 LOG_ADD(LOG_INT16, xRaw, &gyroRaw.x)
@@ -791,4 +925,22 @@ LOG_GROUP_STOP(gyro)
 
 PARAM_GROUP_START(imu_sensors)
 PARAM_ADD(PARAM_UINT8 | PARAM_RONLY, BMP388, &isBarometerPresent)
+PARAM_ADD(PARAM_UINT8, warmStart, &warmStartEnable)
 PARAM_GROUP_STOP(imu_sensors)
+
+LOG_GROUP_START(imuCalib)
+LOG_ADD(LOG_UINT8, warmStart, &isWarmStarted)
+LOG_ADD(LOG_UINT32, timeMs, &calibrationTimeMs)
+LOG_GROUP_STOP(imuCalib)
+
+LOG_GROUP_START(gyroFilter)
+LOG_ADD(LOG_FLOAT, notchHz, &gyroNotch.tunedFreq)
+LOG_GROUP_STOP(gyroFilter)
+
+PARAM_GROUP_START(gyroFilter)
+PARAM_ADD(PARAM_UINT8, notchEn, &gyroNotch.enable)
+PARAM_ADD(PARAM_FLOAT, notchMinHz, &gyroNotch.minFreq)
+PARAM_ADD(PARAM_FLOAT, notchMaxHz, &gyroNotch.maxFreq)
+PARAM_ADD(PARAM_FLOAT, notchQ, &gyroNotch.q)
+PARAM_ADD(PARAM_FLOAT, lpfHz, &gyroLpfCutoff)
+PARAM_GROUP_STOP(gyroFilter)
@@ -51,7 +51,7 @@
 #include "nvicconf.h"
 #include "ledseq.h"
 #include "sound.h"
-#include "filter.h"
+#include "filter_bank.h"
 #include "i2cdev.h"
 #include "bmi088.h"
 #include "bmp3.h"
@@ -183,9 +183,8 @@ static uint32_t accScaleSumCount = 0;
 // Low Pass filtering
 #define GYRO_LPF_CUTOFF_FREQ  80
 #define ACCEL_LPF_CUTOFF_FREQ 30
-static lpf2pData accLpf[3];
-static lpf2pData gyroLpf[3];
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in);
+static filterBank_t accLpf;
+static filterBank_t gyroLpf;
 
 static bool isBarometerPresent = false;
 static uint8_t baroMeasDelayMin = SENSORS_DELAY_BARO;
@@ -542,14 +541,14 @@ static void sensorsTask(void *param) {
       sensorData.gyro.x =  (gyroRaw.x - gyroBias.x) * SENSORS_BMI088_DEG_PER_LSB_CFG;
       sensorData.gyro.y =  (gyroRaw.y - gyroBias.y) * SENSORS_BMI088_DEG_PER_LSB_CFG;
       sensorData.gyro.z =  (gyroRaw.z - gyroBias.z) * SENSORS_BMI088_DEG_PER_LSB_CFG;
-      applyAxis3fLpf((lpf2pData*)(&gyroLpf), &sensorData.gyro);
+      filterBankApply(&gyroLpf, sensorData.gyro.axis);
 
       /* Acelerometer */
       accScaled.x = accelRaw.x * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
       accScaled.y = accelRaw.y * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
       accScaled.z = accelRaw.z * SENSORS_BMI088_G_PER_LSB_CFG / accScale;
       sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
-      applyAxis3fLpf((lpf2pData*)(&accLpf), &sensorData.acc);
+      filterBankApply(&accLpf, sensorData.acc.axis);
     }
 
     if (isBarometerPresent) {
@@ -717,10 +716,10 @@ static void sensorsDeviceInit(void) {
   }
 
   // Init second order filer for accelerometer and gyro
-  for (uint8_t i = 0; i < 3; i++) {
-    lpf2pInit(&gyroLpf[i], 1000, GYRO_LPF_CUTOFF_FREQ);
-    lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-  }
+  filterBankInit(&gyroLpf, 3);
+  filterBankAddLowPass(&gyroLpf, 1000, GYRO_LPF_CUTOFF_FREQ);
+  filterBankInit(&accLpf, 3);
+  filterBankAddLowPass(&accLpf, 1000, ACCEL_LPF_CUTOFF_FREQ);
 
   cosPitch = cosf(configblockGetCalibPitch() * (float) M_PI / 180);
   sinPitch = sinf(configblockGetCalibPitch() * (float) M_PI / 180);
@@ -1008,9 +1007,8 @@ void sensorsBmi088SpiBmp388SetAccMode(accModes accMode) {
         DEBUG_PRINT("ACC config [FAIL]\n");
       }
 
-      for (uint8_t i = 0; i < 3; i++) {
-        lpf2pInit(&accLpf[i],  1000, 500);
-      }
+      filterBankSetLowPass(&accLpf, 0, 1000, 500);
+      filterBankReset(&accLpf);
       break;
     case ACC_MODE_FLIGHT:
     default:
@@ -1022,19 +1020,12 @@ void sensorsBmi088SpiBmp388SetAccMode(accModes accMode) {
         DEBUG_PRINT("ACC config [FAIL]\n");
       }
 
-      for (uint8_t i = 0; i < 3; i++) {
-        lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-      }
+      filterBankSetLowPass(&accLpf, 0, 1000, ACCEL_LPF_CUTOFF_FREQ);
+      filterBankReset(&accLpf);
       break;
   }
 }
 
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in) {
-  for (uint8_t i = 0; i < 3; i++) {
-    in->axis[i] = lpf2pApply(&data[i], in->axis[i]);
-  }
-}
-
 void sensorsBmi088SpiBmp388DataAvailableCallback(void) {
   portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
   imuIntTimestamp = usecTimestamp();
@@ -50,7 +50,7 @@
 #include "nvicconf.h"
 #include "ledseq.h"
 #include "sound.h"
-#include "filter.h"
+#include "filter_bank.h"
 
 /**
  * Enable 250Hz digital LPF mode. However does not work with
@@ -130,9 +130,8 @@ static float accScale = 1;
 // Low Pass filtering
 #define GYRO_LPF_CUTOFF_FREQ  80
 #define ACCEL_LPF_CUTOFF_FREQ 30
-static lpf2pData accLpf[3];
-static lpf2pData gyroLpf[3];
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in);
+static filterBank_t accLpf;
+static filterBank_t gyroLpf;
 
 static bool isBarometerPresent = false;
 static bool isMagnetometerPresent = false;
@@ -312,13 +311,13 @@ void processAccGyroMeasurements(const uint8_t *buffer)
   sensorData.gyro.x = -(gyroRaw.x - gyroBias.x) * SENSORS_DEG_PER_LSB_CFG;
   sensorData.gyro.y =  (gyroRaw.y - gyroBias.y) * SENSORS_DEG_PER_LSB_CFG;
   sensorData.gyro.z =  (gyroRaw.z - gyroBias.z) * SENSORS_DEG_PER_LSB_CFG;
-  applyAxis3fLpf((lpf2pData*)(&gyroLpf), &sensorData.gyro);
+  filterBankApply(&gyroLpf, sensorData.gyro.axis);
 
   accScaled.x = -(accelRaw.x) * SENSORS_G_PER_LSB_CFG / accScale;
   accScaled.y =  (accelRaw.y) * SENSORS_G_PER_LSB_CFG / accScale;
   accScaled.z =  (accelRaw.z) * SENSORS_G_PER_LSB_CFG / accScale;
   sensorsAccAlignToGravity(&accScaled, &sensorData.acc);
-  applyAxis3fLpf((lpf2pData*)(&accLpf), &sensorData.acc);
+  filterBankApply(&accLpf, sensorData.acc.axis);
 }
 
 static void sensorsDeviceInit(void)
@@ -377,11 +376,10 @@ static void sensorsDeviceInit(void)
   // Set digital low-pass bandwidth for gyro
   mpu6500SetDLPFMode(MPU6500_DLPF_BW_98);
   // Init second order filer for accelerometer
-  for (uint8_t i = 0; i < 3; i++)
-  {
-    lpf2pInit(&gyroLpf[i], 1000, GYRO_LPF_CUTOFF_FREQ);
-    lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-  }
+  filterBankInit(&gyroLpf, 3);
+  filterBankAddLowPass(&gyroLpf, 1000, GYRO_LPF_CUTOFF_FREQ);
+  filterBankInit(&accLpf, 3);
+  filterBankAddLowPass(&accLpf, 1000, ACCEL_LPF_CUTOFF_FREQ);
 #endif
 
 
@@ -883,29 +881,18 @@ void sensorsMpu9250Lps25hSetAccMode(accModes accMode)
   {
     case ACC_MODE_PROPTEST:
       mpu6500SetAccelDLPF(MPU6500_ACCEL_DLPF_BW_460);
-      for (uint8_t i = 0; i < 3; i++)
-      {
-        lpf2pInit(&accLpf[i],  1000, 500);
-      }
+      filterBankSetLowPass(&accLpf, 0, 1000, 500);
+      filterBankReset(&accLpf);
       break;
     case ACC_MODE_FLIGHT:
     default:
       mpu6500SetAccelDLPF(MPU6500_ACCEL_DLPF_BW_41);
-      for (uint8_t i = 0; i < 3; i++)
-      {
-        lpf2pInit(&accLpf[i],  1000, ACCEL_LPF_CUTOFF_FREQ);
-      }
+      filterBankSetLowPass(&accLpf, 0, 1000, ACCEL_LPF_CUTOFF_FREQ);
+      filterBankReset(&accLpf);
       break;
   }
 }
 
-static void applyAxis3fLpf(lpf2pData *data, Axis3f* in)
-{
-  for (uint8_t i = 0; i < 3; i++) {
-    in->axis[i] = lpf2pApply(&data[i], in->axis[i]);
-  }
-}
-
 #ifdef GYRO_ADD_RAW_AND_VARIANCE_LOG_VALUES
 LOG_GROUP_START(gyro)
 LOG_ADD(LOG_INT16, xRaw, &gyroRaw.x)
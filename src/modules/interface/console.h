@@ -28,6 +28,7 @@
 #define CONSOLE_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "eprintf.h"
 
 /**
@@ -70,6 +71,18 @@ int consolePuts(char *str);
  */
 void consoleFlush(void);
 
+/**
+ * Put a deferred print record (see deferred_print.h) in the deferred console
+ * buffer. The records are sent on console channel 1 by a low priority task.
+ *
+ * @param record The record
+ * @param size Size of the record in bytes
+ *
+ * @note Never blocks and can be called from interrupts. The record is dropped
+ * if the buffer is full.
+ */
+void consoleDeferredWrite(const uint8_t* record, const uint8_t size);
+
 /**
  * Macro implementing consolePrintf with eprintf
  *
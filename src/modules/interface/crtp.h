@@ -141,6 +141,22 @@ int crtpReceivePacket(CRTPPort taskId, CRTPPacket *p);
  */
 int crtpReceivePacketWait(CRTPPort taskId, CRTPPacket *p, int wait);
 
+/**
+ * Get a packet buffer from the receive packet pool. Used by links to deliver
+ * received packets by pointer to the CRTP rx task. Port callbacks are called
+ * with the pooled packet, packets to port queues are copied (see
+ * crtpReceivePacket()) and the buffer is returned to the pool by the rx task.
+ * @return Pointer to a packet buffer or NULL if the pool is empty, counted in
+ *         the crtp.poolDrop log variable
+ */
+CRTPPacket* crtpPacketAlloc(void);
+
+/**
+ * Return a packet buffer to the receive packet pool.
+ * @param[in] p Packet buffer from crtpPacketAlloc()
+ */
+void crtpPacketFree(CRTPPacket *p);
+
 /**
  * Get the number of free tx packets in the queue
  *
@@ -167,6 +183,9 @@ struct crtpLinkOperations
   int (*setEnable)(bool enable);
   int (*sendPacket)(CRTPPacket *pk);
   int (*receivePacket)(CRTPPacket *pk);
+  // Optional, receives a packet allocated from the packet pool. Used instead
+  // of receivePacket when set.
+  int (*receivePacketRef)(CRTPPacket **pk);
   bool (*isConnected)(void);
   int (*reset)(void);
 };
@@ -32,7 +32,8 @@
 
 void crtpCommanderInit(void);
 void crtpCommanderRpytDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk);
-void crtpCommanderGenericDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk);
+// Returns false if the packet does not hold a setpoint for this Crazyflie
+bool crtpCommanderGenericDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk);
 void crtpCommanderPosHoldDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk);
 void crtpCommanderHeightHoldDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk);
 
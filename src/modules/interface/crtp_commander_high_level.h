@@ -67,4 +67,9 @@ void crtpCommanderHighLevelStop();
 // True if we have landed or emergency-stopped.
 bool crtpCommanderHighLevelIsStopped();
 
+// Time since the start of the uploaded trajectory that is being flown [s],
+// without the timescale applied. Uses the same clock as the setpoints.
+// Returns false if no uploaded trajectory has been started.
+bool crtpCommanderHighLevelGetTrajectoryTime(float* trajectoryTime);
+
 #endif /* CRTP_COMMANDER_HIGH_LEVEL_H_ */
@@ -49,6 +49,30 @@ struct CrtpExtPose
   float qw;
 } __attribute__((packed));
 
+/**
+ * Time sync request, sent by the host with its current time. The latest round
+ * trip the host has completed, that is the request time, the tick in the
+ * answer and the time the answer was received, is appended when available.
+ * Used to convert the capture time of timestamped external poses to ticks.
+ */
+struct CrtpTimeSyncRequest
+{
+  uint32_t hostTime;        // ms, host clock when this request was sent
+  uint32_t prevHostTime;    // ms, host clock when the previous request was sent
+  uint32_t prevTick;        // ms, tick in the answer to the previous request
+  uint32_t prevHostRxTime;  // ms, host clock when that answer was received
+} __attribute__((packed));
+
+/**
+ * Time sync answer, the host time of the request and the tick when it was
+ * received. The answer is sent right away, the tick is also the send time.
+ */
+struct CrtpTimeSync
+{
+  uint32_t hostTime; // ms, host clock
+  uint32_t tick;     // ms
+} __attribute__((packed));
+
 typedef enum
 {
   RANGE_STREAM_FLOAT      = 0,
@@ -60,6 +84,10 @@ typedef enum
   COMM_GNSS_PROPRIETARY    = 7,
   EXT_POSE                 = 8,
   EXT_POSE_PACKED          = 9,
+  EXT_POSE_PACKED_TIMESTAMPED = 10,
+  TIME_SYNC                = 11,
+  SWARM_POSITION_FRAME     = 12,
+  SWARM_POSE_FRAME         = 13,
 } locsrv_t;
 
 // Set up the callback for the CRTP_PORT_LOCALIZATION
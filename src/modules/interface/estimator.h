@@ -35,6 +35,32 @@ typedef enum {
   StateEstimatorTypeCount,
 } StateEstimatorType;
 
+typedef enum {
+  MeasurementTypeTDOA,
+  MeasurementTypePosition,
+  MeasurementTypePose,
+  MeasurementTypeDistance,
+  MeasurementTypeTOF,
+  MeasurementTypeAbsoluteHeight,
+  MeasurementTypeFlow,
+  MeasurementType_COUNT,
+} MeasurementType;
+
+// A measurement of any type, as queued for the estimator
+typedef struct {
+  MeasurementType type;
+  uint64_t timestamp; // us, set by the estimator when the measurement is queued
+  union {
+    tdoaMeasurement_t tdoa;
+    positionMeasurement_t position;
+    poseMeasurement_t pose;
+    distanceMeasurement_t distance;
+    tofMeasurement_t tof;
+    heightMeasurement_t height;
+    flowMeasurement_t flow;
+  } data;
+} measurement_t;
+
 void stateEstimatorInit(StateEstimatorType estimator);
 bool stateEstimatorTest(void);
 void stateEstimator(state_t *state, sensorData_t *sensors, control_t *control, const uint32_t tick);
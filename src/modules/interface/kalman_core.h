@@ -95,6 +95,14 @@ typedef struct {
   float baroReferenceHeight;
 } kalmanCoreData_t;
 
+// Position and attitude at an earlier point in time, used as reference when
+// fusing measurements that were captured in the past
+typedef struct {
+  float pos[3];
+  // (w,x,y,z)
+  float q[4];
+} kalmanCorePastState_t;
+
 
 void kalmanCoreInit(kalmanCoreData_t* this);
 
@@ -112,6 +120,19 @@ void kalmanCoreUpdateWithPosition(kalmanCoreData_t* this, positionMeasurement_t
 // Direct measurements of Crazyflie pose
 void kalmanCoreUpdateWithPose(kalmanCoreData_t* this, poseMeasurement_t *pose);
 
+/**
+ * Direct measurements of Crazyflie position and pose that were captured in the
+ * past, for instance by a motion capture system. The innovation is computed
+ * against the state at capture time, past, and the correction is applied to
+ * the current state. This removes the error caused by the motion of the
+ * Crazyflie during the latency of the measurement.
+ */
+void kalmanCoreUpdateWithPastPosition(kalmanCoreData_t* this, positionMeasurement_t *xyz, const kalmanCorePastState_t* past);
+void kalmanCoreUpdateWithPastPose(kalmanCoreData_t* this, poseMeasurement_t *pose, const kalmanCorePastState_t* past);
+
+// Get the current position and attitude, to be used as past state later
+void kalmanCoreGetPastState(const kalmanCoreData_t* this, kalmanCorePastState_t* past);
+
 // Distance-to-point measurements
 void kalmanCoreUpdateWithDistance(kalmanCoreData_t* this, distanceMeasurement_t *d);
 
@@ -0,0 +1,100 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * led_timeline.h - Keyframe colour timeline for light shows
+ *
+ * A timeline is a list of segments uploaded through the memory subsystem. It
+ * is evaluated on board against the trajectory time of the high-level
+ * commander, which keeps the lights in lockstep with the trajectory without
+ * any radio traffic during the show.
+ *
+ * Memory layout (little endian, packed)
+ *   uint16_t segmentCount
+ *   ledTimelineSegment_t segments[segmentCount]
+ *
+ * A segment ends at its color, it starts at the color of the previous segment
+ * (black for the first segment). After the last segment the last color is
+ * held. The segment count should be written last when uploading, to make the
+ * new timeline visible in one go. Every write to the memory restarts the
+ * playback from the first segment.
+ */
+
+#ifndef __LED_TIMELINE_H__
+#define __LED_TIMELINE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LED_TIMELINE_MEMORY_SIZE 1024
+
+enum ledTimelineSegmentType_e {
+  LED_TIMELINE_STEP = 0, // Switch to the color at the start of the segment
+  LED_TIMELINE_FADE = 1, // Linear interpolation to the color over the segment
+};
+
+typedef struct {
+  uint16_t duration;  // ms, in trajectory time (timescale not applied)
+  uint8_t type;       // one of ledTimelineSegmentType_e
+  uint8_t color[3];   // RGB
+} __attribute__((packed)) ledTimelineSegment_t;
+
+// Remembers the current segment to avoid searching from the start of the
+// timeline for every evaluation
+typedef struct {
+  uint16_t segmentIndex;
+  uint32_t segmentStart; // ms
+} ledTimelineCursor_t;
+
+extern uint8_t ledTimelineMemory[LED_TIMELINE_MEMORY_SIZE];
+
+/**
+ * Write to ledTimelineMemory, used by the memory subsystem
+ *
+ * @return false if the write is outside the memory, nothing is written
+ */
+bool ledTimelineMemoryWrite(const uint32_t memAddr, const uint8_t writeLen, const uint8_t* data);
+
+/**
+ * The number of writes to ledTimelineMemory. Cursors for the memory must be
+ * reset when it changes.
+ */
+uint32_t ledTimelineMemoryWriteCount(void);
+
+/**
+ * Reset a cursor to the start of the timeline
+ */
+void ledTimelineCursorReset(ledTimelineCursor_t* cursor);
+
+/**
+ * Evaluate a timeline
+ *
+ * @param memory The timeline memory
+ * @param memorySize Size of the memory, segments outside it are ignored
+ * @param cursor Cursor for this timeline, moved backwards if time decreases
+ * @param timeMs Time since the start of the timeline, in ms
+ * @param color Output RGB color
+ * @return false if the timeline is empty, color is not updated
+ */
+bool ledTimelineEvaluate(const uint8_t* memory, const uint32_t memorySize, ledTimelineCursor_t* cursor, const uint32_t timeMs, uint8_t color[3]);
+
+#endif // __LED_TIMELINE_H__
@@ -0,0 +1,69 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * measurement_queue.h - Queue of timestamped measurements for the Kalman estimator
+ *
+ * Measurements of all types go through one FIFO queue and are returned in
+ * the order they were enqueued. Each measurement is stamped with
+ * usecTimestamp() when enqueued. Measurements may be enqueued from tasks and
+ * interrupts.
+ *
+ * Each type has a part of the queue reserved (its quota), so that a burst of
+ * one type, for instance TDoA or flow, can not crowd out the others. A
+ * measurement is dropped when its type has used up its quota, drops are
+ * counted per type.
+ */
+#ifndef MEASUREMENT_QUEUE_H_
+#define MEASUREMENT_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "estimator.h"
+
+void measurementQueueInit(void);
+
+// Empty the queue
+void measurementQueueReset(void);
+
+/**
+ * Stamp and enqueue a measurement, from a task or an interrupt
+ *
+ * @return false if the quota of the type is used up and the measurement was dropped
+ */
+bool measurementQueuePut(measurement_t* measurement);
+
+/**
+ * Get the oldest measurement, does not block
+ *
+ * @return false if the queue is empty
+ */
+bool measurementQueueGet(measurement_t* measurement);
+
+// Number of measurements of a type that have been dropped since init
+uint32_t measurementQueueGetDropCount(const MeasurementType type);
+
+// Number of places in the queue reserved for a type
+uint8_t measurementQueueGetQuota(const MeasurementType type);
+
+#endif // MEASUREMENT_QUEUE_H_
@@ -0,0 +1,127 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * pid_batch.h - PID regulator for several axes at once
+ *
+ * Same algorithm as pid.c, but the state of all axes is stored as arrays
+ * (struct of arrays) and updated in one call using the CMSIS-DSP vector
+ * functions. On top of pidUpdate() it supports a feed-forward term and
+ * conditional integration anti-windup.
+ */
+#ifndef PID_BATCH_H_
+#define PID_BATCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "filter.h"
+
+#define PID_BATCH_MAX_AXES 6
+
+typedef struct {
+  uint8_t count;                          //< number of axes in use
+  bool antiWindup;                        //< conditional integration, requires an output limit
+  float dt;                               //< delta-time dt, common to all axes
+  float desired[PID_BATCH_MAX_AXES];      //< set point
+  float error[PID_BATCH_MAX_AXES];        //< error
+  float prevError[PID_BATCH_MAX_AXES];    //< previous error
+  float integ[PID_BATCH_MAX_AXES];        //< integral
+  float deriv[PID_BATCH_MAX_AXES];        //< derivative
+  float kp[PID_BATCH_MAX_AXES];           //< proportional gain
+  float ki[PID_BATCH_MAX_AXES];           //< integral gain
+  float kd[PID_BATCH_MAX_AXES];           //< derivative gain
+  float kff[PID_BATCH_MAX_AXES];          //< feed-forward gain
+  float outP[PID_BATCH_MAX_AXES];         //< proportional output (debugging)
+  float outI[PID_BATCH_MAX_AXES];         //< integral output (debugging)
+  float outD[PID_BATCH_MAX_AXES];         //< derivative output (debugging)
+  float outFF[PID_BATCH_MAX_AXES];        //< feed-forward output (debugging)
+  float iLimit[PID_BATCH_MAX_AXES];       //< integral limit, absolute value. '0' means no limit.
+  float outputLimit[PID_BATCH_MAX_AXES];  //< total output limit, absolute value. '0' means no limit.
+  float output[PID_BATCH_MAX_AXES];       //< output of the last update
+  lpf2pData dFilter[PID_BATCH_MAX_AXES];  //< filter for D term
+  bool enableDFilter[PID_BATCH_MAX_AXES]; //< filter for D term enable flag
+  bool skip[PID_BATCH_MAX_AXES];          //< skip the axis in the next update, its state is kept
+} pidBatch_t;
+
+/**
+ * Initialize a batch of PIDs. All gains are zero and limits are set to the
+ * defaults of pid.h, use pidBatchInitAxis() to set up each axis.
+ *
+ * @param[out] batch  A pointer to the batch to initialize.
+ * @param[in]  count  Number of axes, at most PID_BATCH_MAX_AXES
+ * @param[in]  dt     Delta time between updates
+ */
+void pidBatchInit(pidBatch_t* batch, const uint8_t count, const float dt);
+
+/**
+ * Set up one axis of a batch, same parameters as pidInit().
+ *
+ * @param[in] batch        A pointer to the batch.
+ * @param[in] axis         Index of the axis
+ * @param[in] kp           The proportional gain
+ * @param[in] ki           The integral gain
+ * @param[in] kd           The derivative gain
+ * @param[in] iLimit       The integral limit, '0' means no limit
+ * @param[in] samplingRate Frequency the update will be called
+ * @param[in] cutoffFreq   Frequency to set the low pass filter cutoff at
+ * @param[in] enableDFilter Enable setting for the D lowpass filter
+ */
+void pidBatchInitAxis(pidBatch_t* batch, const uint8_t axis, const float kp,
+                      const float ki, const float kd, const float iLimit,
+                      const float samplingRate, const float cutoffFreq,
+                      bool enableDFilter);
+
+/**
+ * Update all axes of the batch. The result is available in batch->output.
+ *
+ * When anti-windup is enabled, the integral of an axis is frozen while the
+ * output of that axis is saturated and the error would push it further into
+ * saturation.
+ *
+ * Axes with skip set are left as they are, like not calling pidUpdate() for
+ * them. Their integral, previous error, derivative filter and output are kept.
+ *
+ * @param[in] batch       A pointer to the batch.
+ * @param[in] measured    The measured values, one per axis. If NULL, the
+ *                        errors in batch->error are used as they are.
+ * @param[in] feedForward Feed-forward values, one per axis, scaled by kff and
+ *                        added to the output. May be NULL.
+ * @return Pointer to the outputs, one per axis
+ */
+const float* pidBatchUpdate(pidBatch_t* batch, const float* measured, const float* feedForward);
+
+/**
+ * Reset the error values of one axis
+ *
+ * @param[in] batch A pointer to the batch.
+ * @param[in] axis  Index of the axis
+ */
+void pidBatchResetAxis(pidBatch_t* batch, const uint8_t axis);
+
+/**
+ * Reset the error values of all axes
+ *
+ * @param[in] batch A pointer to the batch.
+ */
+void pidBatchReset(pidBatch_t* batch);
+
+#endif /* PID_BATCH_H_ */
@@ -33,4 +33,9 @@ bool powerDistributionTest(void);
 void powerDistribution(const control_t *control);
 void powerStop();
 
+/**
+ * Mean of the commands last sent to the motors, 0 - 1
+ */
+float powerDistributionGetMotorRatio(void);
+
 #endif //__POWER_DISTRIBUTION_H__
@@ -117,8 +117,15 @@ struct traj_eval {
 	struct vec acc;
 	struct vec omega;
 	float yaw;
+	struct vec heading; // [cos(yaw), sin(yaw), 0]
 };
 
+// body axes of the vehicle, as the columns of a rotation matrix, for a
+// thrust vector and a heading [cos(yaw), sin(yaw), 0] in the world frame.
+// this is the flat output to attitude mapping of a multirotor, shared by the
+// trajectory evaluation and the geometric controller.
+struct mat33 flat_attitude(struct vec thrust, struct vec heading);
+
 // a special value of traj_eval that indicates an invalid result.
 struct traj_eval traj_eval_invalid(void);
 
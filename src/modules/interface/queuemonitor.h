@@ -21,7 +21,11 @@
  * You should have received a copy of the GNU General Public License
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  *
- * log.h - Dynamic log system
+ * queuemonitor.h - Monitoring functionality for queues
+ *
+ * Registered queues always count sends, failed sends and the peak number of
+ * waiting items for the system load monitor. DEBUG_QUEUE_MONITOR adds a
+ * periodic print of the queues that overflowed.
  */
 
 #ifndef __QUEUE_MONITOR_H__
@@ -30,17 +34,24 @@
 
 #include "FreeRTOS.h"
 
-#ifdef DEBUG_QUEUE_MONITOR
-  #include "queue.h"
+#include "queue.h"
+
+void queueMonitorInit();
+#define DEBUG_QUEUE_MONITOR_REGISTER(queue) qmRegisterQueue(queue, __FILE__, #queue)
+
+void qm_traceQUEUE_SEND(void* xQueue);
+void qm_traceQUEUE_SEND_FAILED(void* xQueue);
+void qmRegisterQueue(xQueueHandle* xQueue, char* fileName, char* queueName);
 
-  void queueMonitorInit();
-  #define DEBUG_QUEUE_MONITOR_REGISTER(queue) qmRegisterQueue(queue, __FILE__, #queue)
+typedef struct {
+  const char* queueName;
+  uint32_t sendCount;   // Saturating count since boot
+  uint32_t fullCount;   // Saturating count since boot
+  uint8_t peak;         // Peak number of waiting items since last reset
+} queueMonitorStats_t;
 
-  void qm_traceQUEUE_SEND(void* xQueue);
-  void qm_traceQUEUE_SEND_FAILED(void* xQueue);
-  void qmRegisterQueue(xQueueHandle* xQueue, char* fileName, char* queueName);
-#else
-  #define DEBUG_QUEUE_MONITOR_REGISTER(queue)
-#endif // DEBUG_QUEUE_MONITOR
+int queueMonitorGetNrOfQueues();
+void queueMonitorGetStats(int index, queueMonitorStats_t* stats);
+void queueMonitorResetPeak(int index);
 
 #endif // __QUEUE_MONITOR_H__
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * range_map.h - Occupancy grid built from the multiranger and zranger
+ *
+ * The horizontal ranges of the multiranger are added to an occupancy grid
+ * (see occupancy_grid.h) at the estimated position and yaw. Updates are
+ * skipped when the Crazyflie is tilted, or too close to the floor when there
+ * is a zranger to measure the height, since the ranges would then hit the
+ * floor. Without a zranger the height is not checked, see the rangeMap.hasHeight
+ * log variable.
+ *
+ * The map is read through the memory subsystem:
+ *   0x00  Header, see rangeMapHeader_t. A read that starts at address 0
+ *         takes a new snapshot of the header.
+ *   0x20  Change counters of the tiles, one uint16_t per tile
+ *   0xA0  Tile 0, 64 bytes of log-odds, row by row
+ *   0xE0  Tile 1 ...
+ * A client reads the change counters and then the tiles whose counter is
+ * different from its previous read. Reading does not change the map, so a
+ * lost read or a second client does not lose any changes. If the generation
+ * changed the grid has moved, all counters change at the same time.
+ */
+
+#ifndef __RANGE_MAP_H__
+#define __RANGE_MAP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "occupancy_grid.h"
+
+#define RANGE_MAP_VERSION 2
+#define RANGE_MAP_HEADER_SIZE 0x20
+#define RANGE_MAP_CHANGES_ADDRESS RANGE_MAP_HEADER_SIZE
+#define RANGE_MAP_TILES_ADDRESS (RANGE_MAP_CHANGES_ADDRESS + OCCUPANCY_GRID_TILE_COUNT * sizeof(uint16_t))
+#define RANGE_MAP_MEM_SIZE (RANGE_MAP_TILES_ADDRESS + OCCUPANCY_GRID_TILE_COUNT * OCCUPANCY_GRID_TILE_BYTES)
+
+typedef struct {
+  uint8_t version;
+  uint8_t gridSize;        // Cells per side
+  uint8_t tileSize;        // Cells per side of a tile
+  uint16_t resolutionMm;   // Size of a cell
+  int32_t originX;         // World cell index of the first cell
+  int32_t originY;
+  uint16_t generation;     // Incremented when the grid moves
+} __attribute__((packed)) rangeMapHeader_t;
+
+void rangeMapInit(void);
+bool rangeMapTest(void);
+
+/**
+ * Read from the memory mapped grid, used by the memory subsystem
+ *
+ * @return false if the read is outside the memory
+ */
+bool rangeMapMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* dest);
+
+#endif // __RANGE_MAP_H__
@@ -99,6 +99,7 @@ typedef struct positionMeasurement_s {
     float pos[3];
   };
   float stdDev;
+  uint32_t timestamp; // Tick when the measurement was captured, 0 for current measurements
 } positionMeasurement_t;
 
 typedef struct poseMeasurement_s {
@@ -113,6 +114,7 @@ typedef struct poseMeasurement_s {
   quaternion_t quat;
   float stdDevPos;
   float stdDevQuat;
+  uint32_t timestamp; // Tick when the measurement was captured, 0 for current measurements
 } poseMeasurement_t;
 
 typedef struct distanceMeasurement_s {
@@ -180,6 +182,10 @@ typedef struct setpoint_s {
   acc_t acceleration;       // m/s^2
   bool velocity_body;       // true if velocity is given in body frame; false if velocity is given in world frame
 
+  // Attitude feed forward from a trajectory, used instead of attitude.yaw and attitudeRate when mode.heading is modeAbs
+  vector_t heading;         // unit vector [cos(yaw), sin(yaw), 0] in the world frame
+  vector_t omega;           // rad/s, body rates (pitch not inverted)
+
   struct {
     stab_mode_t x;
     stab_mode_t y;
@@ -188,6 +194,7 @@ typedef struct setpoint_s {
     stab_mode_t pitch;
     stab_mode_t yaw;
     stab_mode_t quat;
+    stab_mode_t heading;
   } mode;
 } setpoint_t;
 
@@ -0,0 +1,90 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * state_buffer.h - Double buffered state, written by one task and read by another
+ *
+ * The writer fills the slot that is not the latest one and then increments
+ * the sequence number. A reader copies the latest slot and retries if the
+ * sequence number changed during the copy. No locks are taken, so the reader
+ * is never blocked by the writer.
+ *
+ * There must only be one writer.
+ */
+#ifndef STATE_BUFFER_H_
+#define STATE_BUFFER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stabilizer_types.h"
+
+typedef struct {
+  state_t state;
+  uint32_t tick;
+} stateBufferSlot_t;
+
+typedef struct {
+  stateBufferSlot_t slots[2];
+  volatile uint32_t sequence;
+} stateBuffer_t;
+
+void stateBufferInit(stateBuffer_t* buffer);
+
+/**
+ * Publish a state, the slot that readers may be copying is left untouched
+ *
+ * @param tick Tick of the state
+ */
+void stateBufferPublish(stateBuffer_t* buffer, const state_t* state, const uint32_t tick);
+
+/**
+ * Copy the latest state, one attempt. Must be followed by
+ * stateBufferReadRetry() to know if the copy is valid.
+ *
+ * @return The sequence number of the copied state
+ */
+uint32_t stateBufferReadBegin(const stateBuffer_t* buffer, state_t* state, uint32_t* tick);
+
+/**
+ * @return true if a state has been published since stateBufferReadBegin(),
+ *         the copy may be inconsistent and must be read again
+ */
+bool stateBufferReadRetry(const stateBuffer_t* buffer, const uint32_t sequence);
+
+/**
+ * Copy the latest state, retrying until the copy is consistent
+ *
+ * @return The sequence number of the copied state
+ */
+uint32_t stateBufferRead(const stateBuffer_t* buffer, state_t* state, uint32_t* tick);
+
+/**
+ * Move a state that was read too late forward in time, at constant velocity.
+ * The attitude is left as is.
+ *
+ * @param tick Tick to predict the state to
+ * @param dt Time from the tick of the state to tick (s)
+ */
+void stateBufferPredict(state_t* state, const uint32_t tick, const float dt);
+
+#endif // STATE_BUFFER_H_
@@ -1,6 +1,17 @@
 #ifndef __SYSLOAD_H__
 #define __SYSLOAD_H__
 
+#include "crtp.h"
+
+// Channel on CRTP_PORT_PLATFORM used for the task/queue profile stream
+#define SYSLOAD_CRTP_CHANNEL 0x02
+
 void sysLoadInit();
 
-#endif
\ No newline at end of file
+/**
+ * Handle a request from the host on the sysload channel, used to query the
+ * names matching the task and queue numbers in the profile stream.
+ */
+void sysLoadHandlePacket(CRTPPacket *p);
+
+#endif
@@ -0,0 +1,50 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * vibration.h - On-board vibration spectrum analyzer
+ *
+ * Only built with VIBRATION_ENABLE=1, the functions are empty otherwise.
+ */
+#ifndef __VIBRATION_H__
+#define __VIBRATION_H__
+
+#include <stdbool.h>
+
+#include "stabilizer_types.h"
+
+#ifdef VIBRATION_ENABLE
+void vibrationInit(void);
+bool vibrationTest(void);
+
+/**
+ * Feed the gyro and accelerometer samples of one stabilizer loop iteration to
+ * the analyzer. Must be called at RATE_MAIN_LOOP.
+ */
+void vibrationAddSample(const sensorData_t* sensors);
+#else
+static inline void vibrationInit(void) {}
+static inline bool vibrationTest(void) { return true; }
+static inline void vibrationAddSample(const sensorData_t* sensors) { (void)sensors; }
+#endif
+
+#endif // __VIBRATION_H__
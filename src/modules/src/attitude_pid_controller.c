@@ -29,6 +29,7 @@
 
 #include "attitude_controller.h"
 #include "pid.h"
+#include "pid_batch.h"
 #include "param.h"
 #include "log.h"
 
@@ -49,12 +50,16 @@ static inline int16_t saturateSignedInt16(float in)
     return (int16_t)in;
 }
 
-PidObject pidRollRate;
-PidObject pidPitchRate;
-PidObject pidYawRate;
-PidObject pidRoll;
-PidObject pidPitch;
-PidObject pidYaw;
+enum {
+  AXIS_ROLL = 0,
+  AXIS_PITCH,
+  AXIS_YAW,
+  AXIS_COUNT
+};
+
+// Roll, pitch and yaw of each cascade level are updated in one batch
+static pidBatch_t pidRate;
+static pidBatch_t pidAttitude;
 
 static int16_t rollOutput;
 static int16_t pitchOutput;
@@ -67,27 +72,27 @@ void attitudeControllerInit(const float updateDt) {
     return;
 
   //TODO: get parameters from configuration manager instead
-  pidInit(&pidRollRate,  0, PID_ROLL_RATE_KP,  PID_ROLL_RATE_KI,  PID_ROLL_RATE_KD,
-      updateDt, ATTITUDE_RATE, ATTITUDE_RATE_LPF_CUTOFF_FREQ, ATTITUDE_RATE_LPF_ENABLE);
-  pidInit(&pidPitchRate, 0, PID_PITCH_RATE_KP, PID_PITCH_RATE_KI, PID_PITCH_RATE_KD,
-      updateDt, ATTITUDE_RATE, ATTITUDE_RATE_LPF_CUTOFF_FREQ, ATTITUDE_RATE_LPF_ENABLE);
-  pidInit(&pidYawRate,   0, PID_YAW_RATE_KP,   PID_YAW_RATE_KI,   PID_YAW_RATE_KD,
-      updateDt, ATTITUDE_RATE, ATTITUDE_RATE_LPF_CUTOFF_FREQ, ATTITUDE_RATE_LPF_ENABLE);
-
-  pidSetIntegralLimit(&pidRollRate,  PID_ROLL_RATE_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidPitchRate, PID_PITCH_RATE_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidYawRate,   PID_YAW_RATE_INTEGRATION_LIMIT);
-
-  pidInit(&pidRoll,  0, PID_ROLL_KP,  PID_ROLL_KI,  PID_ROLL_KD,  updateDt,
-      ATTITUDE_RATE, ATTITUDE_LPF_CUTOFF_FREQ, ATTITUDE_LPF_ENABLE);
-  pidInit(&pidPitch, 0, PID_PITCH_KP, PID_PITCH_KI, PID_PITCH_KD, updateDt,
-      ATTITUDE_RATE, ATTITUDE_LPF_CUTOFF_FREQ, ATTITUDE_LPF_ENABLE);
-  pidInit(&pidYaw,   0, PID_YAW_KP,   PID_YAW_KI,   PID_YAW_KD,   updateDt,
-      ATTITUDE_RATE, ATTITUDE_LPF_CUTOFF_FREQ, ATTITUDE_LPF_ENABLE);
-
-  pidSetIntegralLimit(&pidRoll,  PID_ROLL_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidPitch, PID_PITCH_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidYaw,   PID_YAW_INTEGRATION_LIMIT);
+  pidBatchInit(&pidRate, AXIS_COUNT, updateDt);
+  pidBatchInitAxis(&pidRate, AXIS_ROLL,  PID_ROLL_RATE_KP,  PID_ROLL_RATE_KI,  PID_ROLL_RATE_KD,
+      PID_ROLL_RATE_INTEGRATION_LIMIT, ATTITUDE_RATE, ATTITUDE_RATE_LPF_CUTOFF_FREQ, ATTITUDE_RATE_LPF_ENABLE);
+  pidBatchInitAxis(&pidRate, AXIS_PITCH, PID_PITCH_RATE_KP, PID_PITCH_RATE_KI, PID_PITCH_RATE_KD,
+      PID_PITCH_RATE_INTEGRATION_LIMIT, ATTITUDE_RATE, ATTITUDE_RATE_LPF_CUTOFF_FREQ, ATTITUDE_RATE_LPF_ENABLE);
+  pidBatchInitAxis(&pidRate, AXIS_YAW,   PID_YAW_RATE_KP,   PID_YAW_RATE_KI,   PID_YAW_RATE_KD,
+      PID_YAW_RATE_INTEGRATION_LIMIT, ATTITUDE_RATE, ATTITUDE_RATE_LPF_CUTOFF_FREQ, ATTITUDE_RATE_LPF_ENABLE);
+
+  // The rate output ends up as an int16, stop integrating when it saturates
+  pidRate.antiWindup = true;
+  for (int i = 0; i < AXIS_COUNT; i++) {
+    pidRate.outputLimit[i] = INT16_MAX;
+  }
+
+  pidBatchInit(&pidAttitude, AXIS_COUNT, updateDt);
+  pidBatchInitAxis(&pidAttitude, AXIS_ROLL,  PID_ROLL_KP,  PID_ROLL_KI,  PID_ROLL_KD,
+      PID_ROLL_INTEGRATION_LIMIT, ATTITUDE_RATE, ATTITUDE_LPF_CUTOFF_FREQ, ATTITUDE_LPF_ENABLE);
+  pidBatchInitAxis(&pidAttitude, AXIS_PITCH, PID_PITCH_KP, PID_PITCH_KI, PID_PITCH_KD,
+      PID_PITCH_INTEGRATION_LIMIT, ATTITUDE_RATE, ATTITUDE_LPF_CUTOFF_FREQ, ATTITUDE_LPF_ENABLE);
+  pidBatchInitAxis(&pidAttitude, AXIS_YAW,   PID_YAW_KP,   PID_YAW_KI,   PID_YAW_KD,
+      PID_YAW_INTEGRATION_LIMIT, ATTITUDE_RATE, ATTITUDE_LPF_CUTOFF_FREQ, ATTITUDE_LPF_ENABLE);
 
   isInit = true;
 }
@@ -100,14 +105,16 @@ void attitudeControllerCorrectRatePID(
        float rollRateActual, float pitchRateActual, float yawRateActual,
        float rollRateDesired, float pitchRateDesired, float yawRateDesired)
 {
-  pidSetDesired(&pidRollRate, rollRateDesired);
-  rollOutput = saturateSignedInt16(pidUpdate(&pidRollRate, rollRateActual, true));
+  const float actual[AXIS_COUNT] = {rollRateActual, pitchRateActual, yawRateActual};
+  pidRate.desired[AXIS_ROLL] = rollRateDesired;
+  pidRate.desired[AXIS_PITCH] = pitchRateDesired;
+  pidRate.desired[AXIS_YAW] = yawRateDesired;
 
-  pidSetDesired(&pidPitchRate, pitchRateDesired);
-  pitchOutput = saturateSignedInt16(pidUpdate(&pidPitchRate, pitchRateActual, true));
+  const float* output = pidBatchUpdate(&pidRate, actual, 0);
 
-  pidSetDesired(&pidYawRate, yawRateDesired);
-  yawOutput = saturateSignedInt16(pidUpdate(&pidYawRate, yawRateActual, true));
+  rollOutput = saturateSignedInt16(output[AXIS_ROLL]);
+  pitchOutput = saturateSignedInt16(output[AXIS_PITCH]);
+  yawOutput = saturateSignedInt16(output[AXIS_YAW]);
 }
 
 void attitudeControllerCorrectAttitudePID(
@@ -115,39 +122,40 @@ void attitudeControllerCorrectAttitudePID(
        float eulerRollDesired, float eulerPitchDesired, float eulerYawDesired,
        float* rollRateDesired, float* pitchRateDesired, float* yawRateDesired)
 {
-  pidSetDesired(&pidRoll, eulerRollDesired);
-  *rollRateDesired = pidUpdate(&pidRoll, eulerRollActual, true);
+  pidAttitude.desired[AXIS_ROLL] = eulerRollDesired;
+  pidAttitude.desired[AXIS_PITCH] = eulerPitchDesired;
+  pidAttitude.desired[AXIS_YAW] = eulerYawDesired;
 
-  // Update PID for pitch axis
-  pidSetDesired(&pidPitch, eulerPitchDesired);
-  *pitchRateDesired = pidUpdate(&pidPitch, eulerPitchActual, true);
+  pidAttitude.error[AXIS_ROLL] = eulerRollDesired - eulerRollActual;
+  pidAttitude.error[AXIS_PITCH] = eulerPitchDesired - eulerPitchActual;
 
-  // Update PID for yaw axis
+  // Yaw error is wrapped to the shortest way around
   float yawError;
   yawError = eulerYawDesired - eulerYawActual;
   if (yawError > 180.0f)
     yawError -= 360.0f;
   else if (yawError < -180.0f)
     yawError += 360.0f;
-  pidSetError(&pidYaw, yawError);
-  *yawRateDesired = pidUpdate(&pidYaw, eulerYawActual, false);
+  pidAttitude.error[AXIS_YAW] = yawError;
+
+  const float* output = pidBatchUpdate(&pidAttitude, 0, 0);
+
+  *rollRateDesired = output[AXIS_ROLL];
+  *pitchRateDesired = output[AXIS_PITCH];
+  *yawRateDesired = output[AXIS_YAW];
 }
 
 void attitudeControllerResetRollAttitudePID(void) {
-    pidReset(&pidRoll);
+    pidBatchResetAxis(&pidAttitude, AXIS_ROLL);
 }
 
 void attitudeControllerResetPitchAttitudePID(void) {
-    pidReset(&pidPitch);
+    pidBatchResetAxis(&pidAttitude, AXIS_PITCH);
 }
 
 void attitudeControllerResetAllPID(void) {
-  pidReset(&pidRoll);
-  pidReset(&pidPitch);
-  pidReset(&pidYaw);
-  pidReset(&pidRollRate);
-  pidReset(&pidPitchRate);
-  pidReset(&pidYawRate);
+  pidBatchReset(&pidAttitude);
+  pidBatchReset(&pidRate);
 }
 
 void attitudeControllerGetActuatorOutput(int16_t* roll, int16_t* pitch, int16_t* yaw) {
@@ -157,49 +165,49 @@ void attitudeControllerGetActuatorOutput(int16_t* roll, int16_t* pitch, int16_t*
 }
 
 LOG_GROUP_START(pid_attitude)
-LOG_ADD(LOG_FLOAT, roll_outP, &pidRoll.outP)
-LOG_ADD(LOG_FLOAT, roll_outI, &pidRoll.outI)
-LOG_ADD(LOG_FLOAT, roll_outD, &pidRoll.outD)
-LOG_ADD(LOG_FLOAT, pitch_outP, &pidPitch.outP)
-LOG_ADD(LOG_FLOAT, pitch_outI, &pidPitch.outI)
-LOG_ADD(LOG_FLOAT, pitch_outD, &pidPitch.outD)
-LOG_ADD(LOG_FLOAT, yaw_outP, &pidYaw.outP)
-LOG_ADD(LOG_FLOAT, yaw_outI, &pidYaw.outI)
-LOG_ADD(LOG_FLOAT, yaw_outD, &pidYaw.outD)
+LOG_ADD(LOG_FLOAT, roll_outP, &pidAttitude.outP[AXIS_ROLL])
+LOG_ADD(LOG_FLOAT, roll_outI, &pidAttitude.outI[AXIS_ROLL])
+LOG_ADD(LOG_FLOAT, roll_outD, &pidAttitude.outD[AXIS_ROLL])
+LOG_ADD(LOG_FLOAT, pitch_outP, &pidAttitude.outP[AXIS_PITCH])
+LOG_ADD(LOG_FLOAT, pitch_outI, &pidAttitude.outI[AXIS_PITCH])
+LOG_ADD(LOG_FLOAT, pitch_outD, &pidAttitude.outD[AXIS_PITCH])
+LOG_ADD(LOG_FLOAT, yaw_outP, &pidAttitude.outP[AXIS_YAW])
+LOG_ADD(LOG_FLOAT, yaw_outI, &pidAttitude.outI[AXIS_YAW])
+LOG_ADD(LOG_FLOAT, yaw_outD, &pidAttitude.outD[AXIS_YAW])
 LOG_GROUP_STOP(pid_attitude)
 
 LOG_GROUP_START(pid_rate)
-LOG_ADD(LOG_FLOAT, roll_outP, &pidRollRate.outP)
-LOG_ADD(LOG_FLOAT, roll_outI, &pidRollRate.outI)
-LOG_ADD(LOG_FLOAT, roll_outD, &pidRollRate.outD)
-LOG_ADD(LOG_FLOAT, pitch_outP, &pidPitchRate.outP)
-LOG_ADD(LOG_FLOAT, pitch_outI, &pidPitchRate.outI)
-LOG_ADD(LOG_FLOAT, pitch_outD, &pidPitchRate.outD)
-LOG_ADD(LOG_FLOAT, yaw_outP, &pidYawRate.outP)
-LOG_ADD(LOG_FLOAT, yaw_outI, &pidYawRate.outI)
-LOG_ADD(LOG_FLOAT, yaw_outD, &pidYawRate.outD)
+LOG_ADD(LOG_FLOAT, roll_outP, &pidRate.outP[AXIS_ROLL])
+LOG_ADD(LOG_FLOAT, roll_outI, &pidRate.outI[AXIS_ROLL])
+LOG_ADD(LOG_FLOAT, roll_outD, &pidRate.outD[AXIS_ROLL])
+LOG_ADD(LOG_FLOAT, pitch_outP, &pidRate.outP[AXIS_PITCH])
+LOG_ADD(LOG_FLOAT, pitch_outI, &pidRate.outI[AXIS_PITCH])
+LOG_ADD(LOG_FLOAT, pitch_outD, &pidRate.outD[AXIS_PITCH])
+LOG_ADD(LOG_FLOAT, yaw_outP, &pidRate.outP[AXIS_YAW])
+LOG_ADD(LOG_FLOAT, yaw_outI, &pidRate.outI[AXIS_YAW])
+LOG_ADD(LOG_FLOAT, yaw_outD, &pidRate.outD[AXIS_YAW])
 LOG_GROUP_STOP(pid_rate)
 
 PARAM_GROUP_START(pid_attitude)
-PARAM_ADD(PARAM_FLOAT, roll_kp, &pidRoll.kp)
-PARAM_ADD(PARAM_FLOAT, roll_ki, &pidRoll.ki)
-PARAM_ADD(PARAM_FLOAT, roll_kd, &pidRoll.kd)
-PARAM_ADD(PARAM_FLOAT, pitch_kp, &pidPitch.kp)
-PARAM_ADD(PARAM_FLOAT, pitch_ki, &pidPitch.ki)
-PARAM_ADD(PARAM_FLOAT, pitch_kd, &pidPitch.kd)
-PARAM_ADD(PARAM_FLOAT, yaw_kp, &pidYaw.kp)
-PARAM_ADD(PARAM_FLOAT, yaw_ki, &pidYaw.ki)
-PARAM_ADD(PARAM_FLOAT, yaw_kd, &pidYaw.kd)
+PARAM_ADD(PARAM_FLOAT, roll_kp, &pidAttitude.kp[AXIS_ROLL])
+PARAM_ADD(PARAM_FLOAT, roll_ki, &pidAttitude.ki[AXIS_ROLL])
+PARAM_ADD(PARAM_FLOAT, roll_kd, &pidAttitude.kd[AXIS_ROLL])
+PARAM_ADD(PARAM_FLOAT, pitch_kp, &pidAttitude.kp[AXIS_PITCH])
+PARAM_ADD(PARAM_FLOAT, pitch_ki, &pidAttitude.ki[AXIS_PITCH])
+PARAM_ADD(PARAM_FLOAT, pitch_kd, &pidAttitude.kd[AXIS_PITCH])
+PARAM_ADD(PARAM_FLOAT, yaw_kp, &pidAttitude.kp[AXIS_YAW])
+PARAM_ADD(PARAM_FLOAT, yaw_ki, &pidAttitude.ki[AXIS_YAW])
+PARAM_ADD(PARAM_FLOAT, yaw_kd, &pidAttitude.kd[AXIS_YAW])
 PARAM_GROUP_STOP(pid_attitude)
 
 PARAM_GROUP_START(pid_rate)
-PARAM_ADD(PARAM_FLOAT, roll_kp, &pidRollRate.kp)
-PARAM_ADD(PARAM_FLOAT, roll_ki, &pidRollRate.ki)
-PARAM_ADD(PARAM_FLOAT, roll_kd, &pidRollRate.kd)
-PARAM_ADD(PARAM_FLOAT, pitch_kp, &pidPitchRate.kp)
-PARAM_ADD(PARAM_FLOAT, pitch_ki, &pidPitchRate.ki)
-PARAM_ADD(PARAM_FLOAT, pitch_kd, &pidPitchRate.kd)
-PARAM_ADD(PARAM_FLOAT, yaw_kp, &pidYawRate.kp)
-PARAM_ADD(PARAM_FLOAT, yaw_ki, &pidYawRate.ki)
-PARAM_ADD(PARAM_FLOAT, yaw_kd, &pidYawRate.kd)
+PARAM_ADD(PARAM_FLOAT, roll_kp, &pidRate.kp[AXIS_ROLL])
+PARAM_ADD(PARAM_FLOAT, roll_ki, &pidRate.ki[AXIS_ROLL])
+PARAM_ADD(PARAM_FLOAT, roll_kd, &pidRate.kd[AXIS_ROLL])
+PARAM_ADD(PARAM_FLOAT, pitch_kp, &pidRate.kp[AXIS_PITCH])
+PARAM_ADD(PARAM_FLOAT, pitch_ki, &pidRate.ki[AXIS_PITCH])
+PARAM_ADD(PARAM_FLOAT, pitch_kd, &pidRate.kd[AXIS_PITCH])
+PARAM_ADD(PARAM_FLOAT, yaw_kp, &pidRate.kp[AXIS_YAW])
+PARAM_ADD(PARAM_FLOAT, yaw_ki, &pidRate.ki[AXIS_YAW])
+PARAM_ADD(PARAM_FLOAT, yaw_kd, &pidRate.kd[AXIS_YAW])
 PARAM_GROUP_STOP(pid_rate)
@@ -30,8 +30,16 @@
 /*FreeRtos includes*/
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "task.h"
 
+#include "config.h"
 #include "crtp.h"
+#include "console.h"
+#include "log.h"
+
+#ifdef DEBUG_PRINT_DEFERRED
+#include "deferred_print.h"
+#endif
 
 #ifdef STM32F40_41xxx
 #include "stm32f4xx.h"
@@ -51,6 +59,27 @@ static bool isInit;
 
 static void addBufferFullMarker();
 
+#ifdef DEBUG_PRINT_DEFERRED
+// Deferred print records, sent on a separate channel by a low priority task
+#define DEFERRED_CHANNEL 1
+#define DEFERRED_BUFFER_SIZE 1024 // Must be a power of 2
+#define DEFERRED_BUFFER_MASK (DEFERRED_BUFFER_SIZE - 1)
+#define DEFERRED_SEND_PERIOD_MS 20
+
+#if DEFERRED_PRINT_MAX_RECORD_SIZE > CRTP_MAX_DATA_SIZE
+#error "A deferred print record must fit in one CRTP packet"
+#endif
+
+static uint8_t deferredBuffer[DEFERRED_BUFFER_SIZE];
+// Written by the producers (with interrupts masked)
+static volatile uint32_t deferredHead;
+// Written by the deferred console task
+static volatile uint32_t deferredTail;
+static uint32_t deferredDropCount;
+
+static void consoleDeferredTask(void* param);
+#endif
+
 
 /**
  * Send the data to the client
@@ -77,6 +106,13 @@ void consoleInit() {
   vSemaphoreCreateBinary(synch);
   messageSendingIsPending = false;
 
+#ifdef DEBUG_PRINT_DEFERRED
+  deferredHead = 0;
+  deferredTail = 0;
+  xTaskCreate(consoleDeferredTask, CONSOLE_DEFERRED_TASK_NAME,
+              CONSOLE_DEFERRED_TASK_STACKSIZE, NULL, CONSOLE_DEFERRED_TASK_PRI, NULL);
+#endif
+
   isInit = true;
 }
 
@@ -182,3 +218,62 @@ static void addBufferFullMarker()
   memcpy(&messageToPrint.data[startMarker], bufferFullMsg, sizeof(bufferFullMsg));
   messageToPrint.size = startMarker + sizeof(bufferFullMsg);
 }
+
+#ifdef DEBUG_PRINT_DEFERRED
+void consoleDeferredWrite(const uint8_t* record, const uint8_t size) {
+  if (!isInit) {
+    return;
+  }
+
+  // Only a short copy with interrupts masked, no blocking, which makes it
+  // possible to print from real time tasks and interrupts
+  UBaseType_t savedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+  const uint32_t head = deferredHead;
+  if (DEFERRED_BUFFER_SIZE - (head - deferredTail) >= size) {
+    for (int i = 0; i < size; i++) {
+      deferredBuffer[(head + i) & DEFERRED_BUFFER_MASK] = record[i];
+    }
+    __DMB();
+    deferredHead = head + size;
+  } else {
+    deferredDropCount++;
+  }
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(savedInterruptStatus);
+}
+
+static void consoleDeferredTask(void* param) {
+  CRTPPacket packet;
+  packet.header = CRTP_HEADER(CRTP_PORT_CONSOLE, DEFERRED_CHANNEL);
+
+  while (true) {
+    vTaskDelay(M2T(DEFERRED_SEND_PERIOD_MS));
+
+    uint32_t tail = deferredTail;
+    while (tail != deferredHead) {
+      __DMB();
+      const uint32_t head = deferredHead;
+
+      // Pack as many complete records as possible in the packet
+      packet.size = 0;
+      while (tail != head) {
+        const uint8_t recordSize = deferredBuffer[tail & DEFERRED_BUFFER_MASK];
+        if (packet.size + recordSize > CRTP_MAX_DATA_SIZE) {
+          break;
+        }
+
+        for (int i = 0; i < recordSize; i++) {
+          packet.data[packet.size++] = deferredBuffer[(tail + i) & DEFERRED_BUFFER_MASK];
+        }
+        tail += recordSize;
+      }
+
+      crtpSendPacketBlock(&packet);
+      deferredTail = tail;
+    }
+  }
+}
+
+LOG_GROUP_START(console)
+LOG_ADD(LOG_UINT32, deferredDrop, &deferredDropCount)
+LOG_GROUP_STOP(console)
+#endif
@@ -40,6 +40,7 @@ We added the following:
 #include "param.h"
 #include "log.h"
 #include "math3d.h"
+#include "pptraj.h"
 #include "position_controller.h"
 #include "controller_mellinger.h"
 
@@ -125,10 +126,10 @@ void controllerMellinger(control_t *control, setpoint_t *setpoint,
   float current_thrust;
   struct vec x_axis_desired;
   struct vec y_axis_desired;
-  struct vec x_c_des;
+  struct vec heading;
+  struct vec omega_des;
   struct vec eR, ew, M;
   float dt;
-  float desiredYaw = 0; //deg
 
   if (!RATE_DO_EXECUTE(ATTITUDE_RATE, tick)) {
     return;
@@ -173,15 +174,27 @@ void controllerMellinger(control_t *control, setpoint_t *setpoint,
     }
   }
 
-  // Rate-controlled YAW is moving YAW angle setpoint
-  if (setpoint->mode.yaw == modeVelocity) {
-    desiredYaw = state->attitude.yaw + setpoint->attitudeRate.yaw * dt;
-  } else if (setpoint->mode.yaw == modeAbs) {
-    desiredYaw = setpoint->attitude.yaw;
-  } else if (setpoint->mode.quat == modeAbs) {
-    struct quat setpoint_quat = mkquat(setpoint->attitudeQuaternion.x, setpoint->attitudeQuaternion.y, setpoint->attitudeQuaternion.z, setpoint->attitudeQuaternion.w);
-    struct vec rpy = quat2rpy(setpoint_quat);
-    desiredYaw = degrees(rpy.z);
+  if (setpoint->mode.heading == modeAbs) {
+    // Heading and body rates straight from the trajectory, no unit conversions or trig needed
+    heading = mkvec(setpoint->heading.x, setpoint->heading.y, setpoint->heading.z);
+    omega_des = mkvec(setpoint->omega.x, setpoint->omega.y, setpoint->omega.z);
+  } else {
+    float desiredYaw = 0; //deg
+
+    // Rate-controlled YAW is moving YAW angle setpoint
+    if (setpoint->mode.yaw == modeVelocity) {
+      desiredYaw = state->attitude.yaw + setpoint->attitudeRate.yaw * dt;
+    } else if (setpoint->mode.yaw == modeAbs) {
+      desiredYaw = setpoint->attitude.yaw;
+    } else if (setpoint->mode.quat == modeAbs) {
+      struct quat setpoint_quat = mkquat(setpoint->attitudeQuaternion.x, setpoint->attitudeQuaternion.y, setpoint->attitudeQuaternion.z, setpoint->attitudeQuaternion.w);
+      struct vec rpy = quat2rpy(setpoint_quat);
+      desiredYaw = degrees(rpy.z);
+    }
+
+    // [xC_des] = [cos(yaw), sin(yaw), 0]^T
+    heading = mkvec(cosf(radians(desiredYaw)), sinf(radians(desiredYaw)), 0);
+    omega_des = mkvec(radians(setpoint->attitudeRate.roll), radians(setpoint->attitudeRate.pitch), radians(setpoint->attitudeRate.yaw));
   }
 
   // Z-Axis [zB]
@@ -202,18 +215,11 @@ void controllerMellinger(control_t *control, setpoint_t *setpoint,
   // Current thrust [F]
   current_thrust = vdot(target_thrust, z_axis);
 
-  // Calculate axis [zB_des]
-  z_axis_desired = vnormalize(target_thrust);
-
-  // [xC_des]
-  // x_axis_desired = z_axis_desired x [sin(yaw), cos(yaw), 0]^T
-  x_c_des.x = cosf(radians(desiredYaw));
-  x_c_des.y = sinf(radians(desiredYaw));
-  x_c_des.z = 0;
-  // [yB_des]
-  y_axis_desired = vnormalize(vcross(z_axis_desired, x_c_des));
-  // [xB_des]
-  x_axis_desired = vcross(y_axis_desired, z_axis_desired);
+  // Calculate axes [xB_des], [yB_des], [zB_des]
+  struct mat33 Rdes = flat_attitude(target_thrust, heading);
+  x_axis_desired = mcolumn(Rdes, 0);
+  y_axis_desired = mcolumn(Rdes, 1);
+  z_axis_desired = mcolumn(Rdes, 2);
 
   // [eR]
   // Slow version
@@ -251,17 +257,17 @@ void controllerMellinger(control_t *control, setpoint_t *setpoint,
   float stateAttitudeRatePitch = -radians(sensors->gyro.y);
   float stateAttitudeRateYaw = radians(sensors->gyro.z);
 
-  ew.x = radians(setpoint->attitudeRate.roll) - stateAttitudeRateRoll;
-  ew.y = -radians(setpoint->attitudeRate.pitch) - stateAttitudeRatePitch;
-  ew.z = radians(setpoint->attitudeRate.yaw) - stateAttitudeRateYaw;
+  ew.x = omega_des.x - stateAttitudeRateRoll;
+  ew.y = -omega_des.y - stateAttitudeRatePitch;
+  ew.z = omega_des.z - stateAttitudeRateYaw;
   if (prev_omega_roll == prev_omega_roll) { /*d part initialized*/
-    err_d_roll = ((radians(setpoint->attitudeRate.roll) - prev_setpoint_omega_roll) - (stateAttitudeRateRoll - prev_omega_roll)) / dt;
-    err_d_pitch = (-(radians(setpoint->attitudeRate.pitch) - prev_setpoint_omega_pitch) - (stateAttitudeRatePitch - prev_omega_pitch)) / dt;
+    err_d_roll = ((omega_des.x - prev_setpoint_omega_roll) - (stateAttitudeRateRoll - prev_omega_roll)) / dt;
+    err_d_pitch = (-(omega_des.y - prev_setpoint_omega_pitch) - (stateAttitudeRatePitch - prev_omega_pitch)) / dt;
   }
   prev_omega_roll = stateAttitudeRateRoll;
   prev_omega_pitch = stateAttitudeRatePitch;
-  prev_setpoint_omega_roll = radians(setpoint->attitudeRate.roll);
-  prev_setpoint_omega_pitch = radians(setpoint->attitudeRate.pitch);
+  prev_setpoint_omega_roll = omega_des.x;
+  prev_setpoint_omega_pitch = omega_des.y;
 
   // Integral Error
   i_error_m_x += (-eR.x) * dt;
@@ -73,10 +73,22 @@ static xQueueHandle  txQueue;
 #define CRTP_NBR_OF_PORTS 16
 #define CRTP_TX_QUEUE_SIZE 100
 #define CRTP_RX_QUEUE_SIZE 16
+// The pool only holds packets on their way from the link to the rx task, at
+// most the radiolink delivery queue (5), the packet handled by the rx task and
+// one being filled by the link. Port callbacks get the pooled packet without a
+// copy, port queues hold copies so that a slow port task can never starve the
+// link of buffers.
+#define CRTP_RX_PACKET_POOL_SIZE 8
 
 static void crtpTxTask(void *param);
 static void crtpRxTask(void *param);
 
+// Received packets are passed by pointer from the link to the rx task
+static CRTPPacket packetPool[CRTP_RX_PACKET_POOL_SIZE];
+static xQueueHandle packetPoolFree;
+// Packets dropped by the link because the pool was empty
+static uint32_t packetPoolDropCount;
+
 static xQueueHandle queues[CRTP_NBR_OF_PORTS];
 static volatile CrtpCallback callbacks[CRTP_NBR_OF_PORTS];
 static void updateStats();
@@ -88,6 +100,13 @@ void crtpInit(void) {
   txQueue = xQueueCreate(CRTP_TX_QUEUE_SIZE, sizeof(CRTPPacket));
   DEBUG_QUEUE_MONITOR_REGISTER(txQueue);
 
+  packetPoolFree = xQueueCreate(CRTP_RX_PACKET_POOL_SIZE, sizeof(CRTPPacket*));
+  DEBUG_QUEUE_MONITOR_REGISTER(packetPoolFree);
+  for (int i = 0; i < CRTP_RX_PACKET_POOL_SIZE; i++) {
+    CRTPPacket* p = &packetPool[i];
+    xQueueSend(packetPoolFree, &p, 0);
+  }
+
   xTaskCreate(crtpTxTask, CRTP_TX_TASK_NAME,
               CRTP_TX_TASK_STACKSIZE, NULL, CRTP_TX_TASK_PRI, NULL);
   xTaskCreate(crtpRxTask, CRTP_RX_TASK_NAME,
@@ -110,6 +129,22 @@ void crtpInitTaskQueue(CRTPPort portId) {
   DEBUG_QUEUE_MONITOR_REGISTER(queues[portId]);
 }
 
+CRTPPacket* crtpPacketAlloc(void) {
+  CRTPPacket* p = NULL;
+  if (xQueueReceive(packetPoolFree, &p, 0) != pdTRUE) {
+    packetPoolDropCount++;
+    return NULL;
+  }
+
+  return p;
+}
+
+void crtpPacketFree(CRTPPacket *p) {
+  ASSERT(p >= &packetPool[0] && p < &packetPool[CRTP_RX_PACKET_POOL_SIZE]);
+
+  xQueueSend(packetPoolFree, &p, 0);
+}
+
 int crtpReceivePacket(CRTPPort portId, CRTPPacket *p) {
   ASSERT(queues[portId]);
   ASSERT(p);
@@ -156,22 +191,38 @@ void crtpTxTask(void *param) {
   }
 }
 
+// Links that use the pool deliver a pooled packet, other links receive into
+// the buffer of the rx task.
+static int receiveFromLink(CRTPPacket *buffer, CRTPPacket **p) {
+  if (link->receivePacketRef) {
+    return link->receivePacketRef(p);
+  }
+
+  *p = buffer;
+  return link->receivePacket(buffer);
+}
+
 void crtpRxTask(void *param) {
-  CRTPPacket p;
+  CRTPPacket buffer;
+  CRTPPacket* p;
 
   while (true) {
     if (link != &nopLink) {
-      if (!link->receivePacket(&p)) {
+      if (!receiveFromLink(&buffer, &p)) {
 
-        if (queues[p.port]) {
-          if (xQueueSend(queues[p.port], &p, 0) == errQUEUE_FULL) {
+        if (queues[p->port]) {
+          if (xQueueSend(queues[p->port], p, 0) == errQUEUE_FULL) {
             // We should never drop packet
             ASSERT(0);
-          }          
+          }
+        }
+
+        if (callbacks[p->port]) {
+          callbacks[p->port](p);
         }
 
-        if (callbacks[p.port]) {
-          callbacks[p.port](&p);
+        if (p != &buffer) {
+          crtpPacketFree(p);
         }
 
         stats.rxCount++;
@@ -265,4 +316,5 @@ static void updateStats()
 LOG_GROUP_START(crtp)
 LOG_ADD(LOG_UINT16, rxRate, &stats.rxRate)
 LOG_ADD(LOG_UINT16, txRate, &stats.txRate)
+LOG_ADD(LOG_UINT32, poolDrop, &packetPoolDropCount)
 LOG_GROUP_STOP(tdoa)
@@ -69,8 +69,9 @@ static void commanderCrtpCB(CRTPPacket* pk) {
     commanderSetSetpoint(&setpoint, COMMANDER_PRIORITY_CRTP);
   } else if (pk->port == CRTP_PORT_SETPOINT_GENERIC && pk->channel == 0) {
     // guojun: packets like altHold or hover go through here
-    crtpCommanderGenericDecodeSetpoint(&setpoint, pk);
-    commanderSetSetpoint(&setpoint, COMMANDER_PRIORITY_CRTP);
+    if (crtpCommanderGenericDecodeSetpoint(&setpoint, pk)) {
+      commanderSetSetpoint(&setpoint, COMMANDER_PRIORITY_CRTP);
+    }
   } else if (pk->port == CRTP_PORT_SETPOSITION && pk->channel == 0) {
     crtpCommanderPosHoldDecodeSetpoint(&setpoint, pk);
     commanderSetSetpoint(&setpoint, COMMANDER_PRIORITY_CRTP);
@@ -34,6 +34,9 @@
 #include "crtp.h"
 #include "num.h"
 #include "quatcompress.h"
+#include "configblock.h"
+#include "log.h"
+#include "swarm_frame.h"
 #include "FreeRTOS.h"
 
 /* The generic commander format contains a packet type and data that has to be
@@ -71,6 +74,7 @@ enum packet_type {
   hoverType         = 5,
   fullStateType     = 6,
   positionType      = 7,
+  swarmPositionType = 8,
 };
 
 /* ---===== 2 - Decoding functions =====--- */
@@ -359,6 +363,43 @@ static void positionDecoder(setpoint_t *setpoint, uint8_t type, const void *data
   setpoint->attitude.yaw = values->yaw;
 }
 
+/* swarmPositionDecoder
+ * Absolute position and yaw from a broadcast frame with setpoints for a whole
+ * swarm, see swarm_frame.h. Only the packet that carries the slot of this
+ * Crazyflie holds a setpoint, all other packets are ignored. It is handled
+ * before the packetDecoders array since most packets of a frame do not set
+ * the setpoint.
+ */
+static swarmFrameReceiver_t swarmReceiver;
+
+static bool swarmPositionDecoder(setpoint_t *setpoint, const uint8_t *data, size_t datalen)
+{
+  static bool isInit = false;
+  if (!isInit) {
+    swarmFrameReceiverInit(&swarmReceiver, configblockGetRadioAddress() & 0xFF);
+    isInit = true;
+  }
+
+  const swarmFrameSetpointItem_t *item = swarmFrameReceiverAdd(&swarmReceiver, data, datalen, sizeof(swarmFrameSetpointItem_t));
+  if (!item) {
+    return false;
+  }
+
+  setpoint->mode.x = modeAbs;
+  setpoint->mode.y = modeAbs;
+  setpoint->mode.z = modeAbs;
+
+  setpoint->position.x = item->x / 1000.0f;
+  setpoint->position.y = item->y / 1000.0f;
+  setpoint->position.z = item->z / 1000.0f;
+
+  setpoint->mode.yaw = modeAbs;
+
+  setpoint->attitude.yaw = item->yaw / 100.0f;
+
+  return true;
+}
+
  /* ---===== 3 - packetDecoders array =====--- */
 const static packetDecoder_t packetDecoders[] = {
   [stopType]          = stopDecoder,
@@ -372,7 +413,7 @@ const static packetDecoder_t packetDecoders[] = {
 };
 
 /* Decoder switch */
-void crtpCommanderGenericDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk)
+bool crtpCommanderGenericDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk)
 {
   static int nTypes = -1;
 
@@ -386,9 +427,15 @@ void crtpCommanderGenericDecodeSetpoint(setpoint_t *setpoint, CRTPPacket *pk)
 
   memset(setpoint, 0, sizeof(setpoint_t));
 
+  if (type == swarmPositionType) {
+    return swarmPositionDecoder(setpoint, ((uint8_t*)pk->data) + 1, pk->size - 1);
+  }
+
   if (type < nTypes && (packetDecoders[type] != NULL)) {
     packetDecoders[type](setpoint, type, ((char*)pk->data) + 1, pk->size - 1);
   }
+
+  return true;
 }
 
 // Params for generic CRTP handlers
@@ -401,3 +448,11 @@ PARAM_ADD(PARAM_FLOAT, rateYaw, &s_CppmEmuYawMaxRateDps)
 PARAM_ADD(PARAM_FLOAT, angRoll, &s_CppmEmuRollMaxAngleDeg)
 PARAM_ADD(PARAM_FLOAT, angPitch, &s_CppmEmuPitchMaxAngleDeg)
 PARAM_GROUP_STOP(cmdrCPPM)
+
+LOG_GROUP_START(swarmSp)
+LOG_ADD(LOG_UINT32, frames, &swarmReceiver.frameCount)
+LOG_ADD(LOG_UINT32, lost, &swarmReceiver.frameLostCount)
+LOG_ADD(LOG_UINT32, missed, &swarmReceiver.slotMissedCount)
+LOG_ADD(LOG_UINT32, stale, &swarmReceiver.staleCount)
+LOG_ADD(LOG_UINT8, quality, &swarmReceiver.quality)
+LOG_GROUP_STOP(swarmSp)
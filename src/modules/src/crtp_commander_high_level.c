@@ -203,6 +203,20 @@ bool crtpCommanderHighLevelIsStopped() {
   return plan_is_stopped(&planner);
 }
 
+bool crtpCommanderHighLevelGetTrajectoryTime(float* trajectoryTime) {
+  bool result = false;
+
+  xSemaphoreTake(lockTraj, portMAX_DELAY);
+  if (!plan_is_stopped(&planner) && planner.trajectory == &trajectory && trajectory.timescale > 0.0f) {
+    float t = usecTimestamp() / 1e6;
+    *trajectoryTime = (t - trajectory.t_begin) / trajectory.timescale;
+    result = true;
+  }
+  xSemaphoreGive(lockTraj);
+
+  return result;
+}
+
 void crtpCommanderHighLevelGetSetpoint(setpoint_t* setpoint, const state_t *state) {
   xSemaphoreTake(lockTraj, portMAX_DELAY);
   float t = usecTimestamp() / 1e6;
@@ -230,6 +244,13 @@ void crtpCommanderHighLevelGetSetpoint(setpoint_t* setpoint, const state_t *stat
     setpoint->attitudeRate.roll = degrees(ev.omega.x);
     setpoint->attitudeRate.pitch = degrees(ev.omega.y);
     setpoint->attitudeRate.yaw = degrees(ev.omega.z);
+    // Same feed forward in radians for controllers that use it directly
+    setpoint->heading.x = ev.heading.x;
+    setpoint->heading.y = ev.heading.y;
+    setpoint->heading.z = ev.heading.z;
+    setpoint->omega.x = ev.omega.x;
+    setpoint->omega.y = ev.omega.y;
+    setpoint->omega.z = ev.omega.z;
     setpoint->mode.x = modeAbs;
     setpoint->mode.y = modeAbs;
     setpoint->mode.z = modeAbs;
@@ -237,6 +258,7 @@ void crtpCommanderHighLevelGetSetpoint(setpoint_t* setpoint, const state_t *stat
     setpoint->mode.pitch = modeDisable;
     setpoint->mode.yaw = modeAbs;
     setpoint->mode.quat = modeDisable;
+    setpoint->mode.heading = modeAbs;
     setpoint->acceleration.x = ev.acc.x;
     setpoint->acceleration.y = ev.acc.y;
     setpoint->acceleration.z = ev.acc.z;
@@ -43,6 +43,8 @@
 
 #include "estimator.h"
 #include "quatcompress.h"
+#include "time_sync.h"
+#include "swarm_frame.h"
 
 #define NBR_OF_RANGES_IN_PACKET   5
 #define DEFAULT_EMERGENCY_STOP_TIMEOUT (1 * RATE_MAIN_LOOP)
@@ -78,6 +80,12 @@ typedef struct {
   uint32_t quat; // compressed quaternion, see quatcompress.h
 } __attribute__((packed)) extPosePackedItem;
 
+// Header of EXT_POSE_PACKED_TIMESTAMPED, followed by up to 2 extPosePackedItem
+typedef struct {
+  uint8_t type;
+  uint32_t timestamp; // ms, host clock when the poses were captured
+} __attribute__((packed)) extPosePackedTimestampedHeader;
+
 // Struct for logging position information
 static positionMeasurement_t ext_pos;
 // Struct for logging pose information
@@ -91,11 +99,18 @@ static float extQuatStdDev = 4.5e-3;
 static bool isInit = false;
 static uint8_t my_id;
 static uint16_t tickOfLastPacket; // tick when last packet was received
+static timeSync_t hostTimeSync;
+
+// Position and pose frames are one stream, they share the sequence number
+static swarmFrameReceiver_t swarmReceiver;
 
 static void locSrvCrtpCB(CRTPPacket* pk);
 static void extPositionHandler(CRTPPacket* pk);
 static void genericLocHandle(CRTPPacket* pk);
 static void extPositionPackedHandler(CRTPPacket* pk);
+static void extPosePackedHandler(CRTPPacket* pk, const uint8_t headerSize, const uint32_t timestamp);
+static void timeSyncHandler(CRTPPacket* pk);
+static void swarmFrameHandler(CRTPPacket* pk);
 
 void locSrvInit() {
   if (isInit) {
@@ -104,6 +119,8 @@ void locSrvInit() {
 
   uint64_t address = configblockGetRadioAddress();
   my_id = address & 0xFF;
+  timeSyncInit(&hostTimeSync);
+  swarmFrameReceiverInit(&swarmReceiver, my_id);
 
   crtpRegisterPortCB(CRTP_PORT_LOCALIZATION, locSrvCrtpCB);
   isInit = true;
@@ -132,6 +149,7 @@ static void extPositionHandler(CRTPPacket* pk) {
   ext_pos.y = data->y;
   ext_pos.z = data->z;
   ext_pos.stdDev = extPosStdDev;
+  ext_pos.timestamp = 0;
   estimatorEnqueuePosition(&ext_pos);
   tickOfLastPacket = xTaskGetTickCount();
 }
@@ -163,27 +181,64 @@ static void genericLocHandle(CRTPPacket* pk) {
     ext_pose.quat.w = data->qw;
     ext_pose.stdDevPos = extPosStdDev;
     ext_pose.stdDevQuat = extQuatStdDev;
+    ext_pose.timestamp = 0;
     estimatorEnqueuePose(&ext_pose);
     tickOfLastPacket = xTaskGetTickCount();
   } else if (type == EXT_POSE_PACKED) {
-    uint8_t numItems = (pk->size - 1) / sizeof(extPosePackedItem);
-    for (uint8_t i = 0; i < numItems; ++i) {
-      const extPosePackedItem* item = (const extPosePackedItem*)&pk->data[1 + i * sizeof(extPosePackedItem)];
-      if (item->id == my_id) {
-        ext_pose.x = item->x / 1000.0f;
-        ext_pose.y = item->y / 1000.0f;
-        ext_pose.z = item->z / 1000.0f;
-        quatdecompress(item->quat, (float *)&ext_pose.quat.q0);
-        ext_pose.stdDevPos = extPosStdDev;
-        ext_pose.stdDevQuat = extQuatStdDev;
-        estimatorEnqueuePose(&ext_pose);
-        tickOfLastPacket = xTaskGetTickCount();
-        break;
-      }
+    extPosePackedHandler(pk, 1, 0);
+  } else if (type == EXT_POSE_PACKED_TIMESTAMPED && pk->size >= sizeof(extPosePackedTimestampedHeader)) {
+    const extPosePackedTimestampedHeader* header = (const extPosePackedTimestampedHeader*)pk->data;
+    // Without time sync the poses are fused as if they were current
+    uint32_t timestamp = 0;
+    if (timeSyncIsValid(&hostTimeSync)) {
+      timestamp = timeSyncToLocal(&hostTimeSync, header->timestamp);
+    }
+    extPosePackedHandler(pk, sizeof(extPosePackedTimestampedHeader), timestamp);
+  } else if (type == TIME_SYNC && pk->size >= 1 + sizeof(uint32_t)) {
+    timeSyncHandler(pk);
+  } else if (type == SWARM_POSITION_FRAME || type == SWARM_POSE_FRAME) {
+    swarmFrameHandler(pk);
+  }
+}
+
+static void extPosePackedHandler(CRTPPacket* pk, const uint8_t headerSize, const uint32_t timestamp) {
+  uint8_t numItems = (pk->size - headerSize) / sizeof(extPosePackedItem);
+  for (uint8_t i = 0; i < numItems; ++i) {
+    const extPosePackedItem* item = (const extPosePackedItem*)&pk->data[headerSize + i * sizeof(extPosePackedItem)];
+    if (item->id == my_id) {
+      ext_pose.x = item->x / 1000.0f;
+      ext_pose.y = item->y / 1000.0f;
+      ext_pose.z = item->z / 1000.0f;
+      quatdecompress(item->quat, (float *)&ext_pose.quat.q0);
+      ext_pose.stdDevPos = extPosStdDev;
+      ext_pose.stdDevQuat = extQuatStdDev;
+      ext_pose.timestamp = timestamp;
+      estimatorEnqueuePose(&ext_pose);
+      tickOfLastPacket = xTaskGetTickCount();
+      break;
     }
   }
 }
 
+static void timeSyncHandler(CRTPPacket* pk) {
+  const uint32_t tick = xTaskGetTickCount();
+  const struct CrtpTimeSyncRequest* request = (const struct CrtpTimeSyncRequest*)&pk->data[1];
+  const uint32_t hostTime = request->hostTime;
+
+  if (pk->size >= 1 + sizeof(struct CrtpTimeSyncRequest)) {
+    // The answer is sent in the same tick as the request is received
+    timeSyncAddRoundTrip(&hostTimeSync, request->prevHostTime, request->prevTick, request->prevTick, request->prevHostRxTime);
+  }
+
+  struct CrtpTimeSync* data = (struct CrtpTimeSync*)&pk->data[1];
+  data->hostTime = hostTime;
+  data->tick = tick;
+  pk->port = CRTP_PORT_LOCALIZATION;
+  pk->channel = GENERIC_TYPE;
+  pk->size = 1 + sizeof(struct CrtpTimeSync);
+  crtpSendPacket(pk);
+}
+
 static void extPositionPackedHandler(CRTPPacket* pk) {
   uint8_t numItems = pk->size / sizeof(extPositionPackedItem);
   for (uint8_t i = 0; i < numItems; ++i) {
@@ -193,6 +248,7 @@ static void extPositionPackedHandler(CRTPPacket* pk) {
       ext_pos.y = item->y / 1000.0f;
       ext_pos.z = item->z / 1000.0f;
       ext_pos.stdDev = extPosStdDev;
+      ext_pos.timestamp = 0;
       estimatorEnqueuePosition(&ext_pos);
       tickOfLastPacket = xTaskGetTickCount();
       break;
@@ -200,6 +256,36 @@ static void extPositionPackedHandler(CRTPPacket* pk) {
   }
 }
 
+static void swarmFrameHandler(CRTPPacket* pk) {
+  const uint8_t type = pk->data[0];
+
+  if (type == SWARM_POSITION_FRAME) {
+    const swarmFramePositionItem_t* item = swarmFrameReceiverAdd(&swarmReceiver, &pk->data[1], pk->size - 1, sizeof(swarmFramePositionItem_t));
+    if (item) {
+      ext_pos.x = item->x / 1000.0f;
+      ext_pos.y = item->y / 1000.0f;
+      ext_pos.z = item->z / 1000.0f;
+      ext_pos.stdDev = extPosStdDev;
+      ext_pos.timestamp = 0;
+      estimatorEnqueuePosition(&ext_pos);
+      tickOfLastPacket = xTaskGetTickCount();
+    }
+  } else {
+    const swarmFramePoseItem_t* item = swarmFrameReceiverAdd(&swarmReceiver, &pk->data[1], pk->size - 1, sizeof(swarmFramePoseItem_t));
+    if (item) {
+      ext_pose.x = item->x / 1000.0f;
+      ext_pose.y = item->y / 1000.0f;
+      ext_pose.z = item->z / 1000.0f;
+      quatdecompress(item->quat, (float *)&ext_pose.quat.q0);
+      ext_pose.stdDevPos = extPosStdDev;
+      ext_pose.stdDevQuat = extQuatStdDev;
+      ext_pose.timestamp = 0;
+      estimatorEnqueuePose(&ext_pose);
+      tickOfLastPacket = xTaskGetTickCount();
+    }
+  }
+}
+
 void locSrvSendPacket(locsrv_t type, uint8_t *data, uint8_t length) {
   CRTPPacket pk;
 
@@ -240,8 +326,18 @@ LOG_GROUP_STOP(ext_pos)
 
 LOG_GROUP_START(locSrvZ)
   LOG_ADD(LOG_UINT16, tick, &tickOfLastPacket)  // time when data was received last (ms/ticks)
+  LOG_ADD(LOG_INT32, hostOffset, &hostTimeSync.offset)  // tick minus host time (ms)
+  LOG_ADD(LOG_UINT32, hostDelay, &hostTimeSync.delay)   // round trip delay of the offset estimate (ms)
 LOG_GROUP_STOP(locSrvZ)
 
+LOG_GROUP_START(swarmPos)
+  LOG_ADD(LOG_UINT32, frames, &swarmReceiver.frameCount)
+  LOG_ADD(LOG_UINT32, lost, &swarmReceiver.frameLostCount)  // frames where no packet was received
+  LOG_ADD(LOG_UINT32, missed, &swarmReceiver.slotMissedCount)  // frames where the packet for this Crazyflie was lost
+  LOG_ADD(LOG_UINT32, stale, &swarmReceiver.staleCount)
+  LOG_ADD(LOG_UINT8, quality, &swarmReceiver.quality)  // % of the packets received in the last frame
+LOG_GROUP_STOP(swarmPos)
+
 PARAM_GROUP_START(locSrv)
   PARAM_ADD(PARAM_UINT8, enRangeStreamFP32, &enableRangeStreamFloat)
   PARAM_ADD(PARAM_FLOAT, extPosStdDev, &extPosStdDev)
@@ -58,14 +58,18 @@
 #define DEBUG_MODULE "ESTKALMAN"
 
 #include "kalman_core.h"
+#include "estimator.h"
 #include "estimator_kalman.h"
 #include "kalman_supervisor.h"
+#include "state_buffer.h"
+#include "measurement_queue.h"
 
 #include "stm32f4xx.h"
 
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
+#include "semphr.h"
 #include "sensors.h"
 
 #include "log.h"
@@ -82,75 +86,71 @@
  * Additionally, the filter supports the incorporation of additional sensors into the state estimate
  *
  * This is done via the external functions:
- * - bool estimatorKalmanEnqueueUWBPacket(uwbPacket_t *uwb)
- * - bool estimatorKalmanEnqueuePosition(positionMeasurement_t *pos)
- * - bool estimatorKalmanEnqueueDistance(distanceMeasurement_t *dist)
+ * - bool estimatorKalmanEnqueueTDOA(const tdoaMeasurement_t *uwb)
+ * - bool estimatorKalmanEnqueuePosition(const positionMeasurement_t *pos)
+ * - bool estimatorKalmanEnqueueDistance(const distanceMeasurement_t *dist)
+ * - ...
  *
- * As well as by the following internal functions and datatypes
+ * All measurements go through one queue of measurement_t (measurement_queue.c),
+ * stamped with usecTimestamp() when enqueued. They are processed FIFO by
+ * enqueue time, not by the time the measurement was taken.
  */
 
-// Distance-to-point measurements
-static xQueueHandle distDataQueue;
-#define DIST_QUEUE_LENGTH (10)
-
-static inline bool stateEstimatorHasDistanceMeasurement(distanceMeasurement_t *dist) {
-  return (pdTRUE == xQueueReceive(distDataQueue, dist, 0));
-}
-
-// Direct measurements of Crazyflie position
-// External measurements
-static xQueueHandle posDataQueue;
-#define POS_QUEUE_LENGTH (10)
-
-static inline bool stateEstimatorHasPositionMeasurement(positionMeasurement_t *pos) {
-  return (pdTRUE == xQueueReceive(posDataQueue, pos, 0));
-}
-
-// Direct measurements of Crazyflie pose
-// External measurements
-static xQueueHandle poseDataQueue;
-#define POSE_QUEUE_LENGTH (10)
-
-static inline bool stateEstimatorHasPoseMeasurement(poseMeasurement_t *pose) {
-  return (pdTRUE == xQueueReceive(poseDataQueue, pose, 0));
-}
-
-// Measurements of a UWB Tx/Rx
-// UWB extention board
-static xQueueHandle tdoaDataQueue;
-#define UWB_QUEUE_LENGTH (10)
-
-static inline bool stateEstimatorHasTDOAPacket(tdoaMeasurement_t *uwb) {
-  return (pdTRUE == xQueueReceive(tdoaDataQueue, uwb, 0));
-}
-
-
-// Measurements of flow (dnx, dny)
-// flow deck
-static xQueueHandle flowDataQueue;
-#define FLOW_QUEUE_LENGTH (10)
-
-static inline bool stateEstimatorHasFlowPacket(flowMeasurement_t *flow) {
-  return (pdTRUE == xQueueReceive(flowDataQueue, flow, 0));
-}
-
-// Measurements of TOF from laser sensor
-// flow deck
-static xQueueHandle tofDataQueue;
-#define TOF_QUEUE_LENGTH (10)
+/**
+ * The filter runs in its own task, the stabilizer loop only passes the IMU
+ * samples and the thrust to the task and reads the latest published state.
+ * A burst of measurements therefore delays the estimate, not the control
+ * output.
+ */
 
-static inline bool stateEstimatorHasTOFPacket(tofMeasurement_t *tof) {
-  return (pdTRUE == xQueueReceive(tofDataQueue, tof, 0));
+// IMU samples and thrust from the stabilizer loop
+typedef struct {
+  Axis3f acc;
+  Axis3f gyro;
+  baro_t baro;
+  float thrust;
+  bool hasAcc;
+  bool hasGyro;
+  bool hasBaro;
+} imuSample_t;
+
+static xQueueHandle imuDataQueue;
+#define IMU_QUEUE_LENGTH (16)
+
+static inline bool stateEstimatorHasImuSample(imuSample_t *sample) {
+  return (pdTRUE == xQueueReceive(imuDataQueue, sample, 0));
 }
 
-// Absolute height measurement along the room Z
-// UWB board: DW1000
-static xQueueHandle heightDataQueue;
-#define HEIGHT_QUEUE_LENGTH (10)
+#ifndef UNIT_TEST_MODE
+static xSemaphoreHandle runTaskSemaphore;
+#endif
 
-static inline bool stateEstimatorHasHeightPacket(heightMeasurement_t *height) {
-  return (pdTRUE == xQueueReceive(heightDataQueue, height, 0));
-}
+// The state is published through a double buffer, the stabilizer is never
+// blocked by the task
+static stateBuffer_t publishedState;
+// Sequence number of the state published by the last reset, its age is not
+// measured since the task may not have run yet
+static volatile uint32_t resetSequence;
+
+// A state older than this means the task does not keep up with the IMU, it
+// is predicted forward to the current tick before it is used
+#define MAX_STATE_AGE M2T(10)
+
+// The state read by the stabilizer, for logging. Logging the filter state
+// directly would show a mix of two updates when the task runs during the log.
+// The variances and the attitude error are only in the filter state.
+static state_t loggedState;
+static Axis3f loggedBodyVelocity;
+
+// Sensor data as seen by the task, the latest IMU sample
+static sensorData_t taskSensors;
+
+static uint8_t pipelineDepth;    // IMU samples handled in the last run of the task
+static uint8_t pipelineDepthMax;
+static uint16_t stateAge;        // ms, age of the state read by the stabilizer
+static uint16_t stateAgeMax;
+static uint32_t stateTooOld;     // number of times the state was older than MAX_STATE_AGE
+static uint32_t imuSamplesDropped;
 
 /**
  * Constants used in the estimator
@@ -213,6 +213,26 @@ static int32_t lastTDOAUpdate;
 static uint32_t lastFlightCmd;
 static uint32_t takeoffTime;
 
+/**
+ * History of the estimated position and attitude, one entry per prediction.
+ * External position and pose measurements carrying a capture timestamp are
+ * fused against the state at the time of capture, which compensates for the
+ * latency of motion capture systems and the radio link.
+ */
+#define HISTORY_LENGTH 16 // at PREDICT_RATE, covers a latency of 150 ms
+
+typedef struct {
+  uint32_t tick;
+  kalmanCorePastState_t state;
+} historyEntry_t;
+
+static historyEntry_t history[HISTORY_LENGTH];
+static uint8_t historyHead; // next entry to write
+static uint8_t historyCount;
+
+static uint16_t extMeasurementLatency; // ms, latency of the last timestamped measurement
+static uint32_t extMeasurementTooOld;  // timestamped measurements older than the history
+
 /**
  * Supporting and utility functions
  */
@@ -228,12 +248,142 @@ static inline float arm_sqrt(float32_t in)
 
 
 
+static void historyAdd(const uint32_t tick) {
+  history[historyHead].tick = tick;
+  kalmanCoreGetPastState(&coreData, &history[historyHead].state);
+  historyHead = (historyHead + 1) % HISTORY_LENGTH;
+  if (historyCount < HISTORY_LENGTH) {
+    historyCount++;
+  }
+}
+
+/**
+ * Get the state at the time tick. Positions are interpolated between the
+ * entries of the history, the attitude is taken from the closest entry.
+ *
+ * @return false if tick is older than the history
+ */
+static bool historyGetState(const uint32_t tick, const uint32_t now, kalmanCorePastState_t* past) {
+  extMeasurementLatency = (uint16_t)(now - tick);
+
+  const historyEntry_t* newer = 0;
+  for (int i = 1; i <= historyCount; i++) {
+    const historyEntry_t* entry = &history[(historyHead + HISTORY_LENGTH - i) % HISTORY_LENGTH];
+    // Signed difference to handle tick wrap around
+    const int32_t age = (int32_t)(tick - entry->tick);
+    if (age >= 0) {
+      if (!newer) {
+        // More recent than the history, use the current state
+        kalmanCoreGetPastState(&coreData, past);
+        return true;
+      }
+
+      const float span = (float)(newer->tick - entry->tick);
+      const float alpha = age / span;
+      for (int j = 0; j < 3; j++) {
+        past->pos[j] = entry->state.pos[j] + alpha * (newer->state.pos[j] - entry->state.pos[j]);
+      }
+      const float* q = (alpha < 0.5f) ? entry->state.q : newer->state.q;
+      for (int j = 0; j < 4; j++) {
+        past->q[j] = q[j];
+      }
+      return true;
+    }
+    newer = entry;
+  }
+
+  if (historyCount == 0) {
+    kalmanCoreGetPastState(&coreData, past);
+    return true;
+  }
+
+  extMeasurementTooOld++;
+  return false;
+}
+
 // --------------------------------------------------
 
 
+static void resetFilter(void);
+static void updateFilter(void);
+static void updateBodyVelocity(Axis3f* bodyVelocity, const state_t* state);
+
 void estimatorKalman(state_t *state, sensorData_t *sensors, control_t *control, const uint32_t tick) {
+  // The IMU is read here, the controller needs the latest gyro data
+  imuSample_t sample;
+  sample.hasAcc = sensorsReadAcc(&sensors->acc);
+  sample.hasGyro = sensorsReadGyro(&sensors->gyro);
+  sample.hasBaro = sensorsReadBaro(&sensors->baro);
+  sample.acc = sensors->acc;
+  sample.gyro = sensors->gyro;
+  sample.baro = sensors->baro;
+  sample.thrust = control->thrust;
+  if (pdTRUE != xQueueSend(imuDataQueue, &sample, 0)) {
+    imuSamplesDropped++;
+  }
+
+#ifndef UNIT_TEST_MODE
+  xSemaphoreGive(runTaskSemaphore);
+#else
+  // No tasks when replaying on the host, run the filter in line
+  updateFilter();
+#endif
+
+  // Read the latest published state
+  uint32_t stateTick;
+  const uint32_t sequence = stateBufferRead(&publishedState, state, &stateTick);
+
+  if (sequence != resetSequence) {
+    const uint32_t osTick = xTaskGetTickCount();
+    stateAge = (uint16_t)(osTick - stateTick);
+    if (stateAge > stateAgeMax) {
+      stateAgeMax = stateAge;
+    }
+    if (stateAge > MAX_STATE_AGE) {
+      stateTooOld++;
+      stateBufferPredict(state, osTick, (float)stateAge / configTICK_RATE_HZ);
+    }
+  }
+
+  loggedState = *state;
+  updateBodyVelocity(&loggedBodyVelocity, state);
+}
+
+// The logged velocity is in the body frame, as in the filter
+static void updateBodyVelocity(Axis3f* bodyVelocity, const state_t* state) {
+  const quaternion_t* q = &state->attitudeQuaternion;
+  const velocity_t* v = &state->velocity;
+
+  // Rotation matrix as in kalmanCoreFinalize(), rotated by its transpose
+  const float r00 = q->w * q->w + q->x * q->x - q->y * q->y - q->z * q->z;
+  const float r01 = 2 * q->x * q->y - 2 * q->w * q->z;
+  const float r02 = 2 * q->x * q->z + 2 * q->w * q->y;
+  const float r10 = 2 * q->x * q->y + 2 * q->w * q->z;
+  const float r11 = q->w * q->w - q->x * q->x + q->y * q->y - q->z * q->z;
+  const float r12 = 2 * q->y * q->z - 2 * q->w * q->x;
+  const float r20 = 2 * q->x * q->z - 2 * q->w * q->y;
+  const float r21 = 2 * q->y * q->z + 2 * q->w * q->x;
+  const float r22 = q->w * q->w - q->x * q->x - q->y * q->y + q->z * q->z;
+
+  bodyVelocity->x = r00 * v->x + r10 * v->y + r20 * v->z;
+  bodyVelocity->y = r01 * v->x + r11 * v->y + r21 * v->z;
+  bodyVelocity->z = r02 * v->x + r12 * v->y + r22 * v->z;
+}
+
+#ifndef UNIT_TEST_MODE
+static void estimatorKalmanTask(void* parameters) {
+  while (true) {
+    xSemaphoreTake(runTaskSemaphore, portMAX_DELAY);
+    updateFilter();
+  }
+}
+#endif
+
+static void updateFilter(void) {
   // If the client (via a parameter update) triggers an estimator reset:
-  if (coreData.resetEstimation) { estimatorKalmanInit(); coreData.resetEstimation = false; }
+  if (coreData.resetEstimation) { resetFilter(); coreData.resetEstimation = false; }
+
+  sensorData_t *sensors = &taskSensors;
 
   // Tracks whether an update to the state has been made, and the state therefore requires finalization
   bool doneUpdate = false;
@@ -247,25 +397,47 @@ void estimatorKalman(state_t *state, sensorData_t *sensors, control_t *control,
   // Average the last IMU measurements. We do this because the prediction loop is
   // slower than the IMU loop, but the IMU information is required externally at
   // a higher rate (for body rate control).
-  if (sensorsReadAcc(&sensors->acc)) {
-    accAccumulator.x += sensors->acc.x;
-    accAccumulator.y += sensors->acc.y;
-    accAccumulator.z += sensors->acc.z;
-    accAccumulatorCount++;
-  }
+  imuSample_t sample;
+  uint8_t sampleCount = 0;
+  while (stateEstimatorHasImuSample(&sample)) {
+    if (sample.hasAcc) {
+      sensors->acc = sample.acc;
+      accAccumulator.x += sensors->acc.x;
+      accAccumulator.y += sensors->acc.y;
+      accAccumulator.z += sensors->acc.z;
+      accAccumulatorCount++;
+    }
+
+    if (sample.hasGyro) {
+      sensors->gyro = sample.gyro;
+      gyroAccumulator.x += sensors->gyro.x;
+      gyroAccumulator.y += sensors->gyro.y;
+      gyroAccumulator.z += sensors->gyro.z;
+      gyroAccumulatorCount++;
+    }
+
+    if (sample.hasBaro) {
+      sensors->baro = sample.baro;
+#ifdef KALMAN_USE_BARO_UPDATE
+      baroAccumulator.asl += sensors->baro.asl;
+      baroAccumulatorCount++;
+#endif
+    }
 
-  if (sensorsReadGyro(&sensors->gyro)) {
-    gyroAccumulator.x += sensors->gyro.x;
-    gyroAccumulator.y += sensors->gyro.y;
-    gyroAccumulator.z += sensors->gyro.z;
-    gyroAccumulatorCount++;
+    // Average the thrust command from the last time steps, generated externally by the controller
+    thrustAccumulator += sample.thrust;
+    thrustAccumulatorCount++;
+
+    sampleCount++;
   }
 
-  // Average the thrust command from the last time steps, generated externally by the controller
-  thrustAccumulator += control->thrust;
-  thrustAccumulatorCount++;
+  pipelineDepth = sampleCount;
+  if (pipelineDepth > pipelineDepthMax) {
+    pipelineDepthMax = pipelineDepth;
+  }
 
   // Run the system dynamics to predict the state forward.
+  bool donePrediction = false;
   if ((osTick - lastPrediction) >= configTICK_RATE_HZ/PREDICT_RATE // update at the PREDICT_RATE
       && gyroAccumulatorCount > 0
       && accAccumulatorCount > 0
@@ -316,6 +488,7 @@ void estimatorKalman(state_t *state, sensorData_t *sensors, control_t *control,
     thrustAccumulatorCount = 0;
 
     doneUpdate = true;
+    donePrediction = true;
   }
 
 
@@ -328,15 +501,9 @@ void estimatorKalman(state_t *state, sensorData_t *sensors, control_t *control,
 
 
   /**
-   * Update the state estimate with the barometer measurements
+   * Update the state estimate with the barometer measurements, accumulated above
    */
-  // Accumulate the barometer measurements
-  if (sensorsReadBaro(&sensors->baro)) {
 #ifdef KALMAN_USE_BARO_UPDATE
-    baroAccumulator.asl += sensors->baro.asl;
-    baroAccumulatorCount++;
-  }
-
   if ((osTick - lastBaroUpdate) >= configTICK_RATE_HZ/BARO_RATE // update at BARO_RATE
       && baroAccumulatorCount > 0) {
     baroAccumulator.asl /= baroAccumulatorCount;
@@ -347,55 +514,60 @@ void estimatorKalman(state_t *state, sensorData_t *sensors, control_t *control,
     baroAccumulatorCount = 0;
     lastBaroUpdate = osTick;
     doneUpdate = true;
-#endif
   }
+#endif
 
   /**
    * Sensor measurements can come in sporadically and faster than the stabilizer loop frequency,
    * we therefore consume all measurements since the last loop, rather than accumulating
    */
 
-  tofMeasurement_t tof;
-
-  while (stateEstimatorHasTOFPacket(&tof)) {
-    kalmanCoreUpdateWithTof(&coreData, &tof);
-    doneUpdate = true;
-  }
-
-  heightMeasurement_t height;
-  while (stateEstimatorHasHeightPacket(&height)) {
-    kalmanCoreUpdateWithAbsoluteHeight(&coreData, &height);
-    doneUpdate = true;
-  }
-
-  distanceMeasurement_t dist;
-  while (stateEstimatorHasDistanceMeasurement(&dist)) {
-    kalmanCoreUpdateWithDistance(&coreData, &dist);
-    doneUpdate = true;
-  }
-
-  positionMeasurement_t pos;
-  while (stateEstimatorHasPositionMeasurement(&pos)) {
-    kalmanCoreUpdateWithPosition(&coreData, &pos);
-    doneUpdate = true;
-  }
-
-  poseMeasurement_t pose;
-  while (stateEstimatorHasPoseMeasurement(&pose)) {
-    kalmanCoreUpdateWithPose(&coreData, &pose);
-    doneUpdate = true;
-  }
-
-  tdoaMeasurement_t tdoa;
-  while (stateEstimatorHasTDOAPacket(&tdoa)) {
-    kalmanCoreUpdateWithTDOA(&coreData, &tdoa);
-    doneUpdate = true;
-  }
-
-  flowMeasurement_t flow;
-  while (stateEstimatorHasFlowPacket(&flow)) {
-    kalmanCoreUpdateWithFlow(&coreData, &flow, sensors);
-    doneUpdate = true;
+  kalmanCorePastState_t pastState;
+
+  measurement_t m;
+  while (measurementQueueGet(&m)) {
+    switch (m.type) {
+      case MeasurementTypeTOF:
+        kalmanCoreUpdateWithTof(&coreData, &m.data.tof);
+        doneUpdate = true;
+        break;
+      case MeasurementTypeAbsoluteHeight:
+        kalmanCoreUpdateWithAbsoluteHeight(&coreData, &m.data.height);
+        doneUpdate = true;
+        break;
+      case MeasurementTypeDistance:
+        kalmanCoreUpdateWithDistance(&coreData, &m.data.distance);
+        doneUpdate = true;
+        break;
+      case MeasurementTypePosition:
+        if (m.data.position.timestamp == 0) {
+          kalmanCoreUpdateWithPosition(&coreData, &m.data.position);
+          doneUpdate = true;
+        } else if (historyGetState(m.data.position.timestamp, osTick, &pastState)) {
+          kalmanCoreUpdateWithPastPosition(&coreData, &m.data.position, &pastState);
+          doneUpdate = true;
+        }
+        break;
+      case MeasurementTypePose:
+        if (m.data.pose.timestamp == 0) {
+          kalmanCoreUpdateWithPose(&coreData, &m.data.pose);
+          doneUpdate = true;
+        } else if (historyGetState(m.data.pose.timestamp, osTick, &pastState)) {
+          kalmanCoreUpdateWithPastPose(&coreData, &m.data.pose, &pastState);
+          doneUpdate = true;
+        }
+        break;
+      case MeasurementTypeTDOA:
+        kalmanCoreUpdateWithTDOA(&coreData, &m.data.tdoa);
+        doneUpdate = true;
+        break;
+      case MeasurementTypeFlow:
+        kalmanCoreUpdateWithFlow(&coreData, &m.data.flow, sensors);
+        doneUpdate = true;
+        break;
+      default:
+        break;
+    }
   }
 
   /**
@@ -413,32 +585,50 @@ void estimatorKalman(state_t *state, sensorData_t *sensors, control_t *control,
     }
   }
 
+  if (donePrediction) {
+    historyAdd(osTick);
+  }
+
   /**
-   * Finally, the internal state is externalized.
+   * Finally, the internal state is externalized and published to the stabilizer.
    * This is done every round, since the external state includes some sensor data
    */
-  kalmanCoreExternalizeState(&coreData, state, sensors, osTick);
+  state_t state;
+  kalmanCoreExternalizeState(&coreData, &state, sensors, osTick);
+  stateBufferPublish(&publishedState, &state, osTick);
 }
 
 
 void estimatorKalmanInit(void) {
   if (!isInit) {
-    distDataQueue = xQueueCreate(DIST_QUEUE_LENGTH, sizeof(distanceMeasurement_t));
-    posDataQueue = xQueueCreate(POS_QUEUE_LENGTH, sizeof(positionMeasurement_t));
-    poseDataQueue = xQueueCreate(POSE_QUEUE_LENGTH, sizeof(poseMeasurement_t));
-    tdoaDataQueue = xQueueCreate(UWB_QUEUE_LENGTH, sizeof(tdoaMeasurement_t));
-    flowDataQueue = xQueueCreate(FLOW_QUEUE_LENGTH, sizeof(flowMeasurement_t));
-    tofDataQueue = xQueueCreate(TOF_QUEUE_LENGTH, sizeof(tofMeasurement_t));
-    heightDataQueue = xQueueCreate(HEIGHT_QUEUE_LENGTH, sizeof(heightMeasurement_t));
+    measurementQueueInit();
+    imuDataQueue = xQueueCreate(IMU_QUEUE_LENGTH, sizeof(imuSample_t));
+    stateBufferInit(&publishedState);
+
+    // The task is not running yet, the filter can be reset from here
+    resetFilter();
+
+#ifndef UNIT_TEST_MODE
+    vSemaphoreCreateBinary(runTaskSemaphore);
+    xSemaphoreTake(runTaskSemaphore, 0);
+    xTaskCreate(estimatorKalmanTask, KALMAN_TASK_NAME, KALMAN_TASK_STACKSIZE, NULL, KALMAN_TASK_PRI, NULL);
+#endif
+
+    isInit = true;
   } else {
-    xQueueReset(distDataQueue);
-    xQueueReset(posDataQueue);
-    xQueueReset(poseDataQueue);
-    xQueueReset(tdoaDataQueue);
-    xQueueReset(flowDataQueue);
-    xQueueReset(tofDataQueue);
+    measurementQueueReset();
+    xQueueReset(imuDataQueue);
+
+    // The filter state is owned by the task, let it do the reset
+    coreData.resetEstimation = true;
   }
 
+  pipelineDepthMax = 0;
+  stateAgeMax = 0;
+  stateTooOld = 0;
+}
+
+static void resetFilter(void) {
   lastPrediction = xTaskGetTickCount();
   lastBaroUpdate = xTaskGetTickCount();
   lastTDOAUpdate = xTaskGetTickCount();
@@ -454,63 +644,65 @@ void estimatorKalmanInit(void) {
   thrustAccumulatorCount = 0;
   baroAccumulatorCount = 0;
 
+  historyHead = 0;
+  historyCount = 0;
+
   kalmanCoreInit(&coreData);
 
-  isInit = true;
+  // Publish the initial state, read until the first update of the filter
+  state_t state;
+  kalmanCoreExternalizeState(&coreData, &state, &taskSensors, lastPrediction);
+  stateBufferPublish(&publishedState, &state, lastPrediction);
+  resetSequence = publishedState.sequence;
 }
 
-static bool stateEstimatorEnqueueExternalMeasurement(xQueueHandle queue, void *measurement) {
-  portBASE_TYPE result;
-  bool isInInterrupt = (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
-
-  if (isInInterrupt) {
-    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-    result = xQueueSendFromISR(queue, measurement, &xHigherPriorityTaskWoken);
-    if(xHigherPriorityTaskWoken == pdTRUE) {
-      portYIELD();
-    }
-  } else {
-    result = xQueueSend(queue, measurement, 0);
-  }
-  return (result == pdTRUE);
+static bool stateEstimatorEnqueueExternalMeasurement(measurement_t *measurement) {
+  return measurementQueuePut(measurement);
 }
 
 bool estimatorKalmanEnqueueTDOA(const tdoaMeasurement_t *uwb) {
   ASSERT(isInit);
-  return stateEstimatorEnqueueExternalMeasurement(tdoaDataQueue, (void *)uwb);
+  measurement_t m = {.type = MeasurementTypeTDOA, .data.tdoa = *uwb};
+  return stateEstimatorEnqueueExternalMeasurement(&m);
 }
 
 bool estimatorKalmanEnqueuePosition(const positionMeasurement_t *pos) {
   ASSERT(isInit);
-  return stateEstimatorEnqueueExternalMeasurement(posDataQueue, (void *)pos);
+  measurement_t m = {.type = MeasurementTypePosition, .data.position = *pos};
+  return stateEstimatorEnqueueExternalMeasurement(&m);
 }
 
 bool estimatorKalmanEnqueuePose(const poseMeasurement_t *pose) {
   ASSERT(isInit);
-  return stateEstimatorEnqueueExternalMeasurement(poseDataQueue, (void *)pose);
+  measurement_t m = {.type = MeasurementTypePose, .data.pose = *pose};
+  return stateEstimatorEnqueueExternalMeasurement(&m);
 }
 
 bool estimatorKalmanEnqueueDistance(const distanceMeasurement_t *dist) {
   ASSERT(isInit);
-  return stateEstimatorEnqueueExternalMeasurement(distDataQueue, (void *)dist);
+  measurement_t m = {.type = MeasurementTypeDistance, .data.distance = *dist};
+  return stateEstimatorEnqueueExternalMeasurement(&m);
 }
 
 bool estimatorKalmanEnqueueFlow(const flowMeasurement_t *flow) {
   // A flow measurement (dnx,  dny) [accumulated pixels]
   ASSERT(isInit);
-  return stateEstimatorEnqueueExternalMeasurement(flowDataQueue, (void *)flow);
+  measurement_t m = {.type = MeasurementTypeFlow, .data.flow = *flow};
+  return stateEstimatorEnqueueExternalMeasurement(&m);
 }
 
 bool estimatorKalmanEnqueueTOF(const tofMeasurement_t *tof) {
   // A distance (distance) [m] to the ground along the z_B axis.
   ASSERT(isInit);
-  return stateEstimatorEnqueueExternalMeasurement(tofDataQueue, (void *)tof);
+  measurement_t m = {.type = MeasurementTypeTOF, .data.tof = *tof};
+  return stateEstimatorEnqueueExternalMeasurement(&m);
 }
 
 bool estimatorKalmanEnqueueAbsoluteHeight(const heightMeasurement_t *height) {
   // A distance (height) [m] to the ground along the z axis.
   ASSERT(isInit);
-  return stateEstimatorEnqueueExternalMeasurement(heightDataQueue, (void *)height);
+  measurement_t m = {.type = MeasurementTypeAbsoluteHeight, .data.height = *height};
+  return stateEstimatorEnqueueExternalMeasurement(&m);
 }
 
 bool estimatorKalmanTest(void) {
@@ -518,29 +710,34 @@ bool estimatorKalmanTest(void) {
 }
 
 void estimatorKalmanGetEstimatedPos(point_t* pos) {
-  pos->x = coreData.S[KC_STATE_X];
-  pos->y = coreData.S[KC_STATE_Y];
-  pos->z = coreData.S[KC_STATE_Z];
+  // May be called from any task, the filter state is owned by the Kalman task
+  state_t state;
+  uint32_t stateTick;
+  stateBufferRead(&publishedState, &state, &stateTick);
+
+  pos->x = state.position.x;
+  pos->y = state.position.y;
+  pos->z = state.position.z;
 }
 
 // Temporary development groups
 LOG_GROUP_START(kalman_states)
-  LOG_ADD(LOG_FLOAT, ox, &coreData.S[KC_STATE_X])
-  LOG_ADD(LOG_FLOAT, oy, &coreData.S[KC_STATE_Y])
-  LOG_ADD(LOG_FLOAT, vx, &coreData.S[KC_STATE_PX])
-  LOG_ADD(LOG_FLOAT, vy, &coreData.S[KC_STATE_PY])
+  LOG_ADD(LOG_FLOAT, ox, &loggedState.position.x)
+  LOG_ADD(LOG_FLOAT, oy, &loggedState.position.y)
+  LOG_ADD(LOG_FLOAT, vx, &loggedBodyVelocity.x)
+  LOG_ADD(LOG_FLOAT, vy, &loggedBodyVelocity.y)
 LOG_GROUP_STOP(kalman_states)
 
 
 // Stock log groups
 LOG_GROUP_START(kalman)
   LOG_ADD(LOG_UINT8, inFlight, &quadIsFlying)
-  LOG_ADD(LOG_FLOAT, stateX, &coreData.S[KC_STATE_X])
-  LOG_ADD(LOG_FLOAT, stateY, &coreData.S[KC_STATE_Y])
-  LOG_ADD(LOG_FLOAT, stateZ, &coreData.S[KC_STATE_Z])
-  LOG_ADD(LOG_FLOAT, statePX, &coreData.S[KC_STATE_PX])
-  LOG_ADD(LOG_FLOAT, statePY, &coreData.S[KC_STATE_PY])
-  LOG_ADD(LOG_FLOAT, statePZ, &coreData.S[KC_STATE_PZ])
+  LOG_ADD(LOG_FLOAT, stateX, &loggedState.position.x)
+  LOG_ADD(LOG_FLOAT, stateY, &loggedState.position.y)
+  LOG_ADD(LOG_FLOAT, stateZ, &loggedState.position.z)
+  LOG_ADD(LOG_FLOAT, statePX, &loggedBodyVelocity.x)
+  LOG_ADD(LOG_FLOAT, statePY, &loggedBodyVelocity.y)
+  LOG_ADD(LOG_FLOAT, statePZ, &loggedBodyVelocity.z)
   LOG_ADD(LOG_FLOAT, stateD0, &coreData.S[KC_STATE_D0])
   LOG_ADD(LOG_FLOAT, stateD1, &coreData.S[KC_STATE_D1])
   LOG_ADD(LOG_FLOAT, stateD2, &coreData.S[KC_STATE_D2])
@@ -553,10 +750,18 @@ LOG_GROUP_START(kalman)
   LOG_ADD(LOG_FLOAT, varD0, &coreData.P[KC_STATE_D0][KC_STATE_D0])
   LOG_ADD(LOG_FLOAT, varD1, &coreData.P[KC_STATE_D1][KC_STATE_D1])
   LOG_ADD(LOG_FLOAT, varD2, &coreData.P[KC_STATE_D2][KC_STATE_D2])
-  LOG_ADD(LOG_FLOAT, q0, &coreData.q[0])
-  LOG_ADD(LOG_FLOAT, q1, &coreData.q[1])
-  LOG_ADD(LOG_FLOAT, q2, &coreData.q[2])
-  LOG_ADD(LOG_FLOAT, q3, &coreData.q[3])
+  LOG_ADD(LOG_FLOAT, q0, &loggedState.attitudeQuaternion.w)
+  LOG_ADD(LOG_FLOAT, q1, &loggedState.attitudeQuaternion.x)
+  LOG_ADD(LOG_FLOAT, q2, &loggedState.attitudeQuaternion.y)
+  LOG_ADD(LOG_FLOAT, q3, &loggedState.attitudeQuaternion.z)
+  LOG_ADD(LOG_UINT16, extLatency, &extMeasurementLatency)
+  LOG_ADD(LOG_UINT32, extTooOld, &extMeasurementTooOld)
+  LOG_ADD(LOG_UINT8, pipeDepth, &pipelineDepth)
+  LOG_ADD(LOG_UINT8, pipeDepthMax, &pipelineDepthMax)
+  LOG_ADD(LOG_UINT16, stateAge, &stateAge)
+  LOG_ADD(LOG_UINT16, stateAgeMax, &stateAgeMax)
+  LOG_ADD(LOG_UINT32, stateTooOld, &stateTooOld)
+  LOG_ADD(LOG_UINT32, imuDropped, &imuSamplesDropped)
 LOG_GROUP_STOP(kalman)
 
 PARAM_GROUP_START(kalman)
@@ -309,30 +309,23 @@ void kalmanCoreUpdateWithAbsoluteHeight(kalmanCoreData_t* this, heightMeasuremen
   scalarUpdate(this, &H, height->height - this->S[KC_STATE_Z], height->stdDev);
 }
 
-void kalmanCoreUpdateWithPosition(kalmanCoreData_t* this, positionMeasurement_t *xyz) {
-  // a direct measurement of states x, y, and z
+// Direct measurement of states x, y, and z. The innovation is computed against
+// the current state minus offset, where offset is zero for current measurements.
+static void updateWithPosition(kalmanCoreData_t* this, const float pos[3], const float offset[3], float stdDev) {
   // do a scalar update for each state, since this should be faster than updating all together
   for (int i = 0; i < 3; i++) {
     float h[KC_STATE_DIM] = { 0 };
     arm_matrix_instance_f32 H = {1, KC_STATE_DIM, h};
     h[KC_STATE_X + i] = 1;
-    scalarUpdate(this, &H, xyz->pos[i] - this->S[KC_STATE_X+i], xyz->stdDev);
+    scalarUpdate(this, &H, pos[i] - (this->S[KC_STATE_X+i] - offset[i]), stdDev);
   }
 }
 
-void kalmanCoreUpdateWithPose(kalmanCoreData_t* this, poseMeasurement_t *pose) {
-  // a direct measurement of states x, y, and z, and orientation
-  // do a scalar update for each state, since this should be faster than updating all together
-  for (int i = 0; i < 3; i++) {
-    float h[KC_STATE_DIM] = {0};
-    arm_matrix_instance_f32 H = {1, KC_STATE_DIM, h};
-    h[KC_STATE_X + i] = 1;
-    scalarUpdate(this, &H, pose->pos[i] - this->S[KC_STATE_X+i], pose->stdDevPos);
-  }
-
+// Direct measurement of the orientation, relative to the reference attitude qRef (w,x,y,z)
+static void updateWithAttitude(kalmanCoreData_t* this, const float qRef[4], const quaternion_t* measured, float stdDev) {
   // compute orientation error
-  struct quat const q_ekf = mkquat(this->q[1], this->q[2], this->q[3], this->q[0]);
-  struct quat const q_measured = mkquat(pose->quat.x, pose->quat.y, pose->quat.z, pose->quat.w);
+  struct quat const q_ekf = mkquat(qRef[1], qRef[2], qRef[3], qRef[0]);
+  struct quat const q_measured = mkquat(measured->x, measured->y, measured->z, measured->w);
   struct quat const q_residual = qqmul(qinv(q_ekf), q_measured);
   // small angle approximation, see eq. 141 in http://mars.cs.umn.edu/tr/reports/Trawny05b.pdf
   struct vec const err_quat = vscl(2.0f / q_residual.w, quatimagpart(q_residual));
@@ -342,15 +335,54 @@ void kalmanCoreUpdateWithPose(kalmanCoreData_t* this, poseMeasurement_t *pose) {
     float h[KC_STATE_DIM] = {0};
     arm_matrix_instance_f32 H = {1, KC_STATE_DIM, h};
     h[KC_STATE_D0] = 1;
-    scalarUpdate(this, &H, err_quat.x, pose->stdDevQuat);
+    scalarUpdate(this, &H, err_quat.x, stdDev);
     h[KC_STATE_D0] = 0;
 
     h[KC_STATE_D1] = 1;
-    scalarUpdate(this, &H, err_quat.y, pose->stdDevQuat);
+    scalarUpdate(this, &H, err_quat.y, stdDev);
     h[KC_STATE_D1] = 0;
 
     h[KC_STATE_D2] = 1;
-    scalarUpdate(this, &H, err_quat.z, pose->stdDevQuat);
+    scalarUpdate(this, &H, err_quat.z, stdDev);
+  }
+}
+
+static void pastStateOffset(const kalmanCoreData_t* this, const kalmanCorePastState_t* past, float offset[3]) {
+  for (int i = 0; i < 3; i++) {
+    offset[i] = this->S[KC_STATE_X+i] - past->pos[i];
+  }
+}
+
+static const float noOffset[3] = {0};
+
+void kalmanCoreUpdateWithPosition(kalmanCoreData_t* this, positionMeasurement_t *xyz) {
+  updateWithPosition(this, xyz->pos, noOffset, xyz->stdDev);
+}
+
+void kalmanCoreUpdateWithPose(kalmanCoreData_t* this, poseMeasurement_t *pose) {
+  updateWithPosition(this, pose->pos, noOffset, pose->stdDevPos);
+  updateWithAttitude(this, this->q, &pose->quat, pose->stdDevQuat);
+}
+
+void kalmanCoreUpdateWithPastPosition(kalmanCoreData_t* this, positionMeasurement_t *xyz, const kalmanCorePastState_t* past) {
+  float offset[3];
+  pastStateOffset(this, past, offset);
+  updateWithPosition(this, xyz->pos, offset, xyz->stdDev);
+}
+
+void kalmanCoreUpdateWithPastPose(kalmanCoreData_t* this, poseMeasurement_t *pose, const kalmanCorePastState_t* past) {
+  float offset[3];
+  pastStateOffset(this, past, offset);
+  updateWithPosition(this, pose->pos, offset, pose->stdDevPos);
+  updateWithAttitude(this, past->q, &pose->quat, pose->stdDevQuat);
+}
+
+void kalmanCoreGetPastState(const kalmanCoreData_t* this, kalmanCorePastState_t* past) {
+  for (int i = 0; i < 3; i++) {
+    past->pos[i] = this->S[KC_STATE_X+i];
+  }
+  for (int i = 0; i < 4; i++) {
+    past->q[i] = this->q[i];
   }
 }
 
@@ -0,0 +1,125 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * led_timeline.c - Keyframe colour timeline for light shows
+ */
+
+#include <string.h>
+
+#include "led_timeline.h"
+
+uint8_t ledTimelineMemory[LED_TIMELINE_MEMORY_SIZE];
+static uint32_t memoryWriteCount;
+
+static const uint8_t black[3] = {0, 0, 0};
+
+static uint16_t segmentCount(const uint8_t* memory, const uint32_t memorySize) {
+  if (memorySize < sizeof(uint16_t)) {
+    return 0;
+  }
+
+  uint16_t count;
+  memcpy(&count, memory, sizeof(count));
+
+  const uint32_t maxCount = (memorySize - sizeof(uint16_t)) / sizeof(ledTimelineSegment_t);
+  if (count > maxCount) {
+    count = maxCount;
+  }
+
+  return count;
+}
+
+static const ledTimelineSegment_t* segment(const uint8_t* memory, const uint16_t index) {
+  return (const ledTimelineSegment_t*)(memory + sizeof(uint16_t) + index * sizeof(ledTimelineSegment_t));
+}
+
+bool ledTimelineMemoryWrite(const uint32_t memAddr, const uint8_t writeLen, const uint8_t* data) {
+  if (memAddr + writeLen > sizeof(ledTimelineMemory)) {
+    return false;
+  }
+
+  memcpy(&ledTimelineMemory[memAddr], data, writeLen);
+  memoryWriteCount++;
+  return true;
+}
+
+uint32_t ledTimelineMemoryWriteCount(void) {
+  return memoryWriteCount;
+}
+
+void ledTimelineCursorReset(ledTimelineCursor_t* cursor) {
+  cursor->segmentIndex = 0;
+  cursor->segmentStart = 0;
+}
+
+bool ledTimelineEvaluate(const uint8_t* memory, const uint32_t memorySize, ledTimelineCursor_t* cursor, const uint32_t timeMs, uint8_t color[3]) {
+  const uint16_t count = segmentCount(memory, memorySize);
+  if (count == 0) {
+    return false;
+  }
+
+  if (timeMs < cursor->segmentStart || cursor->segmentIndex >= count) {
+    // Time went backwards or the timeline was replaced
+    ledTimelineCursorReset(cursor);
+  }
+
+  // Time is mostly increasing in small steps, move forward from the current segment
+  while (cursor->segmentIndex < count) {
+    const uint16_t duration = segment(memory, cursor->segmentIndex)->duration;
+    if (timeMs < cursor->segmentStart + duration) {
+      break;
+    }
+    cursor->segmentStart += duration;
+    cursor->segmentIndex++;
+  }
+
+  if (cursor->segmentIndex >= count) {
+    // Past the end, hold the last color. Step back so that the next
+    // evaluation does not have to search from the start.
+    const ledTimelineSegment_t* last = segment(memory, count - 1);
+    memcpy(color, last->color, 3);
+    cursor->segmentIndex = count - 1;
+    cursor->segmentStart -= last->duration;
+    return true;
+  }
+
+  const ledTimelineSegment_t* current = segment(memory, cursor->segmentIndex);
+  if (current->type != LED_TIMELINE_FADE) {
+    memcpy(color, current->color, 3);
+    return true;
+  }
+
+  const uint8_t* from = black;
+  if (cursor->segmentIndex > 0) {
+    from = segment(memory, cursor->segmentIndex - 1)->color;
+  }
+
+  // duration is > 0 here, a zero length segment is always passed above
+  const uint32_t elapsed = timeMs - cursor->segmentStart;
+  for (int i = 0; i < 3; i++) {
+    const int32_t delta = (int32_t)current->color[i] - (int32_t)from[i];
+    color[i] = (uint8_t)(from[i] + delta * (int32_t)elapsed / (int32_t)current->duration);
+  }
+
+  return true;
+}
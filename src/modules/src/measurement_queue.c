@@ -0,0 +1,230 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * measurement_queue.c - Queue of timestamped measurements for the Kalman estimator
+ */
+
+#include <string.h>
+
+#include "stm32f4xx.h"
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#include "usec_time.h"
+#include "log.h"
+
+#include "measurement_queue.h"
+
+/**
+ * Places reserved per type. The quotas are sized for the highest rate of
+ * each type during the longest time the Kalman task may be late (about
+ * 10 ms, see MAX_STATE_AGE in estimator_kalman.c), with a factor 2 margin:
+ * - TDoA: up to 400 packets/s from LPS, 4 per 10 ms
+ * - Distance: TWR ranging at up to 200 Hz, 2 per 10 ms
+ * - Position and pose: motion capture at 100 Hz, sent in bursts over the radio
+ * - Flow, ToF and height: 100 Hz or less, 1 per 10 ms
+ *
+ * All can be overridden with CFLAGS in tools/make/config.mk, the
+ * MEASUREMENT_QUEUE_LENGTH must be at least the sum of the quotas.
+ */
+#ifndef MEASUREMENT_QUEUE_QUOTA_TDOA
+#define MEASUREMENT_QUEUE_QUOTA_TDOA 8
+#endif
+#ifndef MEASUREMENT_QUEUE_QUOTA_POSITION
+#define MEASUREMENT_QUEUE_QUOTA_POSITION 4
+#endif
+#ifndef MEASUREMENT_QUEUE_QUOTA_POSE
+#define MEASUREMENT_QUEUE_QUOTA_POSE 4
+#endif
+#ifndef MEASUREMENT_QUEUE_QUOTA_DISTANCE
+#define MEASUREMENT_QUEUE_QUOTA_DISTANCE 4
+#endif
+#ifndef MEASUREMENT_QUEUE_QUOTA_TOF
+#define MEASUREMENT_QUEUE_QUOTA_TOF 2
+#endif
+#ifndef MEASUREMENT_QUEUE_QUOTA_HEIGHT
+#define MEASUREMENT_QUEUE_QUOTA_HEIGHT 2
+#endif
+#ifndef MEASUREMENT_QUEUE_QUOTA_FLOW
+#define MEASUREMENT_QUEUE_QUOTA_FLOW 2
+#endif
+
+// Places in the queue
+#ifndef MEASUREMENT_QUEUE_LENGTH
+#define MEASUREMENT_QUEUE_LENGTH 26
+#endif
+
+_Static_assert(MEASUREMENT_QUEUE_QUOTA_TDOA + MEASUREMENT_QUEUE_QUOTA_POSITION + MEASUREMENT_QUEUE_QUOTA_POSE +
+               MEASUREMENT_QUEUE_QUOTA_DISTANCE + MEASUREMENT_QUEUE_QUOTA_TOF + MEASUREMENT_QUEUE_QUOTA_HEIGHT +
+               MEASUREMENT_QUEUE_QUOTA_FLOW <= MEASUREMENT_QUEUE_LENGTH,
+               "The measurement queue is too short for the sum of the quotas");
+
+// A type without a quota would have all its measurements dropped
+_Static_assert(MeasurementType_COUNT == 7, "Add a quota for the new measurement type");
+
+static const uint8_t quotas[MeasurementType_COUNT] = {
+  [MeasurementTypeTDOA] = MEASUREMENT_QUEUE_QUOTA_TDOA,
+  [MeasurementTypePosition] = MEASUREMENT_QUEUE_QUOTA_POSITION,
+  [MeasurementTypePose] = MEASUREMENT_QUEUE_QUOTA_POSE,
+  [MeasurementTypeDistance] = MEASUREMENT_QUEUE_QUOTA_DISTANCE,
+  [MeasurementTypeTOF] = MEASUREMENT_QUEUE_QUOTA_TOF,
+  [MeasurementTypeAbsoluteHeight] = MEASUREMENT_QUEUE_QUOTA_HEIGHT,
+  [MeasurementTypeFlow] = MEASUREMENT_QUEUE_QUOTA_FLOW,
+};
+
+static xQueueHandle queue;
+
+// Updated from tasks and interrupts, only with interrupts masked
+static uint8_t queued[MeasurementType_COUNT];
+static uint32_t dropped[MeasurementType_COUNT];
+
+static uint32_t latencyMax; // us, from enqueue to get
+
+static inline uint32_t lockCounters(void) {
+#ifndef UNIT_TEST_MODE
+  return portSET_INTERRUPT_MASK_FROM_ISR();
+#else
+  // No interrupts when running on the host
+  return 0;
+#endif
+}
+
+static inline void unlockCounters(const uint32_t savedInterruptStatus) {
+#ifndef UNIT_TEST_MODE
+  portCLEAR_INTERRUPT_MASK_FROM_ISR(savedInterruptStatus);
+#else
+  (void)savedInterruptStatus;
+#endif
+}
+
+void measurementQueueInit(void) {
+  queue = xQueueCreate(MEASUREMENT_QUEUE_LENGTH, sizeof(measurement_t));
+  memset(queued, 0, sizeof(queued));
+  memset(dropped, 0, sizeof(dropped));
+  latencyMax = 0;
+}
+
+void measurementQueueReset(void) {
+  // A measurement enqueued between the two steps is not counted in its
+  // quota, which is harmless. The other way around a place would be lost.
+  xQueueReset(queue);
+
+  const uint32_t savedInterruptStatus = lockCounters();
+  memset(queued, 0, sizeof(queued));
+  unlockCounters(savedInterruptStatus);
+}
+
+bool measurementQueuePut(measurement_t* measurement) {
+  const MeasurementType type = measurement->type;
+  if (type >= MeasurementType_COUNT) {
+    return false;
+  }
+
+#ifndef UNIT_TEST_MODE
+  const bool isInInterrupt = (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
+#else
+  const bool isInInterrupt = false;
+#endif
+
+  measurement->timestamp = usecTimestamp();
+
+  // Take a place from the quota of the type
+  uint32_t savedInterruptStatus = lockCounters();
+  const bool isReserved = queued[type] < quotas[type];
+  if (isReserved) {
+    queued[type]++;
+  } else {
+    dropped[type]++;
+  }
+  unlockCounters(savedInterruptStatus);
+
+  if (!isReserved) {
+    return false;
+  }
+
+  portBASE_TYPE result = pdFALSE;
+  if (isInInterrupt) {
+#ifndef UNIT_TEST_MODE
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    result = xQueueSendFromISR(queue, measurement, &xHigherPriorityTaskWoken);
+    if (xHigherPriorityTaskWoken == pdTRUE) {
+      portYIELD();
+    }
+#endif
+  } else {
+    result = xQueueSend(queue, measurement, 0);
+  }
+
+  // The quotas add up to the queue length, the queue can only be full if a
+  // reset made the counters too low
+  if (result != pdTRUE) {
+    savedInterruptStatus = lockCounters();
+    if (queued[type] > 0) {
+      queued[type]--;
+    }
+    dropped[type]++;
+    unlockCounters(savedInterruptStatus);
+  }
+
+  return (result == pdTRUE);
+}
+
+bool measurementQueueGet(measurement_t* measurement) {
+  if (pdTRUE != xQueueReceive(queue, measurement, 0)) {
+    return false;
+  }
+
+  const uint32_t savedInterruptStatus = lockCounters();
+  if (queued[measurement->type] > 0) {
+    queued[measurement->type]--;
+  }
+  unlockCounters(savedInterruptStatus);
+
+  const uint64_t now = usecTimestamp();
+  const uint32_t latency = (uint32_t)(now - measurement->timestamp);
+  if (measurement->timestamp <= now && latency > latencyMax) {
+    latencyMax = latency;
+  }
+
+  return true;
+}
+
+uint32_t measurementQueueGetDropCount(const MeasurementType type) {
+  return dropped[type];
+}
+
+uint8_t measurementQueueGetQuota(const MeasurementType type) {
+  return quotas[type];
+}
+
+LOG_GROUP_START(kalmanMeas)
+  LOG_ADD(LOG_UINT32, latencyMax, &latencyMax)
+  LOG_ADD(LOG_UINT32, dropTdoa, &dropped[MeasurementTypeTDOA])
+  LOG_ADD(LOG_UINT32, dropPos, &dropped[MeasurementTypePosition])
+  LOG_ADD(LOG_UINT32, dropPose, &dropped[MeasurementTypePose])
+  LOG_ADD(LOG_UINT32, dropDist, &dropped[MeasurementTypeDistance])
+  LOG_ADD(LOG_UINT32, dropTof, &dropped[MeasurementTypeTOF])
+  LOG_ADD(LOG_UINT32, dropHeight, &dropped[MeasurementTypeAbsoluteHeight])
+  LOG_ADD(LOG_UINT32, dropFlow, &dropped[MeasurementTypeFlow])
+LOG_GROUP_STOP(kalmanMeas)
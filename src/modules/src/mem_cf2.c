@@ -42,10 +42,12 @@
 #include "eeprom.h"
 
 #include "ledring12.h"
+#include "led_timeline.h"
 #include "locodeck.h"
 #include "crtp_commander_high_level.h"
 #include "lighthouse.h"
 #include "usddeck.h"
+#include "range_map.h"
 
 #include "console.h"
 #include "assert.h"
@@ -78,6 +80,15 @@
 #define USD_ID          0x07
 #define OW_FIRST_ID     0x08
 
+// Memories added after the one wire ids, so that the ids above are not
+// changed. The id on the wire is OW_FIRST_ID + nbrOwMems + (id - AFTER_OW_FIRST_ID),
+// the ids below are only used internally, see memIdFromWire().
+#define AFTER_OW_FIRST_ID 0xE0
+#define LEDTL_ID        0xE0
+#define RANGE_MAP_ID    0xE1
+#define AFTER_OW_COUNT  2
+#define INVALID_ID      0xFF
+
 #define STATUS_OK 0
 
 #define MEM_TYPE_EEPROM 0x00
@@ -89,6 +100,8 @@
 #define MEM_TYPE_LH     0x14
 #define MEM_TYPE_TESTER 0x15
 #define MEM_TYPE_USD    0x16
+#define MEM_TYPE_LEDTL  0x17
+#define MEM_TYPE_RANGE_MAP 0x18
 
 #define MEM_LOCO_INFO             0x0000
 #define MEM_LOCO_ANCHOR_BASE      0x1000
@@ -112,6 +125,7 @@ static void memWriteProcess(void);
 static void memReadProcess(void);
 static uint8_t handleLocoMemRead(uint32_t memAddr, uint8_t readLen, uint8_t* dest);
 static uint8_t handleLoco2MemRead(uint32_t memAddr, uint8_t readLen, uint8_t* dest);
+static uint8_t memIdFromWire(const uint8_t memId);
 static void createNbrResponse(CRTPPacket* p);
 static void createInfoResponse(CRTPPacket* p, uint8_t memId);
 static void createInfoResponseBody(CRTPPacket* p, uint8_t type, uint32_t memSize, const uint8_t data[8]);
@@ -201,7 +215,21 @@ void createNbrResponse(CRTPPacket* p)
   p->header = CRTP_HEADER(CRTP_PORT_MEM, MEM_SETTINGS_CH);
   p->size = 2;
   p->data[0] = MEM_CMD_GET_NBR;
-  p->data[1] = nbrOwMems + OW_FIRST_ID;
+  p->data[1] = nbrOwMems + OW_FIRST_ID + AFTER_OW_COUNT;
+}
+
+// Translate an id from a packet to the internal id of a memory after the one
+// wire ids, other ids are unchanged
+uint8_t memIdFromWire(const uint8_t memId)
+{
+  const uint8_t afterOwFirstWireId = OW_FIRST_ID + nbrOwMems;
+  if (memId >= afterOwFirstWireId)
+  {
+    const uint8_t index = memId - afterOwFirstWireId;
+    return (index < AFTER_OW_COUNT) ? AFTER_OW_FIRST_ID + index : INVALID_ID;
+  }
+
+  return memId;
 }
 
 void createInfoResponse(CRTPPacket* p, uint8_t memId)
@@ -212,7 +240,7 @@ void createInfoResponse(CRTPPacket* p, uint8_t memId)
   p->data[1] = memId;
 
   // No error code if we fail, just send an empty packet back
-  switch(memId)
+  switch(memIdFromWire(memId))
   {
     case EEPROM_ID:
       createInfoResponseBody(p, MEM_TYPE_EEPROM, EEPROM_SIZE, eepromSerialNum.data);
@@ -238,6 +266,12 @@ void createInfoResponse(CRTPPacket* p, uint8_t memId)
     case USD_ID:
       createInfoResponseBody(p, MEM_TYPE_USD, usddeckFileSize(), noData);
       break;
+    case LEDTL_ID:
+      createInfoResponseBody(p, MEM_TYPE_LEDTL, sizeof(ledTimelineMemory), noData);
+      break;
+    case RANGE_MAP_ID:
+      createInfoResponseBody(p, MEM_TYPE_RANGE_MAP, RANGE_MAP_MEM_SIZE, noData);
+      break;
     default:
       if (owGetinfo(memId - OW_FIRST_ID, &serialNbr))
       {
@@ -273,7 +307,7 @@ void memReadProcess()
   p.header = CRTP_HEADER(CRTP_PORT_MEM, MEM_READ_CH);
   // Dont' touch the first 5 bytes, they will be the same.
 
-  switch(memId)
+  switch(memIdFromWire(memId))
   {
     case EEPROM_ID:
       {
@@ -341,6 +375,27 @@ void memReadProcess()
       }
       break;
 
+    case LEDTL_ID:
+      {
+        if (memAddr + readLen <= sizeof(ledTimelineMemory)) {
+          memcpy(&p.data[6], &(ledTimelineMemory[memAddr]), readLen);
+          status = STATUS_OK;
+        } else {
+          status = EIO;
+        }
+      }
+      break;
+
+    case RANGE_MAP_ID:
+      {
+        if (rangeMapMemRead(memAddr, readLen, &p.data[6])) {
+          status = STATUS_OK;
+        } else {
+          status = EIO;
+        }
+      }
+      break;
+
     default:
       {
         memId = memId - OW_FIRST_ID;
@@ -507,7 +562,7 @@ void memWriteProcess()
   p.header = CRTP_HEADER(CRTP_PORT_MEM, MEM_WRITE_CH);
   // Dont' touch the first 5 bytes, they will be the same.
 
-  switch(memId)
+  switch(memIdFromWire(memId))
   {
     case EEPROM_ID:
       {
@@ -560,11 +615,23 @@ void memWriteProcess()
       status = handleMemTesterWrite(memAddr, writeLen, &p.data[5]);
       break;
 
+    case LEDTL_ID:
+      {
+        if (ledTimelineMemoryWrite(memAddr, writeLen, &p.data[5])) {
+          status = STATUS_OK;
+        } else {
+          status = EIO;
+        }
+      }
+      break;
+
     case USD_ID:
         // Fall through
     case LOCO_ID:
         // Fall through
     case LOCO2_ID:
+        // Fall through
+    case RANGE_MAP_ID:
       // Not supported
       status = EIO;
       break;
@@ -0,0 +1,159 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * pid_batch.c - PID regulator for several axes at once
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "pid_batch.h"
+#include "pid.h"
+#include "num.h"
+#include "cf_math.h"
+
+void pidBatchInit(pidBatch_t* batch, const uint8_t count, const float dt) {
+  memset(batch, 0, sizeof(pidBatch_t));
+  batch->count = count < PID_BATCH_MAX_AXES ? count : PID_BATCH_MAX_AXES;
+  batch->dt = dt;
+
+  for (int i = 0; i < PID_BATCH_MAX_AXES; i++) {
+    batch->iLimit[i] = DEFAULT_PID_INTEGRATION_LIMIT;
+    batch->outputLimit[i] = DEFAULT_PID_OUTPUT_LIMIT;
+  }
+}
+
+void pidBatchInitAxis(pidBatch_t* batch, const uint8_t axis, const float kp,
+                      const float ki, const float kd, const float iLimit,
+                      const float samplingRate, const float cutoffFreq,
+                      bool enableDFilter) {
+  batch->kp[axis] = kp;
+  batch->ki[axis] = ki;
+  batch->kd[axis] = kd;
+  batch->iLimit[axis] = iLimit;
+  batch->enableDFilter[axis] = enableDFilter;
+  if (enableDFilter) {
+    lpf2pInit(&batch->dFilter[axis], samplingRate, cutoffFreq);
+  }
+  pidBatchResetAxis(batch, axis);
+}
+
+const float* pidBatchUpdate(pidBatch_t* batch, const float* measured, const float* feedForward) {
+  const uint32_t n = batch->count;
+  float32_t tmp[PID_BATCH_MAX_AXES];
+  float32_t prevDeriv[PID_BATCH_MAX_AXES];
+  float32_t prevOutput[PID_BATCH_MAX_AXES];
+
+  // Skipped axes are computed along with the others and restored at the end
+  memcpy(prevDeriv, batch->deriv, n * sizeof(float));
+  memcpy(prevOutput, batch->output, n * sizeof(float));
+
+  if (measured) {
+    arm_sub_f32(batch->desired, (float32_t*)measured, batch->error, n);
+  }
+
+  // prop output
+  arm_mult_f32(batch->kp, batch->error, batch->outP, n);
+
+  // deriv output
+  arm_sub_f32(batch->error, batch->prevError, batch->deriv, n);
+  for (uint32_t i = 0; i < n; i++) {
+    // Divide rather than scale by 1/dt to give the same result as pidUpdate()
+    batch->deriv[i] /= batch->dt;
+    if (batch->enableDFilter[i] && !batch->skip[i]) {
+      batch->deriv[i] = lpf2pApply(&batch->dFilter[i], batch->deriv[i]);
+    }
+    if (isnan(batch->deriv[i])) {
+      batch->deriv[i] = 0;
+    }
+  }
+  arm_mult_f32(batch->kd, batch->deriv, batch->outD, n);
+
+  // feed-forward output
+  if (feedForward) {
+    arm_mult_f32(batch->kff, (float32_t*)feedForward, batch->outFF, n);
+  } else {
+    memset(batch->outFF, 0, n * sizeof(float));
+  }
+
+  // integ output, tmp holds the candidate integral
+  arm_scale_f32(batch->error, batch->dt, tmp, n);
+  arm_add_f32(batch->integ, tmp, tmp, n);
+  for (uint32_t i = 0; i < n; i++) {
+    if (batch->skip[i]) {
+      tmp[i] = batch->integ[i];
+      continue;
+    }
+
+    // Constrain the integral (unless the iLimit is zero)
+    if (batch->iLimit[i] != 0) {
+      tmp[i] = constrain(tmp[i], -batch->iLimit[i], batch->iLimit[i]);
+    }
+
+    // Conditional integration, keep the old integral if the new one would
+    // drive an already saturated output further into saturation
+    if (batch->antiWindup && batch->outputLimit[i] != 0) {
+      const float output = batch->outP[i] + batch->outD[i] + batch->ki[i] * tmp[i] + batch->outFF[i];
+      if (fabsf(output) > batch->outputLimit[i] && output * batch->error[i] > 0) {
+        tmp[i] = batch->integ[i];
+      }
+    }
+  }
+  memcpy(batch->integ, tmp, n * sizeof(float));
+  arm_mult_f32(batch->ki, batch->integ, batch->outI, n);
+
+  arm_add_f32(batch->outP, batch->outD, batch->output, n);
+  arm_add_f32(batch->output, batch->outI, batch->output, n);
+  arm_add_f32(batch->output, batch->outFF, batch->output, n);
+
+  // Constrain the total output (unless the outputLimit is zero)
+  for (uint32_t i = 0; i < n; i++) {
+    if (batch->outputLimit[i] != 0) {
+      batch->output[i] = constrain(batch->output[i], -batch->outputLimit[i], batch->outputLimit[i]);
+    }
+  }
+
+  for (uint32_t i = 0; i < n; i++) {
+    if (batch->skip[i]) {
+      batch->deriv[i] = prevDeriv[i];
+      batch->output[i] = prevOutput[i];
+    } else {
+      batch->prevError[i] = batch->error[i];
+    }
+  }
+
+  return batch->output;
+}
+
+void pidBatchResetAxis(pidBatch_t* batch, const uint8_t axis) {
+  batch->error[axis]     = 0;
+  batch->prevError[axis] = 0;
+  batch->integ[axis]     = 0;
+  batch->deriv[axis]     = 0;
+}
+
+void pidBatchReset(pidBatch_t* batch) {
+  for (uint8_t i = 0; i < batch->count; i++) {
+    pidBatchResetAxis(batch, i);
+  }
+}
@@ -37,12 +37,14 @@
 #include "syslink.h"
 #include "version.h"
 #include "platform.h"
+#include "sysload.h"
 
 static bool isInit=false;
 
 typedef enum {
   platformCommand   = 0x00,
   versionCommand    = 0x01,
+  sysLoadChannel    = SYSLOAD_CRTP_CHANNEL,
 } Channel;
 
 typedef enum {
@@ -85,6 +87,10 @@ void platformserviceHandler(CRTPPacket *p)
       break;
     case versionCommand:
       versionCommandProcess(p);
+      break;
+    case sysLoadChannel:
+      sysLoadHandlePacket(p);
+      break;
     default:
       break;
   }
@@ -33,6 +33,7 @@
 #include "log.h"
 #include "param.h"
 #include "pid.h"
+#include "pid_batch.h"
 #include "num.h"
 #include "position_controller.h"
 #include "debug.h"
@@ -90,12 +91,23 @@ static const float thrustScale = 1000.0f;
 #define PID_Z_KD  1.0
 #define PID_Z_INTEGRATION_LIMIT   2.0
 
-PidObject pidXRate;
-PidObject pidYRate;
-PidObject pidZRate;
-PidObject pidX;
-PidObject pidY;
-PidObject pidZ;
+// Feed-forward of the setpoint acceleration into the velocity loop, off by
+// default. For x and y the output is a tilt in degrees, a small tilt
+// accelerates the Crazyflie by g * tilt (in rad), so 180 / pi / g (about 5.8)
+// is the starting point when tuning posHoldPid.x_kff and y_kff.
+#define PID_XY_RATE_KFF 0.0f
+#define PID_Z_RATE_KFF  0.0f
+
+enum {
+  AXIS_X = 0,
+  AXIS_Y,
+  AXIS_Z,
+  AXIS_COUNT
+};
+
+// x, y and z of each cascade level are updated in one batch
+static pidBatch_t pidVelocity;
+static pidBatch_t pidPosition;
 
 static bool isInit;
 
@@ -106,27 +118,25 @@ bool posHoldControllerTest() {
 void posHoldControllerInit(const float updateDt) {
   if (isInit)
     return;
-  pidInit(&pidXRate, 0, PID_X_RATE_KP, PID_X_RATE_KI, PID_X_RATE_KD,
-      updateDt, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
-  pidInit(&pidYRate, 0, PID_Y_RATE_KP, PID_Y_RATE_KI, PID_Y_RATE_KD,
-      updateDt, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
-  pidInit(&pidZRate, 0, PID_Z_RATE_KP, PID_Z_RATE_KI, PID_Z_RATE_KD,
-      updateDt, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
-
-  pidSetIntegralLimit(&pidXRate,  PID_X_RATE_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidYRate,  PID_Y_RATE_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidZRate,  PID_Z_RATE_INTEGRATION_LIMIT);
-
-  pidInit(&pidX, 0, PID_X_KP, PID_X_KI, PID_X_KD,
-      updateDt, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
-  pidInit(&pidY, 0, PID_Y_KP, PID_Y_KI, PID_Y_KD,
-      updateDt, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
-  pidInit(&pidZ, 0, PID_Z_KP, PID_Z_KI, PID_Z_KD,
-      updateDt, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
-
-  pidSetIntegralLimit(&pidX,  PID_X_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidY,  PID_Y_INTEGRATION_LIMIT);
-  pidSetIntegralLimit(&pidZ,  PID_Z_INTEGRATION_LIMIT);
+  pidBatchInit(&pidVelocity, AXIS_COUNT, updateDt);
+  pidBatchInitAxis(&pidVelocity, AXIS_X, PID_X_RATE_KP, PID_X_RATE_KI, PID_X_RATE_KD,
+      PID_X_RATE_INTEGRATION_LIMIT, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
+  pidBatchInitAxis(&pidVelocity, AXIS_Y, PID_Y_RATE_KP, PID_Y_RATE_KI, PID_Y_RATE_KD,
+      PID_Y_RATE_INTEGRATION_LIMIT, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
+  pidBatchInitAxis(&pidVelocity, AXIS_Z, PID_Z_RATE_KP, PID_Z_RATE_KI, PID_Z_RATE_KD,
+      PID_Z_RATE_INTEGRATION_LIMIT, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
+
+  pidVelocity.kff[AXIS_X] = PID_XY_RATE_KFF;
+  pidVelocity.kff[AXIS_Y] = PID_XY_RATE_KFF;
+  pidVelocity.kff[AXIS_Z] = PID_Z_RATE_KFF;
+
+  pidBatchInit(&pidPosition, AXIS_COUNT, updateDt);
+  pidBatchInitAxis(&pidPosition, AXIS_X, PID_X_KP, PID_X_KI, PID_X_KD,
+      PID_X_INTEGRATION_LIMIT, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
+  pidBatchInitAxis(&pidPosition, AXIS_Y, PID_Y_KP, PID_Y_KI, PID_Y_KD,
+      PID_Y_INTEGRATION_LIMIT, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
+  pidBatchInitAxis(&pidPosition, AXIS_Z, PID_Z_KP, PID_Z_KI, PID_Z_KD,
+      PID_Z_INTEGRATION_LIMIT, POSHOLD_RATE, POSHOLD_LPF_CUTOFF_FREQ, POSHOLD_LPF_ENABLE);
 
   isInit = true;
 }
@@ -146,43 +156,58 @@ void posHoldController(float* thrust, attitude_t *attitude, setpoint_t *setpoint
   // }
   
 
+  // Position, only axes in absolute mode are updated
+  const float position[AXIS_COUNT] = {state->position.x, state->position.y, state->position.z};
+  const bool isAbs[AXIS_COUNT] = {setpoint->mode.x == modeAbs, setpoint->mode.y == modeAbs, setpoint->mode.z == modeAbs};
+  pidPosition.desired[AXIS_X] = setpoint->position.x;
+  pidPosition.desired[AXIS_Y] = setpoint->position.y;
+  pidPosition.desired[AXIS_Z] = setpoint->position.z;
+  for (int i = 0; i < AXIS_COUNT; i++) {
+    pidPosition.skip[i] = !isAbs[i];
+  }
+
+  const float* velocityOut = pidBatchUpdate(&pidPosition, position, 0);
+
   // X, Y
-  if (setpoint->mode.x == modeAbs) {
+  if (isAbs[AXIS_X]) {
     // set world axis absolute x velocity
-    pidSetDesired(&pidX, setpoint->position.x);
-    setpoint->velocity.x = pidUpdate(&pidX, state->position.x, true);
+    setpoint->velocity.x = velocityOut[AXIS_X];
   } else if (setpoint->velocity_body) {
     // convert body axis to world axis
     setpoint->velocity.x = body_vx * cos_yaw - body_vy * sin_yaw;
   }
 
-  if (setpoint->mode.y == modeAbs) {
+  if (isAbs[AXIS_Y]) {
     // set world axis absolute y velocity
-    pidSetDesired(&pidY, setpoint->position.y);
-    setpoint->velocity.y = pidUpdate(&pidY, state->position.y, true);
+    setpoint->velocity.y = velocityOut[AXIS_Y];
   } else if (setpoint->velocity_body) {
     // convert body axis to world axis
     setpoint->velocity.y = body_vy * cos_yaw + body_vx * sin_yaw;
   }
 
-  if (setpoint->mode.z == modeAbs) {
+  if (isAbs[AXIS_Z]) {
     // keep height stable
-    pidSetDesired(&pidZ, setpoint->position.z);
-    setpoint->velocity.z = pidUpdate(&pidZ, state->position.z, true);
+    setpoint->velocity.z = velocityOut[AXIS_Z];
   }
 
+  // Velocity, with the setpoint acceleration as feed-forward
+  const float velocity[AXIS_COUNT] = {state->velocity.x, state->velocity.y, state->velocity.z};
+  const float acceleration[AXIS_COUNT] = {setpoint->acceleration.x, setpoint->acceleration.y, setpoint->acceleration.z};
+  pidVelocity.desired[AXIS_X] = setpoint->velocity.x;
+  pidVelocity.desired[AXIS_Y] = setpoint->velocity.y;
+  pidVelocity.desired[AXIS_Z] = setpoint->velocity.z;
+
+  const float* raw = pidBatchUpdate(&pidVelocity, velocity, acceleration);
+
   // Roll and Pitch (X and Y)
-  pidSetDesired(&pidXRate, setpoint->velocity.x);
-  float XRaw = pidUpdate(&pidXRate, state->velocity.x, true);
-  pidSetDesired(&pidYRate, setpoint->velocity.y);
-  float YRaw = pidUpdate(&pidYRate, state->velocity.y, true);
+  float XRaw = raw[AXIS_X];
+  float YRaw = raw[AXIS_Y];
 
   attitude->pitch = -(XRaw  * cos_yaw) - (YRaw * sin_yaw);
   attitude->roll  = -(YRaw * cos_yaw) + (XRaw  * sin_yaw);
 
   // Thrust
-  pidSetDesired(&pidZRate, setpoint->velocity.z);
-  float thrustRaw = pidUpdate(&pidZRate, state->velocity.z, true);
+  float thrustRaw = raw[AXIS_Z];
   *thrust = thrustRaw * thrustScale + thrustBase;
   // Check for minimum thrust
   if (*thrust < thrustMin) {
@@ -191,10 +216,12 @@ void posHoldController(float* thrust, attitude_t *attitude, setpoint_t *setpoint
 }
 
 void posHoldControllerResetAllPID() {
-  pidReset(&pidXRate);
-  pidReset(&pidYRate);
-  pidReset(&pidZRate);
-  pidReset(&pidX);
-  pidReset(&pidY);
-  pidReset(&pidZ);
+  pidBatchReset(&pidVelocity);
+  pidBatchReset(&pidPosition);
 }
+
+PARAM_GROUP_START(posHoldPid)
+PARAM_ADD(PARAM_FLOAT, x_kff, &pidVelocity.kff[AXIS_X])
+PARAM_ADD(PARAM_FLOAT, y_kff, &pidVelocity.kff[AXIS_Y])
+PARAM_ADD(PARAM_FLOAT, z_kff, &pidVelocity.kff[AXIS_Z])
+PARAM_GROUP_STOP(posHoldPid)
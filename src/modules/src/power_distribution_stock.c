@@ -51,6 +51,9 @@ static struct {
   uint16_t m4;
 } motorPowerSet;
 
+// Mean of the commands sent to the motors
+static uint16_t motorRatioMean;
+
 void powerDistributionInit(void) {
   const MotorPerifDef** motorMap = platformConfigGetMotorMapping();
 
@@ -76,6 +79,7 @@ void powerStop() {
   (*motorsDrive)(MOTOR_M2, 0);
   (*motorsDrive)(MOTOR_M3, 0);
   (*motorsDrive)(MOTOR_M4, 0);
+  motorRatioMean = 0;
 }
 
 void powerDistribution(const control_t *control) {
@@ -115,14 +119,20 @@ void powerDistribution(const control_t *control) {
     (*motorsDrive)(MOTOR_M2, motorPowerSet.m2);
     (*motorsDrive)(MOTOR_M3, motorPowerSet.m3);
     (*motorsDrive)(MOTOR_M4, motorPowerSet.m4);
+    motorRatioMean = ((uint32_t)motorPowerSet.m1 + motorPowerSet.m2 + motorPowerSet.m3 + motorPowerSet.m4) / 4;
   } else {
     (*motorsDrive)(MOTOR_M1, motorPower.m1);
     (*motorsDrive)(MOTOR_M2, motorPower.m2);
     (*motorsDrive)(MOTOR_M3, motorPower.m3);
     (*motorsDrive)(MOTOR_M4, motorPower.m4);
+    motorRatioMean = (motorPower.m1 + motorPower.m2 + motorPower.m3 + motorPower.m4) / 4;
   }
 }
 
+float powerDistributionGetMotorRatio(void) {
+  return motorRatioMean / (float)UINT16_MAX;
+}
+
 PARAM_GROUP_START(motorPowerSet)
 PARAM_ADD(PARAM_UINT8, enable, &motorSetEnable)
 PARAM_ADD(PARAM_UINT16, m1, &motorPowerSet.m1)
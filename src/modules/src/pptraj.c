@@ -231,6 +231,13 @@ bool is_traj_eval_valid(struct traj_eval const *ev) {
 	return !visnan(ev->pos);
 }
 
+struct mat33 flat_attitude(struct vec thrust, struct vec heading) {
+	struct vec z_body = vnormalize(thrust);
+	struct vec y_body = vnormalize(vcross(z_body, heading));
+	struct vec x_body = vcross(y_body, z_body);
+	return mcolumns(x_body, y_body, z_body);
+}
+
 struct traj_eval poly4d_eval(struct poly4d const *p, float t) {
 	// flat variables
 	struct traj_eval out;
@@ -255,10 +262,11 @@ struct traj_eval poly4d_eval(struct poly4d const *p, float t) {
 	struct vec thrust = vadd(out.acc, mkvec(0, 0, GRAV));
 	// float thrust_mag = mass * vmag(thrust);
 
-	struct vec z_body = vnormalize(thrust);
-	struct vec x_world = mkvec(cosf(out.yaw), sinf(out.yaw), 0);
-	struct vec y_body = vnormalize(vcross(z_body, x_world));
-	struct vec x_body = vcross(y_body, z_body);
+	out.heading = mkvec(cosf(out.yaw), sinf(out.yaw), 0);
+	struct mat33 attitude = flat_attitude(thrust, out.heading);
+	struct vec x_body = mcolumn(attitude, 0);
+	struct vec y_body = mcolumn(attitude, 1);
+	struct vec z_body = mcolumn(attitude, 2);
 
 	struct vec jerk_orth_zbody = vorthunit(jerk, z_body);
 	struct vec h_w = vscl(1.0f / vmag(thrust), jerk_orth_zbody);
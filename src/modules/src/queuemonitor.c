@@ -28,8 +28,6 @@
 
 #include "queuemonitor.h"
 
-#ifdef DEBUG_QUEUE_MONITOR
-
 #include <stdbool.h>
 #include "timers.h"
 #include "debug.h"
@@ -43,48 +41,68 @@
 
 typedef struct
 {
-  char* fileName;
   char* queueName;
+  // Counters for the system load monitor, not reset by the timer
+  uint32_t totalSendCount;
+  uint32_t totalFullCount;
+  uint8_t peak;
+#ifdef DEBUG_QUEUE_MONITOR
+  char* fileName;
   int sendCount;
   int maxWaiting;
   int fullCount;
+#endif
 } Data;
 
 static Data data[MAX_NR_OF_QUEUES];
 
-static xTimerHandle timer;
 static unsigned char nrOfQueues = 1; // Unregistered queues will end up at 0
 static bool initialized = false;
 
+static Data* getQueueData(xQueueHandle* xQueue);
+static int getMaxWaiting(xQueueHandle* xQueue, int prevPeak);
+
+#ifdef DEBUG_QUEUE_MONITOR
+static xTimerHandle timer;
+
 static void timerHandler(xTimerHandle timer);
 static void debugPrint();
 static bool filter(Data* queueData);
 static void debugPrintQueue(Data* queueData);
-static Data* getQueueData(xQueueHandle* xQueue);
-static int getMaxWaiting(xQueueHandle* xQueue, int prevPeak);
 static void resetCounters();
+#endif
 
 unsigned char ucQueueGetQueueNumber( xQueueHandle xQueue );
 
 
 void queueMonitorInit() {
   ASSERT(!initialized);
+#ifdef DEBUG_QUEUE_MONITOR
   timer = xTimerCreate( "queueMonitorTimer", TIMER_PERIOD,
     pdTRUE, NULL, timerHandler );
   xTimerStart(timer, 100);
 
   data[0].fileName = "Na";
+#endif
   data[0].queueName = "Na";
 
   initialized = true;
 }
 
+// Called from the queue send functions, inside their critical section
 void qm_traceQUEUE_SEND(void* xQueue) {
   if(initialized) {
     Data* queueData = getQueueData(xQueue);
 
+    if (queueData->totalSendCount < UINT32_MAX) {
+      queueData->totalSendCount++;
+    }
+    queueData->peak = getMaxWaiting(xQueue, queueData->peak);
+
+#ifdef DEBUG_QUEUE_MONITOR
     queueData->sendCount++;
     queueData->maxWaiting = getMaxWaiting(xQueue, queueData->maxWaiting);
+#endif
   }
 }
 
@@ -92,7 +110,13 @@ void qm_traceQUEUE_SEND_FAILED(void* xQueue) {
   if(initialized) {
     Data* queueData = getQueueData(xQueue);
 
+    if (queueData->totalFullCount < UINT32_MAX) {
+      queueData->totalFullCount++;
+    }
+
+#ifdef DEBUG_QUEUE_MONITOR
     queueData->fullCount++;
+#endif
   }
 }
 
@@ -101,13 +125,38 @@ void qmRegisterQueue(xQueueHandle* xQueue, char* fileName, char* queueName) {
   ASSERT(nrOfQueues < MAX_NR_OF_QUEUES);
   Data* queueData = &data[nrOfQueues];
 
+#ifdef DEBUG_QUEUE_MONITOR
   queueData->fileName = fileName;
+#else
+  (void)fileName;
+#endif
   queueData->queueName = queueName;
   vQueueSetQueueNumber(xQueue, nrOfQueues);
 
   nrOfQueues++;
 }
 
+int queueMonitorGetNrOfQueues() {
+  return nrOfQueues;
+}
+
+void queueMonitorGetStats(int index, queueMonitorStats_t* stats) {
+  ASSERT(index < nrOfQueues);
+  Data* queueData = &data[index];
+
+  taskENTER_CRITICAL();
+  stats->queueName = queueData->queueName;
+  stats->sendCount = queueData->totalSendCount;
+  stats->fullCount = queueData->totalFullCount;
+  stats->peak = queueData->peak;
+  taskEXIT_CRITICAL();
+}
+
+void queueMonitorResetPeak(int index) {
+  ASSERT(index < nrOfQueues);
+  data[index].peak = 0;
+}
+
 static Data* getQueueData(xQueueHandle* xQueue) {
   unsigned char number = uxQueueGetQueueNumber(xQueue);
   ASSERT(number < MAX_NR_OF_QUEUES);
@@ -120,11 +169,12 @@ static int getMaxWaiting(xQueueHandle* xQueue, int prevPeak) {
   unsigned portBASE_TYPE waiting = uxQueueMessagesWaitingFromISR(xQueue) + 1;
 
   if (waiting > prevPeak) {
-    return waiting;
+    return (waiting > UINT8_MAX) ? UINT8_MAX : waiting;
   }
   return prevPeak;
 }
 
+#ifdef DEBUG_QUEUE_MONITOR
 static void debugPrint() {
   int i = 0;
   for (i = 0; i < nrOfQueues; i++) {
@@ -43,7 +43,8 @@ float rangeGet(rangeDirection_t direction)
 {
     if (direction > (RANGE_T_END-1)) return 0;
 
-  return ranges[direction];
+  // Stored in mm for the log
+  return ranges[direction] / 1000.0f;
 }
 
 LOG_GROUP_START(range)
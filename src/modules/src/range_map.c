@@ -0,0 +1,224 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * range_map.c - Occupancy grid built from the multiranger and zranger
+ */
+
+#define DEBUG_MODULE "RMAP"
+
+#include <string.h>
+#include <math.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "config.h"
+#include "debug.h"
+#include "log.h"
+#include "param.h"
+#include "range.h"
+#include "system.h"
+
+#include "range_map.h"
+
+#define UPDATE_PERIOD_MS 100
+#define DEG_TO_RAD (3.14159265f / 180.0f)
+
+static bool isInit = false;
+
+// Settings
+static uint8_t enable = 1;
+static float maxRange = 3.0f;   // m, longer ranges are treated as no hit
+static float minHeight = 0.15f; // m, measured by the zranger
+static float maxTilt = 15.0f;   // degrees
+
+// Written by the range map task, read by the memory subsystem
+static occupancyGrid_t grid;
+static xSemaphoreHandle gridMutex;
+
+// The header as of the last read of address 0
+static uint8_t header[RANGE_MAP_HEADER_SIZE];
+
+// Stats
+static uint32_t updateCount;
+static uint32_t skipCount;
+static bool hasHeight;         // The height is measured and checked against minHeight
+
+typedef struct {
+  rangeDirection_t direction;
+  float angle; // rad, in the body frame
+} rangeSensor_t;
+
+static const rangeSensor_t sensors[] = {
+  {rangeFront, 0.0f},
+  {rangeLeft, 90.0f * DEG_TO_RAD},
+  {rangeBack, 180.0f * DEG_TO_RAD},
+  {rangeRight, -90.0f * DEG_TO_RAD},
+};
+
+static int idX;
+static int idY;
+static int idRoll;
+static int idPitch;
+static int idYaw;
+
+static void rangeMapTask(void* param);
+
+void rangeMapInit(void) {
+  if (isInit) {
+    return;
+  }
+
+  occupancyGridInit(&grid, 0.1f);
+  gridMutex = xSemaphoreCreateMutex();
+
+  xTaskCreate(rangeMapTask, RANGE_MAP_TASK_NAME,
+              RANGE_MAP_TASK_STACKSIZE, NULL, RANGE_MAP_TASK_PRI, NULL);
+
+  isInit = true;
+}
+
+bool rangeMapTest(void) {
+  return isInit;
+}
+
+bool rangeMapMemRead(const uint32_t memAddr, const uint8_t readLen, uint8_t* dest) {
+  if (memAddr + readLen > RANGE_MAP_MEM_SIZE || !isInit) {
+    return false;
+  }
+
+  xSemaphoreTake(gridMutex, portMAX_DELAY);
+
+  if (memAddr == 0) {
+    const rangeMapHeader_t snapshot = {
+      .version = RANGE_MAP_VERSION,
+      .gridSize = OCCUPANCY_GRID_SIZE,
+      .tileSize = OCCUPANCY_GRID_TILE_SIZE,
+      .resolutionMm = (uint16_t)(grid.resolution * 1000.0f + 0.5f),
+      .originX = grid.originX,
+      .originY = grid.originY,
+      .generation = grid.generation,
+    };
+    memset(header, 0, sizeof(header));
+    memcpy(header, &snapshot, sizeof(snapshot));
+  }
+
+  const uint8_t* changes = (const uint8_t*)grid.tileChanges;
+  const uint8_t* tiles = (const uint8_t*)grid.tiles;
+  for (int i = 0; i < readLen; i++) {
+    const uint32_t address = memAddr + i;
+    if (address < RANGE_MAP_CHANGES_ADDRESS) {
+      dest[i] = header[address];
+    } else if (address < RANGE_MAP_TILES_ADDRESS) {
+      dest[i] = changes[address - RANGE_MAP_CHANGES_ADDRESS];
+    } else {
+      dest[i] = tiles[address - RANGE_MAP_TILES_ADDRESS];
+    }
+  }
+
+  xSemaphoreGive(gridMutex);
+
+  return true;
+}
+
+static bool isMappingPossible(void) {
+  // The down range is 0 until a zranger has measured it
+  const float height = rangeGet(rangeDown);
+  hasHeight = (height > 0.0f);
+  if (hasHeight && height < minHeight) {
+    return false;
+  }
+
+  if (fabsf(logGetFloat(idRoll)) > maxTilt || fabsf(logGetFloat(idPitch)) > maxTilt) {
+    return false;
+  }
+
+  return true;
+}
+
+static void updateMap(void) {
+  const float x = logGetFloat(idX);
+  const float y = logGetFloat(idY);
+  const float yaw = logGetFloat(idYaw) * DEG_TO_RAD;
+
+  xSemaphoreTake(gridMutex, portMAX_DELAY);
+
+  occupancyGridFollow(&grid, x, y);
+  for (int i = 0; i < sizeof(sensors) / sizeof(sensors[0]); i++) {
+    const float range = rangeGet(sensors[i].direction);
+    // Not measured (yet)
+    if (range <= 0.0f) {
+      continue;
+    }
+
+    occupancyGridAddRange(&grid, x, y, yaw + sensors[i].angle, range, maxRange);
+  }
+
+  xSemaphoreGive(gridMutex);
+}
+
+static void rangeMapTask(void* param) {
+  systemWaitStart();
+
+  idX = logGetVarId("stateEstimate", "x");
+  idY = logGetVarId("stateEstimate", "y");
+  idRoll = logGetVarId("stateEstimate", "roll");
+  idPitch = logGetVarId("stateEstimate", "pitch");
+  idYaw = logGetVarId("stateEstimate", "yaw");
+
+  TickType_t lastWakeTime = xTaskGetTickCount();
+
+  while (1) {
+    vTaskDelayUntil(&lastWakeTime, M2T(UPDATE_PERIOD_MS));
+
+    if (!enable) {
+      continue;
+    }
+
+    if (isMappingPossible()) {
+      updateMap();
+      updateCount++;
+    } else {
+      skipCount++;
+    }
+  }
+}
+
+PARAM_GROUP_START(rangeMap)
+PARAM_ADD(PARAM_UINT8, enable, &enable)
+PARAM_ADD(PARAM_FLOAT, maxRange, &maxRange)
+PARAM_ADD(PARAM_FLOAT, minHeight, &minHeight)
+PARAM_ADD(PARAM_FLOAT, maxTilt, &maxTilt)
+PARAM_ADD(PARAM_INT8, hit, &grid.hit)
+PARAM_ADD(PARAM_INT8, miss, &grid.miss)
+PARAM_GROUP_STOP(rangeMap)
+
+LOG_GROUP_START(rangeMap)
+LOG_ADD(LOG_UINT32, updates, &updateCount)
+LOG_ADD(LOG_UINT32, skipped, &skipCount)
+LOG_ADD(LOG_UINT8, hasHeight, &hasHeight)
+LOG_ADD(LOG_UINT16, gen, &grid.generation)
+LOG_ADD(LOG_INT32, originX, &grid.originX)
+LOG_ADD(LOG_INT32, originY, &grid.originY)
+LOG_GROUP_STOP(rangeMap)
@@ -51,6 +51,7 @@
 #include "quatcompress.h"
 
 #include "zranger.h"
+#include "vibration.h"
 
 static bool isInit;
 static bool emergencyStop = false;
@@ -195,6 +196,7 @@ void stabilizerInit(StateEstimatorType estimator) {
   // the actual controller type is PID
   controllerInit(ControllerTypeAny);
   powerDistributionInit();
+  vibrationInit();
   if (estimator == kalmanEstimator) {
     sitAwInit();
   }
@@ -214,6 +216,7 @@ bool stabilizerTest(void) {
   pass &= stateEstimatorTest();
   pass &= controllerTest();
   pass &= powerDistributionTest();
+  pass &= vibrationTest();
   return pass;
 }
 
@@ -318,6 +321,7 @@ static void stabilizerTask(void* param) {
       }
       ///////////////////////////////////////////////////////////////////////////
     }
+    vibrationAddSample(&sensorData);
     calcSensorToOutputLatency(&sensorData);
     tick++;
   }
@@ -0,0 +1,69 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * state_buffer.c - Double buffered state, written by one task and read by another
+ */
+
+#include <string.h>
+
+#include "state_buffer.h"
+
+void stateBufferInit(stateBuffer_t* buffer) {
+  memset(buffer, 0, sizeof(*buffer));
+}
+
+void stateBufferPublish(stateBuffer_t* buffer, const state_t* state, const uint32_t tick) {
+  const uint32_t sequence = buffer->sequence + 1;
+  buffer->slots[sequence & 1].state = *state;
+  buffer->slots[sequence & 1].tick = tick;
+  __sync_synchronize();
+  buffer->sequence = sequence;
+}
+
+uint32_t stateBufferReadBegin(const stateBuffer_t* buffer, state_t* state, uint32_t* tick) {
+  const uint32_t sequence = buffer->sequence;
+  __sync_synchronize();
+  *state = buffer->slots[sequence & 1].state;
+  *tick = buffer->slots[sequence & 1].tick;
+  __sync_synchronize();
+  return sequence;
+}
+
+bool stateBufferReadRetry(const stateBuffer_t* buffer, const uint32_t sequence) {
+  return buffer->sequence != sequence;
+}
+
+uint32_t stateBufferRead(const stateBuffer_t* buffer, state_t* state, uint32_t* tick) {
+  uint32_t sequence;
+  do {
+    sequence = stateBufferReadBegin(buffer, state, tick);
+  } while (stateBufferReadRetry(buffer, sequence));
+  return sequence;
+}
+
+void stateBufferPredict(state_t* state, const uint32_t tick, const float dt) {
+  state->position.x += state->velocity.x * dt;
+  state->position.y += state->velocity.y * dt;
+  state->position.z += state->velocity.z * dt;
+  state->position.timestamp = tick;
+}
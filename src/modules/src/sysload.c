@@ -22,16 +22,28 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  *
  * sysload.c - System load monitor
+ *
+ * Samples CPU load, stack high-water marks and context switch counts for
+ * all tasks, and send/fail counts and peak depth for all registered queues,
+ * once per TIMER_PERIOD. Summary values are available as log variables, the
+ * per task and per queue records can be streamed on the platform CRTP port by
+ * setting the sysload.stream parameter. See tools/sysload/sysload_recorder.py.
  */
 
 #define DEBUG_MODULE "SYSLOAD"
 
 #include <stdbool.h>
+#include <string.h>
 #include "FreeRTOS.h"
 #include "timers.h"
+#include "task.h"
+#include "semphr.h"
 #include "debug.h"
 #include "cfassert.h"
 #include "param.h"
+#include "log.h"
+#include "crtp.h"
+#include "queuemonitor.h"
 
 #include "sysload.h"
 
@@ -41,10 +53,12 @@ static void timerHandler(xTimerHandle timer);
 
 static bool initialized = false;
 static uint8_t triggerDump = 0;
+static uint8_t streamEnable = 0;
 
 typedef struct {
   uint32_t ulRunTimeCounter;
   uint32_t xTaskNumber;
+  uint32_t contextSwitches;
 } taskData_t;
 
 #define TASK_MAX_COUNT 32
@@ -52,9 +66,68 @@ static taskData_t previousSnapshot[TASK_MAX_COUNT];
 static int taskTopIndex = 0;
 static uint32_t previousTotalRunTime = 0;
 
+// Written by the timer, taskStats and taskCount are also read by the CRTP
+// task in sendTaskNames()
+static SemaphoreHandle_t taskStatsMutex;
+static TaskStatus_t taskStats[TASK_MAX_COUNT];
+static uint32_t taskCount = 0;
+
+// Copy of the task names for sendTaskNames()
+typedef struct {
+  uint8_t number;
+  char name[configMAX_TASK_NAME_LEN];
+} taskName_t;
+static taskName_t taskNames[TASK_MAX_COUNT];
+
+// Per task result of the latest sample, indexed as taskStats
+typedef struct {
+  uint16_t load;            // Permille of total run time
+  uint16_t switches;        // Context switches into the task during the period
+} taskProfile_t;
+static taskProfile_t taskProfile[TASK_MAX_COUNT];
+
+// Log variables
+static uint16_t cpuLoad;          // Permille of run time not spent in the idle task
+static uint32_t totalSwitches;    // Context switches during the period
+static uint16_t minStackLeft;     // Lowest stack high-water mark of all tasks (words)
+static uint32_t totalQueueFull;   // Failed queue sends since boot
+
+// CRTP stream format, sent on channel SYSLOAD_CRTP_CHANNEL of the platform port
+typedef enum {
+  sysLoadTaskRecords  = 0x00,
+  sysLoadQueueRecords = 0x01,
+  sysLoadTaskName     = 0x02,
+  sysLoadQueueName    = 0x03,
+} SysLoadPacketType;
+
+typedef enum {
+  sysLoadGetTaskNames  = 0x00,
+  sysLoadGetQueueNames = 0x01,
+} SysLoadCommand;
+
+struct taskRecord_s {
+  uint8_t number;
+  uint16_t load;
+  uint16_t stackLeft;
+  uint16_t switches;
+} __attribute__((packed));
+
+struct queueRecord_s {
+  uint8_t number;
+  uint8_t peak;
+  uint32_t sent;
+  uint32_t full;
+} __attribute__((packed));
+
+#define TASK_RECORDS_PER_PACKET ((CRTP_MAX_DATA_SIZE - 2) / sizeof(struct taskRecord_s))
+#define QUEUE_RECORDS_PER_PACKET ((CRTP_MAX_DATA_SIZE - 2) / sizeof(struct queueRecord_s))
+
+static uint8_t streamSequence = 0;
+
 void sysLoadInit() {
   ASSERT(!initialized);
 
+  taskStatsMutex = xSemaphoreCreateMutex();
   xTimerHandle timer = xTimerCreate( "sysLoadMonitorTimer", TIMER_PERIOD, pdTRUE, NULL, timerHandler);
   xTimerStart(timer, 100);
 
@@ -62,59 +135,231 @@ void sysLoadInit() {
 }
 
 
-static taskData_t* getPreviousTaskData(uint32_t xTaskNumber) {
+static taskData_t* getPreviousTaskData(const TaskStatus_t* stats) {
   // Try to find the task in the list of tasks
   for (int i = 0; i < taskTopIndex; i++) {
-    if (previousSnapshot[i].xTaskNumber == xTaskNumber) {
+    if (previousSnapshot[i].xTaskNumber == stats->xTaskNumber) {
       return &previousSnapshot[i];
     }
   }
 
-  // Allocate a new entry
+  // Allocate a new entry. The switch counter of a task is not initialized
+  // when it is created, start counting from its current value
   ASSERT(taskTopIndex < TASK_MAX_COUNT);
   taskData_t* result = &previousSnapshot[taskTopIndex];
-  result->xTaskNumber = xTaskNumber;
+  result->xTaskNumber = stats->xTaskNumber;
+  result->contextSwitches = uxTaskGetTaskNumber(stats->xHandle);
 
   taskTopIndex++;
 
   return result;
 }
 
-static void timerHandler(xTimerHandle timer) {
-  if (triggerDump != 0) {
-    uint32_t totalRunTime;
-
-    TaskStatus_t taskStats[TASK_MAX_COUNT];
-    uint32_t taskCount = uxTaskGetSystemState(taskStats, TASK_MAX_COUNT, &totalRunTime);
-    ASSERT(taskCount < TASK_MAX_COUNT);
-
-    uint32_t totalDelta = totalRunTime - previousTotalRunTime;
-    float f = 100.0 / totalDelta;
-
-    // Dumps the the CPU load and stack usage for all tasks
-    // CPU usage is since last dump in % compared to total time spent in tasks. Note that time spent in interrupts will be included in measured time.
-    // Stack usage is displayed as nr of unused bytes at peak stack usage.
-
-    DEBUG_PRINT("Task dump\n");
-    DEBUG_PRINT("Load\tStack left\tName\n");
-    for (uint32_t i = 0; i < taskCount; i++) {
-      TaskStatus_t* stats = &taskStats[i];
-      taskData_t* previousTaskData = getPreviousTaskData(stats->xTaskNumber);
-
-      uint32_t taskRunTime = stats->ulRunTimeCounter;
-      float load = f * (taskRunTime - previousTaskData->ulRunTimeCounter);
-      DEBUG_PRINT("%.2f \t%u \t%s\n", (double)load, stats->usStackHighWaterMark, stats->pcTaskName);
-      
-      previousTaskData->ulRunTimeCounter = taskRunTime;
+static void sampleTasks() {
+  uint32_t totalRunTime;
+
+  xSemaphoreTake(taskStatsMutex, portMAX_DELAY);
+  taskCount = uxTaskGetSystemState(taskStats, TASK_MAX_COUNT, &totalRunTime);
+  xSemaphoreGive(taskStatsMutex);
+  ASSERT(taskCount < TASK_MAX_COUNT);
+
+  uint32_t totalDelta = totalRunTime - previousTotalRunTime;
+  if (totalDelta == 0) {
+    return;
+  }
+  float f = 1000.0f / totalDelta;
+
+  TaskHandle_t idleTask = xTaskGetIdleTaskHandle();
+  uint16_t idleLoad = 0;
+  uint32_t switches = 0;
+  uint16_t minStack = UINT16_MAX;
+
+  for (uint32_t i = 0; i < taskCount; i++) {
+    TaskStatus_t* stats = &taskStats[i];
+    taskData_t* previousTaskData = getPreviousTaskData(stats);
+
+    uint32_t taskRunTime = stats->ulRunTimeCounter;
+    uint16_t load = (uint16_t)(f * (taskRunTime - previousTaskData->ulRunTimeCounter));
+
+    uint32_t taskSwitches = uxTaskGetTaskNumber(stats->xHandle);
+    uint32_t switchDelta = taskSwitches - previousTaskData->contextSwitches;
+
+    taskProfile[i].load = load;
+    taskProfile[i].switches = (switchDelta > UINT16_MAX) ? UINT16_MAX : switchDelta;
+
+    if (stats->xHandle == idleTask) {
+      idleLoad = load;
+    }
+    if (stats->usStackHighWaterMark < minStack) {
+      minStack = stats->usStackHighWaterMark;
     }
+    switches += switchDelta;
+
+    previousTaskData->ulRunTimeCounter = taskRunTime;
+    previousTaskData->contextSwitches = taskSwitches;
+  }
 
-    previousTotalRunTime = totalRunTime;
+  cpuLoad = (idleLoad < 1000) ? 1000 - idleLoad : 0;
+  totalSwitches = switches;
+  minStackLeft = minStack;
+  previousTotalRunTime = totalRunTime;
+}
+
+static void dumpTaskInfo() {
+  // Dumps the the CPU load and stack usage for all tasks
+  // CPU usage is since last sample in % compared to total time spent in tasks. Note that time spent in interrupts will be included in measured time.
+  // Stack usage is displayed as nr of unused words at peak stack usage.
+
+  DEBUG_PRINT("Task dump\n");
+  DEBUG_PRINT("Load\tStack left\tSwitches\tName\n");
+  for (uint32_t i = 0; i < taskCount; i++) {
+    TaskStatus_t* stats = &taskStats[i];
+    DEBUG_PRINT("%.1f \t%u \t%u \t%s\n", (double)(taskProfile[i].load / 10.0f), stats->usStackHighWaterMark, taskProfile[i].switches, stats->pcTaskName);
+  }
+}
+
+static void streamTaskRecords() {
+  CRTPPacket p;
+  p.header = CRTP_HEADER(CRTP_PORT_PLATFORM, SYSLOAD_CRTP_CHANNEL);
+
+  uint32_t i = 0;
+  while (i < taskCount) {
+    p.data[0] = sysLoadTaskRecords;
+    p.data[1] = streamSequence;
+    struct taskRecord_s* records = (struct taskRecord_s*)&p.data[2];
+
+    uint32_t n = 0;
+    for (; n < TASK_RECORDS_PER_PACKET && i < taskCount; n++, i++) {
+      records[n].number = taskStats[i].xTaskNumber;
+      records[n].load = taskProfile[i].load;
+      records[n].stackLeft = taskStats[i].usStackHighWaterMark;
+      records[n].switches = taskProfile[i].switches;
+    }
 
+    p.size = 2 + n * sizeof(struct taskRecord_s);
+    crtpSendPacket(&p);
+  }
+}
+
+static void sampleQueues() {
+  queueMonitorStats_t stats;
+  uint32_t full = 0;
+
+  int nrOfQueues = queueMonitorGetNrOfQueues();
+  for (int i = 0; i < nrOfQueues; i++) {
+    queueMonitorGetStats(i, &stats);
+    full += stats.fullCount;
+  }
+
+  totalQueueFull = full;
+}
+
+static void streamQueueRecords() {
+  CRTPPacket p;
+  queueMonitorStats_t stats;
+  p.header = CRTP_HEADER(CRTP_PORT_PLATFORM, SYSLOAD_CRTP_CHANNEL);
+
+  int nrOfQueues = queueMonitorGetNrOfQueues();
+  int i = 0;
+  while (i < nrOfQueues) {
+    p.data[0] = sysLoadQueueRecords;
+    p.data[1] = streamSequence;
+    struct queueRecord_s* records = (struct queueRecord_s*)&p.data[2];
+
+    uint32_t n = 0;
+    for (; n < QUEUE_RECORDS_PER_PACKET && i < nrOfQueues; n++, i++) {
+      queueMonitorGetStats(i, &stats);
+      queueMonitorResetPeak(i);
+      records[n].number = i;
+      records[n].peak = stats.peak;
+      records[n].sent = stats.sendCount;
+      records[n].full = stats.fullCount;
+    }
+
+    p.size = 2 + n * sizeof(struct queueRecord_s);
+    crtpSendPacket(&p);
+  }
+}
+
+static void timerHandler(xTimerHandle timer) {
+  sampleTasks();
+  sampleQueues();
+
+  if (streamEnable != 0) {
+    streamTaskRecords();
+    streamQueueRecords();
+    streamSequence++;
+  }
+
+  if (triggerDump != 0) {
+    dumpTaskInfo();
     triggerDump = 0;
   }
 }
 
+static void sendTaskNames() {
+  CRTPPacket p;
+  p.header = CRTP_HEADER(CRTP_PORT_PLATFORM, SYSLOAD_CRTP_CHANNEL);
+
+  // Copy the names, the lock is not held while sending
+  xSemaphoreTake(taskStatsMutex, portMAX_DELAY);
+  const uint32_t count = taskCount;
+  for (uint32_t i = 0; i < count; i++) {
+    taskNames[i].number = taskStats[i].xTaskNumber;
+    strncpy(taskNames[i].name, taskStats[i].pcTaskName, configMAX_TASK_NAME_LEN);
+  }
+  xSemaphoreGive(taskStatsMutex);
+
+  for (uint32_t i = 0; i < count; i++) {
+    p.data[0] = sysLoadTaskName;
+    p.data[1] = taskNames[i].number;
+    strncpy((char*)&p.data[2], taskNames[i].name, configMAX_TASK_NAME_LEN);
+    p.size = 2 + strnlen(taskNames[i].name, configMAX_TASK_NAME_LEN);
+    crtpSendPacketBlock(&p);
+  }
+}
+
+static void sendQueueNames() {
+  CRTPPacket p;
+  queueMonitorStats_t stats;
+  p.header = CRTP_HEADER(CRTP_PORT_PLATFORM, SYSLOAD_CRTP_CHANNEL);
+
+  int nrOfQueues = queueMonitorGetNrOfQueues();
+  for (int i = 0; i < nrOfQueues; i++) {
+    queueMonitorGetStats(i, &stats);
+    p.data[0] = sysLoadQueueName;
+    p.data[1] = i;
+    strncpy((char*)&p.data[2], stats.queueName, CRTP_MAX_DATA_SIZE - 2);
+    p.size = 2 + strnlen(stats.queueName, CRTP_MAX_DATA_SIZE - 2);
+    crtpSendPacketBlock(&p);
+  }
+}
+
+void sysLoadHandlePacket(CRTPPacket *p) {
+  switch (p->data[0]) {
+    case sysLoadGetTaskNames:
+      sendTaskNames();
+      break;
+    case sysLoadGetQueueNames:
+      sendQueueNames();
+      break;
+    default:
+      break;
+  }
+}
+
 
 PARAM_GROUP_START(system)
 PARAM_ADD(PARAM_UINT8, taskDump, &triggerDump)
 PARAM_GROUP_STOP(system)
+
+PARAM_GROUP_START(sysload)
+PARAM_ADD(PARAM_UINT8, stream, &streamEnable)
+PARAM_GROUP_STOP(sysload)
+
+LOG_GROUP_START(sysload)
+LOG_ADD(LOG_UINT16, cpu, &cpuLoad)
+LOG_ADD(LOG_UINT32, ctxSw, &totalSwitches)
+LOG_ADD(LOG_UINT16, minStack, &minStackLeft)
+LOG_ADD(LOG_UINT32, qFull, &totalQueueFull)
+LOG_GROUP_STOP(sysload)
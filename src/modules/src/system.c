@@ -142,9 +142,7 @@ void systemTask(void *arg) {
   ledInit();
   ledSet(CHG_LED, 1);
 
-#ifdef DEBUG_QUEUE_MONITOR
   queueMonitorInit();
-#endif
 
 #ifdef ENABLE_UART1
   // uart1Init(9600);
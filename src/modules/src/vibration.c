@@ -0,0 +1,198 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * vibration.c - On-board vibration spectrum analyzer
+ *
+ * The gyro and accelerometer samples from the stabilizer loop are collected
+ * in overlapping frames. Each frame is analyzed in a low priority task and
+ * the peak frequency, peak amplitude and the energy in a few frequency bands
+ * are published as log variables, per axis. The analysis runs during the
+ * propeller test as well as in flight, which makes it possible to find
+ * unbalanced or damaged propellers and to set the gyro notch filter.
+ *
+ * Bands: 0-50 Hz (flight dynamics), 50-150 Hz, 150-300 Hz (propeller and
+ * motor vibrations) and 300-500 Hz (high frequency noise).
+ *
+ * The analyzer uses about 14 kB of RAM and is only built with
+ * VIBRATION_ENABLE=1 (see vibration.h).
+ */
+
+#define DEBUG_MODULE "VIB"
+
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "config.h"
+#include "debug.h"
+#include "log.h"
+#include "param.h"
+#include "spectrum.h"
+
+#include "vibration.h"
+
+typedef enum {
+  GYRO_X,
+  GYRO_Y,
+  GYRO_Z,
+  ACC_X,
+  ACC_Y,
+  ACC_Z,
+  CHANNEL_COUNT
+} channel_t;
+
+static const float bandEdges[SPECTRUM_BAND_COUNT + 1] = {0.0f, 50.0f, 150.0f, 300.0f, RATE_MAIN_LOOP / 2.0f};
+
+static bool isInit = false;
+static uint8_t enable = 1;
+
+static xSemaphoreHandle frameReady;
+
+// Written by the stabilizer task, read by the vibration task
+static spectrumBuffer_t buffers[CHANNEL_COUNT];
+// Incremented by the stabilizer task after each sample. The vibration task
+// copies the buffers without blocking the stabilizer and copies again if a
+// sample was added during the copy (a sequence lock). The stabilizer task has
+// the higher priority and is never interrupted by the copy.
+static volatile uint32_t sampleCount;
+
+static spectrum_t spectrum;
+// Snapshot of all channels, taken at the same sample
+static float frames[CHANNEL_COUNT][SPECTRUM_FFT_SIZE];
+static spectrumResult_t results[CHANNEL_COUNT];
+
+static void vibrationTask(void* param);
+
+void vibrationInit(void) {
+  if (isInit) {
+    return;
+  }
+
+  for (int i = 0; i < CHANNEL_COUNT; i++) {
+    spectrumBufferInit(&buffers[i]);
+  }
+  if (!spectrumInit(&spectrum, RATE_MAIN_LOOP, bandEdges)) {
+    DEBUG_PRINT("Failed to initialize FFT\n");
+    return;
+  }
+
+  vSemaphoreCreateBinary(frameReady);
+  xSemaphoreTake(frameReady, 0);
+
+  xTaskCreate(vibrationTask, VIBRATION_TASK_NAME,
+              VIBRATION_TASK_STACKSIZE, NULL, VIBRATION_TASK_PRI, NULL);
+
+  isInit = true;
+}
+
+bool vibrationTest(void) {
+  return isInit;
+}
+
+void vibrationAddSample(const sensorData_t* sensors) {
+  if (!isInit || !enable) {
+    return;
+  }
+
+  // All channels get one sample per call, the first one tells when a frame is ready
+  const bool isReady = spectrumBufferAdd(&buffers[GYRO_X], sensors->gyro.x);
+  spectrumBufferAdd(&buffers[GYRO_Y], sensors->gyro.y);
+  spectrumBufferAdd(&buffers[GYRO_Z], sensors->gyro.z);
+  spectrumBufferAdd(&buffers[ACC_X], sensors->acc.x);
+  spectrumBufferAdd(&buffers[ACC_Y], sensors->acc.y);
+  spectrumBufferAdd(&buffers[ACC_Z], sensors->acc.z);
+  sampleCount++;
+
+  if (isReady) {
+    // If the task is still busy with the previous frame this one is dropped
+    xSemaphoreGive(frameReady);
+  }
+}
+
+static void vibrationTask(void* param) {
+  while (1) {
+    xSemaphoreTake(frameReady, portMAX_DELAY);
+
+    // Copy all channels at the same sample, so the frames cover the same
+    // samples. The copy takes a few us, a sample is added every ms.
+    uint32_t countBeforeCopy;
+    do {
+      countBeforeCopy = sampleCount;
+      for (int i = 0; i < CHANNEL_COUNT; i++) {
+        spectrumBufferGetFrame(&buffers[i], frames[i]);
+      }
+    } while (countBeforeCopy != sampleCount);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+      spectrumAnalyze(&spectrum, frames[i], &results[i]);
+    }
+  }
+}
+
+PARAM_GROUP_START(vibration)
+PARAM_ADD(PARAM_UINT8, enable, &enable)
+PARAM_GROUP_STOP(vibration)
+
+LOG_GROUP_START(vibGyro)
+LOG_ADD(LOG_FLOAT, xHz, &results[GYRO_X].peakFreq)
+LOG_ADD(LOG_FLOAT, yHz, &results[GYRO_Y].peakFreq)
+LOG_ADD(LOG_FLOAT, zHz, &results[GYRO_Z].peakFreq)
+LOG_ADD(LOG_FLOAT, xAmp, &results[GYRO_X].peakAmplitude)
+LOG_ADD(LOG_FLOAT, yAmp, &results[GYRO_Y].peakAmplitude)
+LOG_ADD(LOG_FLOAT, zAmp, &results[GYRO_Z].peakAmplitude)
+LOG_ADD(LOG_FLOAT, xB0, &results[GYRO_X].bandEnergy[0])
+LOG_ADD(LOG_FLOAT, xB1, &results[GYRO_X].bandEnergy[1])
+LOG_ADD(LOG_FLOAT, xB2, &results[GYRO_X].bandEnergy[2])
+LOG_ADD(LOG_FLOAT, xB3, &results[GYRO_X].bandEnergy[3])
+LOG_ADD(LOG_FLOAT, yB0, &results[GYRO_Y].bandEnergy[0])
+LOG_ADD(LOG_FLOAT, yB1, &results[GYRO_Y].bandEnergy[1])
+LOG_ADD(LOG_FLOAT, yB2, &results[GYRO_Y].bandEnergy[2])
+LOG_ADD(LOG_FLOAT, yB3, &results[GYRO_Y].bandEnergy[3])
+LOG_ADD(LOG_FLOAT, zB0, &results[GYRO_Z].bandEnergy[0])
+LOG_ADD(LOG_FLOAT, zB1, &results[GYRO_Z].bandEnergy[1])
+LOG_ADD(LOG_FLOAT, zB2, &results[GYRO_Z].bandEnergy[2])
+LOG_ADD(LOG_FLOAT, zB3, &results[GYRO_Z].bandEnergy[3])
+LOG_GROUP_STOP(vibGyro)
+
+LOG_GROUP_START(vibAcc)
+LOG_ADD(LOG_FLOAT, xHz, &results[ACC_X].peakFreq)
+LOG_ADD(LOG_FLOAT, yHz, &results[ACC_Y].peakFreq)
+LOG_ADD(LOG_FLOAT, zHz, &results[ACC_Z].peakFreq)
+LOG_ADD(LOG_FLOAT, xAmp, &results[ACC_X].peakAmplitude)
+LOG_ADD(LOG_FLOAT, yAmp, &results[ACC_Y].peakAmplitude)
+LOG_ADD(LOG_FLOAT, zAmp, &results[ACC_Z].peakAmplitude)
+LOG_ADD(LOG_FLOAT, xB0, &results[ACC_X].bandEnergy[0])
+LOG_ADD(LOG_FLOAT, xB1, &results[ACC_X].bandEnergy[1])
+LOG_ADD(LOG_FLOAT, xB2, &results[ACC_X].bandEnergy[2])
+LOG_ADD(LOG_FLOAT, xB3, &results[ACC_X].bandEnergy[3])
+LOG_ADD(LOG_FLOAT, yB0, &results[ACC_Y].bandEnergy[0])
+LOG_ADD(LOG_FLOAT, yB1, &results[ACC_Y].bandEnergy[1])
+LOG_ADD(LOG_FLOAT, yB2, &results[ACC_Y].bandEnergy[2])
+LOG_ADD(LOG_FLOAT, yB3, &results[ACC_Y].bandEnergy[3])
+LOG_ADD(LOG_FLOAT, zB0, &results[ACC_Z].bandEnergy[0])
+LOG_ADD(LOG_FLOAT, zB1, &results[ACC_Z].bandEnergy[1])
+LOG_ADD(LOG_FLOAT, zB2, &results[ACC_Z].bandEnergy[2])
+LOG_ADD(LOG_FLOAT, zB3, &results[ACC_Z].bandEnergy[3])
+LOG_GROUP_STOP(vibAcc)
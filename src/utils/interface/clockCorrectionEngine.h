@@ -13,4 +13,27 @@ double clockCorrectionEngineGet(const clockCorrectionStorage_t* storage);
 double clockCorrectionEngineCalculate(const uint64_t new_t_in_cl_reference, const uint64_t old_t_in_cl_reference, const uint64_t new_t_in_cl_x, const uint64_t old_t_in_cl_x, const uint64_t mask);
 bool clockCorrectionEngineUpdate(clockCorrectionStorage_t* storage, const double clockCorrectionCandidate);
 
+// Fixed point version of the clock correction, the ratio is stored in an
+// int64_t with CLOCK_CORRECTION_FIXED_SHIFT fractional bits. Doubles are
+// emulated in software on the Cortex-M4, the fixed point functions only use
+// integer arithmetic.
+#define CLOCK_CORRECTION_FIXED_SHIFT 48
+#define CLOCK_CORRECTION_FIXED_ONE ((int64_t)1 << CLOCK_CORRECTION_FIXED_SHIFT)
+
+// Number of fractional bits in tick values returned by clockCorrectionEngineApplyFixed()
+#define CLOCK_CORRECTION_FIXED_TICK_SHIFT 16
+
+typedef int64_t clockCorrectionFixed_t;
+
+typedef struct {
+  clockCorrectionFixed_t clockCorrection;
+  unsigned int clockCorrectionBucket;
+} clockCorrectionFixedStorage_t;
+
+clockCorrectionFixed_t clockCorrectionEngineGetFixed(const clockCorrectionFixedStorage_t* storage);
+clockCorrectionFixed_t clockCorrectionEngineCalculateFixed(const uint64_t new_t_in_cl_reference, const uint64_t old_t_in_cl_reference, const uint64_t new_t_in_cl_x, const uint64_t old_t_in_cl_x, const uint64_t mask);
+bool clockCorrectionEngineUpdateFixed(clockCorrectionFixedStorage_t* storage, const clockCorrectionFixed_t clockCorrectionCandidate);
+int64_t clockCorrectionEngineApplyFixed(const int64_t ticks, const clockCorrectionFixed_t clockCorrection);
+float clockCorrectionEngineFixedToFloat(const clockCorrectionFixed_t clockCorrection);
+
 #endif /* clockCorrectionEngine_h */
@@ -27,6 +27,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "sensor_calib.h"
+
 #ifndef __CONFIGBLOCK_H__
 #define __CONFIGBLOCK_H__
 
@@ -41,4 +43,8 @@ uint64_t configblockGetRadioAddress(void);
 float configblockGetCalibPitch(void);
 float configblockGetCalibRoll(void);
 
+/* Stored IMU calibration, kept outside of the config block */
+bool configblockGetSensorCalib(sensorCalib_t* calib);
+bool configblockSetSensorCalib(const sensorCalib_t* calib);
+
 #endif //__CONFIGBLOCK_H__
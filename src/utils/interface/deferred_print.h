@@ -0,0 +1,140 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * deferred_print.h - Binary printf records, formatted on the host
+ *
+ * Instead of formatting the text on the target, a deferred print emits a
+ * compact record with the id of the format string and the raw arguments. The
+ * format strings are placed in the .deferred_fmt section, which is not loaded
+ * to the target, and the id of a format string is its offset in the section.
+ * The section must be placed by the linker script (see sections_FLASH.ld),
+ * linking fails otherwise.
+ * The text is reconstructed on the host from the ELF file, see
+ * tools/console/deferred_console.py
+ *
+ * Record layout (little endian)
+ *   uint8_t  size       Size of the record, including this byte
+ *   uint16_t formatId   Offset of the format string in .deferred_fmt
+ *   ...                 Arguments in the order of the format string
+ *                         integers:     4 bytes, 8 bytes for long long
+ *                         float/double: 4 bytes float
+ *                         strings:      uint8_t length + characters
+ * Arguments that do not fit in the record are dropped, strings are truncated.
+ */
+
+#ifndef __DEFERRED_PRINT_H__
+#define __DEFERRED_PRINT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// A record always fits in one CRTP packet
+#define DEFERRED_PRINT_MAX_RECORD_SIZE 30
+#define DEFERRED_PRINT_HEADER_SIZE 3
+
+#define DEFERRED_PRINT_SECTION __attribute__((section(".deferred_fmt"), used))
+
+typedef struct {
+  uint8_t size;
+  bool isFull;
+  uint8_t data[DEFERRED_PRINT_MAX_RECORD_SIZE];
+} deferredPrintRecord_t;
+
+typedef void (*deferredPrintWrite_t)(const uint8_t* record, const uint8_t size);
+
+void deferredPrintBegin(deferredPrintRecord_t* record, const char* fmt);
+void deferredPrintAddInt(deferredPrintRecord_t* record, const uint32_t value);
+void deferredPrintAddInt64(deferredPrintRecord_t* record, const uint64_t value);
+void deferredPrintAddFloat(deferredPrintRecord_t* record, const float value);
+void deferredPrintAddDouble(deferredPrintRecord_t* record, const double value);
+void deferredPrintAddString(deferredPrintRecord_t* record, const char* value);
+
+// Only used to get the compiler to check the format string against the arguments
+static inline void deferredPrintCheckFormat(const char* fmt, ...) __attribute__ (( format(printf, 1, 2) ));
+static inline void deferredPrintCheckFormat(const char* fmt, ...) { (void)fmt; }
+
+#define DEFERRED_PRINT_ARG(record, arg) _Generic((arg), \
+  float: deferredPrintAddFloat, \
+  double: deferredPrintAddDouble, \
+  long long: deferredPrintAddInt64, \
+  unsigned long long: deferredPrintAddInt64, \
+  char*: deferredPrintAddString, \
+  const char*: deferredPrintAddString, \
+  default: deferredPrintAddInt)(record, arg)
+
+#define DEFERRED_PRINT_ARGS_0(r)
+#define DEFERRED_PRINT_ARGS_1(r, a) DEFERRED_PRINT_ARG(r, a);
+#define DEFERRED_PRINT_ARGS_2(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_1(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_3(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_2(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_4(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_3(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_5(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_4(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_6(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_5(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_7(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_6(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_8(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_7(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_9(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_8(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_10(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_9(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_11(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_10(r, __VA_ARGS__)
+#define DEFERRED_PRINT_ARGS_12(r, a, ...) DEFERRED_PRINT_ARG(r, a); DEFERRED_PRINT_ARGS_11(r, __VA_ARGS__)
+
+#define DEFERRED_PRINT_SELECT(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, NAME, ...) NAME
+#define DEFERRED_PRINT_ARGS(r, ...) DEFERRED_PRINT_SELECT(_0, ##__VA_ARGS__, \
+  DEFERRED_PRINT_ARGS_12, DEFERRED_PRINT_ARGS_11, DEFERRED_PRINT_ARGS_10, DEFERRED_PRINT_ARGS_9, \
+  DEFERRED_PRINT_ARGS_8, DEFERRED_PRINT_ARGS_7, DEFERRED_PRINT_ARGS_6, DEFERRED_PRINT_ARGS_5, \
+  DEFERRED_PRINT_ARGS_4, DEFERRED_PRINT_ARGS_3, DEFERRED_PRINT_ARGS_2, DEFERRED_PRINT_ARGS_1, \
+  DEFERRED_PRINT_ARGS_0)(r, ##__VA_ARGS__)
+
+/**
+ * Emit a deferred print record
+ *
+ * @param WRITE Function of type deferredPrintWrite_t that takes care of the record
+ * @param FMT Format string, must be a string literal
+ * @param ... Parameters to print, at most 12
+ */
+#define DEFERRED_PRINT(WRITE, FMT, ...) do { \
+  static const char DEFERRED_PRINT_SECTION deferredFmt[] = FMT; \
+  if (0) { \
+    deferredPrintCheckFormat(FMT, ## __VA_ARGS__); \
+  } \
+  deferredPrintRecord_t deferredRecord; \
+  deferredPrintBegin(&deferredRecord, deferredFmt); \
+  DEFERRED_PRINT_ARGS(&deferredRecord, ## __VA_ARGS__) \
+  WRITE(deferredRecord.data, deferredRecord.size); \
+} while (0)
+
+/**
+ * Emit a deferred print record for a format string without arguments
+ *
+ * Same as DEFERRED_PRINT() without parameters, but does not need an empty
+ * variadic argument list, which is not allowed in ISO C.
+ *
+ * @param WRITE Function of type deferredPrintWrite_t that takes care of the record
+ * @param FMT Format string, must be a string literal
+ */
+#define DEFERRED_PRINT_TEXT(WRITE, FMT) do { \
+  static const char DEFERRED_PRINT_SECTION deferredFmt[] = FMT; \
+  deferredPrintRecord_t deferredRecord; \
+  deferredPrintBegin(&deferredRecord, deferredFmt); \
+  WRITE(deferredRecord.data, deferredRecord.size); \
+} while (0)
+
+#endif // __DEFERRED_PRINT_H__
@@ -0,0 +1,87 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * dynamic_notch.h - Notch filter that follows the motor vibration frequency
+ *
+ * The vibration from the motors and propellers moves with the motor speed.
+ * The frequency is estimated from the mean motor command, assuming that the
+ * motor speed is proportional to the command, and one notch section of a
+ * filter bank is retuned to it. Below a minimum command (motors stopped or
+ * idling) the section passes samples through.
+ */
+#ifndef DYNAMIC_NOTCH_H_
+#define DYNAMIC_NOTCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "filter_bank.h"
+
+#define DYNAMIC_NOTCH_DEFAULT_MIN_FREQ 80.0f
+#define DYNAMIC_NOTCH_DEFAULT_MAX_FREQ 400.0f
+#define DYNAMIC_NOTCH_DEFAULT_Q 3.0f
+#define DYNAMIC_NOTCH_DEFAULT_MIN_RATIO 0.1f
+#define DYNAMIC_NOTCH_DEFAULT_SMOOTHING 0.2f
+
+// The section is only retuned when the frequency has moved more than this
+#define DYNAMIC_NOTCH_RETUNE_THRESHOLD 1.0f
+
+typedef struct {
+  bool enable;
+  float minFreq;      // Vibration frequency at a motor command of 0, Hz
+  float maxFreq;      // Vibration frequency at full motor command, Hz
+  float q;            // Quality factor of the notch
+  float minRatio;     // Motor command (0 - 1) below which the notch is off
+  float smoothing;    // Weight of a new estimate, 0 - 1
+
+  float sampleFreq;
+  int section;        // Section in the filter bank, -1 if the bank was full
+  float frequency;    // Smoothed frequency estimate, 0 when off
+  float tunedFreq;    // Frequency the section is tuned to, 0 when off
+  float tunedQ;       // Quality factor the section is tuned to
+} dynamicNotch_t;
+
+/**
+ * Initialize a dynamic notch with default parameters and add its section to
+ * a filter bank. The notch is disabled, set enable to turn it on. The section
+ * passes samples through until the first update with the notch enabled.
+ */
+void dynamicNotchInit(dynamicNotch_t* notch, filterBank_t* bank, const float sampleFreq);
+
+/**
+ * Estimate the vibration frequency from the mean motor command
+ *
+ * @param motorRatio Mean motor command, 0 - 1
+ * @return The frequency in Hz, 0 if the notch should be off
+ */
+float dynamicNotchEstimateFrequency(const dynamicNotch_t* notch, const float motorRatio);
+
+/**
+ * Update the frequency estimate and retune the section if needed. Should be
+ * called regularly, at a lower rate than the samples are filtered.
+ *
+ * @param motorRatio Mean motor command, 0 - 1
+ */
+void dynamicNotchUpdate(dynamicNotch_t* notch, filterBank_t* bank, const float motorRatio);
+
+#endif // DYNAMIC_NOTCH_H_
@@ -0,0 +1,100 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * filter_bank.h - Biquad filter bank for multi-channel data
+ *
+ * A filter bank runs the same cascade of biquad sections on a number of
+ * channels, typically the three axes of a sensor. Samples are interleaved,
+ * one frame holds one sample per channel, and all channels of a frame are
+ * filtered in one call.
+ *
+ * Sections are in transposed direct form II with the coefficient layout of
+ * the CMSIS-DSP arm_biquad_cascade_df2T_f32() function, {b0, b1, b2, a1, a2}
+ * where a1 and a2 have the opposite sign compared to the usual notation.
+ * Coefficients can be changed at runtime without resetting the state.
+ */
+#ifndef FILTER_BANK_H_
+#define FILTER_BANK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FILTER_BANK_MAX_CHANNELS 6
+#define FILTER_BANK_MAX_SECTIONS 4
+#define FILTER_BANK_COEFF_COUNT 5
+
+typedef struct {
+  uint8_t channelCount;
+  uint8_t sectionCount;
+  float coeffs[FILTER_BANK_MAX_SECTIONS][FILTER_BANK_COEFF_COUNT];
+  float state[FILTER_BANK_MAX_SECTIONS][FILTER_BANK_MAX_CHANNELS][2];
+} filterBank_t;
+
+/**
+ * Initialize an empty filter bank, with no sections it passes samples through
+ *
+ * @param bank The filter bank
+ * @param channelCount Number of channels, at most FILTER_BANK_MAX_CHANNELS
+ */
+void filterBankInit(filterBank_t* bank, const uint8_t channelCount);
+
+/**
+ * Add a 2-pole Butterworth low pass section, same response as lpf2p. A cutoff
+ * at or above the Nyquist frequency makes the section pass samples through.
+ *
+ * @return The index of the section, or -1 if the bank is full
+ */
+int filterBankAddLowPass(filterBank_t* bank, const float sampleFreq, const float cutoffFreq);
+
+/**
+ * Add a notch section
+ *
+ * @param centerFreq The frequency to reject
+ * @param q Quality factor, the -3 dB width of the notch is centerFreq / q
+ * @return The index of the section, or -1 if the bank is full
+ */
+int filterBankAddNotch(filterBank_t* bank, const float sampleFreq, const float centerFreq, const float q);
+
+/**
+ * Retune a section to a low pass or notch filter, the state is kept to avoid
+ * transients when the frequency is moved during operation.
+ */
+void filterBankSetLowPass(filterBank_t* bank, const int section, const float sampleFreq, const float cutoffFreq);
+void filterBankSetNotch(filterBank_t* bank, const int section, const float sampleFreq, const float centerFreq, const float q);
+
+/**
+ * Filter one frame, one sample per channel, in place
+ */
+void filterBankApply(filterBank_t* bank, float* frame);
+
+/**
+ * Filter a block of interleaved frames in place
+ */
+void filterBankApplyBlock(filterBank_t* bank, float* frames, const uint32_t frameCount);
+
+/**
+ * Clear the state of all channels
+ */
+void filterBankReset(filterBank_t* bank);
+
+#endif // FILTER_BANK_H_
@@ -12,3 +12,54 @@ typedef struct baseStationGeometry_s {
 } __attribute__((packed)) baseStationGeometry_t;
 
 bool lighthouseGeometryGetPosition(baseStationGeometry_t baseStations[2], float angles[4], vec3d position, float *position_delta);
+
+// Standard deviation of the sweep angles [rad], used as the lower limit of the
+// solution covariance
+#define LIGHTHOUSE_ANGLE_STD_DEV 0.0004f
+
+#define LIGHTHOUSE_GEOMETRY_MAX_SENSORS 4
+
+// Base station data that only depends on the geometry. Prepare it with
+// lighthouseGeometryPrepare() every time the geometry is updated.
+typedef struct {
+  vec3d origin;
+  vec3d axis[3];  // Columns of the rotation matrix
+} lighthouseBaseStationPrepared_t;
+
+typedef struct {
+  lighthouseBaseStationPrepared_t baseStations[2];
+} lighthouseGeometryPrepared_t;
+
+typedef struct {
+  vec3d position;       // Position of the deck reference point
+  float covariance[3][3];
+  float residual;       // RMS distance between the rays and the solution [m]
+  int rayCount;
+} lighthouseSolution_t;
+
+void lighthouseGeometryPrepare(const baseStationGeometry_t baseStations[2], lighthouseGeometryPrepared_t* prepared);
+
+/**
+ * Computes the ray from a base station that hits a sensor
+ *
+ * @param baseStation Prepared base station data
+ * @param angle1 Horizontal sweep angle
+ * @param angle2 Vertical sweep angle
+ * @param ray Output unit vector in the lighthouse coordinate system
+ */
+void lighthouseGeometryGetRay(const lighthouseBaseStationPrepared_t* baseStation, const float angle1, const float angle2, vec3d ray);
+
+/**
+ * Least squares position from the rays of all sensors and both base
+ * stations, using the known positions of the sensors. All coordinates are in
+ * the lighthouse coordinate system.
+ *
+ * @param prepared Prepared geometry
+ * @param angles Angles per sensor, [base station][axis]
+ * @param isValid True for sensors with all four angles
+ * @param sensorPositions Position of each sensor relative to the reference point
+ * @param sensorCount Number of sensors, at most LIGHTHOUSE_GEOMETRY_MAX_SENSORS
+ * @param solution Position, covariance and residual
+ * @return true if the rays give a well defined position
+ */
+bool lighthouseGeometrySolve(const lighthouseGeometryPrepared_t* prepared, float angles[][2][2], const bool isValid[], vec3d sensorPositions[], const int sensorCount, lighthouseSolution_t* solution);
@@ -0,0 +1,108 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * occupancy_grid.h - Memory bounded 2D occupancy grid
+ *
+ * A square grid of log-odds cells around the Crazyflie, built from range
+ * measurements. Each cell is one signed byte, positive means occupied and
+ * negative free, in units of 1/32 log-odds. The cells are stored in tiles of
+ * 8x8 cells, each tile is 64 consecutive bytes. Each tile has a change
+ * counter that is incremented when the tile changes, a client that keeps the
+ * counters of its last read can read the map incrementally. Reading does not
+ * change the grid, so any number of clients can read it.
+ *
+ * The grid follows the Crazyflie. When it gets too close to an edge the grid
+ * is moved by whole tiles, cells that leave the grid are forgotten. Every move
+ * increments the generation and the change counters of all tiles.
+ */
+
+#ifndef __OCCUPANCY_GRID_H__
+#define __OCCUPANCY_GRID_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Cells per side of a tile and of the grid
+#define OCCUPANCY_GRID_TILE_SIZE 8
+#define OCCUPANCY_GRID_SIZE 64
+
+#define OCCUPANCY_GRID_TILES_PER_SIDE (OCCUPANCY_GRID_SIZE / OCCUPANCY_GRID_TILE_SIZE)
+#define OCCUPANCY_GRID_TILE_COUNT (OCCUPANCY_GRID_TILES_PER_SIDE * OCCUPANCY_GRID_TILES_PER_SIDE)
+#define OCCUPANCY_GRID_TILE_BYTES (OCCUPANCY_GRID_TILE_SIZE * OCCUPANCY_GRID_TILE_SIZE)
+
+typedef struct {
+  // Settings, log-odds in units of 1/32
+  int8_t hit;          // Added to the cell where a range ends
+  int8_t miss;         // Added to the cells a range passes through
+  int8_t limit;        // Cells are clamped to +-limit
+
+  float resolution;    // m per cell
+
+  // World cell index of the first cell in the grid
+  int32_t originX;
+  int32_t originY;
+
+  uint16_t generation;
+
+  // Incremented when a tile changes, wraps around
+  uint16_t tileChanges[OCCUPANCY_GRID_TILE_COUNT];
+
+  int8_t tiles[OCCUPANCY_GRID_TILE_COUNT][OCCUPANCY_GRID_TILE_BYTES];
+} occupancyGrid_t;
+
+/**
+ * Clear the grid and center it on (0, 0)
+ *
+ * @param grid The grid
+ * @param resolution Size of a cell (m)
+ */
+void occupancyGridInit(occupancyGrid_t* grid, const float resolution);
+
+/**
+ * Move the grid by whole tiles if (x, y) is too far from the center
+ *
+ * @return true if the grid was moved
+ */
+bool occupancyGridFollow(occupancyGrid_t* grid, const float x, const float y);
+
+/**
+ * Add one range measurement. The cells between the sensor and the end of
+ * the range are made more free and the last cell more occupied. A range that
+ * is longer than maxRange did not hit anything, only the cells up to maxRange
+ * are updated, as free.
+ *
+ * @param grid The grid
+ * @param x Position of the sensor (m)
+ * @param y Position of the sensor (m)
+ * @param angle Direction of the measurement in the world frame (rad)
+ * @param range Measured range (m)
+ * @param maxRange Longest range that is trusted (m)
+ */
+void occupancyGridAddRange(occupancyGrid_t* grid, const float x, const float y, const float angle, const float range, const float maxRange);
+
+/**
+ * @return The log-odds of the cell at (x, y), 0 (unknown) if outside the grid
+ */
+int8_t occupancyGridGet(const occupancyGrid_t* grid, const float x, const float y);
+
+#endif // __OCCUPANCY_GRID_H__
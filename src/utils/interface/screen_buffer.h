@@ -0,0 +1,97 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * screen_buffer.h - Frame buffer with dirty region tracking for 128x64 displays
+ *
+ * The frame is organized as the SSD1309 memory: 8 pages of 8 pixel rows, one
+ * byte per column and page with the top row in the least significant bit.
+ *
+ * Drawing is done in a back frame. screenFrameUpdate() copies what has changed
+ * to the front frame, which mirrors the display memory and is used as DMA
+ * source, and returns the regions that must be sent to the display.
+ */
+
+#ifndef __SCREEN_BUFFER_H__
+#define __SCREEN_BUFFER_H__
+
+#include <stdint.h>
+
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 64
+#define SCREEN_PAGES (SCREEN_HEIGHT / 8)
+
+#define SCREEN_FONT_WIDTH 8
+
+typedef struct {
+  uint8_t data[SCREEN_PAGES][SCREEN_WIDTH];
+} screenFrame_t;
+
+// A region that is contiguous in the frame, and in the display memory when
+// it is in horizontal addressing mode. Several pages are always full width.
+typedef struct {
+  uint8_t firstPage;
+  uint8_t lastPage;
+  uint8_t firstColumn;
+  uint8_t lastColumn;
+} screenTransfer_t;
+
+void screenFrameClear(screenFrame_t* frame, const uint8_t value);
+
+/**
+ * Write a string with the 8x8 font. The field is cleared first, characters
+ * after the end of the string are blank.
+ *
+ * @param frame The frame to draw in
+ * @param x Left column of the field
+ * @param y Top row of the field, 0 - 63
+ * @param fieldWidth Width of the field, in characters
+ * @param text The string
+ */
+void screenFramePutString(screenFrame_t* frame, const uint8_t x, const uint8_t y, const uint8_t fieldWidth, const char* text);
+
+void screenFrameHorizontalLine(screenFrame_t* frame, const uint8_t x1, const uint8_t y, const uint8_t x2);
+
+/**
+ * Copy the changes in the back frame to the front frame
+ *
+ * Changed pages that follow each other are merged to one transfer, a single
+ * changed page is sent from the first to the last changed column.
+ *
+ * @param front The front frame, updated
+ * @param back The back frame
+ * @param transfers Filled with the regions to send, room for SCREEN_PAGES
+ * @return The number of transfers, 0 if nothing has changed
+ */
+int screenFrameUpdate(screenFrame_t* front, const screenFrame_t* back, screenTransfer_t* transfers);
+
+/**
+ * Get the data for a transfer
+ *
+ * @param front The front frame
+ * @param transfer The transfer
+ * @param size Set to the number of bytes to send
+ * @return Pointer to the first byte in the front frame
+ */
+const uint8_t* screenFrameTransferData(const screenFrame_t* front, const screenTransfer_t* transfer, uint16_t* size);
+
+#endif // __SCREEN_BUFFER_H__
@@ -0,0 +1,99 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sensor_calib.h - Reuse of a stored IMU calibration at start up
+ *
+ * The gyro bias and accelerometer scale found at start up are stored together
+ * with the IMU temperature. On the next start the stored values can be used
+ * directly, instead of waiting for a full calibration, if a short window of
+ * samples shows that the platform is still and that the sensor agrees with the
+ * stored values.
+ */
+
+#ifndef __SENSOR_CALIB_H__
+#define __SENSOR_CALIB_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Number of samples used to check a stored calibration
+#define SENSOR_CALIB_CHECK_SAMPLES 100
+
+typedef struct {
+  float gyroBias[3];  // Gyro bias in raw LSB
+  float accScale;     // Measured gravity, in g
+  float temperature;  // IMU temperature at calibration, degrees C
+} sensorCalib_t;
+
+typedef struct {
+  float maxTemperatureDiff;  // Degrees C
+  float maxGyroBiasDiff;     // Raw LSB, per axis
+  float maxGyroVariance;     // Raw LSB^2, per axis
+  float maxAccScaleDiff;     // g
+} sensorCalibLimits_t;
+
+typedef struct {
+  uint32_t count;
+  int64_t gyroSum[3];
+  int64_t gyroSumSquares[3];
+  float accScaleSum;
+} sensorCalibCheck_t;
+
+/**
+ * Check that a stored calibration has sane values, for instance after reading
+ * it from memory.
+ */
+bool sensorCalibIsPlausible(const sensorCalib_t* calib);
+
+void sensorCalibCheckInit(sensorCalibCheck_t* check);
+
+/**
+ * Add a sample to the check window
+ *
+ * @param check The check window
+ * @param gyro Raw gyro sample
+ * @param accScale Norm of the accelerometer sample, in g
+ * @return true when SENSOR_CALIB_CHECK_SAMPLES have been added
+ */
+bool sensorCalibCheckAdd(sensorCalibCheck_t* check, const int16_t gyro[3], const float accScale);
+
+/**
+ * Decide if a stored calibration can be used, based on a full check window
+ *
+ * @param check The check window
+ * @param stored The stored calibration
+ * @param temperature The current IMU temperature, degrees C
+ * @param limits Accepted differences
+ * @return true if the platform was still during the window and the stored
+ *         calibration matches the current conditions
+ */
+bool sensorCalibCheckMatches(const sensorCalibCheck_t* check, const sensorCalib_t* stored, const float temperature, const sensorCalibLimits_t* limits);
+
+/**
+ * Decide if a new calibration should replace the stored one. Small differences
+ * are ignored to avoid wearing the memory, a new calibration is stored when it
+ * differs by more than half of the limits.
+ */
+bool sensorCalibNeedsUpdate(const sensorCalib_t* stored, const sensorCalib_t* fresh, const sensorCalibLimits_t* limits);
+
+#endif // __SENSOR_CALIB_H__
@@ -0,0 +1,102 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sliding_median.h - Median of a sliding window with O(log n) updates
+ *
+ * The samples are kept in a ring buffer and indexed by two heaps that share
+ * the median as root, a max heap with the samples below the median and a min
+ * heap with the samples above it. A new sample replaces the oldest one in the
+ * same heap slot and is moved up or down, which is O(log n) in the window
+ * size, and the median is always available at the root.
+ *
+ * The median outlier filter adds the absolute deviation of each sample from
+ * the median to a second window, the median of that window is an estimate of
+ * the median absolute deviation (MAD) that is used to reject outliers.
+ */
+
+#ifndef __SLIDING_MEDIAN_H__
+#define __SLIDING_MEDIAN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SLIDING_MEDIAN_MAX_SIZE 32
+
+typedef struct {
+  float samples[SLIDING_MEDIAN_MAX_SIZE];  // Ring buffer
+  int8_t position[SLIDING_MEDIAN_MAX_SIZE]; // Heap position of each sample
+  int8_t heap[SLIDING_MEDIAN_MAX_SIZE];     // Sample index of each heap position, offset by size / 2
+  uint8_t size;
+  uint8_t count;
+  uint8_t next;
+} slidingMedian_t;
+
+typedef struct {
+  slidingMedian_t samples;
+  slidingMedian_t deviations;
+  float threshold;     // Samples further from the median than threshold * deviation are outliers
+  float minDeviation;  // Lower limit of the deviation, for samples with little or no noise
+  uint8_t minCount;    // Samples needed in the window before any sample is accepted
+} medianOutlierFilter_t;
+
+/**
+ * @param median The median
+ * @param size Size of the window, at most SLIDING_MEDIAN_MAX_SIZE
+ */
+void slidingMedianInit(slidingMedian_t* median, const uint8_t size);
+
+/**
+ * Add a sample, replacing the oldest one when the window is full
+ *
+ * @return The new median
+ */
+float slidingMedianAdd(slidingMedian_t* median, const float sample);
+
+/**
+ * @return The median of the samples in the window. For an even number of
+ * samples it is the upper of the two middle samples. 0 if there are no samples.
+ */
+float slidingMedianGet(const slidingMedian_t* median);
+
+bool slidingMedianIsFull(const slidingMedian_t* median);
+
+/**
+ * @param filter The filter
+ * @param size Size of the windows, at most SLIDING_MEDIAN_MAX_SIZE
+ * @param threshold Limit for outliers, in standard deviations
+ * @param minDeviation Lower limit of the standard deviation
+ * @param minCount Samples needed in the window before any sample is accepted, at most size
+ */
+void medianOutlierFilterInit(medianOutlierFilter_t* filter, const uint8_t size, const float threshold, const float minDeviation, const uint8_t minCount);
+
+/**
+ * Add a sample to the filter. All samples are added to the window, also the
+ * ones that are rejected, so the filter follows a real step in the input.
+ *
+ * @return true if the sample is accepted, that is the window held at least
+ * minCount samples before the sample was added and the sample is not an
+ * outlier
+ */
+bool medianOutlierFilterAdd(medianOutlierFilter_t* filter, const float sample);
+
+#endif // __SLIDING_MEDIAN_H__
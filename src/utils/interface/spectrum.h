@@ -0,0 +1,112 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * spectrum.h - Windowed FFT spectrum analysis of sampled signals
+ *
+ * A frame of SPECTRUM_FFT_SIZE samples is detrended, Hann windowed and
+ * transformed with the CMSIS-DSP real FFT. The result is the frequency and
+ * amplitude of the strongest component and the signal energy in a number of
+ * frequency bands.
+ *
+ * Frames are collected from a stream of samples with a spectrumBuffer_t, a
+ * new frame is ready every SPECTRUM_HOP_SIZE samples, giving 50% overlap
+ * between consecutive frames.
+ */
+#ifndef SPECTRUM_H_
+#define SPECTRUM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cf_math.h"
+
+#define SPECTRUM_FFT_SIZE 256
+#define SPECTRUM_HOP_SIZE (SPECTRUM_FFT_SIZE / 2)
+#define SPECTRUM_BAND_COUNT 4
+
+typedef struct {
+  float sampleFreq;
+  // Band b covers bandEdges[b] <= f < bandEdges[b + 1], in Hz
+  float bandEdges[SPECTRUM_BAND_COUNT + 1];
+
+  float window[SPECTRUM_FFT_SIZE];
+  float windowSum;
+  float windowSquareSum;
+
+  arm_rfft_fast_instance_f32 fft;
+  float fftOut[SPECTRUM_FFT_SIZE];
+} spectrum_t;
+
+typedef struct {
+  // Frequency of the strongest component, interpolated between bins (Hz)
+  float peakFreq;
+  // Amplitude of the strongest component, in the unit of the samples
+  float peakAmplitude;
+  // Mean square of the signal in each band, in the unit of the samples squared
+  float bandEnergy[SPECTRUM_BAND_COUNT];
+} spectrumResult_t;
+
+typedef struct {
+  float samples[SPECTRUM_FFT_SIZE];
+  uint16_t head;
+  uint16_t fill;
+  uint16_t sinceFrame;
+} spectrumBuffer_t;
+
+/**
+ * Initialize a spectrum analyzer
+ *
+ * @param spectrum The analyzer
+ * @param sampleFreq Sample frequency of the signal (Hz)
+ * @param bandEdges SPECTRUM_BAND_COUNT + 1 increasing band edges (Hz)
+ * @return true if the FFT could be initialized
+ */
+bool spectrumInit(spectrum_t* spectrum, const float sampleFreq, const float bandEdges[SPECTRUM_BAND_COUNT + 1]);
+
+/**
+ * Analyze one frame. The DC component is removed before the analysis and is
+ * not part of the result.
+ *
+ * @param spectrum The analyzer
+ * @param frame SPECTRUM_FFT_SIZE samples, oldest first. Used as work area, the
+ *              content is destroyed.
+ * @param result The result
+ */
+void spectrumAnalyze(spectrum_t* spectrum, float* frame, spectrumResult_t* result);
+
+void spectrumBufferInit(spectrumBuffer_t* buffer);
+
+/**
+ * Add a sample to the buffer
+ *
+ * @return true when the buffer is full and SPECTRUM_HOP_SIZE samples have been
+ *         added since the last time a frame was ready
+ */
+bool spectrumBufferAdd(spectrumBuffer_t* buffer, const float sample);
+
+/**
+ * Copy the last SPECTRUM_FFT_SIZE samples, oldest first
+ */
+void spectrumBufferGetFrame(const spectrumBuffer_t* buffer, float* frame);
+
+#endif // SPECTRUM_H_
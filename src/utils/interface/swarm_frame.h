@@ -0,0 +1,121 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * swarm_frame.h - Broadcast frames with one slot per Crazyflie
+ *
+ * A frame carries the same kind of data (poses, setpoints...) for a whole
+ * swarm and is broadcasted as a sequence of packets. Each Crazyflie has a
+ * slot in the frame, the slot is the last byte of its radio address. Slots are
+ * packed in order, packet n carries the items of slots
+ * n * itemsPerPacket to (n + 1) * itemsPerPacket - 1, so a Crazyflie only has
+ * to check the first slot of a packet to know if its item is there.
+ *
+ * Packet layout, after the type byte of the service:
+ *   uint8_t seq        Sequence number of the frame, same for all packets
+ *   uint8_t slotCount  Number of slots in the frame
+ *   uint8_t firstSlot  Slot of the first item in this packet
+ *   ...                Items, one per slot
+ *
+ * Every packet can be decoded on its own, a lost packet only affects the slots
+ * it carried. Packets of a frame older than the current one are dropped, so
+ * a late packet never overwrites newer data.
+ */
+
+#ifndef __SWARM_FRAME_H__
+#define __SWARM_FRAME_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Room for items in a CRTP packet (CRTP_MAX_DATA_SIZE), after the type byte and the header
+#define SWARM_FRAME_MAX_PAYLOAD (30 - 1 - sizeof(swarmFrameHeader_t))
+
+#define SWARM_FRAME_MAX_PACKETS 128
+
+// A frame that is older than this is taken as a restart of the sequence
+#define SWARM_FRAME_MAX_AGE 8
+
+typedef struct {
+  uint8_t seq;
+  uint8_t slotCount;
+  uint8_t firstSlot;
+} __attribute__((packed)) swarmFrameHeader_t;
+
+// 4 items per packet
+typedef struct {
+  int16_t x; // mm
+  int16_t y; // mm
+  int16_t z; // mm
+} __attribute__((packed)) swarmFramePositionItem_t;
+
+// 2 items per packet
+typedef struct {
+  int16_t x; // mm
+  int16_t y; // mm
+  int16_t z; // mm
+  uint32_t quat; // compressed quaternion, see quatcompress.h
+} __attribute__((packed)) swarmFramePoseItem_t;
+
+// 3 items per packet
+typedef struct {
+  int16_t x;   // mm
+  int16_t y;   // mm
+  int16_t z;   // mm
+  int16_t yaw; // 1/100 degree
+} __attribute__((packed)) swarmFrameSetpointItem_t;
+
+typedef struct {
+  uint8_t slot;
+
+  // Current frame
+  bool hasFrame;
+  uint8_t seq;
+  uint8_t packetCount;
+  uint8_t packetsReceived;
+  bool isSlotInFrame;
+  bool isSlotReceived;
+  uint8_t receivedMask[SWARM_FRAME_MAX_PACKETS / 8];
+
+  // Stats
+  uint32_t frameCount;       // Frames with at least one received packet
+  uint32_t frameLostCount;   // Frames with no received packet
+  uint32_t slotMissedCount;  // Frames where the packet with the slot was lost
+  uint32_t staleCount;       // Packets dropped since they belong to an old frame
+  uint8_t quality;           // % of the packets received in the last finished frame
+} swarmFrameReceiver_t;
+
+void swarmFrameReceiverInit(swarmFrameReceiver_t* receiver, const uint8_t slot);
+
+/**
+ * Handle one packet of a frame
+ *
+ * @param receiver The receiver
+ * @param data The packet data, after the type byte
+ * @param length Length of data
+ * @param itemSize Size of the items in the frame
+ * @return The item of the slot of the receiver, NULL if it is not in this
+ * packet or if the packet was dropped
+ */
+const void* swarmFrameReceiverAdd(swarmFrameReceiver_t* receiver, const uint8_t* data, const uint8_t length, const uint8_t itemSize);
+
+#endif // __SWARM_FRAME_H__
@@ -14,6 +14,9 @@ typedef struct {
   // Configuration
   tdoaEngineSendTdoaToEstimator sendTdoaToEstimator;
   double locodeckTsFreq;
+#ifdef TDOA_ENGINE_FIXED_POINT
+  float metersPerFixedTick; // Distance per fixed point tick, see CLOCK_CORRECTION_FIXED_TICK_SHIFT
+#endif
 } tdoaEngineState_t;
 
 void tdoaEngineInit(tdoaEngineState_t* state, const uint32_t now_ms, tdoaEngineSendTdoaToEstimator sendTdoaToEstimator, const double locodeckTsFreq);
@@ -4,10 +4,25 @@
 #include "stabilizer_types.h"
 #include "clockCorrectionEngine.h"
 
+// The number of anchors that can be tracked at the same time, max 255. Can be
+// increased for large anchor networks. Each anchor uses about 0.9 kB of RAM
+// (sizeof(tdoaAnchorInfo_t)), 16 anchors use 14.5 kB and 64 anchors 58 kB.
+#ifndef ANCHOR_STORAGE_COUNT
 #define ANCHOR_STORAGE_COUNT 16
+#endif
 #define REMOTE_ANCHOR_DATA_COUNT 16
 #define TOF_PER_ANCHOR_COUNT 16
 
+// Size of the direct mapped lookup hint tables, must be a power of 2
+#define TDOA_LOOKUP_HINT_COUNT 32
+
+// The clock correction is stored in fixed point when the engine is built with TDOA_ENGINE_FIXED_POINT
+#ifdef TDOA_ENGINE_FIXED_POINT
+typedef clockCorrectionFixedStorage_t tdoaClockCorrectionStorage_t;
+#else
+typedef clockCorrectionStorage_t tdoaClockCorrectionStorage_t;
+#endif
+
 
 typedef struct {
   uint8_t id; // Id of remote remote anchor
@@ -27,16 +42,24 @@ typedef struct {
   uint32_t lastUpdateTime; // The time when this anchor was updated the last time
   uint8_t id; // Anchor id
 
+  // Lookup hint for anchor ids that map to this slot (id % ANCHOR_STORAGE_COUNT),
+  // the slot where the anchor was last found. Not related to the anchor in this slot.
+  uint8_t anchorSlotHint;
+
   int64_t txTime; // Transmit time of last packet, in remote DWM clock
   int64_t rxTime; // Receive time of last packet, in local DWM clock
   uint8_t seqNr; // Sequence nr of last packet (7 bits)
 
-  clockCorrectionStorage_t clockCorrectionStorage;
+  tdoaClockCorrectionStorage_t clockCorrectionStorage;
 
   point_t position; // The coordinates of the anchor
 
   tdoaTimeOfFlight_t tof[TOF_PER_ANCHOR_COUNT];
   tdoaRemoteAnchorData_t remoteAnchorData[REMOTE_ANCHOR_DATA_COUNT];
+
+  // Lookup hints for tof and remoteAnchorData, indexed by remote anchor id
+  uint8_t tofHint[TDOA_LOOKUP_HINT_COUNT];
+  uint8_t remoteAnchorDataHint[TDOA_LOOKUP_HINT_COUNT];
 } tdoaAnchorInfo_t;
 
 typedef tdoaAnchorInfo_t tdaoAnchorInfoArray_t[ANCHOR_STORAGE_COUNT];
@@ -63,11 +86,15 @@ int64_t tdoaStorageGetRxTime(const tdoaAnchorContext_t* anchorCtx);
 int64_t tdoaStorageGetTxTime(const tdoaAnchorContext_t* anchorCtx);
 uint8_t tdoaStorageGetSeqNr(const tdoaAnchorContext_t* anchorCtx);
 uint32_t tdoaStorageGetLastUpdateTime(const tdoaAnchorContext_t* anchorCtx);
-clockCorrectionStorage_t* tdoaStorageGetClockCorrectionStorage(const tdoaAnchorContext_t* anchorCtx);
+tdoaClockCorrectionStorage_t* tdoaStorageGetClockCorrectionStorage(const tdoaAnchorContext_t* anchorCtx);
 bool tdoaStorageGetAnchorPosition(const tdoaAnchorContext_t* anchorCtx, point_t* position);
 void tdoaStorageSetAnchorPosition(tdoaAnchorContext_t* anchorCtx, const float x, const float y, const float z);
 void tdoaStorageSetRxTxData(tdoaAnchorContext_t* anchorCtx, int64_t rxTime, int64_t txTime, uint8_t seqNr);
+#ifdef TDOA_ENGINE_FIXED_POINT
+clockCorrectionFixed_t tdoaStorageGetClockCorrectionFixed(const tdoaAnchorContext_t* anchorCtx);
+#else
 double tdoaStorageGetClockCorrection(const tdoaAnchorContext_t* anchorCtx);
+#endif
 int64_t tdoaStorageGetRemoteRxTime(const tdoaAnchorContext_t* anchorCtx, const uint8_t remoteAnchor);
 void tdoaStorageSetRemoteRxTime(tdoaAnchorContext_t* anchorCtx, const uint8_t remoteAnchor, const int64_t remoteRxTime, const uint8_t remoteSeqNr);
 void tdoaStorageGetRemoteSeqNrList(const tdoaAnchorContext_t* anchorCtx, int* remoteCount, uint8_t seqNr[], uint8_t id[]);
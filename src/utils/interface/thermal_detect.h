@@ -0,0 +1,95 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * thermal_detect.h - Hot spot detection in 8x8 thermal images
+ *
+ * The images are kept in fixed point, 1/4 degree C per unit as delivered by
+ * the AMG8833. A background model is subtracted, pixels that are warmer than
+ * the background by a threshold are grouped in 4-connected blobs and the
+ * blobs are reported with their area, peak temperature and centroid.
+ */
+
+#ifndef __THERMAL_DETECT_H__
+#define __THERMAL_DETECT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define THERMAL_IMAGE_SIZE 8
+#define THERMAL_PIXELS (THERMAL_IMAGE_SIZE * THERMAL_IMAGE_SIZE)
+
+// Temperatures are in 1/4 degree C
+#define THERMAL_UNITS_PER_DEGREE 4
+
+// Fractional bits of the background model and the centroids
+#define THERMAL_FRACTION_BITS 8
+
+// Pixels in a blob follow the image 2^THERMAL_FOREGROUND_SLOWDOWN times
+// slower than the background pixels
+#define THERMAL_FOREGROUND_SLOWDOWN 4
+
+// Highest backgroundRate, the background update shifts must stay below 32
+#define THERMAL_MAX_BACKGROUND_RATE (31 - THERMAL_FOREGROUND_SLOWDOWN)
+
+typedef struct {
+  uint8_t area;        // Number of pixels
+  int16_t peak;        // Highest temperature, 1/4 degree C
+  uint16_t centroidX;  // Column, weighted by the excess temperature, Q8
+  uint16_t centroidY;  // Row, weighted by the excess temperature, Q8
+} thermalDetection_t;
+
+typedef struct {
+  // Settings
+  int16_t threshold;      // Excess temperature over the background, 1/4 degree C, >= 0
+  uint8_t minArea;        // Smaller blobs are ignored
+  uint8_t backgroundRate; // The background follows the image by 2^-backgroundRate per frame, <= THERMAL_MAX_BACKGROUND_RATE
+
+  // Background, 1/4 degree C in Q8
+  int32_t background[THERMAL_PIXELS];
+  bool hasBackground;
+
+  // Number of blobs in the last frame, including the ones not reported
+  uint8_t blobCount;
+} thermalDetector_t;
+
+void thermalDetectorInit(thermalDetector_t* detector, const int16_t threshold, const uint8_t minArea, const uint8_t backgroundRate);
+
+/**
+ * Process one frame
+ *
+ * The first frame initializes the background. After that the background is
+ * updated with all pixels, but the pixels that are part of a blob are
+ * followed 2^THERMAL_FOREGROUND_SLOWDOWN times slower. A target that moves is
+ * not absorbed into the background, while a warm object that stays in view
+ * (a radiator, a sunlit spot) fades out after a while instead of being
+ * reported forever.
+ *
+ * @param detector The detector
+ * @param image The frame, row by row
+ * @param detections Filled with the blobs with the highest peak temperatures first
+ * @param maxDetections Room in detections
+ * @return The number of detections
+ */
+int thermalDetectorUpdate(thermalDetector_t* detector, const int16_t image[THERMAL_PIXELS], thermalDetection_t* detections, const int maxDetections);
+
+#endif // __THERMAL_DETECT_H__
@@ -0,0 +1,83 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * time_sync.h - Estimation of the offset between a remote clock and the local tick
+ *
+ * Round trips are used, as in NTP. The remote side sends a request at t0
+ * (remote clock), which is received at t1 and answered at t2 (local tick).
+ * The answer is received at t3 (remote clock). The offset of the local tick
+ * relative to the remote clock is
+ *
+ *   offset = ((t1 - t0) + (t2 - t3)) / 2
+ *
+ * which is exact when the latencies in both directions are equal, and off by
+ * half the difference otherwise. The error is never larger than half the
+ * round trip delay (t3 - t0) - (t2 - t1), so the round trip with the smallest
+ * delay in a window of recent samples is used as the estimate.
+ *
+ * Both clocks are in ms and may wrap around.
+ */
+#ifndef TIME_SYNC_H_
+#define TIME_SYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIME_SYNC_WINDOW 16
+
+typedef struct {
+  int32_t offset;
+  uint32_t delay;
+} timeSyncSample_t;
+
+typedef struct {
+  timeSyncSample_t samples[TIME_SYNC_WINDOW];
+  uint8_t count;
+  uint8_t next;
+  int32_t offset;
+  uint32_t delay;
+} timeSync_t;
+
+void timeSyncInit(timeSync_t* sync);
+
+/**
+ * Add a completed round trip
+ *
+ * @param remoteTxTime Time of the remote clock when the request was sent, t0 (ms)
+ * @param localRxTime Local tick when the request was received, t1 (ms)
+ * @param localTxTime Local tick when the answer was sent, t2 (ms)
+ * @param remoteRxTime Time of the remote clock when the answer was received, t3 (ms)
+ */
+void timeSyncAddRoundTrip(timeSync_t* sync, const uint32_t remoteTxTime, const uint32_t localRxTime, const uint32_t localTxTime, const uint32_t remoteRxTime);
+
+/**
+ * @return true when at least one round trip has been added
+ */
+bool timeSyncIsValid(const timeSync_t* sync);
+
+/**
+ * Convert a time of the remote clock to local tick
+ */
+uint32_t timeSyncToLocal(const timeSync_t* sync, const uint32_t remoteTime);
+
+#endif // TIME_SYNC_H_
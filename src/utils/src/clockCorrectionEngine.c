@@ -8,6 +8,15 @@
 #define CLOCK_CORRECTION_FILTER 0.1
 #define CLOCK_CORRECTION_BUCKET_MAX 4
 
+// Constants for the fixed point implementation, folded at compile time
+#define FIXED(value) ((clockCorrectionFixed_t)((value) * CLOCK_CORRECTION_FIXED_ONE))
+#define CLOCK_CORRECTION_SPEC_MIN_FIXED FIXED(CLOCK_CORRECTION_SPEC_MIN)
+#define CLOCK_CORRECTION_SPEC_MAX_FIXED FIXED(CLOCK_CORRECTION_SPEC_MAX)
+#define CLOCK_CORRECTION_ACCEPTED_NOISE_FIXED FIXED(CLOCK_CORRECTION_ACCEPTED_NOISE)
+#define CLOCK_CORRECTION_FILTER_GAIN_SHIFT 24
+#define CLOCK_CORRECTION_FILTER_GAIN_FIXED ((int64_t)((1.0 - CLOCK_CORRECTION_FILTER) * (1 << CLOCK_CORRECTION_FILTER_GAIN_SHIFT) + 0.5))
+#define CLOCK_CORRECTION_FIXED_MAX_INTEGER_PART (INT64_MAX >> CLOCK_CORRECTION_FIXED_SHIFT)
+
 /**
  Logging all the clock correction information requires scaling the values repeatedly, which is computer intense. Thus, the logging functionality is enabled at compile time with the CLOCK_CORRECTION_ENABLE_LOGGING flag.
  */
@@ -43,18 +52,18 @@ static uint64_t truncateTimeStamp(uint64_t timeStamp, uint64_t mask) {
 /**
  Implementation of the leaky bucket algorithm. See: https://en.wikipedia.org/wiki/Leaky_bucket
  */
-static void fillClockCorrectionBucket(clockCorrectionStorage_t* storage) {
-  if (storage->clockCorrectionBucket < CLOCK_CORRECTION_BUCKET_MAX) {
-    storage->clockCorrectionBucket++;
+static void fillClockCorrectionBucket(unsigned int* bucket) {
+  if (*bucket < CLOCK_CORRECTION_BUCKET_MAX) {
+    (*bucket)++;
   }
 }
 
 /**
  Implementation of the leaky bucket algorithm. See: https://en.wikipedia.org/wiki/Leaky_bucket
  */
-static bool emptyClockCorrectionBucket(clockCorrectionStorage_t* storage) {
-  if (storage->clockCorrectionBucket > 0) {
-    storage->clockCorrectionBucket--;
+static bool emptyClockCorrectionBucket(unsigned int* bucket) {
+  if (*bucket > 0) {
+    (*bucket)--;
     return false;
   }
 
@@ -106,10 +115,10 @@ bool clockCorrectionEngineUpdate(clockCorrectionStorage_t* storage, const double
     const double newClockCorrection = currentClockCorrection * CLOCK_CORRECTION_FILTER + clockCorrectionCandidate * (1.0 - CLOCK_CORRECTION_FILTER);
 
     sampleIsReliable = true;
-    fillClockCorrectionBucket(storage);
+    fillClockCorrectionBucket(&storage->clockCorrectionBucket);
     storage->clockCorrection = newClockCorrection;
   } else {
-    const bool shouldAcceptANewClockReference = emptyClockCorrectionBucket(storage);
+    const bool shouldAcceptANewClockReference = emptyClockCorrectionBucket(&storage->clockCorrectionBucket);
     if (shouldAcceptANewClockReference) {
       if (CLOCK_CORRECTION_SPEC_MIN < clockCorrectionCandidate && clockCorrectionCandidate < CLOCK_CORRECTION_SPEC_MAX) {
         // We do not fill the bucket and accept the clock correction sample as reliable: a sample is reliable when it is in the accepted noise level (which means that we already have two or more samples that are similar) and has been LP filtered. See: https://github.com/bitcraze/crazyflie-firmware/pull/328
@@ -121,6 +130,119 @@ bool clockCorrectionEngineUpdate(clockCorrectionStorage_t* storage, const double
   return sampleIsReliable;
 }
 
+/**
+ Obtains the fixed point clock correction from a clockCorrectionFixedStorage_t object.
+ */
+clockCorrectionFixed_t clockCorrectionEngineGetFixed(const clockCorrectionFixedStorage_t* storage) {
+  return storage->clockCorrection;
+}
+
+/**
+ Fixed point version of clockCorrectionEngineCalculate(). The quotient is computed with integer long division in steps of 24 bits, the remainder is always less than the 40 bit tick count and does not overflow when shifted.
+
+ @return The clock correction with CLOCK_CORRECTION_FIXED_SHIFT fractional bits, or -1.0 (-CLOCK_CORRECTION_FIXED_ONE) if it was not possible to perform the computation.
+ */
+clockCorrectionFixed_t clockCorrectionEngineCalculateFixed(const uint64_t new_t_in_cl_reference, const uint64_t old_t_in_cl_reference, const uint64_t new_t_in_cl_x, const uint64_t old_t_in_cl_x, const uint64_t mask) {
+  uint64_t tickCount_in_cl_reference = truncateTimeStamp(new_t_in_cl_reference - old_t_in_cl_reference, mask);
+  uint64_t tickCount_in_cl_x = truncateTimeStamp(new_t_in_cl_x - old_t_in_cl_x, mask);
+
+  if (tickCount_in_cl_x == 0) {
+    return -CLOCK_CORRECTION_FIXED_ONE;
+  }
+
+  // Only needed for masks wider than the 40 bits of the DW1000 timestamps
+  while ((tickCount_in_cl_x >> 40) != 0) {
+    tickCount_in_cl_x >>= 1;
+    tickCount_in_cl_reference >>= 1;
+  }
+
+  const uint64_t integerPart = tickCount_in_cl_reference / tickCount_in_cl_x;
+  if (integerPart > CLOCK_CORRECTION_FIXED_MAX_INTEGER_PART) {
+    return -CLOCK_CORRECTION_FIXED_ONE;
+  }
+
+  uint64_t remainder = tickCount_in_cl_reference - integerPart * tickCount_in_cl_x;
+  uint64_t result = integerPart;
+  for (int i = 0; i < CLOCK_CORRECTION_FIXED_SHIFT / 24; i++) {
+    remainder <<= 24;
+    const uint64_t digits = remainder / tickCount_in_cl_x;
+    remainder -= digits * tickCount_in_cl_x;
+    result = (result << 24) + digits;
+  }
+
+  return (clockCorrectionFixed_t)result;
+}
+
+/**
+ Fixed point version of clockCorrectionEngineUpdate().
+ */
+bool clockCorrectionEngineUpdateFixed(clockCorrectionFixedStorage_t* storage, const clockCorrectionFixed_t clockCorrectionCandidate) {
+  bool sampleIsReliable = false;
+
+  const clockCorrectionFixed_t currentClockCorrection = storage->clockCorrection;
+  const clockCorrectionFixed_t difference = clockCorrectionCandidate - currentClockCorrection;
+
+#ifdef CLOCK_CORRECTION_ENABLE_LOGGING
+  logClockCorrection = scaleValueForLogging(clockCorrectionEngineFixedToFloat(currentClockCorrection));
+  logClockCorrectionCandidate = scaleValueForLogging(clockCorrectionEngineFixedToFloat(clockCorrectionCandidate));
+#endif
+
+  if (-CLOCK_CORRECTION_ACCEPTED_NOISE_FIXED < difference && difference < CLOCK_CORRECTION_ACCEPTED_NOISE_FIXED) {
+    // Simple low pass filter, the difference is small enough to be scaled without overflow
+    const clockCorrectionFixed_t newClockCorrection = currentClockCorrection + ((difference * CLOCK_CORRECTION_FILTER_GAIN_FIXED) >> CLOCK_CORRECTION_FILTER_GAIN_SHIFT);
+
+    sampleIsReliable = true;
+    fillClockCorrectionBucket(&storage->clockCorrectionBucket);
+    storage->clockCorrection = newClockCorrection;
+  } else {
+    const bool shouldAcceptANewClockReference = emptyClockCorrectionBucket(&storage->clockCorrectionBucket);
+    if (shouldAcceptANewClockReference) {
+      if (CLOCK_CORRECTION_SPEC_MIN_FIXED < clockCorrectionCandidate && clockCorrectionCandidate < CLOCK_CORRECTION_SPEC_MAX_FIXED) {
+        storage->clockCorrection = clockCorrectionCandidate;
+      }
+    }
+  }
+
+  return sampleIsReliable;
+}
+
+/**
+ Multiplies a tick count with a fixed point clock correction. The 128 bit product is built from 32 bit partial products, which maps to a few UMULL/UMLAL instructions on the Cortex-M4.
+
+ @return ticks * clockCorrection with CLOCK_CORRECTION_FIXED_TICK_SHIFT fractional bits, truncated towards zero
+ */
+int64_t clockCorrectionEngineApplyFixed(const int64_t ticks, const clockCorrectionFixed_t clockCorrection) {
+  const bool isNegative = (ticks < 0) != (clockCorrection < 0);
+  const uint64_t a = ticks < 0 ? -(uint64_t)ticks : (uint64_t)ticks;
+  const uint64_t b = clockCorrection < 0 ? -(uint64_t)clockCorrection : (uint64_t)clockCorrection;
+
+  const uint64_t aLow = a & 0xffffffff;
+  const uint64_t aHigh = a >> 32;
+  const uint64_t bLow = b & 0xffffffff;
+  const uint64_t bHigh = b >> 32;
+
+  const uint64_t lowLow = aLow * bLow;
+  const uint64_t highLow = aHigh * bLow;
+  const uint64_t lowHigh = aLow * bHigh;
+  const uint64_t highHigh = aHigh * bHigh;
+
+  const uint64_t middle = (lowLow >> 32) + (highLow & 0xffffffff) + (lowHigh & 0xffffffff);
+  const uint64_t productHigh = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+  const uint64_t productLow = (middle << 32) | (lowLow & 0xffffffff);
+
+  const int shift = CLOCK_CORRECTION_FIXED_SHIFT - CLOCK_CORRECTION_FIXED_TICK_SHIFT;
+  const uint64_t result = (productHigh << (64 - shift)) | (productLow >> shift);
+
+  return isNegative ? -(int64_t)result : (int64_t)result;
+}
+
+/**
+ Converts a fixed point clock correction to float, for logging.
+ */
+float clockCorrectionEngineFixedToFloat(const clockCorrectionFixed_t clockCorrection) {
+  return (float)clockCorrection * (1.0f / CLOCK_CORRECTION_FIXED_ONE);
+}
+
 #ifdef CLOCK_CORRECTION_ENABLE_LOGGING
 LOG_GROUP_START(CkCorrection)
 LOG_ADD(LOG_FLOAT, minNoise, &logMinAcceptedNoiseLimit)
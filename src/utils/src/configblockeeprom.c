@@ -89,6 +89,27 @@ static configblock_t configblockDefault =
     .radioAddress_lower = (RADIO_ADDRESS & 0xFFFFFFFFULL),
 };
 
+/* Sensor calibration, stored at the end of the eeprom. It is not part of the
+ * config block to keep the config block format the same for clients. */
+#define SENSOR_CALIB_MAGIC 0x53434c30
+#define SENSOR_CALIB_VERSION 1
+#define SENSOR_CALIB_ADDRESS (EEPROM_SIZE + 1 - 0x40)
+
+typedef struct {
+  /* header */
+  uint32_t magic;
+  uint8_t  version;
+  /* Content */
+  float gyroBias[3];
+  float accScale;
+  float temperature;
+  /* Simple modulo 256 checksum */
+  uint8_t cksum;
+} __attribute__((__packed__)) sensorCalibBlock_t;
+
+static sensorCalibBlock_t sensorCalibBlock;
+static bool sensorCalibOk = false;
+
 static const uint32_t configblockSizes[] =
 {
   sizeof(struct configblock_v0_s),
@@ -104,6 +125,7 @@ static bool configblockCheckChecksum(configblock_t *configblock);
 static bool configblockCheckDataIntegrity(uint8_t *data, uint8_t version);
 static bool configblockWrite(configblock_t *configblock);
 static bool configblockCopyToNewVersion(configblock_t *configblockSaved, configblock_t *configblockNew);
+static void sensorCalibRead(void);
 
 static uint8_t calculate_cksum(void* data, size_t len)
 {
@@ -191,6 +213,8 @@ int configblockInit(void)
     }
   }
 
+  sensorCalibRead();
+
   isInit = true;
 
   return 0;
@@ -246,6 +270,17 @@ static bool configblockWrite(configblock_t *configblock)
   return true;
 }
 
+static void sensorCalibRead(void)
+{
+  sensorCalibOk = false;
+  if (eepromReadBuffer((uint8_t *)&sensorCalibBlock, SENSOR_CALIB_ADDRESS, sizeof(sensorCalibBlock)))
+  {
+    sensorCalibOk = (sensorCalibBlock.magic == SENSOR_CALIB_MAGIC &&
+                     sensorCalibBlock.version == SENSOR_CALIB_VERSION &&
+                     sensorCalibBlock.cksum == calculate_cksum(&sensorCalibBlock, sizeof(sensorCalibBlock) - 1));
+  }
+}
+
 static bool configblockCopyToNewVersion(configblock_t *configblockSaved, configblock_t *configblockNew)
 {
   configblock_t configblockTmp;
@@ -311,3 +346,38 @@ float configblockGetCalibRoll(void)
   else
     return 0;
 }
+
+bool configblockGetSensorCalib(sensorCalib_t* calib)
+{
+  if (!sensorCalibOk)
+  {
+    return false;
+  }
+
+  memcpy(calib->gyroBias, sensorCalibBlock.gyroBias, sizeof(calib->gyroBias));
+  calib->accScale = sensorCalibBlock.accScale;
+  calib->temperature = sensorCalibBlock.temperature;
+
+  return true;
+}
+
+/* Slow, the eeprom is written one byte at the time. Should not be called from
+ * a time critical task. */
+bool configblockSetSensorCalib(const sensorCalib_t* calib)
+{
+  if (!isInit)
+  {
+    return false;
+  }
+
+  sensorCalibBlock.magic = SENSOR_CALIB_MAGIC;
+  sensorCalibBlock.version = SENSOR_CALIB_VERSION;
+  memcpy(sensorCalibBlock.gyroBias, calib->gyroBias, sizeof(sensorCalibBlock.gyroBias));
+  sensorCalibBlock.accScale = calib->accScale;
+  sensorCalibBlock.temperature = calib->temperature;
+  sensorCalibBlock.cksum = calculate_cksum(&sensorCalibBlock, sizeof(sensorCalibBlock) - 1);
+
+  sensorCalibOk = eepromWriteBuffer((uint8_t *)&sensorCalibBlock, SENSOR_CALIB_ADDRESS, sizeof(sensorCalibBlock));
+
+  return sensorCalibOk;
+}
@@ -0,0 +1,96 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * deferred_print.c - Binary printf records, formatted on the host
+ */
+
+#include <string.h>
+
+#include "deferred_print.h"
+
+#ifndef UNIT_TEST_MODE
+// Start of the .deferred_fmt section, defined in the linker script
+// (sections_FLASH.ld). Linking fails with an undefined reference when deferred
+// prints are used with a linker script that does not place the section.
+extern const char _deferred_fmt_start[];
+#define DEFERRED_FMT_START ((uintptr_t)_deferred_fmt_start)
+#else
+#define DEFERRED_FMT_START ((uintptr_t)0)
+#endif
+
+static void addBytes(deferredPrintRecord_t* record, const void* data, const uint8_t size) {
+  if (!record->isFull && record->size + size <= DEFERRED_PRINT_MAX_RECORD_SIZE) {
+    memcpy(&record->data[record->size], data, size);
+    record->size += size;
+    record->data[0] = record->size;
+  } else {
+    // Does not fit, make sure following arguments are not added either
+    record->isFull = true;
+  }
+}
+
+void deferredPrintBegin(deferredPrintRecord_t* record, const char* fmt) {
+  // The id is the offset in the (non-loaded) .deferred_fmt section
+  const uint16_t formatId = (uint16_t)((uintptr_t)fmt - DEFERRED_FMT_START);
+
+  record->data[0] = DEFERRED_PRINT_HEADER_SIZE;
+  memcpy(&record->data[1], &formatId, sizeof(formatId));
+  record->size = DEFERRED_PRINT_HEADER_SIZE;
+  record->isFull = false;
+}
+
+void deferredPrintAddInt(deferredPrintRecord_t* record, const uint32_t value) {
+  addBytes(record, &value, sizeof(value));
+}
+
+void deferredPrintAddInt64(deferredPrintRecord_t* record, const uint64_t value) {
+  addBytes(record, &value, sizeof(value));
+}
+
+void deferredPrintAddFloat(deferredPrintRecord_t* record, const float value) {
+  addBytes(record, &value, sizeof(value));
+}
+
+void deferredPrintAddDouble(deferredPrintRecord_t* record, const double value) {
+  deferredPrintAddFloat(record, (float)value);
+}
+
+void deferredPrintAddString(deferredPrintRecord_t* record, const char* value) {
+  if (record->isFull || record->size >= DEFERRED_PRINT_MAX_RECORD_SIZE) {
+    record->isFull = true;
+    return;
+  }
+
+  // Truncate to the space left in the record
+  const uint8_t maxLength = DEFERRED_PRINT_MAX_RECORD_SIZE - record->size - 1;
+  uint8_t length = 0;
+  while (length < maxLength && value[length]) {
+    length++;
+  }
+
+  record->data[record->size] = length;
+  record->size++;
+  memcpy(&record->data[record->size], value, length);
+  record->size += length;
+  record->data[0] = record->size;
+}
@@ -0,0 +1,82 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * dynamic_notch.c - Notch filter that follows the motor vibration frequency
+ */
+
+#include <math.h>
+
+#include "dynamic_notch.h"
+
+void dynamicNotchInit(dynamicNotch_t* notch, filterBank_t* bank, const float sampleFreq) {
+  // Opt-in, the section passes samples through until enabled
+  notch->enable = false;
+  notch->minFreq = DYNAMIC_NOTCH_DEFAULT_MIN_FREQ;
+  notch->maxFreq = DYNAMIC_NOTCH_DEFAULT_MAX_FREQ;
+  notch->q = DYNAMIC_NOTCH_DEFAULT_Q;
+  notch->minRatio = DYNAMIC_NOTCH_DEFAULT_MIN_RATIO;
+  notch->smoothing = DYNAMIC_NOTCH_DEFAULT_SMOOTHING;
+
+  notch->sampleFreq = sampleFreq;
+  notch->frequency = 0.0f;
+  notch->tunedFreq = 0.0f;
+  notch->tunedQ = notch->q;
+
+  // A center frequency of 0 makes the section pass samples through
+  notch->section = filterBankAddNotch(bank, sampleFreq, 0.0f, notch->q);
+}
+
+float dynamicNotchEstimateFrequency(const dynamicNotch_t* notch, const float motorRatio) {
+  if (!notch->enable || motorRatio < notch->minRatio) {
+    return 0.0f;
+  }
+
+  const float ratio = fminf(motorRatio, 1.0f);
+  return notch->minFreq + (notch->maxFreq - notch->minFreq) * ratio;
+}
+
+void dynamicNotchUpdate(dynamicNotch_t* notch, filterBank_t* bank, const float motorRatio) {
+  if (notch->section < 0) {
+    return;
+  }
+
+  const float estimate = dynamicNotchEstimateFrequency(notch, motorRatio);
+  if (estimate == 0.0f) {
+    notch->frequency = 0.0f;
+  } else if (notch->frequency == 0.0f) {
+    // Start from the estimate when the motors spin up
+    notch->frequency = estimate;
+  } else {
+    notch->frequency += notch->smoothing * (estimate - notch->frequency);
+  }
+
+  // Retuning is expensive (trigonometric functions), skip small changes
+  const bool isOff = (notch->frequency == 0.0f);
+  const bool wasOff = (notch->tunedFreq == 0.0f);
+  if (isOff != wasOff || fabsf(notch->frequency - notch->tunedFreq) > DYNAMIC_NOTCH_RETUNE_THRESHOLD ||
+      notch->q != notch->tunedQ) {
+    filterBankSetNotch(bank, notch->section, notch->sampleFreq, notch->frequency, notch->q);
+    notch->tunedFreq = notch->frequency;
+    notch->tunedQ = notch->q;
+  }
+}
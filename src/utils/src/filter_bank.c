@@ -0,0 +1,159 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * filter_bank.c - Biquad filter bank for multi-channel data
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "filter_bank.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define M_PI_F (float)M_PI
+
+enum {
+  B0 = 0,
+  B1,
+  B2,
+  A1,
+  A2,
+};
+
+void filterBankInit(filterBank_t* bank, const uint8_t channelCount) {
+  memset(bank, 0, sizeof(filterBank_t));
+  bank->channelCount = channelCount < FILTER_BANK_MAX_CHANNELS ? channelCount : FILTER_BANK_MAX_CHANNELS;
+}
+
+static int addSection(filterBank_t* bank) {
+  if (bank->sectionCount >= FILTER_BANK_MAX_SECTIONS) {
+    return -1;
+  }
+
+  const int section = bank->sectionCount;
+  memset(bank->state[section], 0, sizeof(bank->state[section]));
+  bank->sectionCount++;
+  return section;
+}
+
+int filterBankAddLowPass(filterBank_t* bank, const float sampleFreq, const float cutoffFreq) {
+  const int section = addSection(bank);
+  if (section >= 0) {
+    filterBankSetLowPass(bank, section, sampleFreq, cutoffFreq);
+  }
+  return section;
+}
+
+int filterBankAddNotch(filterBank_t* bank, const float sampleFreq, const float centerFreq, const float q) {
+  const int section = addSection(bank);
+  if (section >= 0) {
+    filterBankSetNotch(bank, section, sampleFreq, centerFreq, q);
+  }
+  return section;
+}
+
+static void setPassThrough(float* coeffs) {
+  coeffs[B0] = 1.0f;
+  coeffs[B1] = 0.0f;
+  coeffs[B2] = 0.0f;
+  coeffs[A1] = 0.0f;
+  coeffs[A2] = 0.0f;
+}
+
+void filterBankSetLowPass(filterBank_t* bank, const int section, const float sampleFreq, const float cutoffFreq) {
+  float* coeffs = bank->coeffs[section];
+  if (cutoffFreq <= 0.0f || cutoffFreq >= sampleFreq / 2.0f) {
+    setPassThrough(coeffs);
+    return;
+  }
+
+  // Same as lpf2pSetCutoffFreq()
+  const float ohm = tanf(M_PI_F * cutoffFreq / sampleFreq);
+  const float c = 1.0f + 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm;
+  coeffs[B0] = ohm * ohm / c;
+  coeffs[B1] = 2.0f * coeffs[B0];
+  coeffs[B2] = coeffs[B0];
+  coeffs[A1] = -2.0f * (ohm * ohm - 1.0f) / c;
+  coeffs[A2] = -(1.0f - 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm) / c;
+}
+
+void filterBankSetNotch(filterBank_t* bank, const int section, const float sampleFreq, const float centerFreq, const float q) {
+  float* coeffs = bank->coeffs[section];
+  if (centerFreq <= 0.0f || centerFreq >= sampleFreq / 2.0f || q <= 0.0f) {
+    setPassThrough(coeffs);
+    return;
+  }
+
+  const float omega = 2.0f * M_PI_F * centerFreq / sampleFreq;
+  const float alpha = sinf(omega) / (2.0f * q);
+  const float cosOmega = cosf(omega);
+  const float a0 = 1.0f + alpha;
+  coeffs[B0] = 1.0f / a0;
+  coeffs[B1] = -2.0f * cosOmega / a0;
+  coeffs[B2] = coeffs[B0];
+  coeffs[A1] = 2.0f * cosOmega / a0;
+  coeffs[A2] = -(1.0f - alpha) / a0;
+}
+
+void filterBankApply(filterBank_t* bank, float* frame) {
+  const uint8_t channelCount = bank->channelCount;
+  const uint8_t sectionCount = bank->sectionCount;
+
+  for (int ch = 0; ch < channelCount; ch++) {
+    const float input = frame[ch];
+    float x = input;
+
+    for (int s = 0; s < sectionCount; s++) {
+      const float* c = bank->coeffs[s];
+      float* d = bank->state[s][ch];
+      const float y = c[B0] * x + d[0];
+      d[0] = c[B1] * x + c[A1] * y + d[1];
+      d[1] = c[B2] * x + c[A2] * y;
+      x = y;
+    }
+
+    if (!isfinite(x)) {
+      // don't allow bad values to propagate via the filter
+      for (int s = 0; s < sectionCount; s++) {
+        bank->state[s][ch][0] = 0.0f;
+        bank->state[s][ch][1] = 0.0f;
+      }
+      x = input;
+    }
+
+    frame[ch] = x;
+  }
+}
+
+void filterBankApplyBlock(filterBank_t* bank, float* frames, const uint32_t frameCount) {
+  for (uint32_t i = 0; i < frameCount; i++) {
+    filterBankApply(bank, &frames[i * bank->channelCount]);
+  }
+}
+
+void filterBankReset(filterBank_t* bank) {
+  memset(bank->state, 0, sizeof(bank->state));
+}
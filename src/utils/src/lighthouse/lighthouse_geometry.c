@@ -36,6 +36,7 @@
 
 #include "lighthouse_geometry.h"
 
+#include <string.h>
 #include <arm_math.h>
 
 static void vec_cross_product(const vec3d a, const vec3d b, vec3d res) {
@@ -127,3 +128,145 @@ bool lighthouseGeometryGetPosition(baseStationGeometry_t baseStations[2], float
 
   return intersect_lines(origin1, ray1, origin2, ray2, position, position_delta);
 }
+
+void lighthouseGeometryPrepare(const baseStationGeometry_t baseStations[2], lighthouseGeometryPrepared_t* prepared) {
+  for (int bs = 0; bs < 2; bs++) {
+    lighthouseBaseStationPrepared_t* p = &prepared->baseStations[bs];
+    for (int i = 0; i < 3; i++) {
+      p->origin[i] = baseStations[bs].origin[i];
+      for (int col = 0; col < 3; col++) {
+        p->axis[col][i] = baseStations[bs].mat[i][col];
+      }
+    }
+  }
+}
+
+void lighthouseGeometryGetRay(const lighthouseBaseStationPrepared_t* baseStation, const float angle1, const float angle2, vec3d ray) {
+  const float s1 = arm_sin_f32(angle1);
+  const float c1 = arm_cos_f32(angle1);
+  const float s2 = arm_sin_f32(angle2);
+  const float c2 = arm_cos_f32(angle2);
+
+  // Intersection of the two sweep planes in the base station frame, same as
+  // in calc_ray_vec(), then rotated by a linear combination of the columns
+  const float local[3] = {-c2 * s1, c1 * s2, -c1 * c2};
+  float len;
+  arm_sqrt_f32(local[0] * local[0] + local[1] * local[1] + local[2] * local[2], &len);
+  const float scale = 1.0f / len;
+
+  for (int i = 0; i < 3; i++) {
+    ray[i] = (local[0] * baseStation->axis[0][i] + local[1] * baseStation->axis[1][i] + local[2] * baseStation->axis[2][i]) * scale;
+  }
+}
+
+bool lighthouseGeometrySolve(const lighthouseGeometryPrepared_t* prepared, float angles[][2][2], const bool isValid[], vec3d sensorPositions[], const int sensorCount, lighthouseSolution_t* solution) {
+  // Each ray (origin o, direction d) hitting sensor s at position p + s gives
+  // (I - dd')(p + s - o) = 0. The normal equations of all rays are
+  // sum(I - dd') p = sum((I - dd')(o - s)), a 3x3 system.
+  float a[3][3] = {{0}};
+  float b[3] = {0};
+  vec3d rays[2 * LIGHTHOUSE_GEOMETRY_MAX_SENSORS];
+  int rayCount = 0;
+
+  if (sensorCount > LIGHTHOUSE_GEOMETRY_MAX_SENSORS) {
+    return false;
+  }
+
+  for (int sensor = 0; sensor < sensorCount; sensor++) {
+    if (!isValid[sensor]) {
+      continue;
+    }
+
+    for (int bs = 0; bs < 2; bs++) {
+      const lighthouseBaseStationPrepared_t* baseStation = &prepared->baseStations[bs];
+      float* d = rays[rayCount];
+      lighthouseGeometryGetRay(baseStation, angles[sensor][bs][0], angles[sensor][bs][1], d);
+
+      vec3d q;
+      for (int i = 0; i < 3; i++) {
+        q[i] = baseStation->origin[i] - sensorPositions[sensor][i];
+      }
+      const float dq = d[0] * q[0] + d[1] * q[1] + d[2] * q[2];
+
+      for (int i = 0; i < 3; i++) {
+        b[i] += q[i] - d[i] * dq;
+        for (int j = 0; j < 3; j++) {
+          a[i][j] -= d[i] * d[j];
+        }
+        a[i][i] += 1.0f;
+      }
+
+      rayCount++;
+    }
+  }
+
+  solution->rayCount = rayCount;
+  if (rayCount < 2) {
+    return false;
+  }
+
+  // Closed form inverse of the symmetric matrix
+  float inv[3][3];
+  inv[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+  inv[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+  inv[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+  inv[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+  inv[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+  inv[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+  inv[1][0] = inv[0][1];
+  inv[2][0] = inv[0][2];
+  inv[2][1] = inv[1][2];
+
+  const float det = a[0][0] * inv[0][0] + a[0][1] * inv[1][0] + a[0][2] * inv[2][0];
+  // The determinant is small when all rays are close to parallel
+  if (det < 1e-3f) {
+    return false;
+  }
+
+  const float invDet = 1.0f / det;
+  for (int i = 0; i < 3; i++) {
+    solution->position[i] = (inv[i][0] * b[0] + inv[i][1] * b[1] + inv[i][2] * b[2]) * invDet;
+  }
+
+  // Residual and mean range, for the covariance
+  float sumSquares = 0.0f;
+  float sumRangeSquares = 0.0f;
+  rayCount = 0;
+  for (int sensor = 0; sensor < sensorCount; sensor++) {
+    if (!isValid[sensor]) {
+      continue;
+    }
+
+    for (int bs = 0; bs < 2; bs++) {
+      const float* d = rays[rayCount];
+      vec3d w;
+      for (int i = 0; i < 3; i++) {
+        w[i] = solution->position[i] + sensorPositions[sensor][i] - prepared->baseStations[bs].origin[i];
+      }
+      const float dw = d[0] * w[0] + d[1] * w[1] + d[2] * w[2];
+      const float ww = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+      sumSquares += ww - dw * dw;
+      sumRangeSquares += ww;
+
+      rayCount++;
+    }
+  }
+
+  float residualSquared = sumSquares / rayCount;
+  arm_sqrt_f32(residualSquared, &solution->residual);
+
+  // Each ray constrains two directions, three are used by the position
+  float variance = sumSquares / (2 * rayCount - 3);
+  const float angleVariance = LIGHTHOUSE_ANGLE_STD_DEV * LIGHTHOUSE_ANGLE_STD_DEV * sumRangeSquares / rayCount;
+  if (variance < angleVariance) {
+    variance = angleVariance;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      solution->covariance[i][j] = variance * inv[i][j] * invDet;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,178 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * occupancy_grid.c - Memory bounded 2D occupancy grid
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "occupancy_grid.h"
+
+// The grid is moved when the Crazyflie gets closer than this to an edge (cells)
+#define FOLLOW_MARGIN (2 * OCCUPANCY_GRID_TILE_SIZE)
+
+// Default log-odds, 1/32 units. Roughly p = 0.7 for a hit and p = 0.4 for a miss
+#define DEFAULT_HIT 27
+#define DEFAULT_MISS (-13)
+#define DEFAULT_LIMIT 127
+
+static int32_t floorDiv(const int32_t a, const int32_t b) {
+  int32_t result = a / b;
+  if ((a % b != 0) && (a < 0)) {
+    result--;
+  }
+  return result;
+}
+
+static int32_t toWorldCell(const occupancyGrid_t* grid, const float value) {
+  return (int32_t)floorf(value / grid->resolution);
+}
+
+static bool isInGrid(const int32_t cx, const int32_t cy) {
+  return cx >= 0 && cx < OCCUPANCY_GRID_SIZE && cy >= 0 && cy < OCCUPANCY_GRID_SIZE;
+}
+
+static int tileIndex(const int32_t cx, const int32_t cy) {
+  return (cy / OCCUPANCY_GRID_TILE_SIZE) * OCCUPANCY_GRID_TILES_PER_SIDE + cx / OCCUPANCY_GRID_TILE_SIZE;
+}
+
+static int cellIndex(const int32_t cx, const int32_t cy) {
+  return (cy % OCCUPANCY_GRID_TILE_SIZE) * OCCUPANCY_GRID_TILE_SIZE + cx % OCCUPANCY_GRID_TILE_SIZE;
+}
+
+static void updateCell(occupancyGrid_t* grid, const int32_t cx, const int32_t cy, const int8_t delta) {
+  int8_t* value = &grid->tiles[tileIndex(cx, cy)][cellIndex(cx, cy)];
+
+  int32_t updated = *value + delta;
+  if (updated > grid->limit) {
+    updated = grid->limit;
+  } else if (updated < -grid->limit) {
+    updated = -grid->limit;
+  }
+
+  // Cells that are saturated do not change the tile
+  if (updated != *value) {
+    *value = (int8_t)updated;
+    grid->tileChanges[tileIndex(cx, cy)]++;
+  }
+}
+
+void occupancyGridInit(occupancyGrid_t* grid, const float resolution) {
+  memset(grid, 0, sizeof(occupancyGrid_t));
+  grid->hit = DEFAULT_HIT;
+  grid->miss = DEFAULT_MISS;
+  grid->limit = DEFAULT_LIMIT;
+  grid->resolution = resolution;
+  grid->originX = -OCCUPANCY_GRID_SIZE / 2;
+  grid->originY = -OCCUPANCY_GRID_SIZE / 2;
+}
+
+bool occupancyGridFollow(occupancyGrid_t* grid, const float x, const float y) {
+  const int32_t cx = toWorldCell(grid, x) - grid->originX;
+  const int32_t cy = toWorldCell(grid, y) - grid->originY;
+
+  if (cx >= FOLLOW_MARGIN && cx < OCCUPANCY_GRID_SIZE - FOLLOW_MARGIN &&
+      cy >= FOLLOW_MARGIN && cy < OCCUPANCY_GRID_SIZE - FOLLOW_MARGIN) {
+    return false;
+  }
+
+  // Move by whole tiles to get the Crazyflie back to the center
+  const int32_t dtx = floorDiv(cx - OCCUPANCY_GRID_SIZE / 2, OCCUPANCY_GRID_TILE_SIZE);
+  const int32_t dty = floorDiv(cy - OCCUPANCY_GRID_SIZE / 2, OCCUPANCY_GRID_TILE_SIZE);
+
+  // Tile n gets the content of tile n + shift. Copy in the direction that
+  // does not overwrite tiles that are still to be copied.
+  const int shift = dty * OCCUPANCY_GRID_TILES_PER_SIDE + dtx;
+  for (int i = 0; i < OCCUPANCY_GRID_TILE_COUNT; i++) {
+    const int n = (shift > 0) ? i : (OCCUPANCY_GRID_TILE_COUNT - 1 - i);
+    const int32_t sourceX = n % OCCUPANCY_GRID_TILES_PER_SIDE + dtx;
+    const int32_t sourceY = n / OCCUPANCY_GRID_TILES_PER_SIDE + dty;
+
+    if (sourceX >= 0 && sourceX < OCCUPANCY_GRID_TILES_PER_SIDE &&
+        sourceY >= 0 && sourceY < OCCUPANCY_GRID_TILES_PER_SIDE) {
+      memcpy(grid->tiles[n], grid->tiles[n + shift], OCCUPANCY_GRID_TILE_BYTES);
+    } else {
+      memset(grid->tiles[n], 0, OCCUPANCY_GRID_TILE_BYTES);
+    }
+  }
+
+  grid->originX += dtx * OCCUPANCY_GRID_TILE_SIZE;
+  grid->originY += dty * OCCUPANCY_GRID_TILE_SIZE;
+  grid->generation++;
+  for (int i = 0; i < OCCUPANCY_GRID_TILE_COUNT; i++) {
+    grid->tileChanges[i]++;
+  }
+
+  return true;
+}
+
+void occupancyGridAddRange(occupancyGrid_t* grid, const float x, const float y, const float angle, const float range, const float maxRange) {
+  const bool isHit = range <= maxRange;
+  const float length = isHit ? range : maxRange;
+
+  int32_t cx = toWorldCell(grid, x) - grid->originX;
+  int32_t cy = toWorldCell(grid, y) - grid->originY;
+  const int32_t endX = toWorldCell(grid, x + length * cosf(angle)) - grid->originX;
+  const int32_t endY = toWorldCell(grid, y + length * sinf(angle)) - grid->originY;
+
+  // Bresenham from the sensor to the end of the range
+  const int32_t dx = abs(endX - cx);
+  const int32_t dy = -abs(endY - cy);
+  const int32_t stepX = (cx < endX) ? 1 : -1;
+  const int32_t stepY = (cy < endY) ? 1 : -1;
+  int32_t error = dx + dy;
+
+  while (cx != endX || cy != endY) {
+    // The start may be outside the grid and the line enter it later
+    if (isInGrid(cx, cy)) {
+      updateCell(grid, cx, cy, grid->miss);
+    }
+
+    const int32_t error2 = 2 * error;
+    if (error2 >= dy) {
+      error += dy;
+      cx += stepX;
+    }
+    if (error2 <= dx) {
+      error += dx;
+      cy += stepY;
+    }
+  }
+
+  if (isInGrid(cx, cy)) {
+    updateCell(grid, cx, cy, isHit ? grid->hit : grid->miss);
+  }
+}
+
+int8_t occupancyGridGet(const occupancyGrid_t* grid, const float x, const float y) {
+  const int32_t cx = toWorldCell(grid, x) - grid->originX;
+  const int32_t cy = toWorldCell(grid, y) - grid->originY;
+
+  if (!isInGrid(cx, cy)) {
+    return 0;
+  }
+
+  return grid->tiles[tileIndex(cx, cy)][cellIndex(cx, cy)];
+}
@@ -0,0 +1,102 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sensor_calib.c - Reuse of a stored IMU calibration at start up
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sensor_calib.h"
+
+// Accelerometer scales outside this range are not reasonable
+#define ACC_SCALE_MIN 0.8f
+#define ACC_SCALE_MAX 1.2f
+
+bool sensorCalibIsPlausible(const sensorCalib_t* calib) {
+  for (int i = 0; i < 3; i++) {
+    if (!isfinite(calib->gyroBias[i])) {
+      return false;
+    }
+  }
+
+  return isfinite(calib->temperature) &&
+         calib->accScale > ACC_SCALE_MIN && calib->accScale < ACC_SCALE_MAX;
+}
+
+void sensorCalibCheckInit(sensorCalibCheck_t* check) {
+  memset(check, 0, sizeof(sensorCalibCheck_t));
+}
+
+bool sensorCalibCheckAdd(sensorCalibCheck_t* check, const int16_t gyro[3], const float accScale) {
+  if (check->count < SENSOR_CALIB_CHECK_SAMPLES) {
+    for (int i = 0; i < 3; i++) {
+      check->gyroSum[i] += gyro[i];
+      check->gyroSumSquares[i] += (int32_t)gyro[i] * gyro[i];
+    }
+    check->accScaleSum += accScale;
+    check->count++;
+  }
+
+  return check->count == SENSOR_CALIB_CHECK_SAMPLES;
+}
+
+bool sensorCalibCheckMatches(const sensorCalibCheck_t* check, const sensorCalib_t* stored, const float temperature, const sensorCalibLimits_t* limits) {
+  if (check->count < SENSOR_CALIB_CHECK_SAMPLES) {
+    return false;
+  }
+
+  if (fabsf(temperature - stored->temperature) > limits->maxTemperatureDiff) {
+    return false;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    const float mean = (float)check->gyroSum[i] / check->count;
+    const float variance = (float)(check->gyroSumSquares[i] - (check->gyroSum[i] * check->gyroSum[i]) / check->count) / check->count;
+
+    if (variance > limits->maxGyroVariance) {
+      return false;
+    }
+
+    if (fabsf(mean - stored->gyroBias[i]) > limits->maxGyroBiasDiff) {
+      return false;
+    }
+  }
+
+  const float accScale = check->accScaleSum / check->count;
+  return fabsf(accScale - stored->accScale) <= limits->maxAccScaleDiff;
+}
+
+bool sensorCalibNeedsUpdate(const sensorCalib_t* stored, const sensorCalib_t* fresh, const sensorCalibLimits_t* limits) {
+  if (fabsf(fresh->temperature - stored->temperature) > limits->maxTemperatureDiff / 2) {
+    return true;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    if (fabsf(fresh->gyroBias[i] - stored->gyroBias[i]) > limits->maxGyroBiasDiff / 2) {
+      return true;
+    }
+  }
+
+  return fabsf(fresh->accScale - stored->accScale) > limits->maxAccScaleDiff / 2;
+}
@@ -0,0 +1,211 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * sliding_median.c - Median of a sliding window with O(log n) updates
+ *
+ * Heap positions are relative to the median at position 0. Positive
+ * positions 1..minCount are the min heap and negative positions
+ * -1..-maxCount the max heap, the parent of position i is i / 2 and the
+ * children are 2 * i and 2 * i + 1 (2 * i - 1 for the max heap).
+ */
+
+#include <math.h>
+
+#include "sliding_median.h"
+
+// Scale factor from the MAD to the standard deviation of a normal distribution
+#define MAD_TO_STD_DEV 1.4826f
+
+static int minCount(const slidingMedian_t* m) {
+  return (m->count - 1) / 2;
+}
+
+static int maxCount(const slidingMedian_t* m) {
+  return m->count / 2;
+}
+
+static int8_t* heapAt(slidingMedian_t* m, const int i) {
+  return &m->heap[i + m->size / 2];
+}
+
+static float valueAt(slidingMedian_t* m, const int i) {
+  return m->samples[*heapAt(m, i)];
+}
+
+static bool isLess(slidingMedian_t* m, const int i, const int j) {
+  return valueAt(m, i) < valueAt(m, j);
+}
+
+static void exchange(slidingMedian_t* m, const int i, const int j) {
+  int8_t* a = heapAt(m, i);
+  int8_t* b = heapAt(m, j);
+  const int8_t tmp = *a;
+  *a = *b;
+  *b = tmp;
+  m->position[*a] = (int8_t)i;
+  m->position[*b] = (int8_t)j;
+}
+
+// Swaps i and j if the sample at i is less than the sample at j
+static bool exchangeIfLess(slidingMedian_t* m, const int i, const int j) {
+  if (isLess(m, i, j)) {
+    exchange(m, i, j);
+    return true;
+  }
+  return false;
+}
+
+// Moves the parent of i down the min heap, i is the first child
+static void minSortDown(slidingMedian_t* m, int i) {
+  for (; i <= minCount(m); i *= 2) {
+    if (i > 1 && i < minCount(m) && isLess(m, i + 1, i)) {
+      i++;
+    }
+    if (!exchangeIfLess(m, i, i / 2)) {
+      break;
+    }
+  }
+}
+
+// Moves the parent of i down the max heap, i is the first child
+static void maxSortDown(slidingMedian_t* m, int i) {
+  for (; i >= -maxCount(m); i *= 2) {
+    if (i < -1 && i > -maxCount(m) && isLess(m, i, i - 1)) {
+      i--;
+    }
+    if (!exchangeIfLess(m, i / 2, i)) {
+      break;
+    }
+  }
+}
+
+// Moves i up the min heap, returns true if it became the median
+static bool minSortUp(slidingMedian_t* m, int i) {
+  while (i > 0 && exchangeIfLess(m, i, i / 2)) {
+    i /= 2;
+  }
+  return i == 0;
+}
+
+// Moves i up the max heap, returns true if it became the median
+static bool maxSortUp(slidingMedian_t* m, int i) {
+  while (i < 0 && exchangeIfLess(m, i / 2, i)) {
+    i /= 2;
+  }
+  return i == 0;
+}
+
+void slidingMedianInit(slidingMedian_t* median, const uint8_t size) {
+  median->size = size;
+  if (median->size > SLIDING_MEDIAN_MAX_SIZE) {
+    median->size = SLIDING_MEDIAN_MAX_SIZE;
+  } else if (median->size < 1) {
+    median->size = 1;
+  }
+  median->count = 0;
+  median->next = 0;
+
+  // The heap is filled from the median and out, alternating between the max
+  // and the min heap: 0, -1, 1, -2, 2...
+  for (int i = 0; i < median->size; i++) {
+    const int position = ((i + 1) / 2) * ((i & 1) ? -1 : 1);
+    median->samples[i] = 0.0f;
+    median->position[i] = (int8_t)position;
+    *heapAt(median, position) = (int8_t)i;
+  }
+}
+
+float slidingMedianAdd(slidingMedian_t* median, const float sample) {
+  const bool isNew = median->count < median->size;
+  const int i = median->position[median->next];
+  const float old = median->samples[median->next];
+
+  median->samples[median->next] = sample;
+  median->next = (median->next + 1) % median->size;
+  if (isNew) {
+    median->count++;
+  }
+
+  // A new sample is always at the end of a heap and can only move up
+  if (i > 0) {
+    if (!isNew && old < sample) {
+      minSortDown(median, i * 2);
+    } else if (minSortUp(median, i)) {
+      maxSortDown(median, -1);
+    }
+  } else if (i < 0) {
+    if (!isNew && sample < old) {
+      maxSortDown(median, i * 2);
+    } else if (maxSortUp(median, i)) {
+      minSortDown(median, 1);
+    }
+  } else {
+    if (maxCount(median) > 0) {
+      maxSortDown(median, -1);
+    }
+    if (minCount(median) > 0) {
+      minSortDown(median, 1);
+    }
+  }
+
+  return slidingMedianGet(median);
+}
+
+float slidingMedianGet(const slidingMedian_t* median) {
+  if (median->count == 0) {
+    return 0.0f;
+  }
+  return median->samples[median->heap[median->size / 2]];
+}
+
+bool slidingMedianIsFull(const slidingMedian_t* median) {
+  return median->count == median->size;
+}
+
+void medianOutlierFilterInit(medianOutlierFilter_t* filter, const uint8_t size, const float threshold, const float minDeviation, const uint8_t minCount) {
+  slidingMedianInit(&filter->samples, size);
+  slidingMedianInit(&filter->deviations, size);
+  filter->threshold = threshold;
+  filter->minDeviation = minDeviation;
+  filter->minCount = (minCount < size) ? minCount : size;
+}
+
+bool medianOutlierFilterAdd(medianOutlierFilter_t* filter, const float sample) {
+  const bool hasEnoughSamples = filter->samples.count >= filter->minCount;
+  const bool isEmpty = filter->samples.count == 0;
+  const float difference = fabsf(sample - slidingMedianGet(&filter->samples));
+
+  float deviation = MAD_TO_STD_DEV * slidingMedianGet(&filter->deviations);
+  if (deviation < filter->minDeviation) {
+    deviation = filter->minDeviation;
+  }
+  const bool isAccepted = hasEnoughSamples && (difference <= filter->threshold * deviation);
+
+  slidingMedianAdd(&filter->samples, sample);
+  // There is no median to deviate from for the first sample
+  if (!isEmpty) {
+    slidingMedianAdd(&filter->deviations, difference);
+  }
+
+  return isAccepted;
+}
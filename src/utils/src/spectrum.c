@@ -0,0 +1,137 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * spectrum.c - Windowed FFT spectrum analysis of sampled signals
+ */
+
+#include <string.h>
+
+#include "spectrum.h"
+
+bool spectrumInit(spectrum_t* spectrum, const float sampleFreq, const float bandEdges[SPECTRUM_BAND_COUNT + 1]) {
+  spectrum->sampleFreq = sampleFreq;
+  memcpy(spectrum->bandEdges, bandEdges, sizeof(spectrum->bandEdges));
+
+  // Hann window
+  spectrum->windowSum = 0.0f;
+  spectrum->windowSquareSum = 0.0f;
+  for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+    const float w = 0.5f - 0.5f * arm_cos_f32(2.0f * PI * i / SPECTRUM_FFT_SIZE);
+    spectrum->window[i] = w;
+    spectrum->windowSum += w;
+    spectrum->windowSquareSum += w * w;
+  }
+
+  return arm_rfft_fast_init_f32(&spectrum->fft, SPECTRUM_FFT_SIZE) == ARM_MATH_SUCCESS;
+}
+
+void spectrumAnalyze(spectrum_t* spectrum, float* frame, spectrumResult_t* result) {
+  const int binCount = SPECTRUM_FFT_SIZE / 2;
+  const float binWidth = spectrum->sampleFreq / SPECTRUM_FFT_SIZE;
+  float* power = spectrum->fftOut;
+
+  // Remove the DC component (gyro bias, gravity) so that its leakage does
+  // not show up in the lowest band
+  float mean;
+  arm_mean_f32(frame, SPECTRUM_FFT_SIZE, &mean);
+  arm_offset_f32(frame, -mean, frame, SPECTRUM_FFT_SIZE);
+  arm_mult_f32(frame, spectrum->window, frame, SPECTRUM_FFT_SIZE);
+
+  // Output is DC and Nyquist in the first two elements, followed by the
+  // complex bins 1 to N/2 - 1
+  arm_rfft_fast_f32(&spectrum->fft, frame, spectrum->fftOut, 0);
+
+  // Power of bin k is written to index k, which has already been read. DC and
+  // Nyquist are ignored.
+  power[0] = 0.0f;
+  int peakBin = 1;
+  for (int k = 1; k < binCount; k++) {
+    const float re = spectrum->fftOut[2 * k];
+    const float im = spectrum->fftOut[2 * k + 1];
+    power[k] = re * re + im * im;
+    if (power[k] > power[peakBin]) {
+      peakBin = k;
+    }
+  }
+
+  // Parabolic interpolation of the magnitude around the peak
+  float offset = 0.0f;
+  const float peak = sqrtf(power[peakBin]);
+  if (peakBin > 1 && peakBin < binCount - 1) {
+    const float before = sqrtf(power[peakBin - 1]);
+    const float after = sqrtf(power[peakBin + 1]);
+    const float denominator = before - 2.0f * peak + after;
+    if (denominator < 0.0f) {
+      offset = 0.5f * (before - after) / denominator;
+    }
+  }
+  result->peakFreq = (peakBin + offset) * binWidth;
+  result->peakAmplitude = 2.0f * peak / spectrum->windowSum;
+
+  // Parseval, scaled by the window power and doubled for the negative
+  // frequencies
+  const float energyScale = 2.0f / (SPECTRUM_FFT_SIZE * spectrum->windowSquareSum);
+  for (int b = 0; b < SPECTRUM_BAND_COUNT; b++) {
+    result->bandEnergy[b] = 0.0f;
+  }
+  int band = 0;
+  for (int k = 1; k < binCount; k++) {
+    const float freq = k * binWidth;
+    while (band < SPECTRUM_BAND_COUNT && freq >= spectrum->bandEdges[band + 1]) {
+      band++;
+    }
+    if (band == SPECTRUM_BAND_COUNT) {
+      break;
+    }
+    if (freq >= spectrum->bandEdges[band]) {
+      result->bandEnergy[band] += power[k] * energyScale;
+    }
+  }
+}
+
+void spectrumBufferInit(spectrumBuffer_t* buffer) {
+  memset(buffer, 0, sizeof(*buffer));
+}
+
+bool spectrumBufferAdd(spectrumBuffer_t* buffer, const float sample) {
+  buffer->samples[buffer->head] = sample;
+  buffer->head = (buffer->head + 1) % SPECTRUM_FFT_SIZE;
+
+  if (buffer->fill < SPECTRUM_FFT_SIZE) {
+    buffer->fill++;
+  }
+  buffer->sinceFrame++;
+
+  if (buffer->fill == SPECTRUM_FFT_SIZE && buffer->sinceFrame >= SPECTRUM_HOP_SIZE) {
+    buffer->sinceFrame = 0;
+    return true;
+  }
+  return false;
+}
+
+void spectrumBufferGetFrame(const spectrumBuffer_t* buffer, float* frame) {
+  // head points at the oldest sample
+  const uint16_t tailCount = SPECTRUM_FFT_SIZE - buffer->head;
+  memcpy(frame, &buffer->samples[buffer->head], tailCount * sizeof(float));
+  memcpy(&frame[tailCount], buffer->samples, buffer->head * sizeof(float));
+}
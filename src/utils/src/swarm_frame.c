@@ -0,0 +1,104 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * swarm_frame.c - Broadcast frames with one slot per Crazyflie
+ */
+
+#include <string.h>
+
+#include "swarm_frame.h"
+
+static void finishFrame(swarmFrameReceiver_t* receiver) {
+  receiver->quality = (uint8_t)((100 * receiver->packetsReceived) / receiver->packetCount);
+  if (receiver->isSlotInFrame && !receiver->isSlotReceived) {
+    receiver->slotMissedCount++;
+  }
+}
+
+static void startFrame(swarmFrameReceiver_t* receiver, const swarmFrameHeader_t* header, const uint8_t itemsPerPacket) {
+  if (receiver->hasFrame) {
+    finishFrame(receiver);
+
+    const int8_t age = (int8_t)(header->seq - receiver->seq);
+    if (age > 1) {
+      receiver->frameLostCount += age - 1;
+    }
+  }
+
+  receiver->hasFrame = true;
+  receiver->seq = header->seq;
+  receiver->packetCount = (uint8_t)((header->slotCount + itemsPerPacket - 1) / itemsPerPacket);
+  receiver->packetsReceived = 0;
+  receiver->isSlotInFrame = receiver->slot < header->slotCount;
+  receiver->isSlotReceived = false;
+  memset(receiver->receivedMask, 0, sizeof(receiver->receivedMask));
+
+  receiver->frameCount++;
+}
+
+void swarmFrameReceiverInit(swarmFrameReceiver_t* receiver, const uint8_t slot) {
+  memset(receiver, 0, sizeof(swarmFrameReceiver_t));
+  receiver->slot = slot;
+}
+
+const void* swarmFrameReceiverAdd(swarmFrameReceiver_t* receiver, const uint8_t* data, const uint8_t length, const uint8_t itemSize) {
+  if (length < sizeof(swarmFrameHeader_t) || itemSize == 0 || itemSize > SWARM_FRAME_MAX_PAYLOAD) {
+    return NULL;
+  }
+
+  const swarmFrameHeader_t* header = (const swarmFrameHeader_t*)data;
+  const uint8_t itemsPerPacket = SWARM_FRAME_MAX_PAYLOAD / itemSize;
+  const uint8_t itemCount = (length - sizeof(swarmFrameHeader_t)) / itemSize;
+
+  // Slots are packed in order, a packet always starts on a packet boundary
+  if (header->firstSlot % itemsPerPacket != 0 || header->firstSlot >= header->slotCount) {
+    return NULL;
+  }
+  const uint8_t packet = header->firstSlot / itemsPerPacket;
+  if (packet >= SWARM_FRAME_MAX_PACKETS) {
+    return NULL;
+  }
+
+  const int8_t age = (int8_t)(header->seq - receiver->seq);
+  if (!receiver->hasFrame || age > 0 || age < -SWARM_FRAME_MAX_AGE) {
+    startFrame(receiver, header, itemsPerPacket);
+  } else if (age < 0) {
+    receiver->staleCount++;
+    return NULL;
+  }
+
+  // Duplicates are ignored
+  const uint8_t bit = 1 << (packet % 8);
+  if (receiver->receivedMask[packet / 8] & bit) {
+    return NULL;
+  }
+  receiver->receivedMask[packet / 8] |= bit;
+  receiver->packetsReceived++;
+
+  if (receiver->slot < header->firstSlot || receiver->slot >= header->firstSlot + itemCount) {
+    return NULL;
+  }
+
+  receiver->isSlotReceived = true;
+  return &data[sizeof(swarmFrameHeader_t) + (receiver->slot - header->firstSlot) * itemSize];
+}
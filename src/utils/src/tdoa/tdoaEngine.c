@@ -41,6 +41,11 @@ The implementation must handle
 3. Dynamically changing visibility of anchors over time
 4. Random TX times from anchors with possible packet collisions and packet loss
 
+When built with TDOA_ENGINE_FIXED_POINT the clock correction and time
+difference of arrival are computed in integer arithmetic, in DW1000 ticks with
+a fixed point clock correction, and converted to float only for the final
+distance difference. Doubles are emulated in software on the Cortex-M4.
+
 */
 
 #include <string.h>
@@ -55,11 +60,18 @@ The implementation must handle
 
 #define MEASUREMENT_NOISE_STD 0.15f
 
+// The max number of useful candidates to compare when looking for a suitable
+// anchor, bounds the time spent per packet
+#define TDOA_ENGINE_CANDIDATE_COUNT 2
+
 void tdoaEngineInit(tdoaEngineState_t* engineState, const uint32_t now_ms, tdoaEngineSendTdoaToEstimator sendTdoaToEstimator, const double locodeckTsFreq) {
   tdoaStorageInitialize(engineState->anchorInfoArray);
   tdoaStatsInit(&engineState->stats, now_ms);
   engineState->sendTdoaToEstimator = sendTdoaToEstimator;
   engineState->locodeckTsFreq = locodeckTsFreq;
+#ifdef TDOA_ENGINE_FIXED_POINT
+  engineState->metersPerFixedTick = SPEED_OF_LIGHT / locodeckTsFreq / (1 << CLOCK_CORRECTION_FIXED_TICK_SHIFT);
+#endif
 }
 
 #define TRUNCATE_TO_ANCHOR_TS_BITMAP 0x00FFFFFFFF
@@ -67,7 +79,7 @@ static uint64_t truncateToAnchorTimeStamp(uint64_t fullTimeStamp) {
   return fullTimeStamp & TRUNCATE_TO_ANCHOR_TS_BITMAP;
 }
 
-static void enqueueTDOA(const tdoaAnchorContext_t* anchorACtx, const tdoaAnchorContext_t* anchorBCtx, double distanceDiff, tdoaEngineState_t* engineState) {
+static void enqueueTDOA(const tdoaAnchorContext_t* anchorACtx, const tdoaAnchorContext_t* anchorBCtx, float distanceDiff, tdoaEngineState_t* engineState) {
   tdoaStats_t* stats = &engineState->stats;
 
   tdoaMeasurement_t tdoa = {
@@ -97,12 +109,21 @@ static bool updateClockCorrection(tdoaAnchorContext_t* anchorCtx, const int64_t
   const int64_t latest_txAn_in_cl_An = tdoaStorageGetTxTime(anchorCtx);
 
   if (latest_rxAn_by_T_in_cl_T != 0 && latest_txAn_in_cl_An != 0) {
+#ifdef TDOA_ENGINE_FIXED_POINT
+    clockCorrectionFixed_t clockCorrectionCandidate = clockCorrectionEngineCalculateFixed(rxAn_by_T_in_cl_T, latest_rxAn_by_T_in_cl_T, txAn_in_cl_An, latest_txAn_in_cl_An, TRUNCATE_TO_ANCHOR_TS_BITMAP);
+    sampleIsReliable = clockCorrectionEngineUpdateFixed(tdoaStorageGetClockCorrectionStorage(anchorCtx), clockCorrectionCandidate);
+#else
     double clockCorrectionCandidate = clockCorrectionEngineCalculate(rxAn_by_T_in_cl_T, latest_rxAn_by_T_in_cl_T, txAn_in_cl_An, latest_txAn_in_cl_An, TRUNCATE_TO_ANCHOR_TS_BITMAP);
     sampleIsReliable = clockCorrectionEngineUpdate(tdoaStorageGetClockCorrectionStorage(anchorCtx), clockCorrectionCandidate);
+#endif
 
     if (sampleIsReliable){
       if (tdoaStorageGetId(anchorCtx) == stats->anchorId) {
+#ifdef TDOA_ENGINE_FIXED_POINT
+        stats->clockCorrection = clockCorrectionEngineFixedToFloat(tdoaStorageGetClockCorrectionFixed(anchorCtx));
+#else
         stats->clockCorrection = tdoaStorageGetClockCorrection(anchorCtx);
+#endif
         stats->clockCorrectionCount++;
       }
     }
@@ -111,6 +132,32 @@ static bool updateClockCorrection(tdoaAnchorContext_t* anchorCtx, const int64_t
   return sampleIsReliable;
 }
 
+#ifdef TDOA_ENGINE_FIXED_POINT
+// Returns the TDoA in ticks with CLOCK_CORRECTION_FIXED_TICK_SHIFT fractional bits
+static int64_t calcTDoA(const tdoaAnchorContext_t* otherAnchorCtx, const tdoaAnchorContext_t* anchorCtx, const int64_t txAn_in_cl_An, const int64_t rxAn_by_T_in_cl_T) {
+  const uint8_t otherAnchorId = tdoaStorageGetId(otherAnchorCtx);
+
+  const int64_t tof_Ar_to_An_in_cl_An = tdoaStorageGetTimeOfFlight(anchorCtx, otherAnchorId);
+  const int64_t rxAr_by_An_in_cl_An = tdoaStorageGetRemoteRxTime(anchorCtx, otherAnchorId);
+  const clockCorrectionFixed_t clockCorrection = tdoaStorageGetClockCorrectionFixed(anchorCtx);
+
+  const int64_t rxAr_by_T_in_cl_T = tdoaStorageGetRxTime(otherAnchorCtx);
+
+  const int64_t delta_txAr_to_txAn_in_cl_An = (tof_Ar_to_An_in_cl_An + truncateToAnchorTimeStamp(txAn_in_cl_An - rxAr_by_An_in_cl_An));
+  const int64_t timeDiffOfArrival_in_cl_T = ((int64_t)truncateToAnchorTimeStamp(rxAn_by_T_in_cl_T - rxAr_by_T_in_cl_T) << CLOCK_CORRECTION_FIXED_TICK_SHIFT) - clockCorrectionEngineApplyFixed(delta_txAr_to_txAn_in_cl_An, clockCorrection);
+
+  return timeDiffOfArrival_in_cl_T;
+}
+
+static float calcDistanceDiff(const tdoaAnchorContext_t* otherAnchorCtx, const tdoaAnchorContext_t* anchorCtx, const int64_t txAn_in_cl_An, const int64_t rxAn_by_T_in_cl_T, const tdoaEngineState_t* engineState) {
+  const int64_t tdoa = calcTDoA(otherAnchorCtx, anchorCtx, txAn_in_cl_An, rxAn_by_T_in_cl_T);
+  return (float)tdoa * engineState->metersPerFixedTick;
+}
+
+static bool hasClockCorrection(const tdoaAnchorContext_t* anchorCtx) {
+  return tdoaStorageGetClockCorrectionFixed(anchorCtx) > 0;
+}
+#else
 static int64_t calcTDoA(const tdoaAnchorContext_t* otherAnchorCtx, const tdoaAnchorContext_t* anchorCtx, const int64_t txAn_in_cl_An, const int64_t rxAn_by_T_in_cl_T) {
   const uint8_t otherAnchorId = tdoaStorageGetId(otherAnchorCtx);
 
@@ -126,17 +173,22 @@ static int64_t calcTDoA(const tdoaAnchorContext_t* otherAnchorCtx, const tdoaAnc
   return timeDiffOfArrival_in_cl_T;
 }
 
-static double calcDistanceDiff(const tdoaAnchorContext_t* otherAnchorCtx, const tdoaAnchorContext_t* anchorCtx, const int64_t txAn_in_cl_An, const int64_t rxAn_by_T_in_cl_T, const double locodeckTsFreq) {
+static double calcDistanceDiff(const tdoaAnchorContext_t* otherAnchorCtx, const tdoaAnchorContext_t* anchorCtx, const int64_t txAn_in_cl_An, const int64_t rxAn_by_T_in_cl_T, const tdoaEngineState_t* engineState) {
   const int64_t tdoa = calcTDoA(otherAnchorCtx, anchorCtx, txAn_in_cl_An, rxAn_by_T_in_cl_T);
-  return SPEED_OF_LIGHT * tdoa / locodeckTsFreq;
+  return SPEED_OF_LIGHT * tdoa / engineState->locodeckTsFreq;
+}
+
+static bool hasClockCorrection(const tdoaAnchorContext_t* anchorCtx) {
+  return tdoaStorageGetClockCorrection(anchorCtx) > 0.0;
 }
+#endif
 
 static bool findSuitableAnchor(tdoaEngineState_t* engineState, tdoaAnchorContext_t* otherAnchorCtx, const tdoaAnchorContext_t* anchorCtx) {
   static uint8_t seqNr[REMOTE_ANCHOR_DATA_COUNT];
   static uint8_t id[REMOTE_ANCHOR_DATA_COUNT];
   static uint8_t offset = 0;
 
-  if (tdoaStorageGetClockCorrection(anchorCtx) <= 0.0) {
+  if (!hasClockCorrection(anchorCtx)) {
     return false;
   }
 
@@ -146,19 +198,33 @@ static bool findSuitableAnchor(tdoaEngineState_t* engineState, tdoaAnchorContext
 
   uint32_t now_ms = anchorCtx->currentTime_ms;
 
-  // Loop over the candidates and pick the first one that is useful
+  // Loop over the candidates and pick the one with the longest baseline (time
+  // of flight) among the first few that are useful. A longer baseline gives a
+  // better geometry and a smaller error in the TDoA measurement.
   // An offset (updated for each call) is added to make sure we start at
-  // different positions in the list and vary which candidate to choose
-  for (int i = offset; i < (remoteCount + offset); i++) {
+  // different positions in the list and vary which candidates to compare
+  int candidatesFound = 0;
+  int64_t bestTof = 0;
+  tdoaAnchorContext_t candidateCtx;
+  for (int i = offset; i < (remoteCount + offset) && candidatesFound < TDOA_ENGINE_CANDIDATE_COUNT; i++) {
     uint8_t index = i % remoteCount;
     const uint8_t candidateAnchorId = id[index];
-    if (tdoaStorageGetCreateAnchorCtx(engineState->anchorInfoArray, candidateAnchorId, now_ms, otherAnchorCtx)) {
-      if (seqNr[index] == tdoaStorageGetSeqNr(otherAnchorCtx) && tdoaStorageGetTimeOfFlight(anchorCtx, candidateAnchorId)) {
-        return true;
+    if (tdoaStorageGetCreateAnchorCtx(engineState->anchorInfoArray, candidateAnchorId, now_ms, &candidateCtx)) {
+      const int64_t tof = tdoaStorageGetTimeOfFlight(anchorCtx, candidateAnchorId);
+      if (seqNr[index] == tdoaStorageGetSeqNr(&candidateCtx) && tof) {
+        candidatesFound++;
+        if (tof > bestTof) {
+          bestTof = tof;
+          *otherAnchorCtx = candidateCtx;
+        }
       }
     }
   }
 
+  if (candidatesFound > 0) {
+    return true;
+  }
+
   otherAnchorCtx->anchorInfo = 0;
   return false;
 }
@@ -179,7 +245,7 @@ void tdoaEngineProcessPacket(tdoaEngineState_t* engineState, tdoaAnchorContext_t
     tdoaAnchorContext_t otherAnchorCtx;
     if (findSuitableAnchor(engineState, &otherAnchorCtx, anchorCtx)) {
       engineState->stats.suitableDataFound++;
-      double tdoaDistDiff = calcDistanceDiff(&otherAnchorCtx, anchorCtx, txAn_in_cl_An, rxAn_by_T_in_cl_T, engineState->locodeckTsFreq);
+      float tdoaDistDiff = calcDistanceDiff(&otherAnchorCtx, anchorCtx, txAn_in_cl_An, rxAn_by_T_in_cl_T, engineState);
       enqueueTDOA(&otherAnchorCtx, anchorCtx, tdoaDistDiff, engineState);
     }
   }
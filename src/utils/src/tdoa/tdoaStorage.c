@@ -26,6 +26,13 @@
 
 /*
 Data storage encapsulation for the TDoA engine
+
+Lookups by anchor id use direct mapped hints: a small table, indexed by the id,
+holding the index where the id was found the last time. A hint is verified
+before it is used, if it is stale (the entry has been replaced or another id
+mapped to the same hint) the lookup falls back to a linear search and updates
+the hint. This makes lookups O(1) in the normal case while keeping the storage
+compact and the order of entries unchanged.
 */
 
 #include <string.h>
@@ -41,8 +48,13 @@ Data storage encapsulation for the TDoA engine
 #define ANCHOR_POSITION_VALIDITY_PERIOD (2 * 1000)
 #define ANCHOR_ACTIVE_VALIDITY_PERIOD (2 * 1000)
 
+#define HINT_MASK (TDOA_LOOKUP_HINT_COUNT - 1)
+
 
 static tdoaAnchorInfo_t* initializeSlot(tdoaAnchorInfo_t anchorStorage[], const uint8_t slot, const uint8_t anchor);
+static int findAnchorSlot(tdoaAnchorInfo_t anchorStorage[], const uint8_t anchor);
+static int findRemoteAnchorData(const tdoaAnchorInfo_t* anchorInfo, const uint8_t remoteAnchor);
+static int findTimeOfFlight(const tdoaAnchorInfo_t* anchorInfo, const uint8_t otherAnchor);
 
 void tdoaStorageInitialize(tdoaAnchorInfo_t anchorStorage[]) {
   memset(anchorStorage, 0, sizeof(tdoaAnchorInfo_t) * ANCHOR_STORAGE_COUNT);
@@ -50,29 +62,30 @@ void tdoaStorageInitialize(tdoaAnchorInfo_t anchorStorage[]) {
 
 bool tdoaStorageGetCreateAnchorCtx(tdoaAnchorInfo_t anchorStorage[], const uint8_t anchor, const uint32_t currentTime_ms, tdoaAnchorContext_t* anchorCtx) {
   anchorCtx->currentTime_ms = currentTime_ms;
+
+  const int slot = findAnchorSlot(anchorStorage, anchor);
+  if (slot >= 0) {
+    anchorCtx->anchorInfo = &anchorStorage[slot];
+    return true;
+  }
+
+  // The anchor was not found in storage, use the first free slot or replace the oldest one
   uint32_t oldestUpdateTime = currentTime_ms;
   int firstUninitializedSlot = -1;
   int oldestSlot = 0;
 
   for (int i = 0; i < ANCHOR_STORAGE_COUNT; i++) {
     if (anchorStorage[i].isInitialized) {
-      if (anchor == anchorStorage[i].id) {
-        anchorCtx->anchorInfo = &anchorStorage[i];
-        return true;
-      }
-
       if (anchorStorage[i].lastUpdateTime < oldestUpdateTime) {
         oldestUpdateTime = anchorStorage[i].lastUpdateTime;
         oldestSlot = i;
       }
     } else {
-      if (firstUninitializedSlot == -1) {
-        firstUninitializedSlot = i;
-      }
+      firstUninitializedSlot = i;
+      break;
     }
   }
 
-  // The anchor was not found in storage
   tdoaAnchorInfo_t* newAnchorInfo = 0;
   if (firstUninitializedSlot != -1) {
     newAnchorInfo = initializeSlot(anchorStorage, firstUninitializedSlot, anchor);
@@ -87,13 +100,10 @@ bool tdoaStorageGetCreateAnchorCtx(tdoaAnchorInfo_t anchorStorage[], const uint8
 bool tdoaStorageGetAnchorCtx(tdoaAnchorInfo_t anchorStorage[], const uint8_t anchor, const uint32_t currentTime_ms, tdoaAnchorContext_t* anchorCtx) {
   anchorCtx->currentTime_ms = currentTime_ms;
 
-  for (int i = 0; i < ANCHOR_STORAGE_COUNT; i++) {
-    if (anchorStorage[i].isInitialized) {
-      if (anchor == anchorStorage[i].id) {
-        anchorCtx->anchorInfo = &anchorStorage[i];
-        return true;
-      }
-    }
+  const int slot = findAnchorSlot(anchorStorage, anchor);
+  if (slot >= 0) {
+    anchorCtx->anchorInfo = &anchorStorage[slot];
+    return true;
   }
 
   anchorCtx->anchorInfo = 0;
@@ -147,7 +157,7 @@ uint32_t tdoaStorageGetLastUpdateTime(const tdoaAnchorContext_t* anchorCtx) {
   return anchorCtx->anchorInfo->lastUpdateTime;
 }
 
-clockCorrectionStorage_t* tdoaStorageGetClockCorrectionStorage(const tdoaAnchorContext_t* anchorCtx) {
+tdoaClockCorrectionStorage_t* tdoaStorageGetClockCorrectionStorage(const tdoaAnchorContext_t* anchorCtx) {
   return &anchorCtx->anchorInfo->clockCorrectionStorage;
 }
 
@@ -187,20 +197,24 @@ void tdoaStorageSetRxTxData(tdoaAnchorContext_t* anchorCtx, int64_t rxTime, int6
   anchorInfo->lastUpdateTime = now;
 }
 
+#ifdef TDOA_ENGINE_FIXED_POINT
+clockCorrectionFixed_t tdoaStorageGetClockCorrectionFixed(const tdoaAnchorContext_t* anchorCtx) {
+  return clockCorrectionEngineGetFixed(&anchorCtx->anchorInfo->clockCorrectionStorage);
+}
+#else
 double tdoaStorageGetClockCorrection(const tdoaAnchorContext_t* anchorCtx) {
   return clockCorrectionEngineGet(&anchorCtx->anchorInfo->clockCorrectionStorage);
 }
+#endif
 
 int64_t tdoaStorageGetRemoteRxTime(const tdoaAnchorContext_t* anchorCtx, const uint8_t remoteAnchor) {
   const tdoaAnchorInfo_t* anchorInfo = anchorCtx->anchorInfo;
 
-  for (int i = 0; i < REMOTE_ANCHOR_DATA_COUNT; i++) {
-    if (remoteAnchor == anchorInfo->remoteAnchorData[i].id) {
-      uint32_t now = anchorCtx->currentTime_ms;
-      if (anchorInfo->remoteAnchorData[i].endOfLife > now) {
-        return anchorInfo->remoteAnchorData[i].rxTime;
-      }
-      break;
+  const int i = findRemoteAnchorData(anchorInfo, remoteAnchor);
+  if (i >= 0) {
+    uint32_t now = anchorCtx->currentTime_ms;
+    if (anchorInfo->remoteAnchorData[i].endOfLife > now) {
+      return anchorInfo->remoteAnchorData[i].rxTime;
     }
   }
 
@@ -210,19 +224,17 @@ int64_t tdoaStorageGetRemoteRxTime(const tdoaAnchorContext_t* anchorCtx, const u
 void tdoaStorageSetRemoteRxTime(tdoaAnchorContext_t* anchorCtx, const uint8_t remoteAnchor, const int64_t remoteRxTime, const uint8_t remoteSeqNr) {
   tdoaAnchorInfo_t* anchorInfo = anchorCtx->anchorInfo;
 
-  int indexToUpdate = 0;
   uint32_t now = anchorCtx->currentTime_ms;
-  uint32_t oldestTime = 0xFFFFFFFF;
-
-  for (int i = 0; i < REMOTE_ANCHOR_DATA_COUNT; i++) {
-    if (remoteAnchor == anchorInfo->remoteAnchorData[i].id) {
-      indexToUpdate = i;
-      break;
-    }
 
-    if (anchorInfo->remoteAnchorData[i].endOfLife < oldestTime) {
-      oldestTime = anchorInfo->remoteAnchorData[i].endOfLife;
-      indexToUpdate = i;
+  int indexToUpdate = findRemoteAnchorData(anchorInfo, remoteAnchor);
+  if (indexToUpdate < 0) {
+    indexToUpdate = 0;
+    uint32_t oldestTime = 0xFFFFFFFF;
+    for (int i = 0; i < REMOTE_ANCHOR_DATA_COUNT; i++) {
+      if (anchorInfo->remoteAnchorData[i].endOfLife < oldestTime) {
+        oldestTime = anchorInfo->remoteAnchorData[i].endOfLife;
+        indexToUpdate = i;
+      }
     }
   }
 
@@ -230,6 +242,7 @@ void tdoaStorageSetRemoteRxTime(tdoaAnchorContext_t* anchorCtx, const uint8_t re
   anchorInfo->remoteAnchorData[indexToUpdate].rxTime = remoteRxTime;
   anchorInfo->remoteAnchorData[indexToUpdate].seqNr = remoteSeqNr;
   anchorInfo->remoteAnchorData[indexToUpdate].endOfLife = now + REMOTE_DATA_VALIDITY_PERIOD;
+  anchorInfo->remoteAnchorDataHint[remoteAnchor & HINT_MASK] = indexToUpdate;
 }
 
 void tdoaStorageGetRemoteSeqNrList(const tdoaAnchorContext_t* anchorCtx, int* remoteCount, uint8_t seqNr[], uint8_t id[]) {
@@ -252,13 +265,11 @@ void tdoaStorageGetRemoteSeqNrList(const tdoaAnchorContext_t* anchorCtx, int* re
 int64_t tdoaStorageGetTimeOfFlight(const tdoaAnchorContext_t* anchorCtx, const uint8_t otherAnchor) {
   const tdoaAnchorInfo_t* anchorInfo = anchorCtx->anchorInfo;
 
-  for (int i = 0; i < TOF_PER_ANCHOR_COUNT; i++) {
-    if (otherAnchor == anchorInfo->tof[i].id) {
-      uint32_t now = anchorCtx->currentTime_ms;
-      if (anchorInfo->tof[i].endOfLife > now) {
-        return anchorInfo->tof[i].tof;
-      }
-      break;
+  const int i = findTimeOfFlight(anchorInfo, otherAnchor);
+  if (i >= 0) {
+    uint32_t now = anchorCtx->currentTime_ms;
+    if (anchorInfo->tof[i].endOfLife > now) {
+      return anchorInfo->tof[i].tof;
     }
   }
 
@@ -268,43 +279,88 @@ int64_t tdoaStorageGetTimeOfFlight(const tdoaAnchorContext_t* anchorCtx, const u
 void tdoaStorageSetTimeOfFlight(tdoaAnchorContext_t* anchorCtx, const uint8_t remoteAnchor, const int64_t tof) {
   tdoaAnchorInfo_t* anchorInfo = anchorCtx->anchorInfo;
 
-  int indexToUpdate = 0;
   uint32_t now = anchorCtx->currentTime_ms;
-  uint32_t oldestTime = 0xFFFFFFFF;
-
-  for (int i = 0; i < TOF_PER_ANCHOR_COUNT; i++) {
-    if (remoteAnchor == anchorInfo->tof[i].id) {
-      indexToUpdate = i;
-      break;
-    }
 
-    if (anchorInfo->tof[i].endOfLife < oldestTime) {
-      oldestTime = anchorInfo->tof[i].endOfLife;
-      indexToUpdate = i;
+  int indexToUpdate = findTimeOfFlight(anchorInfo, remoteAnchor);
+  if (indexToUpdate < 0) {
+    indexToUpdate = 0;
+    uint32_t oldestTime = 0xFFFFFFFF;
+    for (int i = 0; i < TOF_PER_ANCHOR_COUNT; i++) {
+      if (anchorInfo->tof[i].endOfLife < oldestTime) {
+        oldestTime = anchorInfo->tof[i].endOfLife;
+        indexToUpdate = i;
+      }
     }
   }
 
   anchorInfo->tof[indexToUpdate].id = remoteAnchor;
   anchorInfo->tof[indexToUpdate].tof = tof;
   anchorInfo->tof[indexToUpdate].endOfLife = now + TOF_VALIDITY_PERIOD;
+  anchorInfo->tofHint[remoteAnchor & HINT_MASK] = indexToUpdate;
 }
 
 bool tdoaStorageIsAnchorInStorage(tdoaAnchorInfo_t anchorStorage[], const uint8_t anchor) {
+  return findAnchorSlot(anchorStorage, anchor) >= 0;
+}
+
+static tdoaAnchorInfo_t* initializeSlot(tdoaAnchorInfo_t anchorStorage[], const uint8_t slot, const uint8_t anchor) {
+  // The anchor slot hint belongs to the slot, not to the anchor, keep it
+  const uint8_t anchorSlotHint = anchorStorage[slot].anchorSlotHint;
+  memset(&anchorStorage[slot], 0, sizeof(tdoaAnchorInfo_t));
+  anchorStorage[slot].anchorSlotHint = anchorSlotHint;
+
+  anchorStorage[slot].id = anchor;
+  anchorStorage[slot].isInitialized = true;
+  anchorStorage[anchor % ANCHOR_STORAGE_COUNT].anchorSlotHint = slot;
+
+  return &anchorStorage[slot];
+}
+
+static int findAnchorSlot(tdoaAnchorInfo_t anchorStorage[], const uint8_t anchor) {
+  tdoaAnchorInfo_t* hintSlot = &anchorStorage[anchor % ANCHOR_STORAGE_COUNT];
+  const uint8_t hint = hintSlot->anchorSlotHint;
+  if (anchorStorage[hint].isInitialized && anchor == anchorStorage[hint].id) {
+    return hint;
+  }
+
   for (int i = 0; i < ANCHOR_STORAGE_COUNT; i++) {
     if (anchorStorage[i].isInitialized) {
       if (anchor == anchorStorage[i].id) {
-        return true;
+        hintSlot->anchorSlotHint = i;
+        return i;
       }
     }
   }
 
-  return false;
+  return -1;
 }
 
-static tdoaAnchorInfo_t* initializeSlot(tdoaAnchorInfo_t anchorStorage[], const uint8_t slot, const uint8_t anchor) {
-  memset(&anchorStorage[slot], 0, sizeof(tdoaAnchorInfo_t));
-  anchorStorage[slot].id = anchor;
-  anchorStorage[slot].isInitialized = true;
+static int findRemoteAnchorData(const tdoaAnchorInfo_t* anchorInfo, const uint8_t remoteAnchor) {
+  const uint8_t hint = anchorInfo->remoteAnchorDataHint[remoteAnchor & HINT_MASK];
+  if (remoteAnchor == anchorInfo->remoteAnchorData[hint].id) {
+    return hint;
+  }
 
-  return &anchorStorage[slot];
+  for (int i = 0; i < REMOTE_ANCHOR_DATA_COUNT; i++) {
+    if (remoteAnchor == anchorInfo->remoteAnchorData[i].id) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static int findTimeOfFlight(const tdoaAnchorInfo_t* anchorInfo, const uint8_t otherAnchor) {
+  const uint8_t hint = anchorInfo->tofHint[otherAnchor & HINT_MASK];
+  if (otherAnchor == anchorInfo->tof[hint].id) {
+    return hint;
+  }
+
+  for (int i = 0; i < TOF_PER_ANCHOR_COUNT; i++) {
+    if (otherAnchor == anchorInfo->tof[i].id) {
+      return i;
+    }
+  }
+
+  return -1;
 }
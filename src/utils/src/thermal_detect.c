@@ -0,0 +1,160 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * thermal_detect.c - Hot spot detection in 8x8 thermal images
+ */
+
+#include <string.h>
+
+#include "thermal_detect.h"
+
+#define NO_LABEL 0xff
+
+typedef struct {
+  uint8_t area;
+  int16_t peak;
+  int32_t weight;
+  int32_t sumX;
+  int32_t sumY;
+} blob_t;
+
+// Adds a detection if it is among the maxDetections hottest so far
+static int insertDetection(thermalDetection_t* detections, int count, const int maxDetections, const thermalDetection_t* detection) {
+  int position = count;
+  while (position > 0 && detections[position - 1].peak < detection->peak) {
+    position--;
+  }
+
+  if (position >= maxDetections) {
+    return count;
+  }
+
+  const int last = (count < maxDetections) ? count : maxDetections - 1;
+  memmove(&detections[position + 1], &detections[position], (last - position) * sizeof(thermalDetection_t));
+  detections[position] = *detection;
+
+  return (count < maxDetections) ? count + 1 : count;
+}
+
+// Flood fill of the 4-connected foreground pixels from start
+static void fillBlob(const int16_t excess[THERMAL_PIXELS], uint8_t labels[THERMAL_PIXELS], const uint8_t start, const uint8_t label, const int16_t* image, blob_t* blob) {
+  uint8_t stack[THERMAL_PIXELS];
+  int stackSize = 0;
+
+  memset(blob, 0, sizeof(blob_t));
+  blob->peak = image[start];
+
+  labels[start] = label;
+  stack[stackSize++] = start;
+
+  while (stackSize > 0) {
+    const uint8_t pixel = stack[--stackSize];
+    const int x = pixel % THERMAL_IMAGE_SIZE;
+    const int y = pixel / THERMAL_IMAGE_SIZE;
+
+    blob->area++;
+    blob->weight += excess[pixel];
+    blob->sumX += excess[pixel] * x;
+    blob->sumY += excess[pixel] * y;
+    if (image[pixel] > blob->peak) {
+      blob->peak = image[pixel];
+    }
+
+    const int neighbours[4][2] = {{x - 1, y}, {x + 1, y}, {x, y - 1}, {x, y + 1}};
+    for (int i = 0; i < 4; i++) {
+      const int nx = neighbours[i][0];
+      const int ny = neighbours[i][1];
+      if (nx < 0 || nx >= THERMAL_IMAGE_SIZE || ny < 0 || ny >= THERMAL_IMAGE_SIZE) {
+        continue;
+      }
+
+      const uint8_t neighbour = ny * THERMAL_IMAGE_SIZE + nx;
+      if (excess[neighbour] > 0 && labels[neighbour] == NO_LABEL) {
+        // Each pixel is labelled before it is pushed, the stack can not overflow
+        labels[neighbour] = label;
+        stack[stackSize++] = neighbour;
+      }
+    }
+  }
+}
+
+void thermalDetectorInit(thermalDetector_t* detector, const int16_t threshold, const uint8_t minArea, const uint8_t backgroundRate) {
+  memset(detector, 0, sizeof(thermalDetector_t));
+  detector->threshold = threshold;
+  detector->minArea = minArea;
+  detector->backgroundRate = backgroundRate;
+}
+
+int thermalDetectorUpdate(thermalDetector_t* detector, const int16_t image[THERMAL_PIXELS], thermalDetection_t* detections, const int maxDetections) {
+  detector->blobCount = 0;
+
+  if (!detector->hasBackground) {
+    for (int i = 0; i < THERMAL_PIXELS; i++) {
+      detector->background[i] = (int32_t)image[i] << THERMAL_FRACTION_BITS;
+    }
+    detector->hasBackground = true;
+    return 0;
+  }
+
+  // Excess temperature of the foreground pixels, 0 for background
+  int16_t excess[THERMAL_PIXELS];
+  uint8_t labels[THERMAL_PIXELS];
+  for (int i = 0; i < THERMAL_PIXELS; i++) {
+    const int16_t difference = image[i] - (int16_t)(detector->background[i] >> THERMAL_FRACTION_BITS);
+    excess[i] = (difference > detector->threshold) ? difference : 0;
+    labels[i] = NO_LABEL;
+  }
+
+  int count = 0;
+  for (int i = 0; i < THERMAL_PIXELS; i++) {
+    if (excess[i] == 0 || labels[i] != NO_LABEL) {
+      continue;
+    }
+
+    blob_t blob;
+    fillBlob(excess, labels, i, detector->blobCount, image, &blob);
+    detector->blobCount++;
+
+    if (blob.area >= detector->minArea) {
+      const thermalDetection_t detection = {
+        .area = blob.area,
+        .peak = blob.peak,
+        .centroidX = (blob.sumX << THERMAL_FRACTION_BITS) / blob.weight,
+        .centroidY = (blob.sumY << THERMAL_FRACTION_BITS) / blob.weight,
+      };
+      count = insertDetection(detections, count, maxDetections, &detection);
+    }
+  }
+
+  for (int i = 0; i < THERMAL_PIXELS; i++) {
+    uint8_t rate = detector->backgroundRate;
+    if (excess[i] > 0) {
+      rate += THERMAL_FOREGROUND_SLOWDOWN;
+    }
+
+    const int32_t target = (int32_t)image[i] << THERMAL_FRACTION_BITS;
+    detector->background[i] += (target - detector->background[i]) >> rate;
+  }
+
+  return count;
+}
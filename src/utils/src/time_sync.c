@@ -0,0 +1,71 @@
+/**
+ *    ||          ____  _ __
+ * +------+      / __ )(_) /_______________ _____  ___
+ * | 0xBC |     / __  / / __/ ___/ ___/ __ `/_  / / _ \
+ * +------+    / /_/ / / /_/ /__/ /  / /_/ / / /_/  __/
+ *  ||  ||    /_____/_/\__/\___/_/   \__,_/ /___/\___/
+ *
+ * Crazyflie control firmware
+ *
+ * Copyright (C) 2021 Bitcraze AB
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, in version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * time_sync.c - Estimation of the offset between a remote clock and the local tick
+ */
+
+#include <string.h>
+
+#include "time_sync.h"
+
+void timeSyncInit(timeSync_t* sync) {
+  memset(sync, 0, sizeof(*sync));
+}
+
+void timeSyncAddRoundTrip(timeSync_t* sync, const uint32_t remoteTxTime, const uint32_t localRxTime, const uint32_t localTxTime, const uint32_t remoteRxTime) {
+  // The two differences are close to each other but can be anything, take
+  // the mean of the (small) difference between them to handle wrap around
+  const uint32_t requestDiff = localRxTime - remoteTxTime;
+  const uint32_t answerDiff = localTxTime - remoteRxTime;
+  const int32_t offset = (int32_t)(requestDiff + (uint32_t)((int32_t)(answerDiff - requestDiff) / 2));
+
+  // A negative delay can only come from clock drift over a short round trip
+  int32_t delay = (int32_t)((remoteRxTime - remoteTxTime) - (localTxTime - localRxTime));
+  if (delay < 0) {
+    delay = 0;
+  }
+
+  sync->samples[sync->next] = (timeSyncSample_t){.offset = offset, .delay = (uint32_t)delay};
+  sync->next = (sync->next + 1) % TIME_SYNC_WINDOW;
+  if (sync->count < TIME_SYNC_WINDOW) {
+    sync->count++;
+  }
+
+  // The error of the offset is at most half the delay, use the best one
+  const timeSyncSample_t* best = &sync->samples[0];
+  for (int i = 1; i < sync->count; i++) {
+    if (sync->samples[i].delay < best->delay) {
+      best = &sync->samples[i];
+    }
+  }
+  sync->offset = best->offset;
+  sync->delay = best->delay;
+}
+
+bool timeSyncIsValid(const timeSync_t* sync) {
+  return sync->count > 0;
+}
+
+uint32_t timeSyncToLocal(const timeSync_t* sync, const uint32_t remoteTime) {
+  return remoteTime + (uint32_t)sync->offset;
+}
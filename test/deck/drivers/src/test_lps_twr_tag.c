@@ -12,13 +12,7 @@
 #include "dw1000Mocks.h"
 #include "physicalConstants.h"
 
-// #include "mock_arm_math.h"
-
-// The mocking FW can not handle the cf_math.h/arm_math.h file, it crashes while parsing it. We have to use manual mocks instead.
-// Temporarily fix to make tests pass, add test code for the estimator part of rxcallback()
-#include "cf_math.h"
-void arm_std_f32( float32_t * pSrc, uint32_t blockSize, float32_t * pResult) { *pResult = 0.0; }
-void arm_mean_f32( float32_t * pSrc, uint32_t blockSize, float32_t * pResult) { *pResult = 0.0; }
+// @MODULE "sliding_median.c"
 
 #include "mock_estimator.h"
 
@@ -0,0 +1,204 @@
+// File under test controller_mellinger.c
+#include "controller_mellinger.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "pptraj.h"
+
+#include "unity.h"
+
+#define SAMPLE_COUNT 1000
+
+static uint32_t randomState;
+
+static float randomFloat(const float min, const float max);
+static struct poly4d randomPiece();
+static void fillSetpointInDegrees(setpoint_t* setpoint, const struct traj_eval* ev);
+static void fillSetpointInRadians(setpoint_t* setpoint, const struct traj_eval* ev);
+static void randomSensorsAndState(sensorData_t* sensors, state_t* state);
+static control_t runTwoTicks(setpoint_t* setpoint, const sensorData_t* sensors, const state_t* state);
+
+void setUp(void) {
+  randomState = 1234;
+  controllerMellingerInit();
+}
+
+void tearDown(void) {}
+
+void testThatTrajectoryHeadingMatchesYaw() {
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    // Fixture
+    const struct poly4d piece = randomPiece();
+    const float t = randomFloat(0.0f, piece.duration);
+
+    // Test
+    const struct traj_eval ev = poly4d_eval(&piece, t);
+
+    // Assert
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, cosf(ev.yaw), ev.heading.x);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, sinf(ev.yaw), ev.heading.y);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, ev.heading.z);
+  }
+}
+
+void testThatFlatAttitudeIsARotationWithZAlongThrust() {
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    // Fixture
+    const struct vec thrust = mkvec(randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f), randomFloat(2.0f, 15.0f));
+    const float yaw = randomFloat(-3.0f, 3.0f);
+    const struct vec heading = mkvec(cosf(yaw), sinf(yaw), 0);
+
+    // Test
+    const struct mat33 R = flat_attitude(thrust, heading);
+
+    // Assert
+    const struct vec x = mcolumn(R, 0);
+    const struct vec y = mcolumn(R, 1);
+    const struct vec z = mcolumn(R, 2);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, vmag(vsub(z, vnormalize(thrust))));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, vmag(vsub(vcross(x, y), z)));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, vdot(y, heading));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.0f, vmag(x));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.0f, vmag(y));
+  }
+}
+
+void testThatHeadingSetpointGivesSameControlAsDegreeSetpoint() {
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    // Fixture
+    const struct poly4d piece = randomPiece();
+    const struct traj_eval ev = poly4d_eval(&piece, randomFloat(0.0f, piece.duration));
+    sensorData_t sensors;
+    state_t state;
+    randomSensorsAndState(&sensors, &state);
+
+    setpoint_t inDegrees;
+    fillSetpointInDegrees(&inDegrees, &ev);
+    setpoint_t inRadians;
+    fillSetpointInRadians(&inRadians, &ev);
+
+    // Test
+    controllerMellingerInit();
+    const control_t expected = runTwoTicks(&inDegrees, &sensors, &state);
+    controllerMellingerInit();
+    const control_t actual = runTwoTicks(&inRadians, &sensors, &state);
+
+    // Assert
+    TEST_ASSERT_FLOAT_WITHIN(expected.thrust * 1e-5f, expected.thrust, actual.thrust);
+    TEST_ASSERT_INT16_WITHIN(1, expected.roll, actual.roll);
+    TEST_ASSERT_INT16_WITHIN(1, expected.pitch, actual.pitch);
+    TEST_ASSERT_INT16_WITHIN(1, expected.yaw, actual.yaw);
+  }
+}
+
+void testThatControllerFallsBackToYawWhenHeadingIsDisabled() {
+  // Fixture
+  const struct poly4d piece = randomPiece();
+  const struct traj_eval ev = poly4d_eval(&piece, piece.duration / 2);
+  sensorData_t sensors;
+  state_t state;
+  randomSensorsAndState(&sensors, &state);
+
+  setpoint_t inDegrees;
+  fillSetpointInDegrees(&inDegrees, &ev);
+  setpoint_t withStaleHeading = inDegrees;
+  withStaleHeading.heading.x = -ev.heading.x;
+  withStaleHeading.heading.y = -ev.heading.y;
+
+  // Test
+  controllerMellingerInit();
+  const control_t expected = runTwoTicks(&inDegrees, &sensors, &state);
+  controllerMellingerInit();
+  const control_t actual = runTwoTicks(&withStaleHeading, &sensors, &state);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT16(expected.roll, actual.roll);
+  TEST_ASSERT_EQUAL_INT16(expected.pitch, actual.pitch);
+  TEST_ASSERT_EQUAL_INT16(expected.yaw, actual.yaw);
+}
+
+// Helpers ///////////////
+
+static float randomFloat(const float min, const float max) {
+  randomState = randomState * 1664525 + 1013904223;
+  return min + (max - min) * (randomState / (float)UINT32_MAX);
+}
+
+static struct poly4d randomPiece() {
+  struct poly4d piece;
+  piece.duration = randomFloat(1.0f, 3.0f);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < PP_SIZE; j++) {
+      piece.p[i][j] = randomFloat(-0.5f, 0.5f) / (j + 1);
+    }
+  }
+  return piece;
+}
+
+// The feed forward as set by the high level commander
+static void fillSetpointInDegrees(setpoint_t* setpoint, const struct traj_eval* ev) {
+  setpoint->position.x = ev->pos.x;
+  setpoint->position.y = ev->pos.y;
+  setpoint->position.z = ev->pos.z;
+  setpoint->velocity.x = ev->vel.x;
+  setpoint->velocity.y = ev->vel.y;
+  setpoint->velocity.z = ev->vel.z;
+  setpoint->acceleration.x = ev->acc.x;
+  setpoint->acceleration.y = ev->acc.y;
+  setpoint->acceleration.z = ev->acc.z;
+  setpoint->attitude.yaw = degrees(ev->yaw);
+  setpoint->attitudeRate.roll = degrees(ev->omega.x);
+  setpoint->attitudeRate.pitch = degrees(ev->omega.y);
+  setpoint->attitudeRate.yaw = degrees(ev->omega.z);
+  setpoint->mode.x = modeAbs;
+  setpoint->mode.y = modeAbs;
+  setpoint->mode.z = modeAbs;
+  setpoint->mode.roll = modeDisable;
+  setpoint->mode.pitch = modeDisable;
+  setpoint->mode.yaw = modeAbs;
+  setpoint->mode.quat = modeDisable;
+  setpoint->mode.heading = modeDisable;
+}
+
+static void fillSetpointInRadians(setpoint_t* setpoint, const struct traj_eval* ev) {
+  fillSetpointInDegrees(setpoint, ev);
+  setpoint->heading.x = ev->heading.x;
+  setpoint->heading.y = ev->heading.y;
+  setpoint->heading.z = ev->heading.z;
+  setpoint->omega.x = ev->omega.x;
+  setpoint->omega.y = ev->omega.y;
+  setpoint->omega.z = ev->omega.z;
+  setpoint->mode.heading = modeAbs;
+}
+
+static void randomSensorsAndState(sensorData_t* sensors, state_t* state) {
+  memset(sensors, 0, sizeof(*sensors));
+  memset(state, 0, sizeof(*state));
+
+  sensors->gyro.x = randomFloat(-30.0f, 30.0f);
+  sensors->gyro.y = randomFloat(-30.0f, 30.0f);
+  sensors->gyro.z = randomFloat(-30.0f, 30.0f);
+
+  state->position.x = randomFloat(-0.1f, 0.1f);
+  state->position.y = randomFloat(-0.1f, 0.1f);
+  state->position.z = randomFloat(-0.1f, 0.1f);
+  state->velocity.x = randomFloat(-0.2f, 0.2f);
+  state->velocity.y = randomFloat(-0.2f, 0.2f);
+  state->velocity.z = randomFloat(-0.2f, 0.2f);
+
+  const struct quat q = rpy2quat(mkvec(randomFloat(-0.2f, 0.2f), randomFloat(-0.2f, 0.2f), randomFloat(-3.0f, 3.0f)));
+  state->attitudeQuaternion.x = q.x;
+  state->attitudeQuaternion.y = q.y;
+  state->attitudeQuaternion.z = q.z;
+  state->attitudeQuaternion.w = q.w;
+  state->attitude.yaw = degrees(quat2rpy(q).z);
+}
+
+// The first tick initializes the derivative terms
+static control_t runTwoTicks(setpoint_t* setpoint, const sensorData_t* sensors, const state_t* state) {
+  control_t control;
+  controllerMellinger(&control, setpoint, sensors, state, 0);
+  controllerMellinger(&control, setpoint, sensors, state, 0);
+  return control;
+}
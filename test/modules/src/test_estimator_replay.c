@@ -0,0 +1,173 @@
+// File under test estimator.c, estimator_kalman.c, estimator_complementary.c
+#include "estimator.h"
+#include "estimator_kalman.h"
+#include "estimator_complementary.h"
+#include "kalman_core.h"
+#include "kalman_supervisor.h"
+#include "state_buffer.h"
+#include "measurement_queue.h"
+#include "outlierFilter.h"
+#include "sensfusion6.h"
+#include "num.h"
+#include "eprintf.h"
+#include "estimatorReplay.h"
+
+// @MODULE "position_estimator_altitude.c"
+// @MODULE "arm_mat_trans_f32.c"
+// @MODULE "arm_mat_mult_f32.c"
+// @MODULE "arm_mat_inverse_f32.c"
+// @MODULE "arm_sin_f32.c"
+// @MODULE "arm_cos_f32.c"
+// @MODULE "arm_common_tables.c"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "unity.h"
+#include "mock_cfassert.h"
+
+// Synthetic, see the header of the file
+#define HOVER_LOG "test/modules/data/estimator_replay_hover.csv"
+#define HOVER_GOLDEN "test/modules/data/estimator_replay_hover_golden.csv"
+#define SAMPLE_INTERVAL 10
+
+// Allows for differences in floating point code generation between hosts and compilers
+#define GOLDEN_TOLERANCE 1e-3f
+
+static replayLog_t replayLog;
+static replayResult_t result;
+
+void setUp(void) {
+  memset(&replayLog, 0, sizeof(replayLog));
+  memset(&result, 0, sizeof(result));
+}
+
+void tearDown(void) {
+  estimatorReplayFreeResult(&result);
+  estimatorReplayFreeLog(&replayLog);
+}
+
+
+void testThatHoverLogIsLoaded() {
+  // Fixture
+  // Test
+  bool actual = estimatorReplayLoad(HOVER_LOG, &replayLog);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT32(1000, replayLog.events[0].tick);
+  TEST_ASSERT_EQUAL_UINT32(2500, replayLog.events[replayLog.count - 1].tick);
+  TEST_ASSERT_EQUAL(replayImu, replayLog.events[0].type);
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, replayLog.events[0].imu.acc.z);
+}
+
+void testThatMissingLogIsRejected() {
+  // Fixture
+  // Test
+  bool actual = estimatorReplayLoad("test/modules/data/no_such_log.csv", &replayLog);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatKalmanReplayMatchesGoldenTrajectory() {
+  // Fixture
+  TEST_ASSERT_TRUE(estimatorReplayLoad(HOVER_LOG, &replayLog));
+
+  // Test
+  estimatorReplayRun(&replayLog, kalmanEstimator, SAMPLE_INTERVAL, &result);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, estimatorReplayCompare(&result, HOVER_GOLDEN, GOLDEN_TOLERANCE));
+}
+
+void testThatKalmanReplayIsDeterministic() {
+  // Fixture
+  TEST_ASSERT_TRUE(estimatorReplayLoad(HOVER_LOG, &replayLog));
+  replayResult_t first;
+  estimatorReplayRun(&replayLog, kalmanEstimator, SAMPLE_INTERVAL, &first);
+
+  // Test
+  estimatorReplayRun(&replayLog, kalmanEstimator, SAMPLE_INTERVAL, &result);
+
+  // Assert
+  TEST_ASSERT_EQUAL(first.count, result.count);
+  for (size_t i = 0; i < result.count; i++) {
+    TEST_ASSERT_EQUAL_MEMORY(&first.samples[i].state, &result.samples[i].state, sizeof(state_t));
+  }
+
+  estimatorReplayFreeResult(&first);
+}
+
+void testThatKalmanConvergesToPositionMeasurements() {
+  // Fixture
+  TEST_ASSERT_TRUE(estimatorReplayLoad(HOVER_LOG, &replayLog));
+
+  // Test
+  estimatorReplayRun(&replayLog, kalmanEstimator, SAMPLE_INTERVAL, &result);
+
+  // Assert
+  const state_t* last = &result.samples[result.count - 1].state;
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, last->position.x);
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, -0.5f, last->position.y);
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.3f, last->position.z);
+  TEST_ASSERT_EQUAL_UINT32(0, result.droppedMeasurements);
+}
+
+void testThatComplementaryEstimatorStaysLevel() {
+  // Fixture
+  TEST_ASSERT_TRUE(estimatorReplayLoad(HOVER_LOG, &replayLog));
+
+  // Test
+  estimatorReplayRun(&replayLog, complementaryEstimator, SAMPLE_INTERVAL, &result);
+
+  // Assert
+  const state_t* last = &result.samples[result.count - 1].state;
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, last->attitude.roll);
+  TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, last->attitude.pitch);
+}
+
+// Replays an arbitrary log, for instance a recording from a flight. Set
+//   ESTIMATOR_REPLAY_LOG       the log to replay
+//   ESTIMATOR_REPLAY_ESTIMATOR "kalman" (default) or "complementary"
+//   ESTIMATOR_REPLAY_INTERVAL  optional number of ticks between samples, default 1
+//   ESTIMATOR_REPLAY_OUT       optional file to write the trajectory to
+//   ESTIMATOR_REPLAY_GOLDEN    optional trajectory to compare with
+void testThatLogFromEnvironmentIsReplayed() {
+  // Fixture
+  const char* logFile = getenv("ESTIMATOR_REPLAY_LOG");
+  if (!logFile) {
+    TEST_IGNORE_MESSAGE("ESTIMATOR_REPLAY_LOG not set");
+  }
+
+  StateEstimatorType estimator = kalmanEstimator;
+  const char* estimatorName = getenv("ESTIMATOR_REPLAY_ESTIMATOR");
+  if (estimatorName && strcmp(estimatorName, "complementary") == 0) {
+    estimator = complementaryEstimator;
+  }
+
+  uint32_t sampleInterval = 1;
+  const char* interval = getenv("ESTIMATOR_REPLAY_INTERVAL");
+  if (interval && atoi(interval) > 0) {
+    sampleInterval = atoi(interval);
+  }
+
+  TEST_ASSERT_TRUE_MESSAGE(estimatorReplayLoad(logFile, &replayLog), "Failed to load log");
+
+  // Test
+  estimatorReplayRun(&replayLog, estimator, sampleInterval, &result);
+
+  // Assert
+  const char* outFile = getenv("ESTIMATOR_REPLAY_OUT");
+  if (outFile) {
+    TEST_ASSERT_TRUE(estimatorReplayWriteTrajectory(&result, outFile));
+  }
+
+  const char* goldenFile = getenv("ESTIMATOR_REPLAY_GOLDEN");
+  if (goldenFile) {
+    TEST_ASSERT_EQUAL_INT(0, estimatorReplayCompare(&result, goldenFile, GOLDEN_TOLERANCE));
+  }
+
+  printf("Replayed %u ticks, mean update %.1f us, max update %.1f us, %u dropped measurements\n",
+    (unsigned int)result.updateCount, result.totalUpdateTimeUs / result.updateCount, result.maxUpdateTimeUs, (unsigned int)result.droppedMeasurements);
+}
@@ -0,0 +1,141 @@
+// File under test kalman_core.c
+#include "kalman_core.h"
+#include "outlierFilter.h"
+
+// @MODULE "arm_mat_trans_f32.c"
+// @MODULE "arm_mat_mult_f32.c"
+// @MODULE "arm_mat_inverse_f32.c"
+// @MODULE "arm_sin_f32.c"
+// @MODULE "arm_cos_f32.c"
+// @MODULE "arm_common_tables.c"
+
+#include <string.h>
+
+#include "unity.h"
+#include "mock_cfassert.h"
+
+static kalmanCoreData_t coreData;
+
+static positionMeasurement_t positionAt(const float x, const float y, const float z);
+static poseMeasurement_t poseAt(const float x, const float y, const float z, const float yaw);
+
+void setUp(void) {
+  kalmanCoreInit(&coreData);
+}
+
+void tearDown(void) {}
+
+void testThatPastStateIsCurrentPositionAndAttitude() {
+  // Fixture
+  coreData.S[KC_STATE_X] = 1.0f;
+  coreData.S[KC_STATE_Y] = 2.0f;
+  coreData.S[KC_STATE_Z] = 3.0f;
+
+  // Test
+  kalmanCorePastState_t past;
+  kalmanCoreGetPastState(&coreData, &past);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, past.pos[0]);
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, past.pos[1]);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, past.pos[2]);
+  TEST_ASSERT_EQUAL_FLOAT_ARRAY(coreData.q, past.q, 4);
+}
+
+void testThatPastPositionWithCurrentStateMatchesPositionUpdate() {
+  // Fixture
+  kalmanCoreData_t expected;
+  memcpy(&expected, &coreData, sizeof(expected));
+  expected.Pm.pData = (float*)expected.P;
+  positionMeasurement_t measurement = positionAt(0.1f, -0.2f, 0.3f);
+  kalmanCorePastState_t past;
+  kalmanCoreGetPastState(&coreData, &past);
+
+  // Test
+  kalmanCoreUpdateWithPosition(&expected, &measurement);
+  kalmanCoreUpdateWithPastPosition(&coreData, &measurement, &past);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT_ARRAY(expected.S, coreData.S, KC_STATE_DIM);
+}
+
+void testThatPositionMatchingThePastStateDoesNotMoveTheState() {
+  // Fixture
+  // The Crazyflie was at 0.5 when the measurement was captured and has moved since
+  coreData.S[KC_STATE_X] = 0.6f;
+  kalmanCorePastState_t past;
+  kalmanCoreGetPastState(&coreData, &past);
+  past.pos[0] = 0.5f;
+  positionMeasurement_t measurement = positionAt(0.5f, 0.0f, 0.0f);
+
+  // Test
+  kalmanCoreUpdateWithPastPosition(&coreData, &measurement, &past);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.6f, coreData.S[KC_STATE_X]);
+}
+
+void testThatPositionOffsetFromThePastStateIsApplied() {
+  // Fixture
+  coreData.S[KC_STATE_X] = 0.6f;
+  kalmanCoreData_t reference;
+  memcpy(&reference, &coreData, sizeof(reference));
+  reference.Pm.pData = (float*)reference.P;
+  reference.S[KC_STATE_X] = 0.5f;
+
+  kalmanCorePastState_t past;
+  kalmanCoreGetPastState(&reference, &past);
+  positionMeasurement_t measurement = positionAt(0.55f, 0.0f, 0.0f);
+
+  // Test
+  kalmanCoreUpdateWithPosition(&reference, &measurement);
+  kalmanCoreUpdateWithPastPosition(&coreData, &measurement, &past);
+
+  // Assert
+  // Same correction as if the measurement had been applied at capture time
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, reference.S[KC_STATE_X] - 0.5f, coreData.S[KC_STATE_X] - 0.6f);
+}
+
+void testThatAttitudeMatchingThePastStateDoesNotMoveTheAttitudeError() {
+  // Fixture
+  kalmanCorePastState_t past;
+  kalmanCoreGetPastState(&coreData, &past);
+  // The Crazyflie had a yaw of 0.2 rad when the pose was captured
+  poseMeasurement_t measurement = poseAt(0.0f, 0.0f, 0.0f, 0.2f);
+  past.q[0] = measurement.quat.w;
+  past.q[1] = measurement.quat.x;
+  past.q[2] = measurement.quat.y;
+  past.q[3] = measurement.quat.z;
+
+  // Test
+  kalmanCoreUpdateWithPastPose(&coreData, &measurement, &past);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, coreData.S[KC_STATE_D2]);
+}
+
+void testThatPoseUpdateCorrectsTheAttitudeError() {
+  // Fixture
+  poseMeasurement_t measurement = poseAt(0.0f, 0.0f, 0.0f, 0.2f);
+
+  // Test
+  kalmanCoreUpdateWithPose(&coreData, &measurement);
+
+  // Assert
+  TEST_ASSERT_TRUE(coreData.S[KC_STATE_D2] > 0.01f);
+}
+
+// Helpers ///////////////
+
+static positionMeasurement_t positionAt(const float x, const float y, const float z) {
+  return (positionMeasurement_t){.x = x, .y = y, .z = z, .stdDev = 0.01f};
+}
+
+static poseMeasurement_t poseAt(const float x, const float y, const float z, const float yaw) {
+  poseMeasurement_t pose = {.x = x, .y = y, .z = z, .stdDevPos = 0.01f, .stdDevQuat = 0.01f};
+  pose.quat.w = cosf(yaw / 2.0f);
+  pose.quat.x = 0.0f;
+  pose.quat.y = 0.0f;
+  pose.quat.z = sinf(yaw / 2.0f);
+  return pose;
+}
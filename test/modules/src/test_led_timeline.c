@@ -0,0 +1,175 @@
+// File under test led_timeline.c
+#include "led_timeline.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static uint8_t memory[64];
+static ledTimelineCursor_t cursor;
+static uint8_t color[3];
+
+static void setSegmentCount(const uint16_t count);
+static void setSegment(const uint16_t index, const uint16_t duration, const uint8_t type, const uint8_t r, const uint8_t g, const uint8_t b);
+static void assertColor(const uint8_t r, const uint8_t g, const uint8_t b);
+
+void setUp(void) {
+  memset(memory, 0, sizeof(memory));
+  memset(color, 0xAA, sizeof(color));
+  ledTimelineCursorReset(&cursor);
+}
+
+void tearDown(void) {}
+
+void testThatEmptyTimelineIsNotEvaluated() {
+  // Fixture
+  // Test
+  const bool actual = ledTimelineEvaluate(memory, sizeof(memory), &cursor, 100, color);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  assertColor(0xAA, 0xAA, 0xAA);
+}
+
+void testThatStepSegmentSetsColorForWholeSegment() {
+  // Fixture
+  setSegment(0, 1000, LED_TIMELINE_STEP, 10, 20, 30);
+  setSegmentCount(1);
+
+  // Test
+  ledTimelineEvaluate(memory, sizeof(memory), &cursor, 0, color);
+
+  // Assert
+  assertColor(10, 20, 30);
+}
+
+void testThatFirstFadeStartsFromBlack() {
+  // Fixture
+  setSegment(0, 1000, LED_TIMELINE_FADE, 100, 200, 50);
+  setSegmentCount(1);
+
+  // Test
+  ledTimelineEvaluate(memory, sizeof(memory), &cursor, 500, color);
+
+  // Assert
+  assertColor(50, 100, 25);
+}
+
+void testThatFadeInterpolatesFromPreviousColor() {
+  // Fixture
+  setSegment(0, 1000, LED_TIMELINE_STEP, 200, 0, 100);
+  setSegment(1, 400, LED_TIMELINE_FADE, 0, 200, 100);
+  setSegmentCount(2);
+
+  // Test
+  ledTimelineEvaluate(memory, sizeof(memory), &cursor, 1100, color);
+
+  // Assert
+  assertColor(150, 50, 100);
+}
+
+void testThatLastColorIsHeldAfterTheEnd() {
+  // Fixture
+  setSegment(0, 1000, LED_TIMELINE_STEP, 1, 2, 3);
+  setSegment(1, 1000, LED_TIMELINE_FADE, 4, 5, 6);
+  setSegmentCount(2);
+
+  // Test
+  const bool actual = ledTimelineEvaluate(memory, sizeof(memory), &cursor, 60000, color);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  assertColor(4, 5, 6);
+}
+
+void testThatTimeGoingBackwardsIsEvaluatedFromTheStart() {
+  // Fixture
+  setSegment(0, 1000, LED_TIMELINE_STEP, 1, 1, 1);
+  setSegment(1, 1000, LED_TIMELINE_STEP, 2, 2, 2);
+  setSegment(2, 1000, LED_TIMELINE_STEP, 3, 3, 3);
+  setSegmentCount(3);
+  ledTimelineEvaluate(memory, sizeof(memory), &cursor, 2500, color);
+
+  // Test
+  ledTimelineEvaluate(memory, sizeof(memory), &cursor, 500, color);
+
+  // Assert
+  assertColor(1, 1, 1);
+}
+
+void testThatIncreasingTimeFollowsTheSegments() {
+  // Fixture
+  setSegment(0, 100, LED_TIMELINE_STEP, 1, 1, 1);
+  setSegment(1, 0, LED_TIMELINE_STEP, 9, 9, 9);
+  setSegment(2, 100, LED_TIMELINE_STEP, 2, 2, 2);
+  setSegment(3, 100, LED_TIMELINE_STEP, 3, 3, 3);
+  setSegmentCount(4);
+  const uint8_t expected[] = {1, 1, 2, 2, 3, 3, 3, 3};
+
+  for (int i = 0; i < 8; i++) {
+    // Test
+    ledTimelineEvaluate(memory, sizeof(memory), &cursor, i * 50, color);
+
+    // Assert
+    assertColor(expected[i], expected[i], expected[i]);
+  }
+}
+
+void testThatSegmentsOutsideTheMemoryAreIgnored() {
+  // Fixture
+  const uint32_t memorySize = sizeof(uint16_t) + 2 * sizeof(ledTimelineSegment_t);
+  setSegment(0, 100, LED_TIMELINE_STEP, 1, 1, 1);
+  setSegment(1, 100, LED_TIMELINE_STEP, 2, 2, 2);
+  setSegment(2, 100, LED_TIMELINE_STEP, 3, 3, 3);
+  setSegmentCount(1000);
+
+  // Test
+  ledTimelineEvaluate(memory, memorySize, &cursor, 250, color);
+
+  // Assert
+  assertColor(2, 2, 2);
+}
+
+void testThatMemoryWriteIsCopiedAndCounted() {
+  // Fixture
+  const uint8_t data[] = {1, 2, 3};
+  const uint32_t writeCountBefore = ledTimelineMemoryWriteCount();
+
+  // Test
+  const bool actual = ledTimelineMemoryWrite(10, sizeof(data), data);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(data, &ledTimelineMemory[10], sizeof(data));
+  TEST_ASSERT_EQUAL_UINT32(writeCountBefore + 1, ledTimelineMemoryWriteCount());
+}
+
+void testThatMemoryWriteOutsideTheMemoryIsRejected() {
+  // Fixture
+  const uint8_t data[] = {1, 2, 3};
+  const uint32_t writeCountBefore = ledTimelineMemoryWriteCount();
+
+  // Test
+  const bool actual = ledTimelineMemoryWrite(LED_TIMELINE_MEMORY_SIZE - 2, sizeof(data), data);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT32(writeCountBefore, ledTimelineMemoryWriteCount());
+}
+
+// Helpers ///////////////
+
+static void setSegmentCount(const uint16_t count) {
+  memcpy(memory, &count, sizeof(count));
+}
+
+static void setSegment(const uint16_t index, const uint16_t duration, const uint8_t type, const uint8_t r, const uint8_t g, const uint8_t b) {
+  ledTimelineSegment_t segment = {.duration = duration, .type = type, .color = {r, g, b}};
+  memcpy(&memory[sizeof(uint16_t) + index * sizeof(ledTimelineSegment_t)], &segment, sizeof(segment));
+}
+
+static void assertColor(const uint8_t r, const uint8_t g, const uint8_t b) {
+  TEST_ASSERT_EQUAL_UINT8(r, color[0]);
+  TEST_ASSERT_EQUAL_UINT8(g, color[1]);
+  TEST_ASSERT_EQUAL_UINT8(b, color[2]);
+}
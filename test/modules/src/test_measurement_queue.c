@@ -0,0 +1,229 @@
+// File under test measurement_queue.c
+#include "measurement_queue.h"
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#include "unity.h"
+
+#define FAKE_QUEUE_MAX_LENGTH 64
+
+static uint64_t now;
+
+static measurement_t measurementOf(const MeasurementType type);
+static void fillQuota(const MeasurementType type);
+
+void setUp(void) {
+  now = 1000;
+  measurementQueueInit();
+}
+
+void tearDown(void) {}
+
+void testThatQueueIsEmptyAfterInit() {
+  // Fixture
+  measurement_t measurement;
+
+  // Test
+  const bool actual = measurementQueueGet(&measurement);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatMeasurementsAreReturnedInEnqueueOrder() {
+  // Fixture
+  const MeasurementType types[] = {MeasurementTypeTDOA, MeasurementTypeTOF, MeasurementTypeTDOA, MeasurementTypeFlow, MeasurementTypePose};
+  const int count = sizeof(types) / sizeof(types[0]);
+  for (int i = 0; i < count; i++) {
+    now = 1000 + i;
+    measurement_t measurement = measurementOf(types[i]);
+    measurementQueuePut(&measurement);
+  }
+
+  // Test
+  // Assert
+  for (int i = 0; i < count; i++) {
+    measurement_t actual;
+    TEST_ASSERT_TRUE(measurementQueueGet(&actual));
+    TEST_ASSERT_EQUAL_INT(types[i], actual.type);
+    TEST_ASSERT_EQUAL_UINT64(1000 + i, actual.timestamp);
+  }
+  measurement_t actual;
+  TEST_ASSERT_FALSE(measurementQueueGet(&actual));
+}
+
+void testThatMeasurementIsStampedWhenEnqueued() {
+  // Fixture
+  measurement_t measurement = measurementOf(MeasurementTypeTOF);
+  now = 123456;
+
+  // Test
+  measurementQueuePut(&measurement);
+
+  // Assert
+  measurement_t actual;
+  now = 200000;
+  measurementQueueGet(&actual);
+  TEST_ASSERT_EQUAL_UINT64(123456, actual.timestamp);
+}
+
+void testThatMeasurementIsDroppedWhenTheQuotaOfItsTypeIsUsed() {
+  // Fixture
+  fillQuota(MeasurementTypeTDOA);
+  measurement_t measurement = measurementOf(MeasurementTypeTDOA);
+
+  // Test
+  const bool actual = measurementQueuePut(&measurement);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT32(1, measurementQueueGetDropCount(MeasurementTypeTDOA));
+}
+
+void testThatDropsAreCountedPerType() {
+  // Fixture
+  fillQuota(MeasurementTypeTDOA);
+  fillQuota(MeasurementTypeFlow);
+
+  // Test
+  for (int i = 0; i < 3; i++) {
+    measurement_t measurement = measurementOf(MeasurementTypeTDOA);
+    measurementQueuePut(&measurement);
+  }
+  measurement_t measurement = measurementOf(MeasurementTypeFlow);
+  measurementQueuePut(&measurement);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(3, measurementQueueGetDropCount(MeasurementTypeTDOA));
+  TEST_ASSERT_EQUAL_UINT32(1, measurementQueueGetDropCount(MeasurementTypeFlow));
+  TEST_ASSERT_EQUAL_UINT32(0, measurementQueueGetDropCount(MeasurementTypeTOF));
+}
+
+void testThatABurstOfOneTypeDoesNotCrowdOutTheOthers() {
+  // Fixture
+  for (int i = 0; i < 100; i++) {
+    measurement_t measurement = measurementOf(MeasurementTypeTDOA);
+    measurementQueuePut(&measurement);
+  }
+
+  // Test
+  // Assert
+  for (int type = 0; type < MeasurementType_COUNT; type++) {
+    if (type == MeasurementTypeTDOA) {
+      continue;
+    }
+    for (int i = 0; i < measurementQueueGetQuota(type); i++) {
+      measurement_t measurement = measurementOf(type);
+      TEST_ASSERT_TRUE(measurementQueuePut(&measurement));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, measurementQueueGetDropCount(type));
+  }
+}
+
+void testThatQuotaIsFreedWhenMeasurementIsTaken() {
+  // Fixture
+  fillQuota(MeasurementTypeTOF);
+  measurement_t taken;
+  measurementQueueGet(&taken);
+  measurement_t measurement = measurementOf(MeasurementTypeTOF);
+
+  // Test
+  const bool actual = measurementQueuePut(&measurement);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT32(0, measurementQueueGetDropCount(MeasurementTypeTOF));
+}
+
+void testThatResetEmptiesTheQueueAndFreesTheQuotas() {
+  // Fixture
+  fillQuota(MeasurementTypeTOF);
+
+  // Test
+  measurementQueueReset();
+
+  // Assert
+  measurement_t actual;
+  TEST_ASSERT_FALSE(measurementQueueGet(&actual));
+  fillQuota(MeasurementTypeTOF);
+  TEST_ASSERT_EQUAL_UINT32(0, measurementQueueGetDropCount(MeasurementTypeTOF));
+}
+
+// Helpers ///////////////
+
+static measurement_t measurementOf(const MeasurementType type) {
+  measurement_t measurement;
+  memset(&measurement, 0, sizeof(measurement));
+  measurement.type = type;
+  return measurement;
+}
+
+static void fillQuota(const MeasurementType type) {
+  for (int i = 0; i < measurementQueueGetQuota(type); i++) {
+    measurement_t measurement = measurementOf(type);
+    TEST_ASSERT_TRUE(measurementQueuePut(&measurement));
+  }
+}
+
+uint64_t usecTimestamp(void) {
+  return now;
+}
+
+// Fake FreeRTOS queue, one queue at a time
+
+static struct {
+  uint8_t storage[FAKE_QUEUE_MAX_LENGTH * sizeof(measurement_t)];
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  UBaseType_t head;
+  UBaseType_t count;
+} fakeQueue;
+
+QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, const uint8_t ucQueueType) {
+  (void)ucQueueType;
+  TEST_ASSERT_TRUE(uxQueueLength * uxItemSize <= sizeof(fakeQueue.storage));
+  memset(&fakeQueue, 0, sizeof(fakeQueue));
+  fakeQueue.length = uxQueueLength;
+  fakeQueue.itemSize = uxItemSize;
+  return &fakeQueue;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait, const BaseType_t xCopyPosition) {
+  (void)xQueue;
+  (void)xTicksToWait;
+  (void)xCopyPosition;
+  if (fakeQueue.count == fakeQueue.length) {
+    return errQUEUE_FULL;
+  }
+
+  const UBaseType_t index = (fakeQueue.head + fakeQueue.count) % fakeQueue.length;
+  memcpy(&fakeQueue.storage[index * fakeQueue.itemSize], pvItemToQueue, fakeQueue.itemSize);
+  fakeQueue.count++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueGenericReceive(QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait, const BaseType_t xJustPeek) {
+  (void)xQueue;
+  (void)xTicksToWait;
+  if (fakeQueue.count == 0) {
+    return pdFALSE;
+  }
+
+  memcpy(pvBuffer, &fakeQueue.storage[fakeQueue.head * fakeQueue.itemSize], fakeQueue.itemSize);
+  if (!xJustPeek) {
+    fakeQueue.head = (fakeQueue.head + 1) % fakeQueue.length;
+    fakeQueue.count--;
+  }
+  return pdTRUE;
+}
+
+BaseType_t xQueueGenericReset(QueueHandle_t xQueue, BaseType_t xNewQueue) {
+  (void)xQueue;
+  (void)xNewQueue;
+  fakeQueue.head = 0;
+  fakeQueue.count = 0;
+  return pdPASS;
+}
@@ -0,0 +1,235 @@
+// File under test pid_batch.c
+#include "pid_batch.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "pid.h"
+#include "num.h"
+#include "filter.h"
+
+#include "unity.h"
+
+// @MODULE "arm_add_f32.c"
+// @MODULE "arm_sub_f32.c"
+// @MODULE "arm_mult_f32.c"
+// @MODULE "arm_scale_f32.c"
+
+#define DT (1.0f / 500.0f)
+#define RATE 500.0f
+#define CUTOFF 30.0f
+#define STEP_COUNT 1000
+
+static pidBatch_t batch;
+static PidObject scalar[PID_BATCH_MAX_AXES];
+
+static uint32_t randomState;
+
+static float randomFloat(const float min, const float max);
+static void initBatchAndScalar(const int count);
+
+void setUp(void) {
+  randomState = 1234;
+}
+
+void tearDown(void) {}
+
+void testThatBatchMatchesScalarPid() {
+  // Fixture
+  initBatchAndScalar(PID_BATCH_MAX_AXES);
+
+  for (int step = 0; step < STEP_COUNT; step++) {
+    float measured[PID_BATCH_MAX_AXES];
+    for (int i = 0; i < PID_BATCH_MAX_AXES; i++) {
+      measured[i] = randomFloat(-50.0f, 50.0f);
+      const float desired = randomFloat(-50.0f, 50.0f);
+      batch.desired[i] = desired;
+      pidSetDesired(&scalar[i], desired);
+    }
+
+    // Test
+    const float* actual = pidBatchUpdate(&batch, measured, 0);
+
+    // Assert
+    for (int i = 0; i < PID_BATCH_MAX_AXES; i++) {
+      const float expected = pidUpdate(&scalar[i], measured[i], true);
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f * fmaxf(1.0f, fabsf(expected)), expected, actual[i]);
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f * fmaxf(1.0f, fabsf(scalar[i].integ)), scalar[i].integ, batch.integ[i]);
+    }
+  }
+}
+
+void testThatBatchMatchesScalarPidWithPresetError() {
+  // Fixture
+  initBatchAndScalar(3);
+
+  for (int step = 0; step < STEP_COUNT; step++) {
+    for (int i = 0; i < 3; i++) {
+      const float error = randomFloat(-180.0f, 180.0f);
+      batch.error[i] = error;
+      pidSetError(&scalar[i], error);
+    }
+
+    // Test
+    const float* actual = pidBatchUpdate(&batch, 0, 0);
+
+    // Assert
+    for (int i = 0; i < 3; i++) {
+      const float expected = pidUpdate(&scalar[i], 0.0f, false);
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f * fmaxf(1.0f, fabsf(expected)), expected, actual[i]);
+    }
+  }
+}
+
+void testThatFeedForwardIsAddedToOutput() {
+  // Fixture
+  pidBatchInit(&batch, 2, DT);
+  pidBatchInitAxis(&batch, 0, 1.0f, 0.0f, 0.0f, 0.0f, RATE, CUTOFF, false);
+  pidBatchInitAxis(&batch, 1, 1.0f, 0.0f, 0.0f, 0.0f, RATE, CUTOFF, false);
+  batch.kff[0] = 2.0f;
+  batch.kff[1] = 0.5f;
+  batch.desired[0] = 1.0f;
+  batch.desired[1] = 1.0f;
+  const float measured[] = {0.0f, 0.0f};
+  const float feedForward[] = {3.0f, -4.0f};
+
+  // Test
+  const float* actual = pidBatchUpdate(&batch, measured, feedForward);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(1.0f + 6.0f, actual[0]);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f - 2.0f, actual[1]);
+  TEST_ASSERT_EQUAL_FLOAT(-2.0f, batch.outFF[1]);
+}
+
+void testThatIntegralIsFrozenWhenSaturatedWithAntiWindup() {
+  // Fixture
+  pidBatchInit(&batch, 1, DT);
+  pidBatchInitAxis(&batch, 0, 1.0f, 10.0f, 0.0f, 0.0f, RATE, CUTOFF, false);
+  batch.outputLimit[0] = 5.0f;
+  batch.antiWindup = true;
+  batch.desired[0] = 10.0f;
+  const float measured[] = {0.0f};
+
+  // Test
+  for (int step = 0; step < STEP_COUNT; step++) {
+    pidBatchUpdate(&batch, measured, 0);
+  }
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, batch.integ[0]);
+  TEST_ASSERT_EQUAL_FLOAT(5.0f, batch.output[0]);
+}
+
+void testThatIntegralWindsUpWhenSaturatedWithoutAntiWindup() {
+  // Fixture
+  pidBatchInit(&batch, 1, DT);
+  pidBatchInitAxis(&batch, 0, 1.0f, 10.0f, 0.0f, 0.0f, RATE, CUTOFF, false);
+  batch.outputLimit[0] = 5.0f;
+  batch.antiWindup = false;
+  batch.desired[0] = 10.0f;
+  const float measured[] = {0.0f};
+
+  // Test
+  for (int step = 0; step < STEP_COUNT; step++) {
+    pidBatchUpdate(&batch, measured, 0);
+  }
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, STEP_COUNT * DT * 10.0f, batch.integ[0]);
+  TEST_ASSERT_EQUAL_FLOAT(5.0f, batch.output[0]);
+}
+
+void testThatIntegralUnwindsWhenSaturatedWithAntiWindup() {
+  // Fixture
+  pidBatchInit(&batch, 1, DT);
+  pidBatchInitAxis(&batch, 0, 1.0f, 10.0f, 0.0f, 0.0f, RATE, CUTOFF, false);
+  batch.outputLimit[0] = 5.0f;
+  batch.antiWindup = true;
+  batch.integ[0] = 2.0f;
+  batch.desired[0] = 0.0f;
+  const float measured[] = {-1.0f};
+
+  // Test
+  // Output is saturated (1 + 20), but the error is reducing the integral
+  batch.desired[0] = -2.0f;
+  pidBatchUpdate(&batch, measured, 0);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f - DT, batch.integ[0]);
+}
+
+void testThatResetAxisOnlyResetsThatAxis() {
+  // Fixture
+  initBatchAndScalar(2);
+  batch.desired[0] = 1.0f;
+  batch.desired[1] = 1.0f;
+  const float measured[] = {0.0f, 0.0f};
+  pidBatchUpdate(&batch, measured, 0);
+
+  // Test
+  pidBatchResetAxis(&batch, 1);
+
+  // Assert
+  TEST_ASSERT_NOT_EQUAL(0.0f, batch.integ[0]);
+  TEST_ASSERT_NOT_EQUAL(0.0f, batch.prevError[0]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, batch.integ[1]);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, batch.prevError[1]);
+}
+
+void testThatSkippedAxisMatchesScalarPidThatIsNotUpdated() {
+  // Fixture
+  initBatchAndScalar(PID_BATCH_MAX_AXES);
+
+  for (int step = 0; step < STEP_COUNT; step++) {
+    float measured[PID_BATCH_MAX_AXES];
+    for (int i = 0; i < PID_BATCH_MAX_AXES; i++) {
+      measured[i] = randomFloat(-50.0f, 50.0f);
+      const float desired = randomFloat(-50.0f, 50.0f);
+      batch.desired[i] = desired;
+      pidSetDesired(&scalar[i], desired);
+      batch.skip[i] = randomFloat(0.0f, 1.0f) < 0.3f;
+    }
+    float previousOutput[PID_BATCH_MAX_AXES];
+    memcpy(previousOutput, batch.output, sizeof(previousOutput));
+
+    // Test
+    const float* actual = pidBatchUpdate(&batch, measured, 0);
+
+    // Assert
+    for (int i = 0; i < PID_BATCH_MAX_AXES; i++) {
+      if (batch.skip[i]) {
+        TEST_ASSERT_EQUAL_FLOAT(previousOutput[i], actual[i]);
+      } else {
+        const float expected = pidUpdate(&scalar[i], measured[i], true);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f * fmaxf(1.0f, fabsf(expected)), expected, actual[i]);
+      }
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f * fmaxf(1.0f, fabsf(scalar[i].integ)), scalar[i].integ, batch.integ[i]);
+      TEST_ASSERT_FLOAT_WITHIN(1e-4f * fmaxf(1.0f, fabsf(scalar[i].prevError)), scalar[i].prevError, batch.prevError[i]);
+    }
+  }
+}
+
+// Helpers ///////////////
+
+static float randomFloat(const float min, const float max) {
+  randomState = randomState * 1664525 + 1013904223;
+  return min + (max - min) * (randomState >> 8) / (float)(1 << 24);
+}
+
+static void initBatchAndScalar(const int count) {
+  pidBatchInit(&batch, count, DT);
+
+  for (int i = 0; i < count; i++) {
+    const float kp = randomFloat(0.0f, 250.0f);
+    const float ki = randomFloat(0.0f, 500.0f);
+    const float kd = randomFloat(0.0f, 2.5f);
+    const float iLimit = randomFloat(0.0f, 50.0f);
+    const bool enableDFilter = (i % 2) == 1;
+
+    pidBatchInitAxis(&batch, i, kp, ki, kd, iLimit, RATE, CUTOFF, enableDFilter);
+
+    pidInit(&scalar[i], 0, kp, ki, kd, DT, RATE, CUTOFF, enableDFilter);
+    pidSetIntegralLimit(&scalar[i], iLimit);
+  }
+}
@@ -0,0 +1,127 @@
+// File under test state_buffer.c
+#include "state_buffer.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static stateBuffer_t buffer;
+
+static state_t stateAt(const float x);
+
+void setUp(void) {
+  stateBufferInit(&buffer);
+}
+
+void tearDown(void) {}
+
+void testThatLatestPublishedStateIsRead() {
+  // Fixture
+  const state_t first = stateAt(1.0f);
+  const state_t second = stateAt(2.0f);
+  stateBufferPublish(&buffer, &first, 100);
+  stateBufferPublish(&buffer, &second, 101);
+
+  // Test
+  state_t actual;
+  uint32_t actualTick;
+  stateBufferRead(&buffer, &actual, &actualTick);
+
+  // Assert
+  TEST_ASSERT_EQUAL_MEMORY(&second, &actual, sizeof(state_t));
+  TEST_ASSERT_EQUAL_UINT32(101, actualTick);
+}
+
+void testThatSequenceIsIncrementedOnPublish() {
+  // Fixture
+  const state_t state = stateAt(1.0f);
+  state_t actual;
+  uint32_t actualTick;
+  const uint32_t before = stateBufferRead(&buffer, &actual, &actualTick);
+
+  // Test
+  stateBufferPublish(&buffer, &state, 100);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(before + 1, stateBufferRead(&buffer, &actual, &actualTick));
+}
+
+void testThatPublishLeavesTheSlotBeingReadUntouched() {
+  // Fixture
+  const state_t first = stateAt(1.0f);
+  const state_t second = stateAt(2.0f);
+  stateBufferPublish(&buffer, &first, 100);
+  state_t read;
+  uint32_t readTick;
+  const uint32_t sequence = stateBufferReadBegin(&buffer, &read, &readTick);
+
+  // Test
+  // The writer runs while the reader is copying
+  stateBufferPublish(&buffer, &second, 101);
+
+  // Assert
+  TEST_ASSERT_EQUAL_MEMORY(&first, &buffer.slots[sequence & 1].state, sizeof(state_t));
+  TEST_ASSERT_EQUAL_UINT32(100, buffer.slots[sequence & 1].tick);
+}
+
+void testThatReadIsRetriedIfStateWasPublishedDuringTheCopy() {
+  // Fixture
+  const state_t first = stateAt(1.0f);
+  const state_t second = stateAt(2.0f);
+  stateBufferPublish(&buffer, &first, 100);
+  state_t read;
+  uint32_t readTick;
+  const uint32_t sequence = stateBufferReadBegin(&buffer, &read, &readTick);
+  stateBufferPublish(&buffer, &second, 101);
+
+  // Test
+  const bool actual = stateBufferReadRetry(&buffer, sequence);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+}
+
+void testThatReadIsNotRetriedWithoutPublish() {
+  // Fixture
+  const state_t first = stateAt(1.0f);
+  stateBufferPublish(&buffer, &first, 100);
+  state_t read;
+  uint32_t readTick;
+  const uint32_t sequence = stateBufferReadBegin(&buffer, &read, &readTick);
+
+  // Test
+  const bool actual = stateBufferReadRetry(&buffer, sequence);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_MEMORY(&first, &read, sizeof(state_t));
+  TEST_ASSERT_EQUAL_UINT32(100, readTick);
+}
+
+void testThatStateIsPredictedForwardAtConstantVelocity() {
+  // Fixture
+  state_t state = stateAt(1.0f);
+  state.velocity.y = 2.0f;
+  state.velocity.z = 0.5f;
+
+  // Test
+  stateBufferPredict(&state, 120, 0.02f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.98f, state.position.x);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.04f, state.position.y);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.01f, state.position.z);
+  TEST_ASSERT_EQUAL_UINT32(120, state.position.timestamp);
+  TEST_ASSERT_EQUAL_FLOAT(10.0f, state.attitude.yaw);
+}
+
+// Helpers ///////////////
+
+static state_t stateAt(const float x) {
+  state_t state;
+  memset(&state, 0, sizeof(state));
+  state.position.x = x;
+  state.velocity.x = -x;
+  state.attitude.yaw = 10.0f * x;
+  return state;
+}
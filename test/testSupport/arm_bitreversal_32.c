@@ -0,0 +1,19 @@
+#include <stdint.h>
+
+// C version of arm_bitreversal_32(), in CMSIS-DSP it is only available as
+// assembler for the Cortex-M (arm_bitreversal2.S) which can not be built on
+// the host. The table holds pairs of byte offsets to complex values to swap.
+void arm_bitreversal_32(uint32_t* pSrc, const uint16_t bitRevLen, const uint16_t* pBitRevTable) {
+  for (uint16_t i = 0; i < bitRevLen; i += 2) {
+    const uint32_t a = pBitRevTable[i] >> 2;
+    const uint32_t b = pBitRevTable[i + 1] >> 2;
+
+    uint32_t tmp = pSrc[a];
+    pSrc[a] = pSrc[b];
+    pSrc[b] = tmp;
+
+    tmp = pSrc[a + 1];
+    pSrc[a + 1] = pSrc[b + 1];
+    pSrc[b + 1] = tmp;
+  }
+}
@@ -0,0 +1,448 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "estimatorReplay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+#include "sensors.h"
+#include "console.h"
+#include "usec_time.h"
+
+#define MAX_LINE_LENGTH 512
+#define MAX_FIELDS 16
+
+// Host replacements for the parts of FreeRTOS, the sensor HAL and the console
+// used by the estimators. The estimators are run from one thread only, so no
+// locking is needed.
+
+static uint32_t currentTick = 0;
+
+typedef struct {
+  uint8_t* storage;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  UBaseType_t head;
+  UBaseType_t count;
+} replayQueue_t;
+
+static uint32_t droppedMeasurements = 0;
+
+static struct {
+  Axis3f acc;
+  Axis3f gyro;
+  baro_t baro;
+  bool isAccNew;
+  bool isGyroNew;
+  bool isBaroNew;
+} sensorState;
+
+TickType_t xTaskGetTickCount(void) {
+  return currentTick;
+}
+
+uint64_t usecTimestamp(void) {
+  return (uint64_t)currentTick * 1000;
+}
+
+QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize, const uint8_t ucQueueType) {
+  (void)ucQueueType;
+  replayQueue_t* queue = calloc(1, sizeof(replayQueue_t));
+  queue->storage = calloc(uxQueueLength, uxItemSize);
+  queue->length = uxQueueLength;
+  queue->itemSize = uxItemSize;
+  return queue;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait, const BaseType_t xCopyPosition) {
+  (void)xTicksToWait;
+  (void)xCopyPosition;
+  replayQueue_t* queue = xQueue;
+  if (queue->count == queue->length) {
+    droppedMeasurements++;
+    return errQUEUE_FULL;
+  }
+
+  UBaseType_t index = (queue->head + queue->count) % queue->length;
+  memcpy(&queue->storage[index * queue->itemSize], pvItemToQueue, queue->itemSize);
+  queue->count++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueGenericReceive(QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait, const BaseType_t xJustPeek) {
+  (void)xTicksToWait;
+  replayQueue_t* queue = xQueue;
+  if (queue->count == 0) {
+    return pdFALSE;
+  }
+
+  memcpy(pvBuffer, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+  if (!xJustPeek) {
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+  }
+  return pdTRUE;
+}
+
+BaseType_t xQueueGenericReset(QueueHandle_t xQueue, BaseType_t xNewQueue) {
+  (void)xNewQueue;
+  replayQueue_t* queue = xQueue;
+  queue->head = 0;
+  queue->count = 0;
+  return pdPASS;
+}
+
+bool sensorsReadAcc(Axis3f *acc) {
+  *acc = sensorState.acc;
+  bool result = sensorState.isAccNew;
+  sensorState.isAccNew = false;
+  return result;
+}
+
+bool sensorsReadGyro(Axis3f *gyro) {
+  *gyro = sensorState.gyro;
+  bool result = sensorState.isGyroNew;
+  sensorState.isGyroNew = false;
+  return result;
+}
+
+bool sensorsReadBaro(baro_t *baro) {
+  *baro = sensorState.baro;
+  bool result = sensorState.isBaroNew;
+  sensorState.isBaroNew = false;
+  return result;
+}
+
+void sensorsAcquire(sensorData_t *sensors, const uint32_t tick) {
+  (void)tick;
+  sensorsReadAcc(&sensors->acc);
+  sensorsReadGyro(&sensors->gyro);
+  sensorsReadBaro(&sensors->baro);
+}
+
+int consolePutchar(int ch) {
+  return ch;
+}
+
+
+static int splitLine(char* line, char* fields[]) {
+  int count = 0;
+  char* token = strtok(line, ",\r\n");
+  while (token && count < MAX_FIELDS) {
+    fields[count++] = token;
+    token = strtok(0, ",\r\n");
+  }
+  return count;
+}
+
+static bool parseFloats(char* fields[], int fieldCount, int expected, float* out) {
+  if (fieldCount != expected + 2) {
+    return false;
+  }
+
+  for (int i = 0; i < expected; i++) {
+    char* end;
+    out[i] = strtof(fields[i + 2], &end);
+    if (end == fields[i + 2]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool parseEvent(char* fields[], int fieldCount, replayEvent_t* event) {
+  float v[MAX_FIELDS];
+  const char* type = fields[1];
+
+  event->tick = strtoul(fields[0], 0, 10);
+
+  if (strcmp(type, "imu") == 0) {
+    event->type = replayImu;
+    if (!parseFloats(fields, fieldCount, 6, v)) return false;
+    event->imu.acc = (Axis3f){.x = v[0], .y = v[1], .z = v[2]};
+    event->imu.gyro = (Axis3f){.x = v[3], .y = v[4], .z = v[5]};
+  } else if (strcmp(type, "baro") == 0) {
+    event->type = replayBaro;
+    if (!parseFloats(fields, fieldCount, 3, v)) return false;
+    event->baro = (baro_t){.asl = v[0], .temperature = v[1], .pressure = v[2]};
+  } else if (strcmp(type, "thrust") == 0) {
+    event->type = replayThrust;
+    if (!parseFloats(fields, fieldCount, 1, v)) return false;
+    event->thrust = v[0];
+  } else if (strcmp(type, "tof") == 0) {
+    event->type = replayTof;
+    if (!parseFloats(fields, fieldCount, 2, v)) return false;
+    event->tof = (tofMeasurement_t){.timestamp = event->tick, .distance = v[0], .stdDev = v[1]};
+  } else if (strcmp(type, "flow") == 0) {
+    event->type = replayFlow;
+    if (!parseFloats(fields, fieldCount, 5, v)) return false;
+    event->flow = (flowMeasurement_t){.timestamp = event->tick, .dt = v[0], .dpixelx = v[1], .dpixely = v[2], .stdDevX = v[3], .stdDevY = v[4]};
+  } else if (strcmp(type, "tdoa") == 0) {
+    event->type = replayTdoa;
+    if (!parseFloats(fields, fieldCount, 8, v)) return false;
+    event->tdoa = (tdoaMeasurement_t){
+      .anchorPosition = {{.x = v[0], .y = v[1], .z = v[2]}, {.x = v[3], .y = v[4], .z = v[5]}},
+      .distanceDiff = v[6],
+      .stdDev = v[7],
+    };
+  } else if (strcmp(type, "pos") == 0) {
+    event->type = replayPosition;
+    if (!parseFloats(fields, fieldCount, 4, v)) return false;
+    event->position = (positionMeasurement_t){.x = v[0], .y = v[1], .z = v[2], .stdDev = v[3]};
+  } else if (strcmp(type, "pose") == 0) {
+    event->type = replayPose;
+    if (!parseFloats(fields, fieldCount, 9, v)) return false;
+    event->pose = (poseMeasurement_t){.x = v[0], .y = v[1], .z = v[2], .stdDevPos = v[7], .stdDevQuat = v[8]};
+    event->pose.quat.x = v[3];
+    event->pose.quat.y = v[4];
+    event->pose.quat.z = v[5];
+    event->pose.quat.w = v[6];
+  } else if (strcmp(type, "dist") == 0) {
+    event->type = replayDistance;
+    if (!parseFloats(fields, fieldCount, 5, v)) return false;
+    event->distance = (distanceMeasurement_t){.x = v[0], .y = v[1], .z = v[2], .distance = v[3], .stdDev = v[4]};
+  } else if (strcmp(type, "height") == 0) {
+    event->type = replayHeight;
+    if (!parseFloats(fields, fieldCount, 2, v)) return false;
+    event->height = (heightMeasurement_t){.timestamp = event->tick, .height = v[0], .stdDev = v[1]};
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+bool estimatorReplayLoad(const char* fileName, replayLog_t* log) {
+  FILE* file = fopen(fileName, "r");
+  if (!file) {
+    return false;
+  }
+
+  size_t capacity = 1024;
+  log->events = malloc(capacity * sizeof(replayEvent_t));
+  log->count = 0;
+
+  char line[MAX_LINE_LENGTH];
+  char* fields[MAX_FIELDS];
+  bool result = true;
+  while (fgets(line, sizeof(line), file)) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+      continue;
+    }
+
+    int fieldCount = splitLine(line, fields);
+    if (fieldCount < 2) {
+      continue;
+    }
+
+    if (log->count == capacity) {
+      capacity *= 2;
+      log->events = realloc(log->events, capacity * sizeof(replayEvent_t));
+    }
+
+    replayEvent_t* event = &log->events[log->count];
+    if (!parseEvent(fields, fieldCount, event) ||
+        (log->count > 0 && event->tick < log->events[log->count - 1].tick)) {
+      result = false;
+      break;
+    }
+    log->count++;
+  }
+
+  fclose(file);
+
+  if (!result || log->count == 0) {
+    estimatorReplayFreeLog(log);
+    return false;
+  }
+  return true;
+}
+
+void estimatorReplayFreeLog(replayLog_t* log) {
+  free(log->events);
+  log->events = 0;
+  log->count = 0;
+}
+
+
+static void dispatchEvent(const replayEvent_t* event, control_t* control) {
+  switch (event->type) {
+    case replayImu:
+      sensorState.acc = event->imu.acc;
+      sensorState.gyro = event->imu.gyro;
+      sensorState.isAccNew = true;
+      sensorState.isGyroNew = true;
+      break;
+    case replayBaro:
+      sensorState.baro = event->baro;
+      sensorState.isBaroNew = true;
+      break;
+    case replayThrust:
+      control->thrust = event->thrust;
+      break;
+    case replayTof:
+      estimatorEnqueueTOF(&event->tof);
+      break;
+    case replayFlow:
+      estimatorEnqueueFlow(&event->flow);
+      break;
+    case replayTdoa:
+      estimatorEnqueueTDOA(&event->tdoa);
+      break;
+    case replayPosition:
+      estimatorEnqueuePosition(&event->position);
+      break;
+    case replayPose:
+      estimatorEnqueuePose(&event->pose);
+      break;
+    case replayDistance:
+      estimatorEnqueueDistance(&event->distance);
+      break;
+    case replayHeight:
+      estimatorEnqueueAbsoluteHeight(&event->height);
+      break;
+  }
+}
+
+static double nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+void estimatorReplayRun(const replayLog_t* log, StateEstimatorType estimator, uint32_t sampleInterval, replayResult_t* result) {
+  memset(&sensorState, 0, sizeof(sensorState));
+  droppedMeasurements = 0;
+
+  const uint32_t firstTick = log->events[0].tick;
+  const uint32_t lastTick = log->events[log->count - 1].tick;
+
+  currentTick = firstTick;
+  stateEstimatorInit(estimator);
+
+  memset(result, 0, sizeof(replayResult_t));
+  result->samples = malloc(((lastTick - firstTick) / sampleInterval + 1) * sizeof(replaySample_t));
+
+  state_t state = {0};
+  sensorData_t sensorData = {0};
+  control_t control = {0};
+
+  size_t eventIndex = 0;
+  for (uint32_t tick = firstTick; tick <= lastTick; tick++) {
+    currentTick = tick;
+
+    while (eventIndex < log->count && log->events[eventIndex].tick == tick) {
+      dispatchEvent(&log->events[eventIndex], &control);
+      eventIndex++;
+    }
+
+    double start = nowUs();
+    stateEstimator(&state, &sensorData, &control, tick);
+    float updateTimeUs = nowUs() - start;
+
+    result->updateCount++;
+    result->totalUpdateTimeUs += updateTimeUs;
+    if (updateTimeUs > result->maxUpdateTimeUs) {
+      result->maxUpdateTimeUs = updateTimeUs;
+    }
+
+    if (((tick - firstTick) % sampleInterval) == 0) {
+      replaySample_t* sample = &result->samples[result->count++];
+      sample->tick = tick;
+      sample->state = state;
+      sample->updateTimeUs = updateTimeUs;
+    }
+  }
+
+  result->droppedMeasurements = droppedMeasurements;
+}
+
+void estimatorReplayFreeResult(replayResult_t* result) {
+  free(result->samples);
+  result->samples = 0;
+  result->count = 0;
+}
+
+
+#define STATE_VALUE_COUNT 13
+
+static void stateToValues(const state_t* state, float* values) {
+  const float v[STATE_VALUE_COUNT] = {
+    state->position.x, state->position.y, state->position.z,
+    state->velocity.x, state->velocity.y, state->velocity.z,
+    state->attitude.roll, state->attitude.pitch, state->attitude.yaw,
+    state->attitudeQuaternion.x, state->attitudeQuaternion.y, state->attitudeQuaternion.z, state->attitudeQuaternion.w,
+  };
+  memcpy(values, v, sizeof(v));
+}
+
+bool estimatorReplayWriteTrajectory(const replayResult_t* result, const char* fileName) {
+  FILE* file = fopen(fileName, "w");
+  if (!file) {
+    return false;
+  }
+
+  fprintf(file, "# tick,x,y,z,vx,vy,vz,roll,pitch,yaw,qx,qy,qz,qw,updateTimeUs\n");
+  for (size_t i = 0; i < result->count; i++) {
+    float values[STATE_VALUE_COUNT];
+    stateToValues(&result->samples[i].state, values);
+
+    fprintf(file, "%u", (unsigned int)result->samples[i].tick);
+    for (int j = 0; j < STATE_VALUE_COUNT; j++) {
+      fprintf(file, ",%.6f", values[j]);
+    }
+    fprintf(file, ",%.2f\n", result->samples[i].updateTimeUs);
+  }
+
+  fclose(file);
+  return true;
+}
+
+int estimatorReplayCompare(const replayResult_t* result, const char* goldenFileName, float tolerance) {
+  FILE* file = fopen(goldenFileName, "r");
+  if (!file) {
+    return -1;
+  }
+
+  int differing = 0;
+  size_t index = 0;
+  char line[MAX_LINE_LENGTH];
+  char* fields[MAX_FIELDS];
+  while (fgets(line, sizeof(line), file)) {
+    if (line[0] == '#') {
+      continue;
+    }
+
+    int fieldCount = splitLine(line, fields);
+    if (fieldCount < STATE_VALUE_COUNT + 1 || index >= result->count ||
+        strtoul(fields[0], 0, 10) != result->samples[index].tick) {
+      differing = -1;
+      break;
+    }
+
+    float values[STATE_VALUE_COUNT];
+    stateToValues(&result->samples[index].state, values);
+    for (int j = 0; j < STATE_VALUE_COUNT; j++) {
+      float expected = strtof(fields[j + 1], 0);
+      float diff = values[j] - expected;
+      if (diff > tolerance || diff < -tolerance || diff != diff) {
+        differing++;
+        break;
+      }
+    }
+
+    index++;
+  }
+
+  fclose(file);
+
+  if (differing >= 0 && index != result->count) {
+    differing = -1;
+  }
+  return differing;
+}
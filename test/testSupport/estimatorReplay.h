@@ -0,0 +1,111 @@
+#ifndef __ESTIMATOR_REPLAY_H__
+#define __ESTIMATOR_REPLAY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "estimator.h"
+#include "stabilizer_types.h"
+
+/**
+ * Host side replay of logged sensor data through stateEstimator().
+ *
+ * The log is a text file with one event per line, fields separated by ',':
+ *
+ *   <tick>,imu,<ax>,<ay>,<az>,<gx>,<gy>,<gz>      acc [G], gyro [deg/s]
+ *   <tick>,baro,<asl>,<temperature>,<pressure>
+ *   <tick>,thrust,<thrust>
+ *   <tick>,tof,<distance>,<stdDev>
+ *   <tick>,flow,<dt>,<dpixelx>,<dpixely>,<stdDevX>,<stdDevY>
+ *   <tick>,tdoa,<ax0>,<ay0>,<az0>,<ax1>,<ay1>,<az1>,<distanceDiff>,<stdDev>
+ *   <tick>,pos,<x>,<y>,<z>,<stdDev>
+ *   <tick>,pose,<x>,<y>,<z>,<qx>,<qy>,<qz>,<qw>,<stdDevPos>,<stdDevQuat>
+ *   <tick>,dist,<x>,<y>,<z>,<distance>,<stdDev>
+ *   <tick>,height,<height>,<stdDev>
+ *
+ * Lines starting with '#' are ignored. Ticks are in ms and must be non
+ * decreasing. The estimator is run once per tick from the first to the last
+ * tick in the log, with the measurements of a tick enqueued before the call,
+ * through the same (length limited) queues as on the Crazyflie.
+ *
+ * uSD-card deck logs are converted to this format with
+ * 'tools/usdlog/native/usdlog replay <log> <out.csv>'.
+ */
+
+typedef enum {
+  replayImu,
+  replayBaro,
+  replayThrust,
+  replayTof,
+  replayFlow,
+  replayTdoa,
+  replayPosition,
+  replayPose,
+  replayDistance,
+  replayHeight,
+} replayEventType_t;
+
+typedef struct {
+  uint32_t tick;
+  replayEventType_t type;
+  union {
+    struct {
+      Axis3f acc;
+      Axis3f gyro;
+    } imu;
+    baro_t baro;
+    float thrust;
+    tofMeasurement_t tof;
+    flowMeasurement_t flow;
+    tdoaMeasurement_t tdoa;
+    positionMeasurement_t position;
+    poseMeasurement_t pose;
+    distanceMeasurement_t distance;
+    heightMeasurement_t height;
+  };
+} replayEvent_t;
+
+typedef struct {
+  replayEvent_t* events;
+  size_t count;
+} replayLog_t;
+
+typedef struct {
+  uint32_t tick;
+  state_t state;
+  float updateTimeUs;   // Wall clock time of the stateEstimator() call
+} replaySample_t;
+
+typedef struct {
+  replaySample_t* samples;
+  size_t count;
+  uint32_t updateCount;           // Number of stateEstimator() calls
+  uint32_t droppedMeasurements;   // Measurements rejected by full queues
+  double totalUpdateTimeUs;
+  float maxUpdateTimeUs;
+} replayResult_t;
+
+bool estimatorReplayLoad(const char* fileName, replayLog_t* log);
+void estimatorReplayFreeLog(replayLog_t* log);
+
+/**
+ * Run the estimator over the log. One sample is stored every
+ * sampleInterval ticks.
+ */
+void estimatorReplayRun(const replayLog_t* log, StateEstimatorType estimator, uint32_t sampleInterval, replayResult_t* result);
+void estimatorReplayFreeResult(replayResult_t* result);
+
+/**
+ * The trajectory file has one line per sample:
+ *   tick,x,y,z,vx,vy,vz,roll,pitch,yaw,qx,qy,qz,qw,updateTimeUs
+ */
+bool estimatorReplayWriteTrajectory(const replayResult_t* result, const char* fileName);
+
+/**
+ * Compare the trajectory with a golden trajectory file (update times are not
+ * compared). Returns the number of samples that differ more than tolerance in
+ * any state variable, or -1 if the files do not match in length or ticks.
+ */
+int estimatorReplayCompare(const replayResult_t* result, const char* goldenFileName, float tolerance);
+
+#endif // __ESTIMATOR_REPLAY_H__
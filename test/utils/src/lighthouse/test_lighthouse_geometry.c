@@ -0,0 +1,220 @@
+// File under test lighthouse_geometry.c
+#include "lighthouse_geometry.h"
+
+#include <math.h>
+
+#include "unity.h"
+
+// @MODULE "arm_sin_f32.c"
+// @MODULE "arm_cos_f32.c"
+// @MODULE "arm_common_tables.c"
+// @MODULE "arm_mat_mult_f32.c"
+// @MODULE "arm_add_f32.c"
+// @MODULE "arm_sub_f32.c"
+// @MODULE "arm_scale_f32.c"
+// @MODULE "arm_dot_prod_f32.c"
+// @MODULE "arm_power_f32.c"
+
+#define SENSOR_COUNT 4
+#define FRAME_COUNT 1000
+
+// Geometry of a typical system, same as the default in lighthouse.c
+static baseStationGeometry_t geometry[2] = {
+  {.origin = {-0.542299, 3.152727, 1.958483, }, .mat = {{0.999975, -0.007080, -0.000000, }, {0.005645, 0.797195, 0.603696, }, {-0.004274, -0.603681, 0.797215, }, }},
+  {.origin = {2.563488, 3.112367, -1.062398, }, .mat = {{0.034269, -0.647552, 0.761251, }, {-0.012392, 0.761364, 0.648206, }, {-0.999336, -0.031647, 0.018067, }, }},
+};
+
+// Lighthouse deck sensor positions in the lighthouse coordinate system
+static vec3d sensorPositions[SENSOR_COUNT] = {
+  {-0.0075f, 0.0f, 0.015f},
+  {0.0075f, 0.0f, 0.015f},
+  {-0.0075f, 0.0f, -0.015f},
+  {0.0075f, 0.0f, -0.015f},
+};
+
+static lighthouseGeometryPrepared_t prepared;
+static float angles[SENSOR_COUNT][2][2];
+static bool isValid[SENSOR_COUNT];
+static uint32_t randomState;
+
+static void generateAngles(const vec3d position, const float noise);
+static float randomNoise(const float amplitude);
+
+void setUp(void) {
+  lighthouseGeometryPrepare(geometry, &prepared);
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    isValid[i] = true;
+  }
+  randomState = 1234;
+}
+
+void tearDown(void) {}
+
+void testThatRayMatchesTheOriginalRayComputation() {
+  // Fixture
+  const vec3d position = {0.3f, 0.5f, -0.2f};
+  generateAngles(position, 0.0f);
+
+  // Test
+  vec3d ray;
+  lighthouseGeometryGetRay(&prepared.baseStations[1], angles[0][1][0], angles[0][1][1], ray);
+
+  // Assert
+  // The ray from base station 1 must point at sensor 0
+  vec3d expected;
+  float length = 0.0f;
+  for (int i = 0; i < 3; i++) {
+    expected[i] = position[i] + sensorPositions[0][i] - geometry[1].origin[i];
+    length += expected[i] * expected[i];
+  }
+  length = sqrtf(length);
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, expected[i] / length, ray[i]);
+  }
+}
+
+void testThatPositionIsFoundFromAllSensors() {
+  // Fixture
+  const vec3d expected = {0.3f, 0.5f, -0.2f};
+  generateAngles(expected, 0.0f);
+  lighthouseSolution_t solution;
+
+  // Test
+  const bool actual = lighthouseGeometrySolve(&prepared, angles, isValid, sensorPositions, SENSOR_COUNT, &solution);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_INT(8, solution.rayCount);
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, expected[i], solution.position[i]);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, solution.residual);
+}
+
+void testThatPositionIsFoundFromOneSensor() {
+  // Fixture
+  const vec3d expected = {-0.4f, 1.0f, 0.6f};
+  generateAngles(expected, 0.0f);
+  isValid[0] = false;
+  isValid[1] = false;
+  isValid[3] = false;
+  lighthouseSolution_t solution;
+
+  // Test
+  const bool actual = lighthouseGeometrySolve(&prepared, angles, isValid, sensorPositions, SENSOR_COUNT, &solution);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_INT(2, solution.rayCount);
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, expected[i], solution.position[i]);
+  }
+}
+
+void testThatNoValidSensorGivesNoSolution() {
+  // Fixture
+  const vec3d position = {0.0f, 0.0f, 0.0f};
+  generateAngles(position, 0.0f);
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    isValid[i] = false;
+  }
+  lighthouseSolution_t solution;
+
+  // Test
+  const bool actual = lighthouseGeometrySolve(&prepared, angles, isValid, sensorPositions, SENSOR_COUNT, &solution);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatCovarianceCoversTheErrorOfNoisyAngles() {
+  // Fixture
+  const vec3d expected = {0.2f, 0.8f, 0.1f};
+  int outsideCount = 0;
+
+  for (int frame = 0; frame < FRAME_COUNT; frame++) {
+    generateAngles(expected, 2 * LIGHTHOUSE_ANGLE_STD_DEV);
+    lighthouseSolution_t solution;
+
+    // Test
+    lighthouseGeometrySolve(&prepared, angles, isValid, sensorPositions, SENSOR_COUNT, &solution);
+
+    // Assert
+    for (int i = 0; i < 3; i++) {
+      const float stdDev = sqrtf(solution.covariance[i][i]);
+      TEST_ASSERT_TRUE(stdDev > 0.0f);
+      if (fabsf(solution.position[i] - expected[i]) > 3 * stdDev) {
+        outsideCount++;
+      }
+    }
+  }
+
+  // Uniform noise, the error should practically never be outside 3 sigma
+  TEST_ASSERT_LESS_THAN(FRAME_COUNT * 3 / 100, outsideCount);
+}
+
+void testThatLeastSquaresIsAsAccurateAsIntersections() {
+  // Fixture
+  vec3d truth;
+  float intersectionError = 0.0f;
+  float leastSquaresError = 0.0f;
+
+  for (int frame = 0; frame < FRAME_COUNT; frame++) {
+    const float t = frame * 0.01f;
+    truth[0] = 1.0f * sinf(t);
+    truth[1] = 0.2f + 0.8f * frame / FRAME_COUNT;
+    truth[2] = 1.0f * cosf(t);
+    generateAngles(truth, LIGHTHOUSE_ANGLE_STD_DEV);
+
+    // Test
+    vec3d sum = {0};
+    for (int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+      vec3d position;
+      float delta;
+      float sensorAngles[4] = {angles[sensor][0][0], angles[sensor][0][1], angles[sensor][1][0], angles[sensor][1][1]};
+      lighthouseGeometryGetPosition(geometry, sensorAngles, position, &delta);
+      for (int i = 0; i < 3; i++) {
+        sum[i] += position[i] / SENSOR_COUNT;
+      }
+    }
+
+    lighthouseSolution_t solution;
+    lighthouseGeometrySolve(&prepared, angles, isValid, sensorPositions, SENSOR_COUNT, &solution);
+
+    for (int i = 0; i < 3; i++) {
+      intersectionError += fabsf(sum[i] - truth[i]);
+      leastSquaresError += fabsf(solution.position[i] - truth[i]);
+    }
+  }
+
+  // Assert
+  TEST_ASSERT_TRUE(leastSquaresError <= intersectionError * 1.1f);
+}
+
+// Helpers ///////////////
+
+// Angles as seen by the sensors for a deck at a position, with uniform noise
+static void generateAngles(const vec3d position, const float noise) {
+  for (int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+    for (int bs = 0; bs < 2; bs++) {
+      vec3d v;
+      for (int i = 0; i < 3; i++) {
+        v[i] = position[i] + sensorPositions[sensor][i] - geometry[bs].origin[i];
+      }
+
+      // To the base station frame, the inverse of the rotation matrix
+      vec3d local;
+      for (int i = 0; i < 3; i++) {
+        local[i] = geometry[bs].mat[0][i] * v[0] + geometry[bs].mat[1][i] * v[1] + geometry[bs].mat[2][i] * v[2];
+      }
+
+      angles[sensor][bs][0] = atan2f(-local[0], -local[2]) + randomNoise(noise);
+      angles[sensor][bs][1] = atan2f(local[1], -local[2]) + randomNoise(noise);
+    }
+  }
+}
+
+static float randomNoise(const float amplitude) {
+  randomState = randomState * 1664525 + 1013904223;
+  return amplitude * ((int32_t)randomState / (float)INT32_MAX);
+}
@@ -0,0 +1,191 @@
+// File under test tdoaEngine.c
+#include "tdoaEngine.h"
+
+#include "unity.h"
+
+#include <math.h>
+#include <string.h>
+#include "tdoaStorage.h"
+#include "tdoaStats.h"
+#include "clockCorrectionEngine.h"
+#include "physicalConstants.h"
+
+// The tests in this file are also run in the fixed point build of the engine,
+// see the unit_tdoa_fixed_point target in the Makefile. Both builds are
+// compared to the same ground truth, which bounds the difference between the
+// fixed point and the float path to twice the tolerance.
+
+#define LOCODECK_TS_FREQ (499.2e6 * 128)
+#define MASK 0xFFFFFFFFFF // 40 bits
+#define ANCHOR_COUNT 4
+#define SLOT_TIME 0.002
+#define CYCLE_COUNT 200
+
+// About 4 ticks, the time stamps are rounded to whole ticks
+#define DISTANCE_DIFF_TOLERANCE 0.02f
+
+typedef struct {
+  uint8_t id;
+  point_t position;
+  double clockRate;
+  double clockOffset; // s
+  uint8_t seqNr;
+  double latestTxTime; // s, global time
+} simAnchor_t;
+
+typedef struct {
+  point_t position;
+  double clockRate;
+  double clockOffset; // s
+} simTag_t;
+
+static tdoaEngineState_t engineState;
+static simAnchor_t anchors[ANCHOR_COUNT];
+static simTag_t tag;
+
+static int measurementCount;
+static float maxError;
+
+static void fixtureSetUpSystem();
+static void runSimulation(const int cycles);
+static void sendTdoaToEstimator(tdoaMeasurement_t* tdoaMeasurement);
+
+void setUp(void) {
+  measurementCount = 0;
+  maxError = 0.0f;
+
+  fixtureSetUpSystem();
+  tdoaEngineInit(&engineState, 0, sendTdoaToEstimator, LOCODECK_TS_FREQ);
+}
+
+void tearDown(void) {
+}
+
+void testThatTdoaMeasurementsAreSentToTheEstimator() {
+  // Fixture
+
+  // Test
+  runSimulation(CYCLE_COUNT);
+
+  // Assert
+  TEST_ASSERT_GREATER_THAN(CYCLE_COUNT, measurementCount);
+  TEST_ASSERT_EQUAL_UINT32(measurementCount, engineState.stats.packetsToEstimator);
+}
+
+void testThatDistanceDiffMatchesGroundTruth() {
+  // Fixture
+
+  // Test
+  runSimulation(CYCLE_COUNT);
+
+  // Assert
+  TEST_ASSERT_GREATER_THAN(0, measurementCount);
+  TEST_ASSERT_FLOAT_WITHIN(DISTANCE_DIFF_TOLERANCE, 0.0f, maxError);
+}
+
+void testThatDistanceDiffMatchesGroundTruthWhenAnchorClockWraps() {
+  // Fixture
+  // The 40 bit anchor clock wraps after about 17.2 s, start just before it
+  const double wrapTime = (MASK + 1) / LOCODECK_TS_FREQ;
+  anchors[2].clockOffset = wrapTime - SLOT_TIME * ANCHOR_COUNT * CYCLE_COUNT / 2;
+
+  // Test
+  runSimulation(CYCLE_COUNT);
+
+  // Assert
+  TEST_ASSERT_GREATER_THAN(0, measurementCount);
+  TEST_ASSERT_FLOAT_WITHIN(DISTANCE_DIFF_TOLERANCE, 0.0f, maxError);
+}
+
+// Helpers ///////////////////////////////////////////////////////////////////
+
+static void fixtureSetUpSystem() {
+  const point_t positions[ANCHOR_COUNT] = {
+    {.x = -2.0f, .y = -2.0f, .z = 0.2f},
+    {.x = 2.5f, .y = -2.0f, .z = 2.8f},
+    {.x = 2.0f, .y = 3.0f, .z = 0.2f},
+    {.x = -2.5f, .y = 2.0f, .z = 2.8f},
+  };
+
+  // Clock deviations within the DW1000 spec of 10 ppm
+  const double clockRates[ANCHOR_COUNT] = {1.0 + 3.1e-6, 1.0 - 6.7e-6, 1.0 + 8.2e-6, 1.0 - 1.4e-6};
+
+  for (int i = 0; i < ANCHOR_COUNT; i++) {
+    anchors[i] = (simAnchor_t){
+      .id = 10 + i,
+      .position = positions[i],
+      .clockRate = clockRates[i],
+      .clockOffset = 1.3 + i * 0.7,
+      .seqNr = 0,
+      .latestTxTime = 0.0,
+    };
+  }
+
+  tag = (simTag_t){
+    .position = {.x = 0.3f, .y = -0.7f, .z = 1.1f},
+    .clockRate = 1.0 - 4.3e-6,
+    .clockOffset = 0.4,
+  };
+}
+
+static double distance(const point_t* a, const point_t* b) {
+  const double dx = a->x - b->x;
+  const double dy = a->y - b->y;
+  const double dz = a->z - b->z;
+  return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static int64_t toTicks(const double time, const double clockRate, const double clockOffset) {
+  return (int64_t)llround((time * clockRate + clockOffset) * LOCODECK_TS_FREQ) & MASK;
+}
+
+static void sendPacket(simAnchor_t* anchor, const double txTime) {
+  anchor->seqNr = (anchor->seqNr + 1) & 0x7f;
+
+  const uint32_t now_ms = (uint32_t)(txTime * 1000);
+  tdoaAnchorContext_t anchorCtx;
+  tdoaEngineGetAnchorCtxForPacketProcessing(&engineState, anchor->id, now_ms, &anchorCtx);
+
+  // Remote data, the receive times of the latest packets from the other anchors
+  for (int i = 0; i < ANCHOR_COUNT; i++) {
+    const simAnchor_t* remote = &anchors[i];
+    if (remote != anchor && remote->latestTxTime > 0.0) {
+      const double flightTime = distance(&remote->position, &anchor->position) / SPEED_OF_LIGHT;
+      const int64_t remoteRxTime = toTicks(remote->latestTxTime + flightTime, anchor->clockRate, anchor->clockOffset);
+      const int64_t tof = llround(flightTime * anchor->clockRate * LOCODECK_TS_FREQ);
+      tdoaStorageSetRemoteRxTime(&anchorCtx, remote->id, remoteRxTime, remote->seqNr);
+      tdoaStorageSetTimeOfFlight(&anchorCtx, remote->id, tof);
+    }
+  }
+
+  const double flightTime = distance(&anchor->position, &tag.position) / SPEED_OF_LIGHT;
+  const int64_t txAn_in_cl_An = toTicks(txTime, anchor->clockRate, anchor->clockOffset);
+  const int64_t rxAn_by_T_in_cl_T = toTicks(txTime + flightTime, tag.clockRate, tag.clockOffset);
+
+  tdoaEngineProcessPacket(&engineState, &anchorCtx, txAn_in_cl_An, rxAn_by_T_in_cl_T);
+  tdoaStorageSetRxTxData(&anchorCtx, rxAn_by_T_in_cl_T, txAn_in_cl_An, anchor->seqNr);
+  tdoaStorageSetAnchorPosition(&anchorCtx, anchor->position.x, anchor->position.y, anchor->position.z);
+
+  anchor->latestTxTime = txTime;
+}
+
+static void runSimulation(const int cycles) {
+  // Anchors transmit in a round robin schedule, as in TDoA2
+  double time = 0.1;
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    for (int i = 0; i < ANCHOR_COUNT; i++) {
+      sendPacket(&anchors[i], time);
+      time += SLOT_TIME;
+    }
+  }
+}
+
+static void sendTdoaToEstimator(tdoaMeasurement_t* tdoaMeasurement) {
+  const double expected = distance(&tdoaMeasurement->anchorPosition[1], &tag.position) - distance(&tdoaMeasurement->anchorPosition[0], &tag.position);
+  const float error = fabsf(tdoaMeasurement->distanceDiff - (float)expected);
+  if (error > maxError) {
+    maxError = error;
+  }
+
+  measurementCount++;
+}
@@ -372,6 +372,23 @@ void testThatRxTxDataIsSet() {
 }
 
 
+#ifdef TDOA_ENGINE_FIXED_POINT
+void testThatClockCorrectionIsReturned() {
+  // Fixture
+  tdoaAnchorContext_t context;
+  tdoaStorageGetCreateAnchorCtx(storage, 0, 0, &context);
+
+  clockCorrectionFixed_t expected = CLOCK_CORRECTION_FIXED_ONE + 123456;
+  clockCorrectionFixedStorage_t* clockCorrectionStorage = tdoaStorageGetClockCorrectionStorage(&context);
+  clockCorrectionEngineGetFixed_ExpectAndReturn(clockCorrectionStorage, expected);
+
+  // Test
+  clockCorrectionFixed_t actual = tdoaStorageGetClockCorrectionFixed(&context);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT64(expected, actual);
+}
+#else
 void testThatClockCorrectionIsReturned() {
   // Fixture
   tdoaAnchorContext_t context;
@@ -387,6 +404,7 @@ void testThatClockCorrectionIsReturned() {
   // Assert
   TEST_ASSERT_EQUAL_DOUBLE(expected, actual);
 }
+#endif
 
 
 void testThatRemoteRxTimeIsReturned() {
@@ -647,6 +665,91 @@ void testThatTofReplacesTheOldestEntryWhenStorageIsFull() {
 }
 
 
+void testThatAnchorsWithCollidingIdsAreFound() {
+  // Fixture
+  // All anchors map to the same lookup hint
+  const uint32_t currentTime = 123;
+  tdoaAnchorContext_t context;
+  for (int i = 0; i < 3; i++) {
+    const uint8_t anchor = 5 + i * ANCHOR_STORAGE_COUNT;
+    tdoaStorageGetCreateAnchorCtx(storage, anchor, currentTime, &context);
+    tdoaStorageSetRxTxData(&context, 0, 0, anchor);
+  }
+
+  // Test
+  // Assert
+  for (int i = 0; i < 3; i++) {
+    const uint8_t anchor = 5 + i * ANCHOR_STORAGE_COUNT;
+    TEST_ASSERT_TRUE(tdoaStorageGetAnchorCtx(storage, anchor, currentTime, &context));
+    TEST_ASSERT_EQUAL_UINT8(anchor, tdoaStorageGetId(&context));
+    TEST_ASSERT_EQUAL_UINT8(anchor, tdoaStorageGetSeqNr(&context));
+  }
+}
+
+
+void testThatReplacedAnchorIsNotFoundThroughStaleLookupHint() {
+  // Fixture
+  // Fill the storage, the anchor in slot 0 is the oldest
+  tdoaAnchorContext_t context;
+  const uint8_t oldestAnchor = 0;
+  tdoaStorageGetCreateAnchorCtx(storage, oldestAnchor, 100, &context);
+  for (int anchor = 1; anchor < ANCHOR_STORAGE_COUNT; anchor++) {
+    tdoaStorageGetCreateAnchorCtx(storage, anchor, 200, &context);
+  }
+
+  // Test
+  // Replaces the oldest anchor, in the slot the hint for the old id points to
+  const uint8_t newAnchor = ANCHOR_STORAGE_COUNT + 1;
+  tdoaStorageGetCreateAnchorCtx(storage, newAnchor, 300, &context);
+
+  // Assert
+  TEST_ASSERT_FALSE(tdoaStorageGetAnchorCtx(storage, oldestAnchor, 300, &context));
+  TEST_ASSERT_TRUE(tdoaStorageGetAnchorCtx(storage, newAnchor, 300, &context));
+  TEST_ASSERT_EQUAL_UINT8(newAnchor, tdoaStorageGetId(&context));
+  for (int anchor = 1; anchor < ANCHOR_STORAGE_COUNT; anchor++) {
+    TEST_ASSERT_TRUE(tdoaStorageIsAnchorInStorage(storage, anchor));
+  }
+}
+
+
+void testThatTofForRemoteAnchorsWithCollidingIdsIsReturned() {
+  // Fixture
+  tdoaAnchorContext_t context;
+  const uint8_t anchor = 17;
+  const uint8_t remoteAnchor1 = 1;
+  const uint8_t remoteAnchor2 = remoteAnchor1 + TDOA_LOOKUP_HINT_COUNT;
+  fixtureSetTof(&context, anchor, 123, remoteAnchor1, 1111);
+  fixtureSetTof(&context, anchor, 123, remoteAnchor2, 2222);
+
+  // Test
+  const int64_t actual1 = tdoaStorageGetTimeOfFlight(&context, remoteAnchor1);
+  const int64_t actual2 = tdoaStorageGetTimeOfFlight(&context, remoteAnchor2);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT64(1111, actual1);
+  TEST_ASSERT_EQUAL_INT64(2222, actual2);
+}
+
+
+void testThatRemoteRxTimeForRemoteAnchorsWithCollidingIdsIsReturned() {
+  // Fixture
+  tdoaAnchorContext_t context;
+  const uint8_t anchor = 17;
+  const uint8_t remoteAnchor1 = 1;
+  const uint8_t remoteAnchor2 = remoteAnchor1 + TDOA_LOOKUP_HINT_COUNT;
+  fixtureSetRemoteRxTime(&context, anchor, 123, remoteAnchor1, 1111, 1);
+  fixtureSetRemoteRxTime(&context, anchor, 123, remoteAnchor2, 2222, 2);
+
+  // Test
+  const int64_t actual1 = tdoaStorageGetRemoteRxTime(&context, remoteAnchor1);
+  const int64_t actual2 = tdoaStorageGetRemoteRxTime(&context, remoteAnchor2);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT64(1111, actual1);
+  TEST_ASSERT_EQUAL_INT64(2222, actual2);
+}
+
+
 // Helpers ///////////////
 
 static void fixtureSetRemoteRxTime(tdoaAnchorContext_t* context, const uint8_t anchor, const uint32_t storageTime, const uint8_t remoteAnchor, const uint64_t remoteRxTime, const uint8_t seqNr) {
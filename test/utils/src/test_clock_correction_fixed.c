@@ -0,0 +1,160 @@
+// File under test clockCorrectionEngine.c
+#include "clockCorrectionEngine.h"
+
+#include "unity.h"
+
+#define MASK 0xFFFFFFFFFF // 40 bits
+#define MAX_CLOCK_DEVIATION_SPEC 10e-6
+#define LOCODECK_TS_FREQ (499.2e6 * 128)
+#define SAMPLE_COUNT 10000
+
+static uint32_t randomState;
+
+static uint32_t nextRandom() {
+  randomState = randomState * 1664525 + 1013904223;
+  return randomState;
+}
+
+// Random clock correction within the specs
+static double randomClockCorrection() {
+  return 1.0 + MAX_CLOCK_DEVIATION_SPEC * ((int32_t)nextRandom() / (double)INT32_MAX);
+}
+
+// Random tick count between 1 and 20 ms, the typical time between packets from an anchor
+static uint64_t randomTickCount() {
+  return (uint64_t)(LOCODECK_TS_FREQ * (0.001 + 0.019 * (nextRandom() / (double)UINT32_MAX)));
+}
+
+static double toDouble(const clockCorrectionFixed_t value) {
+  return (double)value / CLOCK_CORRECTION_FIXED_ONE;
+}
+
+void setUp(void) {
+  randomState = 1234;
+}
+
+void tearDown(void) {
+}
+
+void testGetFixedClockCorrection() {
+  // Fixture
+  const clockCorrectionFixed_t clockCorrection = CLOCK_CORRECTION_FIXED_ONE + 12345;
+  clockCorrectionFixedStorage_t clockCorrectionStorage = {
+    .clockCorrection = clockCorrection,
+    .clockCorrectionBucket = 0
+  };
+
+  // Test
+  const clockCorrectionFixed_t result = clockCorrectionEngineGetFixed(&clockCorrectionStorage);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT64(clockCorrection, result);
+}
+
+void testCalculateFixedClockCorrectionWithInvalidInputData() {
+  // Fixture
+  const uint64_t old_t_in_cl_x = 1000;
+  const uint64_t new_t_in_cl_x = 1000;
+  const uint64_t old_t_in_cl_reference = 56789;
+  const uint64_t new_t_in_cl_reference = 56789;
+
+  // Test
+  const clockCorrectionFixed_t result = clockCorrectionEngineCalculateFixed(new_t_in_cl_reference, old_t_in_cl_reference, new_t_in_cl_x, old_t_in_cl_x, MASK);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT64(-CLOCK_CORRECTION_FIXED_ONE, result);
+}
+
+void testCalculateFixedClockCorrectionMatchesDoubleImplementation() {
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    // Fixture
+    const uint64_t tickCount_in_cl_x = randomTickCount();
+    const uint64_t old_t_in_cl_x = ((uint64_t)nextRandom() << 8) & MASK;
+    const uint64_t new_t_in_cl_x = (old_t_in_cl_x + tickCount_in_cl_x) & MASK; // May wrap around
+    const uint64_t old_t_in_cl_reference = ((uint64_t)nextRandom() << 8) & MASK;
+    const uint64_t new_t_in_cl_reference = (old_t_in_cl_reference + (uint64_t)(randomClockCorrection() * tickCount_in_cl_x)) & MASK;
+
+    // Test
+    const double expected = clockCorrectionEngineCalculate(new_t_in_cl_reference, old_t_in_cl_reference, new_t_in_cl_x, old_t_in_cl_x, MASK);
+    const clockCorrectionFixed_t actual = clockCorrectionEngineCalculateFixed(new_t_in_cl_reference, old_t_in_cl_reference, new_t_in_cl_x, old_t_in_cl_x, MASK);
+
+    // Assert
+    TEST_ASSERT_DOUBLE_WITHIN(1e-14, expected, toDouble(actual));
+  }
+}
+
+void testUpdateFixedClockCorrectionMatchesDoubleImplementation() {
+  // Fixture
+  clockCorrectionStorage_t storage = {0};
+  clockCorrectionFixedStorage_t fixedStorage = {0};
+  const double clockCorrection = randomClockCorrection();
+
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    // Mostly samples within the accepted noise level, with occasional outliers
+    double candidate = clockCorrection + 0.01e-6 * ((int32_t)nextRandom() / (double)INT32_MAX);
+    if ((nextRandom() % 10) == 0) {
+      candidate += 1e-6;
+    }
+    const clockCorrectionFixed_t fixedCandidate = (clockCorrectionFixed_t)(candidate * CLOCK_CORRECTION_FIXED_ONE);
+
+    // Test
+    const bool expected = clockCorrectionEngineUpdate(&storage, candidate);
+    const bool actual = clockCorrectionEngineUpdateFixed(&fixedStorage, fixedCandidate);
+
+    // Assert
+    TEST_ASSERT_EQUAL(expected, actual);
+    TEST_ASSERT_EQUAL_UINT(storage.clockCorrectionBucket, fixedStorage.clockCorrectionBucket);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-13, storage.clockCorrection, toDouble(fixedStorage.clockCorrection));
+  }
+}
+
+void testApplyFixedClockCorrectionMatchesDoubleImplementation() {
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    // Fixture
+    const double clockCorrection = randomClockCorrection();
+    const clockCorrectionFixed_t fixedClockCorrection = (clockCorrectionFixed_t)(clockCorrection * CLOCK_CORRECTION_FIXED_ONE);
+    int64_t ticks = randomTickCount();
+    if (i % 2) {
+      ticks = -ticks;
+    }
+
+    // Test
+    const double expected = ticks * clockCorrection;
+    const int64_t actual = clockCorrectionEngineApplyFixed(ticks, fixedClockCorrection);
+
+    // Assert
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, expected, (double)actual / (1 << CLOCK_CORRECTION_FIXED_TICK_SHIFT));
+  }
+}
+
+void testApplyFixedClockCorrectionToLargeTickCount() {
+  // Fixture
+  const int64_t ticks = MASK;
+  const clockCorrectionFixed_t clockCorrection = CLOCK_CORRECTION_FIXED_ONE + (CLOCK_CORRECTION_FIXED_ONE >> 10);
+
+  // Test
+  const int64_t actual = clockCorrectionEngineApplyFixed(ticks, clockCorrection);
+
+  // Assert
+  const int64_t expected = (ticks + (ticks >> 10)) << CLOCK_CORRECTION_FIXED_TICK_SHIFT;
+  TEST_ASSERT_INT64_WITHIN(1 << CLOCK_CORRECTION_FIXED_TICK_SHIFT, expected, actual);
+}
+
+// Time difference of arrival as computed by the TDoA engine, the fixed point
+// path must be within one tick of the double path
+void testTdoaWithFixedClockCorrectionMatchesDoubleImplementation() {
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    // Fixture
+    const double clockCorrection = randomClockCorrection();
+    const clockCorrectionFixed_t fixedClockCorrection = (clockCorrectionFixed_t)(clockCorrection * CLOCK_CORRECTION_FIXED_ONE);
+    const int64_t delta_txAr_to_txAn_in_cl_An = randomTickCount();
+    const int64_t rxDiff_in_cl_T = delta_txAr_to_txAn_in_cl_An + (int32_t)(nextRandom() % 20000) - 10000;
+
+    // Test
+    const int64_t expected = rxDiff_in_cl_T - delta_txAr_to_txAn_in_cl_An * clockCorrection;
+    const int64_t actual = ((rxDiff_in_cl_T << CLOCK_CORRECTION_FIXED_TICK_SHIFT) - clockCorrectionEngineApplyFixed(delta_txAr_to_txAn_in_cl_An, fixedClockCorrection)) >> CLOCK_CORRECTION_FIXED_TICK_SHIFT;
+
+    // Assert
+    TEST_ASSERT_INT64_WITHIN(1, expected, actual);
+  }
+}
@@ -0,0 +1,151 @@
+// File under test deferred_print.c
+#include "deferred_print.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static uint8_t written[DEFERRED_PRINT_MAX_RECORD_SIZE];
+static uint8_t writtenSize;
+static int writeCount;
+
+static void writeMock(const uint8_t* record, const uint8_t size);
+static uint32_t readUint32(const uint8_t* data);
+
+void setUp(void) {
+  memset(written, 0, sizeof(written));
+  writtenSize = 0;
+  writeCount = 0;
+}
+
+void tearDown(void) {}
+
+void testThatRecordStartsWithSizeAndFormatId() {
+  // Fixture
+  static const char fmt[] = "Some text\n";
+  deferredPrintRecord_t record;
+
+  // Test
+  deferredPrintBegin(&record, fmt);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE, record.size);
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE, record.data[0]);
+  uint16_t formatId;
+  memcpy(&formatId, &record.data[1], sizeof(formatId));
+  TEST_ASSERT_EQUAL_UINT16((uint16_t)(uintptr_t)fmt, formatId);
+}
+
+void testThatTextIsWrittenAsHeaderOnly() {
+  // Fixture
+  // Test
+  DEFERRED_PRINT_TEXT(writeMock, "Some text\n");
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, writeCount);
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE, writtenSize);
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE, written[0]);
+}
+
+void testThatIntegerArgumentsAreWrittenAs32Bits() {
+  // Fixture
+  const int8_t a = -3;
+  const uint16_t b = 1000;
+  const int c = 123456;
+
+  // Test
+  DEFERRED_PRINT(writeMock, "%d %u %d\n", a, b, c);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE + 12, writtenSize);
+  TEST_ASSERT_EQUAL_UINT8(writtenSize, written[0]);
+  TEST_ASSERT_EQUAL_INT32(-3, (int32_t)readUint32(&written[3]));
+  TEST_ASSERT_EQUAL_UINT32(1000, readUint32(&written[7]));
+  TEST_ASSERT_EQUAL_UINT32(123456, readUint32(&written[11]));
+}
+
+void testThatLongLongArgumentIsWrittenAs64Bits() {
+  // Fixture
+  const uint64_t expected = 0x123456789abcdef0ULL;
+
+  // Test
+  DEFERRED_PRINT(writeMock, "%llu\n", (unsigned long long)expected);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE + 8, writtenSize);
+  uint64_t actual;
+  memcpy(&actual, &written[3], sizeof(actual));
+  TEST_ASSERT_EQUAL_UINT64(expected, actual);
+}
+
+void testThatFloatAndDoubleArgumentsAreWrittenAsFloat() {
+  // Fixture
+  const float a = 1.5f;
+  const double b = -2.25;
+
+  // Test
+  DEFERRED_PRINT(writeMock, "%f %f\n", (double)a, b);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE + 8, writtenSize);
+  float actualA;
+  float actualB;
+  memcpy(&actualA, &written[3], sizeof(float));
+  memcpy(&actualB, &written[7], sizeof(float));
+  TEST_ASSERT_EQUAL_FLOAT(1.5f, actualA);
+  TEST_ASSERT_EQUAL_FLOAT(-2.25f, actualB);
+}
+
+void testThatStringArgumentIsWrittenWithLength() {
+  // Fixture
+  const char* name = "bcLps";
+
+  // Test
+  DEFERRED_PRINT(writeMock, "Deck %s found\n", name);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE + 1 + 5, writtenSize);
+  TEST_ASSERT_EQUAL_UINT8(5, written[3]);
+  TEST_ASSERT_EQUAL_MEMORY("bcLps", &written[4], 5);
+}
+
+void testThatLongStringIsTruncatedToFitTheRecord() {
+  // Fixture
+  const char* text = "This string is much too long to fit in one record";
+
+  // Test
+  DEFERRED_PRINT(writeMock, "%s\n", text);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_MAX_RECORD_SIZE, writtenSize);
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_MAX_RECORD_SIZE - DEFERRED_PRINT_HEADER_SIZE - 1, written[3]);
+  TEST_ASSERT_EQUAL_MEMORY(text, &written[4], written[3]);
+}
+
+void testThatArgumentsThatDoNotFitAreDropped() {
+  // Fixture
+  // The 64 bit argument does not fit, the last one would but must not be
+  // added after an argument that is missing
+  const uint64_t big = 1;
+
+  // Test
+  DEFERRED_PRINT(writeMock, "%d %d %d %d %d %llu %c\n", 1, 2, 3, 4, 5, (unsigned long long)big, 'x');
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(DEFERRED_PRINT_HEADER_SIZE + 5 * 4, writtenSize);
+  TEST_ASSERT_EQUAL_UINT8(writtenSize, written[0]);
+}
+
+// Helpers ///////////////
+
+static void writeMock(const uint8_t* record, const uint8_t size) {
+  memcpy(written, record, size);
+  writtenSize = size;
+  writeCount++;
+}
+
+static uint32_t readUint32(const uint8_t* data) {
+  uint32_t result;
+  memcpy(&result, data, sizeof(result));
+  return result;
+}
@@ -0,0 +1,177 @@
+// File under test dynamic_notch.c
+#include "dynamic_notch.h"
+
+#include <math.h>
+
+#include "filter_bank.h"
+
+#include "unity.h"
+
+#define SAMPLE_FREQ 1000.0f
+#define UPDATE_DIVIDER 10
+#define TWO_PI 6.28318530718f
+
+static filterBank_t bank;
+static dynamicNotch_t notch;
+
+static float residualNoiseAfterThrottleRamp(const bool useNotch);
+
+void setUp(void) {
+  filterBankInit(&bank, 1);
+  dynamicNotchInit(&notch, &bank, SAMPLE_FREQ);
+  notch.enable = true;
+}
+
+void tearDown(void) {}
+
+void testThatNotchIsDisabledAfterInit() {
+  // Fixture
+  filterBankInit(&bank, 1);
+
+  // Test
+  dynamicNotchInit(&notch, &bank, SAMPLE_FREQ);
+
+  // Assert
+  TEST_ASSERT_FALSE(notch.enable);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, dynamicNotchEstimateFrequency(&notch, 0.5f));
+}
+
+void testThatFrequencyIsInterpolatedFromMotorRatio() {
+  // Fixture
+  notch.minFreq = 100.0f;
+  notch.maxFreq = 300.0f;
+
+  // Test
+  const float actual = dynamicNotchEstimateFrequency(&notch, 0.5f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(200.0f, actual);
+}
+
+void testThatNotchIsOffBelowMinRatio() {
+  // Fixture
+  // Test
+  const float actual = dynamicNotchEstimateFrequency(&notch, notch.minRatio / 2.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, actual);
+}
+
+void testThatNotchIsOffWhenDisabled() {
+  // Fixture
+  notch.enable = false;
+
+  // Test
+  const float actual = dynamicNotchEstimateFrequency(&notch, 0.5f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, actual);
+}
+
+void testThatSectionPassesSamplesThroughBeforeFirstUpdate() {
+  // Fixture
+  float frame[] = {3.0f};
+
+  // Test
+  filterBankApply(&bank, frame);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, notch.section);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, frame[0]);
+}
+
+void testThatFirstEstimateIsUsedWhenMotorsSpinUp() {
+  // Fixture
+  const float expected = dynamicNotchEstimateFrequency(&notch, 0.6f);
+
+  // Test
+  dynamicNotchUpdate(&notch, &bank, 0.6f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(expected, notch.frequency);
+  TEST_ASSERT_EQUAL_FLOAT(expected, notch.tunedFreq);
+}
+
+void testThatEstimateIsSmoothed() {
+  // Fixture
+  dynamicNotchUpdate(&notch, &bank, 0.4f);
+  const float start = notch.frequency;
+  const float target = dynamicNotchEstimateFrequency(&notch, 0.8f);
+
+  // Test
+  dynamicNotchUpdate(&notch, &bank, 0.8f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(start + notch.smoothing * (target - start), notch.frequency);
+}
+
+void testThatSmallChangesDoNotRetuneTheSection() {
+  // Fixture
+  dynamicNotchUpdate(&notch, &bank, 0.5f);
+  const float tuned = notch.tunedFreq;
+  const float coeff = bank.coeffs[notch.section][1];
+
+  // Test
+  dynamicNotchUpdate(&notch, &bank, 0.501f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(tuned, notch.tunedFreq);
+  TEST_ASSERT_EQUAL_FLOAT(coeff, bank.coeffs[notch.section][1]);
+}
+
+void testThatSectionIsTurnedOffWhenMotorsStop() {
+  // Fixture
+  dynamicNotchUpdate(&notch, &bank, 0.5f);
+  float frame[] = {3.0f};
+
+  // Test
+  dynamicNotchUpdate(&notch, &bank, 0.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, notch.tunedFreq);
+  filterBankReset(&bank);
+  filterBankApply(&bank, frame);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, frame[0]);
+}
+
+void testThatMotorNoiseIsRejectedWhileThrottleChanges() {
+  // Fixture
+  const float withoutNotch = residualNoiseAfterThrottleRamp(false);
+
+  // Test
+  const float withNotch = residualNoiseAfterThrottleRamp(true);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, withoutNotch);
+  TEST_ASSERT_TRUE(withNotch < 0.1f);
+}
+
+// Helpers ///////////////
+
+// Motor noise with unit amplitude that follows a throttle ramp from 30% to
+// 70%, returns the largest remaining noise amplitude during the last part
+static float residualNoiseAfterThrottleRamp(const bool useNotch) {
+  filterBankInit(&bank, 1);
+  dynamicNotchInit(&notch, &bank, SAMPLE_FREQ);
+  notch.enable = true;
+
+  const int sampleCount = 4 * (int)SAMPLE_FREQ;
+  float phase = 0.0f;
+  float amplitude = 0.0f;
+  for (int n = 0; n < sampleCount; n++) {
+    const float ratio = 0.3f + 0.4f * n / sampleCount;
+    if (useNotch && (n % UPDATE_DIVIDER) == 0) {
+      dynamicNotchUpdate(&notch, &bank, ratio);
+    }
+
+    phase += TWO_PI * dynamicNotchEstimateFrequency(&notch, ratio) / SAMPLE_FREQ;
+    float frame[] = {sinf(phase)};
+    filterBankApply(&bank, frame);
+
+    if (n > sampleCount / 2) {
+      amplitude = fmaxf(amplitude, fabsf(frame[0]));
+    }
+  }
+
+  return amplitude;
+}
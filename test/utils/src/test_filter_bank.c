@@ -0,0 +1,243 @@
+// File under test filter_bank.c
+#include "filter_bank.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "filter.h"
+#include "cf_math.h"
+
+#include "unity.h"
+
+// @MODULE "arm_biquad_cascade_df2T_f32.c"
+// @MODULE "arm_biquad_cascade_df2T_init_f32.c"
+
+#define SAMPLE_FREQ 1000.0f
+#define SAMPLE_COUNT 1000
+
+static filterBank_t bank;
+
+static uint32_t randomState;
+
+static float randomFloat(const float min, const float max);
+static float amplitudeAfterSettling(const float freq);
+
+void setUp(void) {
+  randomState = 1234;
+}
+
+void tearDown(void) {}
+
+void testThatEmptyBankPassesSamplesThrough() {
+  // Fixture
+  filterBankInit(&bank, 3);
+  float frame[] = {1.0f, -2.0f, 3.0f};
+
+  // Test
+  filterBankApply(&bank, frame);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, frame[0]);
+  TEST_ASSERT_EQUAL_FLOAT(-2.0f, frame[1]);
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, frame[2]);
+}
+
+void testThatLowPassMatchesLpf2p() {
+  // Fixture
+  filterBankInit(&bank, 3);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 80.0f);
+  lpf2pData lpf[3];
+  for (int i = 0; i < 3; i++) {
+    lpf2pInit(&lpf[i], SAMPLE_FREQ, 80.0f);
+  }
+
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    float frame[3];
+    for (int i = 0; i < 3; i++) {
+      frame[i] = randomFloat(-2000.0f, 2000.0f);
+    }
+    float expected[3];
+    for (int i = 0; i < 3; i++) {
+      expected[i] = lpf2pApply(&lpf[i], frame[i]);
+    }
+
+    // Test
+    filterBankApply(&bank, frame);
+
+    // Assert
+    for (int i = 0; i < 3; i++) {
+      TEST_ASSERT_FLOAT_WITHIN(1e-3f, expected[i], frame[i]);
+    }
+  }
+}
+
+void testThatBankMatchesCmsisBiquadCascade() {
+  // Fixture
+  filterBankInit(&bank, 2);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 80.0f);
+  filterBankAddNotch(&bank, SAMPLE_FREQ, 200.0f, 3.0f);
+
+  arm_biquad_cascade_df2T_instance_f32 cmsis[2];
+  float32_t cmsisState[2][2 * 2];
+  for (int ch = 0; ch < 2; ch++) {
+    arm_biquad_cascade_df2T_init_f32(&cmsis[ch], 2, &bank.coeffs[0][0], cmsisState[ch]);
+  }
+
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    float frame[2] = {randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f)};
+    float expected[2];
+    for (int ch = 0; ch < 2; ch++) {
+      arm_biquad_cascade_df2T_f32(&cmsis[ch], &frame[ch], &expected[ch], 1);
+    }
+
+    // Test
+    filterBankApply(&bank, frame);
+
+    // Assert
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, expected[0], frame[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, expected[1], frame[1]);
+  }
+}
+
+void testThatNotchRejectsCenterFrequency() {
+  // Fixture
+  filterBankInit(&bank, 1);
+  filterBankAddNotch(&bank, SAMPLE_FREQ, 150.0f, 2.0f);
+
+  // Test
+  const float actual = amplitudeAfterSettling(150.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, actual);
+}
+
+void testThatNotchPassesFrequenciesFarFromCenter() {
+  // Fixture
+  filterBankInit(&bank, 1);
+  filterBankAddNotch(&bank, SAMPLE_FREQ, 150.0f, 2.0f);
+
+  // Test
+  const float actual = amplitudeAfterSettling(10.0f);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 1.0f, actual);
+}
+
+void testThatLowPassAttenuatesAboveCutoff() {
+  // Fixture
+  filterBankInit(&bank, 1);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 30.0f);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 30.0f);
+
+  // Test
+  const float actual = amplitudeAfterSettling(300.0f);
+
+  // Assert
+  // Two sections, 4 poles, more than 60 dB at 10 times the cutoff
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, actual);
+}
+
+void testThatCutoffAboveNyquistPassesSamplesThrough() {
+  // Fixture
+  filterBankInit(&bank, 1);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 500.0f);
+  float frame[] = {42.0f};
+
+  // Test
+  filterBankApply(&bank, frame);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(42.0f, frame[0]);
+}
+
+void testThatSectionsCanNotBeAddedToAFullBank() {
+  // Fixture
+  filterBankInit(&bank, 1);
+  for (int i = 0; i < FILTER_BANK_MAX_SECTIONS; i++) {
+    TEST_ASSERT_EQUAL_INT(i, filterBankAddNotch(&bank, SAMPLE_FREQ, 100.0f, 1.0f));
+  }
+
+  // Test
+  const int actual = filterBankAddLowPass(&bank, SAMPLE_FREQ, 100.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(-1, actual);
+  TEST_ASSERT_EQUAL_UINT8(FILTER_BANK_MAX_SECTIONS, bank.sectionCount);
+}
+
+void testThatRetuningKeepsTheState() {
+  // Fixture
+  filterBankInit(&bank, 1);
+  const int section = filterBankAddNotch(&bank, SAMPLE_FREQ, 100.0f, 2.0f);
+  for (int n = 0; n < 100; n++) {
+    float frame[] = {1.0f};
+    filterBankApply(&bank, frame);
+  }
+  const float d0 = bank.state[section][0][0];
+
+  // Test
+  filterBankSetNotch(&bank, section, SAMPLE_FREQ, 120.0f, 2.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(d0, bank.state[section][0][0]);
+  TEST_ASSERT_NOT_EQUAL(0.0f, d0);
+}
+
+void testThatChannelsAreFilteredIndependently() {
+  // Fixture
+  filterBankInit(&bank, 3);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 30.0f);
+  float block[SAMPLE_COUNT * 3];
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    block[n * 3 + 0] = 0.0f;
+    block[n * 3 + 1] = 1.0f;
+    block[n * 3 + 2] = -1.0f;
+  }
+
+  // Test
+  filterBankApplyBlock(&bank, block, SAMPLE_COUNT);
+
+  // Assert
+  const float* last = &block[(SAMPLE_COUNT - 1) * 3];
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, last[0]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, last[1]);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, -1.0f, last[2]);
+}
+
+void testThatNonFiniteSampleDoesNotPropagate() {
+  // Fixture
+  filterBankInit(&bank, 1);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 30.0f);
+  float frame[] = {NAN};
+  filterBankApply(&bank, frame);
+
+  // Test
+  for (int n = 0; n < 10; n++) {
+    frame[0] = 1.0f;
+    filterBankApply(&bank, frame);
+  }
+
+  // Assert
+  TEST_ASSERT_TRUE(isfinite(frame[0]));
+}
+
+// Helpers ///////////////
+
+static float randomFloat(const float min, const float max) {
+  randomState = randomState * 1664525 + 1013904223;
+  return min + (max - min) * (randomState >> 8) / (float)(1 << 24);
+}
+
+// Feeds a unit sine through channel 0 of the bank and returns the amplitude
+// of the output once the filter has settled
+static float amplitudeAfterSettling(const float freq) {
+  float amplitude = 0.0f;
+  for (int n = 0; n < 2 * SAMPLE_COUNT; n++) {
+    float frame[] = {sinf(2.0f * PI * freq * n / SAMPLE_FREQ)};
+    filterBankApply(&bank, frame);
+    if (n >= SAMPLE_COUNT) {
+      amplitude = fmaxf(amplitude, fabsf(frame[0]));
+    }
+  }
+  return amplitude;
+}
@@ -0,0 +1,190 @@
+// File under test occupancy_grid.c
+#include "occupancy_grid.h"
+
+#include "unity.h"
+
+#define RESOLUTION 0.1f
+#define MAX_RANGE 3.0f
+
+// Center of cell (0, 0)
+#define X0 0.05f
+#define Y0 0.05f
+
+static occupancyGrid_t grid;
+
+static void addHits(const float x, const float y, const float angle, const float range, const int count);
+
+void setUp(void) {
+  occupancyGridInit(&grid, RESOLUTION);
+}
+
+void tearDown(void) {}
+
+void testThatNewGridIsUnknown() {
+  // Fixture
+  // Test
+  const int8_t actual = occupancyGridGet(&grid, X0, Y0);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT8(0, actual);
+  TEST_ASSERT_EQUAL_INT8(0, occupancyGridGet(&grid, 1.0f, -1.0f));
+  TEST_ASSERT_EACH_EQUAL_UINT16(0, grid.tileChanges, OCCUPANCY_GRID_TILE_COUNT);
+}
+
+void testThatEndOfRangeIsOccupied() {
+  // Fixture
+  // Test
+  occupancyGridAddRange(&grid, X0, Y0, 0.0f, 1.0f, MAX_RANGE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT8(grid.hit, occupancyGridGet(&grid, X0 + 1.0f, Y0));
+}
+
+void testThatCellsBeforeEndOfRangeAreFree() {
+  // Fixture
+  // Test
+  occupancyGridAddRange(&grid, X0, Y0, 0.0f, 1.0f, MAX_RANGE);
+
+  // Assert
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_EQUAL_INT8(grid.miss, occupancyGridGet(&grid, X0 + i * RESOLUTION, Y0));
+  }
+  TEST_ASSERT_EQUAL_INT8(0, occupancyGridGet(&grid, X0 + 1.1f, Y0));
+}
+
+void testThatDiagonalRangeIsTraced() {
+  // Fixture
+  const float angle = 3.0f * 3.14159265f / 4.0f;
+
+  // Test
+  occupancyGridAddRange(&grid, X0, Y0, angle, 0.5f * 1.41421356f, MAX_RANGE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT8(grid.miss, occupancyGridGet(&grid, X0 - 0.2f, Y0 + 0.2f));
+  TEST_ASSERT_EQUAL_INT8(grid.hit, occupancyGridGet(&grid, X0 - 0.5f, Y0 + 0.5f));
+}
+
+void testThatRangeLongerThanMaxRangeOnlyClearsCells() {
+  // Fixture
+  // Test
+  occupancyGridAddRange(&grid, X0, Y0, 3.14159265f / 2.0f, 8.0f, 1.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT8(grid.miss, occupancyGridGet(&grid, X0, Y0 + 0.5f));
+  TEST_ASSERT_EQUAL_INT8(grid.miss, occupancyGridGet(&grid, X0, Y0 + 1.0f));
+  TEST_ASSERT_EQUAL_INT8(0, occupancyGridGet(&grid, X0, Y0 + 1.1f));
+}
+
+void testThatCellsAreClampedToLimit() {
+  // Fixture
+  // Test
+  addHits(X0, Y0, 0.0f, 1.0f, 20);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT8(grid.limit, occupancyGridGet(&grid, X0 + 1.0f, Y0));
+  TEST_ASSERT_EQUAL_INT8(-grid.limit, occupancyGridGet(&grid, X0, Y0));
+}
+
+void testThatOnlyTheChangedTileIsCounted() {
+  // Fixture
+  const int tile = (OCCUPANCY_GRID_TILES_PER_SIDE / 2) * OCCUPANCY_GRID_TILES_PER_SIDE + OCCUPANCY_GRID_TILES_PER_SIDE / 2;
+
+  // Test
+  // From cell (0, 0) to (5, 0), all in the tile with its corner at the center of the grid
+  occupancyGridAddRange(&grid, X0, Y0, 0.0f, 0.5f, MAX_RANGE);
+
+  // Assert
+  for (int i = 0; i < OCCUPANCY_GRID_TILE_COUNT; i++) {
+    if (i == tile) {
+      TEST_ASSERT_NOT_EQUAL(0, grid.tileChanges[i]);
+    } else {
+      TEST_ASSERT_EQUAL_UINT16(0, grid.tileChanges[i]);
+    }
+  }
+}
+
+void testThatSaturatedCellsDoNotChangeTheTile() {
+  // Fixture
+  const int tile = (OCCUPANCY_GRID_TILES_PER_SIDE / 2) * OCCUPANCY_GRID_TILES_PER_SIDE + OCCUPANCY_GRID_TILES_PER_SIDE / 2;
+  addHits(X0, Y0, 0.0f, 0.5f, 20);
+  const uint16_t expected = grid.tileChanges[tile];
+
+  // Test
+  occupancyGridAddRange(&grid, X0, Y0, 0.0f, 0.5f, MAX_RANGE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT16(expected, grid.tileChanges[tile]);
+}
+
+void testThatGridDoesNotMoveCloseToTheCenter() {
+  // Fixture
+  // Test
+  const bool actual = occupancyGridFollow(&grid, 1.0f, -1.0f);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_EQUAL_UINT16(0, grid.generation);
+}
+
+void testThatGridMovesByWholeTilesAndKeepsTheMap() {
+  // Fixture
+  occupancyGridAddRange(&grid, X0, Y0, 0.0f, 1.0f, MAX_RANGE);
+  const int32_t originX = grid.originX;
+  const uint16_t changesOfEmptyTile = grid.tileChanges[0];
+
+  // Test
+  const bool actual = occupancyGridFollow(&grid, 2.0f, 0.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_UINT16(1, grid.generation);
+  TEST_ASSERT_EQUAL_INT32(originX + 2 * OCCUPANCY_GRID_TILE_SIZE, grid.originX);
+  TEST_ASSERT_EQUAL_UINT16(changesOfEmptyTile + 1, grid.tileChanges[0]);
+  TEST_ASSERT_EQUAL_INT8(grid.hit, occupancyGridGet(&grid, X0 + 1.0f, Y0));
+  TEST_ASSERT_EQUAL_INT8(grid.miss, occupancyGridGet(&grid, X0, Y0));
+}
+
+void testThatGridMovesInNegativeDirectionAndKeepsTheMap() {
+  // Fixture
+  occupancyGridAddRange(&grid, X0, Y0, 0.0f, 1.0f, MAX_RANGE);
+
+  // Test
+  const bool actual = occupancyGridFollow(&grid, -1.5f, -2.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+  TEST_ASSERT_EQUAL_INT8(grid.hit, occupancyGridGet(&grid, X0 + 1.0f, Y0));
+  TEST_ASSERT_EQUAL_INT8(grid.miss, occupancyGridGet(&grid, X0 + 0.5f, Y0));
+}
+
+void testThatCellsLeavingTheGridAreForgotten() {
+  // Fixture
+  occupancyGridAddRange(&grid, X0, Y0, 0.0f, 1.0f, MAX_RANGE);
+
+  // Test
+  occupancyGridFollow(&grid, 20.0f, 0.0f);
+  occupancyGridFollow(&grid, 0.0f, 0.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT8(0, occupancyGridGet(&grid, X0 + 1.0f, Y0));
+  TEST_ASSERT_EQUAL_INT8(0, occupancyGridGet(&grid, X0, Y0));
+}
+
+void testThatRangeFromOutsideTheGridUpdatesCellsInside() {
+  // Fixture
+  const float outside = -(OCCUPANCY_GRID_SIZE / 2 + 5) * RESOLUTION + X0;
+
+  // Test
+  occupancyGridAddRange(&grid, outside, Y0, 0.0f, 1.0f, MAX_RANGE);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT8(grid.hit, occupancyGridGet(&grid, outside + 1.0f, Y0));
+}
+
+// Helpers ///////////////
+
+static void addHits(const float x, const float y, const float angle, const float range, const int count) {
+  for (int i = 0; i < count; i++) {
+    occupancyGridAddRange(&grid, x, y, angle, range, MAX_RANGE);
+  }
+}
@@ -0,0 +1,157 @@
+// File under test screen_buffer.c
+#include "screen_buffer.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+static screenFrame_t front;
+static screenFrame_t back;
+static screenTransfer_t transfers[SCREEN_PAGES];
+
+void setUp(void) {
+  screenFrameClear(&front, 0);
+  screenFrameClear(&back, 0);
+  memset(transfers, 0, sizeof(transfers));
+}
+
+void tearDown(void) {}
+
+void testThatNothingIsSentWhenNothingHasChanged() {
+  // Fixture
+  // Test
+  const int actual = screenFrameUpdate(&front, &back, transfers);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+}
+
+void testThatOnlyChangedColumnsOfOnePageAreSent() {
+  // Fixture
+  back.data[3][10] = 0x01;
+  back.data[3][20] = 0x80;
+
+  // Test
+  const int actual = screenFrameUpdate(&front, &back, transfers);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(3, transfers[0].firstPage);
+  TEST_ASSERT_EQUAL_UINT8(3, transfers[0].lastPage);
+  TEST_ASSERT_EQUAL_UINT8(10, transfers[0].firstColumn);
+  TEST_ASSERT_EQUAL_UINT8(20, transfers[0].lastColumn);
+
+  uint16_t size;
+  const uint8_t* data = screenFrameTransferData(&front, &transfers[0], &size);
+  TEST_ASSERT_EQUAL_UINT16(11, size);
+  TEST_ASSERT_EQUAL_UINT8(0x01, data[0]);
+  TEST_ASSERT_EQUAL_UINT8(0x80, data[10]);
+}
+
+void testThatFrontFrameIsUpdated() {
+  // Fixture
+  back.data[0][0] = 0x12;
+  back.data[7][127] = 0x34;
+
+  // Test
+  screenFrameUpdate(&front, &back, transfers);
+
+  // Assert
+  TEST_ASSERT_EQUAL_MEMORY(&back, &front, sizeof(screenFrame_t));
+  TEST_ASSERT_EQUAL_INT(0, screenFrameUpdate(&front, &back, transfers));
+}
+
+void testThatConsecutivePagesAreMergedToOneFullWidthTransfer() {
+  // Fixture
+  back.data[2][50] = 1;
+  back.data[3][60] = 1;
+  back.data[4][70] = 1;
+
+  // Test
+  const int actual = screenFrameUpdate(&front, &back, transfers);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(2, transfers[0].firstPage);
+  TEST_ASSERT_EQUAL_UINT8(4, transfers[0].lastPage);
+  TEST_ASSERT_EQUAL_UINT8(0, transfers[0].firstColumn);
+  TEST_ASSERT_EQUAL_UINT8(SCREEN_WIDTH - 1, transfers[0].lastColumn);
+
+  uint16_t size;
+  const uint8_t* data = screenFrameTransferData(&front, &transfers[0], &size);
+  TEST_ASSERT_EQUAL_UINT16(3 * SCREEN_WIDTH, size);
+  TEST_ASSERT_EQUAL_PTR(front.data[2], data);
+}
+
+void testThatSeparatedPagesAreSentSeparately() {
+  // Fixture
+  back.data[1][5] = 1;
+  back.data[6][7] = 1;
+
+  // Test
+  const int actual = screenFrameUpdate(&front, &back, transfers);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(1, transfers[0].firstPage);
+  TEST_ASSERT_EQUAL_UINT8(6, transfers[1].firstPage);
+  TEST_ASSERT_EQUAL_UINT8(7, transfers[1].firstColumn);
+}
+
+void testThatStringOnPageBoundaryIsSplitOverTwoPages() {
+  // Fixture
+  // Test
+  screenFramePutString(&back, 0, 4, 1, "-");
+
+  // Assert
+  // The '-' glyph is 0x10 in its 8 columns, shifted down by 4 + 1 rows
+  const uint16_t expected = 0x10 << 5;
+  for (int column = 1; column <= SCREEN_FONT_WIDTH - 1; column++) {
+    TEST_ASSERT_EQUAL_UINT8(expected & 0xff, back.data[0][column]);
+    TEST_ASSERT_EQUAL_UINT8(expected >> 8, back.data[1][column]);
+  }
+  // Blank spacing column
+  TEST_ASSERT_EQUAL_UINT8(0, back.data[0][0]);
+}
+
+void testThatStringClearsItsFieldOnly() {
+  // Fixture
+  screenFrameClear(&back, 0xff);
+
+  // Test
+  screenFramePutString(&back, 0, 0, 2, "");
+
+  // Assert
+  // The field is 9 rows high and 1 + 2 * 8 columns wide
+  for (int column = 0; column <= 2 * SCREEN_FONT_WIDTH; column++) {
+    TEST_ASSERT_EQUAL_UINT8(0x00, back.data[0][column]);
+    TEST_ASSERT_EQUAL_UINT8(0xfe, back.data[1][column]);
+  }
+  TEST_ASSERT_EQUAL_UINT8(0xff, back.data[0][2 * SCREEN_FONT_WIDTH + 1]);
+}
+
+void testThatStringIsClippedAtRightEdge() {
+  // Fixture
+  const screenFrame_t before = back;
+
+  // Test
+  screenFramePutString(&back, SCREEN_WIDTH - 4, 8, 4, "AAAA");
+
+  // Assert
+  // Only page 1 and 2 may be touched, nothing may wrap to the next page
+  TEST_ASSERT_EQUAL_MEMORY(before.data[0], back.data[0], SCREEN_WIDTH);
+  TEST_ASSERT_EQUAL_MEMORY(before.data[3], back.data[3], SCREEN_WIDTH * (SCREEN_PAGES - 3));
+  TEST_ASSERT_EQUAL_MEMORY(before.data[2], back.data[2], SCREEN_WIDTH - 4);
+}
+
+void testThatHorizontalLineSetsOneRow() {
+  // Fixture
+  // Test
+  screenFrameHorizontalLine(&back, 10, 13, 12);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(0x00, back.data[1][9]);
+  TEST_ASSERT_EQUAL_UINT8(0x20, back.data[1][10]);
+  TEST_ASSERT_EQUAL_UINT8(0x20, back.data[1][12]);
+  TEST_ASSERT_EQUAL_UINT8(0x00, back.data[1][13]);
+}
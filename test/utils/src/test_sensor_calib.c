@@ -0,0 +1,176 @@
+// File under test sensor_calib.c
+#include "sensor_calib.h"
+
+#include <math.h>
+
+#include "unity.h"
+
+static const sensorCalibLimits_t limits = {
+  .maxTemperatureDiff = 5.0f,
+  .maxGyroBiasDiff = 10.0f,
+  .maxGyroVariance = 20.0f,
+  .maxAccScaleDiff = 0.02f,
+};
+
+static sensorCalib_t stored;
+static sensorCalibCheck_t check;
+
+static void fillCheck(const int16_t bias[3], const int16_t noise, const float accScale);
+
+void setUp(void) {
+  stored = (sensorCalib_t){
+    .gyroBias = {-12.0f, 30.0f, 4.0f},
+    .accScale = 1.01f,
+    .temperature = 28.0f,
+  };
+  sensorCalibCheckInit(&check);
+}
+
+void tearDown(void) {}
+
+void testThatReasonableCalibrationIsPlausible() {
+  // Fixture
+  // Test
+  const bool actual = sensorCalibIsPlausible(&stored);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+}
+
+void testThatCalibrationWithBadValuesIsNotPlausible() {
+  // Fixture
+  sensorCalib_t badScale = stored;
+  badScale.accScale = 0.0f;
+  sensorCalib_t badBias = stored;
+  badBias.gyroBias[1] = NAN;
+
+  // Test
+  // Assert
+  TEST_ASSERT_FALSE(sensorCalibIsPlausible(&badScale));
+  TEST_ASSERT_FALSE(sensorCalibIsPlausible(&badBias));
+}
+
+void testThatCheckIsDoneAfterAllSamples() {
+  // Fixture
+  const int16_t gyro[3] = {0, 0, 0};
+  for (int i = 0; i < SENSOR_CALIB_CHECK_SAMPLES - 1; i++) {
+    TEST_ASSERT_FALSE(sensorCalibCheckAdd(&check, gyro, 1.0f));
+  }
+
+  // Test
+  const bool actual = sensorCalibCheckAdd(&check, gyro, 1.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+}
+
+void testThatMatchingCalibrationIsAccepted() {
+  // Fixture
+  const int16_t bias[3] = {-10, 33, 2};
+  fillCheck(bias, 3, 1.0f);
+
+  // Test
+  const bool actual = sensorCalibCheckMatches(&check, &stored, 30.0f, &limits);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+}
+
+void testThatIncompleteCheckIsRejected() {
+  // Fixture
+  const int16_t gyro[3] = {-12, 30, 4};
+  sensorCalibCheckAdd(&check, gyro, 1.01f);
+
+  // Test
+  const bool actual = sensorCalibCheckMatches(&check, &stored, 28.0f, &limits);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatCalibrationIsRejectedWhenTemperatureHasChanged() {
+  // Fixture
+  const int16_t bias[3] = {-12, 30, 4};
+  fillCheck(bias, 0, 1.01f);
+
+  // Test
+  const bool actual = sensorCalibCheckMatches(&check, &stored, 34.0f, &limits);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatCalibrationIsRejectedWhenGyroBiasHasChanged() {
+  // Fixture
+  const int16_t bias[3] = {-12, 30, 20};
+  fillCheck(bias, 0, 1.01f);
+
+  // Test
+  const bool actual = sensorCalibCheckMatches(&check, &stored, 28.0f, &limits);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatCalibrationIsRejectedWhenAccScaleHasChanged() {
+  // Fixture
+  const int16_t bias[3] = {-12, 30, 4};
+  fillCheck(bias, 0, 1.05f);
+
+  // Test
+  const bool actual = sensorCalibCheckMatches(&check, &stored, 28.0f, &limits);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatCalibrationIsRejectedWhenPlatformIsMoving() {
+  // Fixture
+  // Right mean, but too much variance
+  const int16_t bias[3] = {-12, 30, 4};
+  fillCheck(bias, 50, 1.01f);
+
+  // Test
+  const bool actual = sensorCalibCheckMatches(&check, &stored, 28.0f, &limits);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatSmallDifferenceDoesNotNeedUpdate() {
+  // Fixture
+  sensorCalib_t fresh = stored;
+  fresh.gyroBias[0] += 2.0f;
+  fresh.accScale += 0.005f;
+  fresh.temperature += 1.0f;
+
+  // Test
+  const bool actual = sensorCalibNeedsUpdate(&stored, &fresh, &limits);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatLargeDifferenceNeedsUpdate() {
+  // Fixture
+  sensorCalib_t freshBias = stored;
+  freshBias.gyroBias[2] += 6.0f;
+  sensorCalib_t freshTemperature = stored;
+  freshTemperature.temperature -= 3.0f;
+
+  // Test
+  // Assert
+  TEST_ASSERT_TRUE(sensorCalibNeedsUpdate(&stored, &freshBias, &limits));
+  TEST_ASSERT_TRUE(sensorCalibNeedsUpdate(&stored, &freshTemperature, &limits));
+}
+
+// Helpers ///////////////
+
+// Alternates +noise and -noise around the bias
+static void fillCheck(const int16_t bias[3], const int16_t noise, const float accScale) {
+  for (int i = 0; i < SENSOR_CALIB_CHECK_SAMPLES; i++) {
+    const int16_t sign = (i % 2) ? 1 : -1;
+    const int16_t gyro[3] = {bias[0] + sign * noise, bias[1] + sign * noise, bias[2] + sign * noise};
+    sensorCalibCheckAdd(&check, gyro, accScale);
+  }
+}
@@ -0,0 +1,229 @@
+// File under test sliding_median.c
+#include "sliding_median.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#define SAMPLE_COUNT 2000
+
+static slidingMedian_t median;
+static medianOutlierFilter_t filter;
+static uint32_t randomState;
+
+static uint32_t nextRandom();
+static float referenceMedian(const float* window, const int size);
+
+void setUp(void) {
+  randomState = 1234;
+  slidingMedianInit(&median, 9);
+  medianOutlierFilterInit(&filter, 9, 3.0f, 0.01f, 5);
+}
+
+void tearDown(void) {}
+
+void testThatEmptyWindowHasZeroMedian() {
+  // Fixture
+  // Test
+  const float actual = slidingMedianGet(&median);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, actual);
+  TEST_ASSERT_FALSE(slidingMedianIsFull(&median));
+}
+
+void testThatMedianOfOneSampleIsTheSample() {
+  // Fixture
+  // Test
+  const float actual = slidingMedianAdd(&median, 3.5f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(3.5f, actual);
+}
+
+void testThatMedianOfPartlyFilledWindowIsTheUpperMiddleSample() {
+  // Fixture
+  slidingMedianAdd(&median, 4.0f);
+  slidingMedianAdd(&median, 1.0f);
+  slidingMedianAdd(&median, 3.0f);
+
+  // Test
+  const float actual = slidingMedianAdd(&median, 2.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(3.0f, actual);
+}
+
+void testThatOldestSampleLeavesTheWindow() {
+  // Fixture
+  slidingMedianInit(&median, 3);
+  slidingMedianAdd(&median, 100.0f);
+  slidingMedianAdd(&median, 100.0f);
+  slidingMedianAdd(&median, 1.0f);
+
+  // Test
+  slidingMedianAdd(&median, 2.0f);
+  const float actual = slidingMedianAdd(&median, 3.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, actual);
+  TEST_ASSERT_TRUE(slidingMedianIsFull(&median));
+}
+
+void testThatSizeIsLimited() {
+  // Fixture
+  // Test
+  slidingMedianInit(&median, SLIDING_MEDIAN_MAX_SIZE + 10);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(SLIDING_MEDIAN_MAX_SIZE, median.size);
+}
+
+void testThatMedianMatchesSortedWindowForAllSizes() {
+  for (int size = 1; size <= SLIDING_MEDIAN_MAX_SIZE; size++) {
+    // Fixture
+    float window[SLIDING_MEDIAN_MAX_SIZE];
+    int count = 0;
+    slidingMedianInit(&median, size);
+
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+      // Few distinct values to get many duplicates
+      const float sample = (float)(nextRandom() % 50);
+      if (count < size) {
+        window[count++] = sample;
+      } else {
+        memmove(&window[0], &window[1], (size - 1) * sizeof(float));
+        window[size - 1] = sample;
+      }
+
+      // Test
+      const float actual = slidingMedianAdd(&median, sample);
+
+      // Assert
+      TEST_ASSERT_EQUAL_FLOAT(referenceMedian(window, count), actual);
+    }
+  }
+}
+
+void testThatFilterRejectsSamplesUntilMinCountIsReached() {
+  // Fixture
+  for (int i = 0; i < 4; i++) {
+    // Test
+    const bool actual = medianOutlierFilterAdd(&filter, 1.0f);
+
+    // Assert
+    TEST_ASSERT_FALSE(actual);
+  }
+
+  // Test
+  const bool actual = medianOutlierFilterAdd(&filter, 1.0f);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+  TEST_ASSERT_TRUE(medianOutlierFilterAdd(&filter, 1.0f));
+}
+
+void testThatFilterRejectsOutlierBeforeTheWindowIsFull() {
+  // Fixture
+  for (int i = 0; i < 5; i++) {
+    medianOutlierFilterAdd(&filter, 5.0f + 0.01f * (float)(i % 3));
+  }
+
+  // Test
+  const bool actual = medianOutlierFilterAdd(&filter, 7.0f);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatMinCountIsLimitedToTheWindowSize() {
+  // Fixture
+  medianOutlierFilterInit(&filter, 3, 3.0f, 0.01f, 10);
+  for (int i = 0; i < 3; i++) {
+    medianOutlierFilterAdd(&filter, 1.0f);
+  }
+
+  // Test
+  const bool actual = medianOutlierFilterAdd(&filter, 1.0f);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+}
+
+void testThatFilterAcceptsNoisySamples() {
+  // Fixture
+  for (int i = 0; i < 20; i++) {
+    medianOutlierFilterAdd(&filter, 5.0f + 0.1f * (float)(i % 3));
+  }
+
+  // Test
+  const bool actual = medianOutlierFilterAdd(&filter, 5.15f);
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+}
+
+void testThatFilterRejectsOutlier() {
+  // Fixture
+  for (int i = 0; i < 20; i++) {
+    medianOutlierFilterAdd(&filter, 5.0f + 0.1f * (float)(i % 3));
+  }
+
+  // Test
+  const bool actual = medianOutlierFilterAdd(&filter, 7.0f);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatMinDeviationIsUsedForNoiseFreeSamples() {
+  // Fixture
+  for (int i = 0; i < 20; i++) {
+    medianOutlierFilterAdd(&filter, 5.0f);
+  }
+
+  // Test
+  // Assert
+  TEST_ASSERT_TRUE(medianOutlierFilterAdd(&filter, 5.02f));
+  TEST_ASSERT_FALSE(medianOutlierFilterAdd(&filter, 5.05f));
+}
+
+void testThatFilterFollowsAStep() {
+  // Fixture
+  for (int i = 0; i < 20; i++) {
+    medianOutlierFilterAdd(&filter, 5.0f + 0.1f * (float)(i % 3));
+  }
+
+  // Test
+  bool actual = false;
+  for (int i = 0; i < 20; i++) {
+    actual = medianOutlierFilterAdd(&filter, 8.0f + 0.1f * (float)(i % 3));
+  }
+
+  // Assert
+  TEST_ASSERT_TRUE(actual);
+}
+
+// Helpers ///////////////
+
+static uint32_t nextRandom() {
+  randomState = randomState * 1664525 + 1013904223;
+  return randomState >> 8;
+}
+
+// Insertion sort of a copy of the window
+static float referenceMedian(const float* window, const int size) {
+  float sorted[SLIDING_MEDIAN_MAX_SIZE];
+  memcpy(sorted, window, size * sizeof(float));
+
+  for (int n = 1; n < size; n++) {
+    const float value = sorted[n];
+    int m;
+    for (m = n - 1; m >= 0 && value < sorted[m]; m--) {
+      sorted[m + 1] = sorted[m];
+    }
+    sorted[m + 1] = value;
+  }
+
+  return sorted[size / 2];
+}
@@ -0,0 +1,182 @@
+// File under test spectrum.c
+#include "spectrum.h"
+
+#include "unity.h"
+
+// @MODULE "arm_cos_f32.c"
+// @MODULE "arm_common_tables.c"
+// @MODULE "arm_const_structs.c"
+// @MODULE "arm_mean_f32.c"
+// @MODULE "arm_offset_f32.c"
+// @MODULE "arm_mult_f32.c"
+// @MODULE "arm_cfft_f32.c"
+// @MODULE "arm_cfft_radix8_f32.c"
+// @MODULE "arm_rfft_fast_f32.c"
+// @MODULE "arm_rfft_fast_init_f32.c"
+// @MODULE "arm_bitreversal_32.c"
+
+#define SAMPLE_FREQ 1000.0f
+#define BIN_WIDTH (SAMPLE_FREQ / SPECTRUM_FFT_SIZE)
+#define TWO_PI (2.0f * PI)
+
+static const float bandEdges[SPECTRUM_BAND_COUNT + 1] = {0.0f, 50.0f, 150.0f, 300.0f, 500.0f};
+
+static spectrum_t spectrum;
+static spectrumResult_t result;
+static float frame[SPECTRUM_FFT_SIZE];
+
+static void fillSine(float* samples, const float amplitude, const float freq, const float offset);
+static void addSine(float* samples, const float amplitude, const float freq);
+
+void setUp(void) {
+  TEST_ASSERT_TRUE(spectrumInit(&spectrum, SAMPLE_FREQ, bandEdges));
+}
+
+void tearDown(void) {}
+
+void testThatPeakFrequencyIsFoundForSineOnBin() {
+  // Fixture
+  const float freq = 40 * BIN_WIDTH;
+  fillSine(frame, 1.0f, freq, 0.0f);
+
+  // Test
+  spectrumAnalyze(&spectrum, frame, &result);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.01f * BIN_WIDTH, freq, result.peakFreq);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, result.peakAmplitude);
+}
+
+void testThatPeakFrequencyIsInterpolatedBetweenBins() {
+  // Fixture
+  const float freq = 123.4f;
+  fillSine(frame, 2.0f, freq, 0.0f);
+
+  // Test
+  spectrumAnalyze(&spectrum, frame, &result);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.25f * BIN_WIDTH, freq, result.peakFreq);
+}
+
+void testThatStrongestOfTwoComponentsIsThePeak() {
+  // Fixture
+  fillSine(frame, 0.5f, 80.0f, 0.0f);
+  addSine(frame, 1.5f, 250.0f);
+
+  // Test
+  spectrumAnalyze(&spectrum, frame, &result);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(BIN_WIDTH, 250.0f, result.peakFreq);
+}
+
+void testThatDcIsIgnored() {
+  // Fixture
+  fillSine(frame, 0.1f, 200.0f, 9.81f);
+
+  // Test
+  spectrumAnalyze(&spectrum, frame, &result);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(BIN_WIDTH, 200.0f, result.peakFreq);
+  TEST_ASSERT_TRUE(result.bandEnergy[0] < 1e-6f);
+}
+
+void testThatBandEnergyOfSineIsMeanSquare() {
+  // Fixture
+  const float amplitude = 3.0f;
+  fillSine(frame, amplitude, 210.0f, 0.0f);
+
+  // Test
+  spectrumAnalyze(&spectrum, frame, &result);
+
+  // Assert
+  const float expected = amplitude * amplitude / 2.0f;
+  TEST_ASSERT_FLOAT_WITHIN(0.02f * expected, expected, result.bandEnergy[2]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f * expected, 0.0f, result.bandEnergy[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f * expected, 0.0f, result.bandEnergy[1]);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f * expected, 0.0f, result.bandEnergy[3]);
+}
+
+void testThatEnergyIsSplitOnBands() {
+  // Fixture
+  fillSine(frame, 1.0f, 20.0f, 0.0f);
+  addSine(frame, 2.0f, 400.0f);
+
+  // Test
+  spectrumAnalyze(&spectrum, frame, &result);
+
+  // Assert
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.5f, result.bandEnergy[0]);
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, result.bandEnergy[1]);
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, result.bandEnergy[2]);
+  TEST_ASSERT_FLOAT_WITHIN(0.04f, 2.0f, result.bandEnergy[3]);
+}
+
+void testThatBufferIsNotReadyUntilFull() {
+  // Fixture
+  spectrumBuffer_t buffer;
+  spectrumBufferInit(&buffer);
+
+  // Test
+  int readyCount = 0;
+  for (int i = 0; i < SPECTRUM_FFT_SIZE - 1; i++) {
+    readyCount += spectrumBufferAdd(&buffer, i);
+  }
+  const bool ready = spectrumBufferAdd(&buffer, 0.0f);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, readyCount);
+  TEST_ASSERT_TRUE(ready);
+}
+
+void testThatBufferIsReadyEveryHop() {
+  // Fixture
+  spectrumBuffer_t buffer;
+  spectrumBufferInit(&buffer);
+  for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+    spectrumBufferAdd(&buffer, i);
+  }
+
+  // Test
+  int readyCount = 0;
+  for (int i = 0; i < 3 * SPECTRUM_HOP_SIZE; i++) {
+    readyCount += spectrumBufferAdd(&buffer, i);
+  }
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(3, readyCount);
+}
+
+void testThatFrameIsOldestSampleFirst() {
+  // Fixture
+  spectrumBuffer_t buffer;
+  spectrumBufferInit(&buffer);
+  const int sampleCount = SPECTRUM_FFT_SIZE + SPECTRUM_HOP_SIZE + 7;
+  for (int i = 0; i < sampleCount; i++) {
+    spectrumBufferAdd(&buffer, i);
+  }
+
+  // Test
+  spectrumBufferGetFrame(&buffer, frame);
+
+  // Assert
+  for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+    TEST_ASSERT_EQUAL_FLOAT(sampleCount - SPECTRUM_FFT_SIZE + i, frame[i]);
+  }
+}
+
+// Helpers ///////////////
+
+static void fillSine(float* samples, const float amplitude, const float freq, const float offset) {
+  for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+    samples[i] = offset + amplitude * sinf(TWO_PI * freq * i / SAMPLE_FREQ);
+  }
+}
+
+static void addSine(float* samples, const float amplitude, const float freq) {
+  for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+    samples[i] += amplitude * sinf(TWO_PI * freq * i / SAMPLE_FREQ);
+  }
+}
@@ -0,0 +1,207 @@
+// File under test swarm_frame.c
+#include "swarm_frame.h"
+
+#include <string.h>
+
+#include "unity.h"
+
+#define MY_SLOT 5
+#define SLOT_COUNT 10
+#define ITEMS_PER_PACKET (SWARM_FRAME_MAX_PAYLOAD / sizeof(swarmFramePositionItem_t))
+
+static swarmFrameReceiver_t receiver;
+static uint8_t packet[30];
+static uint8_t packetLength;
+
+static void buildPacket(const uint8_t seq, const uint8_t slotCount, const uint8_t firstSlot);
+static const swarmFramePositionItem_t* addPacket();
+static void addFrame(const uint8_t seq, const bool includeMySlot);
+
+void setUp(void) {
+  swarmFrameReceiverInit(&receiver, MY_SLOT);
+}
+
+void tearDown(void) {}
+
+void testThatFourPositionsFitInAPacket() {
+  // Fixture
+  // Test
+  // Assert
+  TEST_ASSERT_EQUAL_INT(4, ITEMS_PER_PACKET);
+}
+
+void testThatItemOfMySlotIsReturned() {
+  // Fixture
+  buildPacket(1, SLOT_COUNT, 4);
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(actual);
+  TEST_ASSERT_EQUAL_INT16(MY_SLOT * 100, actual->x);
+  TEST_ASSERT_EQUAL_INT16(-MY_SLOT, actual->z);
+}
+
+void testThatPacketWithoutMySlotReturnsNull() {
+  // Fixture
+  buildPacket(1, SLOT_COUNT, 0);
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT8(1, receiver.packetsReceived);
+}
+
+void testThatLastPacketOfFrameMayBeShort() {
+  // Fixture
+  swarmFrameReceiverInit(&receiver, 9);
+  buildPacket(1, SLOT_COUNT, 8);
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(actual);
+  TEST_ASSERT_EQUAL_INT16(900, actual->x);
+}
+
+void testThatPacketNotOnPacketBoundaryIsDropped() {
+  // Fixture
+  buildPacket(1, SLOT_COUNT, 3);
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT32(0, receiver.frameCount);
+}
+
+void testThatDuplicatePacketIsIgnored() {
+  // Fixture
+  buildPacket(1, SLOT_COUNT, 4);
+  addPacket();
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT8(1, receiver.packetsReceived);
+}
+
+void testThatPacketOfOlderFrameIsDropped() {
+  // Fixture
+  addFrame(10, true);
+  buildPacket(9, SLOT_COUNT, 4);
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT32(1, receiver.staleCount);
+  TEST_ASSERT_EQUAL_UINT8(10, receiver.seq);
+}
+
+void testThatMuchOlderFrameIsARestartOfTheSequence() {
+  // Fixture
+  addFrame(100, true);
+  buildPacket(0, SLOT_COUNT, 4);
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT8(0, receiver.seq);
+}
+
+void testThatSequenceNumberWrapsAround() {
+  // Fixture
+  addFrame(255, true);
+  buildPacket(0, SLOT_COUNT, 4);
+
+  // Test
+  const swarmFramePositionItem_t* actual = addPacket();
+
+  // Assert
+  TEST_ASSERT_NOT_NULL(actual);
+  TEST_ASSERT_EQUAL_UINT32(2, receiver.frameCount);
+  TEST_ASSERT_EQUAL_UINT32(0, receiver.frameLostCount);
+}
+
+void testThatQualityIsSetWhenFrameIsFinished() {
+  // Fixture
+  // Two out of three packets
+  buildPacket(1, SLOT_COUNT, 0);
+  addPacket();
+  buildPacket(1, SLOT_COUNT, 8);
+  addPacket();
+
+  // Test
+  addFrame(2, true);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT8(66, receiver.quality);
+  TEST_ASSERT_EQUAL_UINT32(1, receiver.slotMissedCount);
+}
+
+void testThatLostFramesAreCounted() {
+  // Fixture
+  addFrame(1, true);
+
+  // Test
+  addFrame(4, true);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(2, receiver.frameCount);
+  TEST_ASSERT_EQUAL_UINT32(2, receiver.frameLostCount);
+  TEST_ASSERT_EQUAL_UINT32(0, receiver.slotMissedCount);
+  TEST_ASSERT_EQUAL_UINT8(100, receiver.quality);
+}
+
+void testThatSlotOutsideFrameIsNotMissed() {
+  // Fixture
+  swarmFrameReceiverInit(&receiver, 20);
+  addFrame(1, false);
+
+  // Test
+  addFrame(2, false);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(0, receiver.slotMissedCount);
+}
+
+// Helpers ///////////////
+
+// Items have x = slot * 100, y = slot and z = -slot
+static void buildPacket(const uint8_t seq, const uint8_t slotCount, const uint8_t firstSlot) {
+  swarmFrameHeader_t header = {.seq = seq, .slotCount = slotCount, .firstSlot = firstSlot};
+  memcpy(packet, &header, sizeof(header));
+  packetLength = sizeof(header);
+
+  for (uint8_t slot = firstSlot; slot < slotCount && slot < firstSlot + ITEMS_PER_PACKET; slot++) {
+    swarmFramePositionItem_t item = {.x = slot * 100, .y = slot, .z = -slot};
+    memcpy(&packet[packetLength], &item, sizeof(item));
+    packetLength += sizeof(item);
+  }
+}
+
+static const swarmFramePositionItem_t* addPacket() {
+  return swarmFrameReceiverAdd(&receiver, packet, packetLength, sizeof(swarmFramePositionItem_t));
+}
+
+// All packets of a frame, except the one with my slot unless includeMySlot
+static void addFrame(const uint8_t seq, const bool includeMySlot) {
+  for (uint8_t firstSlot = 0; firstSlot < SLOT_COUNT; firstSlot += ITEMS_PER_PACKET) {
+    const bool hasMySlot = MY_SLOT >= firstSlot && MY_SLOT < firstSlot + ITEMS_PER_PACKET;
+    if (includeMySlot || !hasMySlot) {
+      buildPacket(seq, SLOT_COUNT, firstSlot);
+      addPacket();
+    }
+  }
+}
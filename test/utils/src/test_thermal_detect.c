@@ -0,0 +1,228 @@
+// File under test thermal_detect.c
+#include "thermal_detect.h"
+
+#include "unity.h"
+
+#define AMBIENT (22 * THERMAL_UNITS_PER_DEGREE)
+#define THRESHOLD (2 * THERMAL_UNITS_PER_DEGREE)
+
+static thermalDetector_t detector;
+static int16_t image[THERMAL_PIXELS];
+static thermalDetection_t detections[3];
+
+static void fillImage(const int16_t value);
+static void setPixel(const int x, const int y, const int16_t value);
+static void processBackground();
+
+void setUp(void) {
+  thermalDetectorInit(&detector, THRESHOLD, 1, 4);
+  fillImage(AMBIENT);
+}
+
+void tearDown(void) {}
+
+void testThatFirstFrameOnlyInitializesTheBackground() {
+  // Fixture
+  setPixel(3, 3, AMBIENT + 40);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+}
+
+void testThatUniformSceneHasNoDetections() {
+  // Fixture
+  processBackground();
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+  TEST_ASSERT_EQUAL_UINT8(0, detector.blobCount);
+}
+
+void testThatChangeBelowThresholdIsIgnored() {
+  // Fixture
+  processBackground();
+  setPixel(2, 5, AMBIENT + THRESHOLD);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+}
+
+void testThatSingleHotPixelIsDetected() {
+  // Fixture
+  processBackground();
+  setPixel(2, 5, AMBIENT + 20);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(1, detections[0].area);
+  TEST_ASSERT_EQUAL_INT16(AMBIENT + 20, detections[0].peak);
+  TEST_ASSERT_EQUAL_UINT16(2 << THERMAL_FRACTION_BITS, detections[0].centroidX);
+  TEST_ASSERT_EQUAL_UINT16(5 << THERMAL_FRACTION_BITS, detections[0].centroidY);
+}
+
+void testThatCentroidIsWeightedByExcessTemperature() {
+  // Fixture
+  processBackground();
+  setPixel(4, 1, AMBIENT + 30);
+  setPixel(5, 1, AMBIENT + 10);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(2, detections[0].area);
+  // (4 * 30 + 5 * 10) / 40 = 4.25
+  TEST_ASSERT_EQUAL_UINT16((17 << THERMAL_FRACTION_BITS) / 4, detections[0].centroidX);
+  TEST_ASSERT_EQUAL_UINT16(1 << THERMAL_FRACTION_BITS, detections[0].centroidY);
+}
+
+void testThatDiagonalPixelsAreSeparateBlobs() {
+  // Fixture
+  processBackground();
+  setPixel(1, 1, AMBIENT + 20);
+  setPixel(2, 2, AMBIENT + 30);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(2, detector.blobCount);
+}
+
+void testThatDetectionsAreSortedByPeakAndLimited() {
+  // Fixture
+  thermalDetection_t twoDetections[2];
+  processBackground();
+  setPixel(0, 0, AMBIENT + 20);
+  setPixel(7, 0, AMBIENT + 40);
+  setPixel(0, 7, AMBIENT + 30);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, twoDetections, 2);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(2, actual);
+  TEST_ASSERT_EQUAL_UINT8(3, detector.blobCount);
+  TEST_ASSERT_EQUAL_INT16(AMBIENT + 40, twoDetections[0].peak);
+  TEST_ASSERT_EQUAL_INT16(AMBIENT + 30, twoDetections[1].peak);
+}
+
+void testThatSmallBlobsAreIgnored() {
+  // Fixture
+  thermalDetectorInit(&detector, THRESHOLD, 3, 4);
+  processBackground();
+  setPixel(1, 1, AMBIENT + 20);
+  setPixel(5, 5, AMBIENT + 20);
+  setPixel(5, 6, AMBIENT + 20);
+  setPixel(6, 6, AMBIENT + 20);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT8(3, detections[0].area);
+}
+
+void testThatTargetIsNotAbsorbedIntoTheBackground() {
+  // Fixture
+  processBackground();
+  setPixel(3, 3, AMBIENT + 20);
+  for (int i = 0; i < 100; i++) {
+    thermalDetectorUpdate(&detector, image, detections, 3);
+  }
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+}
+
+void testThatStaticWarmObjectIsEventuallyAbsorbedIntoTheBackground() {
+  // Fixture
+  processBackground();
+  setPixel(3, 3, AMBIENT + 20);
+  for (int i = 0; i < 1000; i++) {
+    thermalDetectorUpdate(&detector, image, detections, 3);
+  }
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+}
+
+void testThatZeroThresholdDetectsAnyWarmerPixel() {
+  // Fixture
+  thermalDetectorInit(&detector, 0, 1, 4);
+  processBackground();
+  setPixel(6, 2, AMBIENT + 1);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_UINT16(6 << THERMAL_FRACTION_BITS, detections[0].centroidX);
+}
+
+void testThatHighestBackgroundRateDoesNotOverflowTheShift() {
+  // Fixture
+  thermalDetectorInit(&detector, THRESHOLD, 1, THERMAL_MAX_BACKGROUND_RATE);
+  processBackground();
+  setPixel(3, 3, AMBIENT + 20);
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(1, actual);
+  TEST_ASSERT_EQUAL_INT32(AMBIENT << THERMAL_FRACTION_BITS, detector.background[3 * THERMAL_IMAGE_SIZE + 3]);
+}
+
+void testThatBackgroundFollowsSlowAmbientChanges() {
+  // Fixture
+  processBackground();
+  for (int i = 0; i < 100; i++) {
+    fillImage(AMBIENT + i / 10);
+    thermalDetectorUpdate(&detector, image, detections, 3);
+  }
+
+  // Test
+  const int actual = thermalDetectorUpdate(&detector, image, detections, 3);
+
+  // Assert
+  TEST_ASSERT_EQUAL_INT(0, actual);
+}
+
+// Helpers ///////////////
+
+static void fillImage(const int16_t value) {
+  for (int i = 0; i < THERMAL_PIXELS; i++) {
+    image[i] = value;
+  }
+}
+
+static void setPixel(const int x, const int y, const int16_t value) {
+  image[y * THERMAL_IMAGE_SIZE + x] = value;
+}
+
+static void processBackground() {
+  thermalDetectorUpdate(&detector, image, detections, 3);
+}
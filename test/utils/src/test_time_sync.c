@@ -0,0 +1,102 @@
+// File under test time_sync.c
+#include "time_sync.h"
+
+#include "unity.h"
+
+static timeSync_t sync;
+
+void setUp(void) {
+  timeSyncInit(&sync);
+}
+
+void tearDown(void) {}
+
+void testThatSyncIsNotValidWithoutSamples() {
+  // Fixture
+  // Test
+  const bool actual = timeSyncIsValid(&sync);
+
+  // Assert
+  TEST_ASSERT_FALSE(actual);
+}
+
+void testThatRemoteTimeIsConvertedWithOneRoundTrip() {
+  // Fixture
+  // True offset -98766, 3 ms latency in both directions
+  timeSyncAddRoundTrip(&sync, 100000, 1237, 1237, 100006);
+
+  // Test
+  const uint32_t actual = timeSyncToLocal(&sync, 100050);
+
+  // Assert
+  TEST_ASSERT_TRUE(timeSyncIsValid(&sync));
+  TEST_ASSERT_EQUAL_UINT32(1284, actual);
+}
+
+void testThatAsymmetricLatencyGivesHalfTheDifferenceAsError() {
+  // Fixture
+  // True offset -99000, 3 ms latency to the Crazyflie and 9 ms back. A one
+  // way estimate would be off by 3 ms, the round trip by (3 - 9) / 2 ms.
+  timeSyncAddRoundTrip(&sync, 100000, 1003, 1004, 100013);
+
+  // Test
+  const uint32_t actual = timeSyncToLocal(&sync, 100300);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1300 - 3, actual);
+  TEST_ASSERT_EQUAL_UINT32(12, sync.delay);
+}
+
+void testThatRoundTripWithSmallestDelayIsUsed() {
+  // Fixture
+  // True offset -99000, latencies (up, down) of (7, 1), (2, 2) and (12, 4) ms
+  timeSyncAddRoundTrip(&sync, 100000, 1007, 1007, 100008);
+  timeSyncAddRoundTrip(&sync, 100100, 1102, 1102, 100104);
+  timeSyncAddRoundTrip(&sync, 100200, 1212, 1212, 100216);
+
+  // Test
+  const uint32_t actual = timeSyncToLocal(&sync, 100300);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(1300, actual);
+  TEST_ASSERT_EQUAL_UINT32(4, sync.delay);
+}
+
+void testThatOldSamplesLeaveTheWindow() {
+  // Fixture
+  timeSyncAddRoundTrip(&sync, 0, 1000, 1000, 0);
+  for (int i = 0; i < TIME_SYNC_WINDOW; i++) {
+    const uint32_t t0 = 100 * (i + 1);
+    timeSyncAddRoundTrip(&sync, t0, t0 + 1005, t0 + 1005, t0 + 10);
+  }
+
+  // Test
+  const uint32_t actual = timeSyncToLocal(&sync, 5000);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(6000, actual);
+}
+
+void testThatClocksMayWrapAround() {
+  // Fixture
+  // True offset 30, the remote clock wraps between request and answer
+  timeSyncAddRoundTrip(&sync, UINT32_MAX - 2, 31, 31, 5);
+
+  // Test
+  const uint32_t actual = timeSyncToLocal(&sync, UINT32_MAX);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32(29, actual);
+}
+
+void testThatOffsetsOfAnySignAreHandled() {
+  // Fixture
+  // Offset around INT32_MAX, where a plain signed mean overflows
+  timeSyncAddRoundTrip(&sync, 0, (uint32_t)INT32_MAX + 5, (uint32_t)INT32_MAX + 5, 10);
+
+  // Test
+  const uint32_t actual = timeSyncToLocal(&sync, 0);
+
+  // Assert
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)INT32_MAX, actual);
+}
@@ -0,0 +1,59 @@
+/**
+ * bench_clock_correction.c - Double and fixed point clock correction
+ *
+ * Clock correction and TDoA distance computation for random tick counts.
+ * Doubles are implemented in hardware on the host, on the Cortex-M4 they are
+ * emulated in software, so the difference on the target is much larger.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "clockCorrectionEngine.h"
+
+#define MASK 0xFFFFFFFFFF // 40 bits
+#define LOCODECK_TS_FREQ (499.2e6 * 128)
+#define BENCHMARK_COUNT 1000000
+
+static uint32_t randomState = 1234;
+
+static uint32_t nextRandom() {
+  randomState = randomState * 1664525 + 1013904223;
+  return randomState;
+}
+
+// Random tick count between 1 and 20 ms, the typical time between packets from an anchor
+static uint64_t randomTickCount() {
+  return (uint64_t)(LOCODECK_TS_FREQ * (0.001 + 0.019 * (nextRandom() / (double)UINT32_MAX)));
+}
+
+int main() {
+  static uint64_t tickCounts[1024];
+  for (int i = 0; i < 1024; i++) {
+    tickCounts[i] = randomTickCount();
+  }
+  volatile double doubleSink = 0;
+  volatile int64_t fixedSink = 0;
+
+  clock_t start = clock();
+  for (int i = 0; i < BENCHMARK_COUNT; i++) {
+    const uint64_t x = tickCounts[i & 1023];
+    const double clockCorrection = clockCorrectionEngineCalculate(x + 17, 0, x, 0, MASK);
+    doubleSink = (int64_t)(x - x * clockCorrection) * 299792458.0 / LOCODECK_TS_FREQ;
+  }
+  const double doubleTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  const float metersPerFixedTick = 299792458.0 / LOCODECK_TS_FREQ / (1 << CLOCK_CORRECTION_FIXED_TICK_SHIFT);
+  start = clock();
+  for (int i = 0; i < BENCHMARK_COUNT; i++) {
+    const uint64_t x = tickCounts[i & 1023];
+    const clockCorrectionFixed_t clockCorrection = clockCorrectionEngineCalculateFixed(x + 17, 0, x, 0, MASK);
+    fixedSink = (int64_t)((float)(((int64_t)x << CLOCK_CORRECTION_FIXED_TICK_SHIFT) - clockCorrectionEngineApplyFixed(x, clockCorrection)) * metersPerFixedTick);
+  }
+  const double fixedTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("Clock correction and TDoA, double: %.1f ns, fixed point: %.1f ns\n",
+    doubleTime * 1e9 / BENCHMARK_COUNT, fixedTime * 1e9 / BENCHMARK_COUNT);
+  (void)doubleSink;
+  (void)fixedSink;
+  return 0;
+}
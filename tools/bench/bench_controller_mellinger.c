@@ -0,0 +1,127 @@
+/**
+ * bench_controller_mellinger.c - Mellinger control with degree and heading setpoints
+ *
+ * Prints the time per tick from trajectory output to control output, for the
+ * degree setpoint and the heading setpoint. The trajectory is evaluated up
+ * front, poly4d_eval() is the same for both.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "controller_mellinger.h"
+#include "pptraj.h"
+
+#define SAMPLE_COUNT 1000000
+
+static struct traj_eval evs[1024];
+static uint32_t randomState = 1234;
+
+static float randomFloat(const float min, const float max) {
+  randomState = randomState * 1664525 + 1013904223;
+  return min + (max - min) * (randomState >> 8) / (float)(1 << 24);
+}
+
+static struct poly4d randomPiece() {
+  struct poly4d piece;
+  piece.duration = randomFloat(1.0f, 3.0f);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < PP_SIZE; j++) {
+      piece.p[i][j] = randomFloat(-0.5f, 0.5f) / (j + 1);
+    }
+  }
+  return piece;
+}
+
+// The feed forward as set by the high level commander
+static void fillSetpointInDegrees(setpoint_t* setpoint, const struct traj_eval* ev) {
+  setpoint->position.x = ev->pos.x;
+  setpoint->position.y = ev->pos.y;
+  setpoint->position.z = ev->pos.z;
+  setpoint->velocity.x = ev->vel.x;
+  setpoint->velocity.y = ev->vel.y;
+  setpoint->velocity.z = ev->vel.z;
+  setpoint->acceleration.x = ev->acc.x;
+  setpoint->acceleration.y = ev->acc.y;
+  setpoint->acceleration.z = ev->acc.z;
+  setpoint->attitude.yaw = degrees(ev->yaw);
+  setpoint->attitudeRate.roll = degrees(ev->omega.x);
+  setpoint->attitudeRate.pitch = degrees(ev->omega.y);
+  setpoint->attitudeRate.yaw = degrees(ev->omega.z);
+  setpoint->mode.x = modeAbs;
+  setpoint->mode.y = modeAbs;
+  setpoint->mode.z = modeAbs;
+  setpoint->mode.roll = modeDisable;
+  setpoint->mode.pitch = modeDisable;
+  setpoint->mode.yaw = modeAbs;
+  setpoint->mode.quat = modeDisable;
+  setpoint->mode.heading = modeDisable;
+}
+
+static void fillSetpointInRadians(setpoint_t* setpoint, const struct traj_eval* ev) {
+  fillSetpointInDegrees(setpoint, ev);
+  setpoint->heading.x = ev->heading.x;
+  setpoint->heading.y = ev->heading.y;
+  setpoint->heading.z = ev->heading.z;
+  setpoint->omega.x = ev->omega.x;
+  setpoint->omega.y = ev->omega.y;
+  setpoint->omega.z = ev->omega.z;
+  setpoint->mode.heading = modeAbs;
+}
+
+// A hovering vehicle with some rotation
+static void fillSensorsAndState(sensorData_t* sensors, state_t* state) {
+  memset(sensors, 0, sizeof(*sensors));
+  memset(state, 0, sizeof(*state));
+
+  sensors->gyro.x = randomFloat(-30.0f, 30.0f);
+  sensors->gyro.y = randomFloat(-30.0f, 30.0f);
+  sensors->gyro.z = randomFloat(-30.0f, 30.0f);
+
+  state->position.z = 0.5f;
+  const struct quat q = rpy2quat(mkvec(0.1f, -0.1f, 1.0f));
+  state->attitudeQuaternion.x = q.x;
+  state->attitudeQuaternion.y = q.y;
+  state->attitudeQuaternion.z = q.z;
+  state->attitudeQuaternion.w = q.w;
+  state->attitude.yaw = degrees(quat2rpy(q).z);
+}
+
+int main() {
+  for (int i = 0; i < 1024; i++) {
+    const struct poly4d piece = randomPiece();
+    evs[i] = poly4d_eval(&piece, randomFloat(0.0f, piece.duration));
+  }
+  sensorData_t sensors;
+  state_t state;
+  fillSensorsAndState(&sensors, &state);
+  setpoint_t setpoint;
+  memset(&setpoint, 0, sizeof(setpoint));
+  control_t control;
+  volatile float sink = 0;
+
+  controllerMellingerInit();
+  clock_t start = clock();
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    fillSetpointInDegrees(&setpoint, &evs[i & 1023]);
+    controllerMellinger(&control, &setpoint, &sensors, &state, 0);
+    sink = control.thrust;
+  }
+  const double degreeTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  controllerMellingerInit();
+  start = clock();
+  for (int i = 0; i < SAMPLE_COUNT; i++) {
+    fillSetpointInRadians(&setpoint, &evs[i & 1023]);
+    controllerMellinger(&control, &setpoint, &sensors, &state, 0);
+    sink = control.thrust;
+  }
+  const double headingTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("Mellinger control per tick, degree setpoint: %.1f ns, heading setpoint: %.1f ns\n",
+    degreeTime * 1e9 / SAMPLE_COUNT, headingTime * 1e9 / SAMPLE_COUNT);
+  (void)sink;
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * bench_filter_bank.c - 3-axis low pass with lpf2p, CMSIS biquad and filter bank
+ *
+ * Prints the time to filter one 3-axis sample with three lpf2p instances, one
+ * CMSIS biquad call per axis and one filter bank.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "filter_bank.h"
+#include "filter.h"
+#include "cf_math.h"
+
+#define SAMPLE_FREQ 1000.0f
+#define SAMPLE_COUNT 1000000
+
+static float samples[1024];
+static filterBank_t bank;
+static uint32_t randomState = 1234;
+
+static float randomFloat(const float min, const float max) {
+  randomState = randomState * 1664525 + 1013904223;
+  return min + (max - min) * (randomState >> 8) / (float)(1 << 24);
+}
+
+int main() {
+  for (int i = 0; i < 1024; i++) {
+    samples[i] = randomFloat(-2000.0f, 2000.0f);
+  }
+  lpf2pData lpf[3];
+  arm_biquad_cascade_df2T_instance_f32 cmsis[3];
+  float32_t cmsisState[3][2];
+  filterBankInit(&bank, 3);
+  filterBankAddLowPass(&bank, SAMPLE_FREQ, 80.0f);
+  for (int i = 0; i < 3; i++) {
+    lpf2pInit(&lpf[i], SAMPLE_FREQ, 80.0f);
+    arm_biquad_cascade_df2T_init_f32(&cmsis[i], 1, &bank.coeffs[0][0], cmsisState[i]);
+  }
+  volatile float sink = 0;
+  float frame[3];
+
+  clock_t start = clock();
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    for (int i = 0; i < 3; i++) {
+      sink = lpf2pApply(&lpf[i], samples[(n + i) & 1023]);
+    }
+  }
+  const double lpf2pTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    for (int i = 0; i < 3; i++) {
+      arm_biquad_cascade_df2T_f32(&cmsis[i], &samples[(n + i) & 1023], &frame[i], 1);
+    }
+    sink = frame[0];
+  }
+  const double cmsisTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (int n = 0; n < SAMPLE_COUNT; n++) {
+    for (int i = 0; i < 3; i++) {
+      frame[i] = samples[(n + i) & 1023];
+    }
+    filterBankApply(&bank, frame);
+    sink = frame[0];
+  }
+  const double bankTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("3-axis low pass, lpf2p: %.1f ns, CMSIS biquad: %.1f ns, filter bank: %.1f ns\n",
+    lpf2pTime * 1e9 / SAMPLE_COUNT, cmsisTime * 1e9 / SAMPLE_COUNT, bankTime * 1e9 / SAMPLE_COUNT);
+  (void)sink;
+
+  return 0;
+}
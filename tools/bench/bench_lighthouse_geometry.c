@@ -0,0 +1,128 @@
+/**
+ * bench_lighthouse_geometry.c - Lighthouse position from sweep angles
+ *
+ * Compares the per sensor ray intersections (averaged) with the least squares
+ * solution on a flight through the space. Prints the time per frame and the
+ * mean position error of both methods.
+ *
+ * The angles are synthetic, computed from an ideal geometry with uniform
+ * noise of LIGHTHOUSE_ANGLE_STD_DEV and no calibration errors, reflections or
+ * dropped sweeps. The errors compare the two methods on the same input, they
+ * are not the accuracy of a real system.
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "lighthouse_geometry.h"
+
+#define SENSOR_COUNT 4
+#define FRAME_COUNT 1000
+#define REPEAT_COUNT 20
+
+// Geometry of a typical system, same as the default in lighthouse.c
+static baseStationGeometry_t geometry[2] = {
+  {.origin = {-0.542299, 3.152727, 1.958483, }, .mat = {{0.999975, -0.007080, -0.000000, }, {0.005645, 0.797195, 0.603696, }, {-0.004274, -0.603681, 0.797215, }, }},
+  {.origin = {2.563488, 3.112367, -1.062398, }, .mat = {{0.034269, -0.647552, 0.761251, }, {-0.012392, 0.761364, 0.648206, }, {-0.999336, -0.031647, 0.018067, }, }},
+};
+
+// Lighthouse deck sensor positions in the lighthouse coordinate system
+static vec3d sensorPositions[SENSOR_COUNT] = {
+  {-0.0075f, 0.0f, 0.015f},
+  {0.0075f, 0.0f, 0.015f},
+  {-0.0075f, 0.0f, -0.015f},
+  {0.0075f, 0.0f, -0.015f},
+};
+
+static float frames[FRAME_COUNT][SENSOR_COUNT][2][2];
+static vec3d truth[FRAME_COUNT];
+static uint32_t randomState = 1234;
+
+static float randomNoise(const float amplitude) {
+  randomState = randomState * 1664525 + 1013904223;
+  return amplitude * ((int32_t)randomState / (float)INT32_MAX);
+}
+
+// Angles as seen by the sensors for a deck at a position, with uniform noise
+static void generateAngles(const vec3d position, const float noise, float angles[SENSOR_COUNT][2][2]) {
+  for (int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+    for (int bs = 0; bs < 2; bs++) {
+      vec3d v;
+      for (int i = 0; i < 3; i++) {
+        v[i] = position[i] + sensorPositions[sensor][i] - geometry[bs].origin[i];
+      }
+
+      // To the base station frame, the inverse of the rotation matrix
+      vec3d local;
+      for (int i = 0; i < 3; i++) {
+        local[i] = geometry[bs].mat[0][i] * v[0] + geometry[bs].mat[1][i] * v[1] + geometry[bs].mat[2][i] * v[2];
+      }
+
+      angles[sensor][bs][0] = atan2f(-local[0], -local[2]) + randomNoise(noise);
+      angles[sensor][bs][1] = atan2f(local[1], -local[2]) + randomNoise(noise);
+    }
+  }
+}
+
+int main() {
+  for (int frame = 0; frame < FRAME_COUNT; frame++) {
+    const float t = frame * 0.01f;
+    truth[frame][0] = 1.0f * sinf(t);
+    truth[frame][1] = 0.2f + 0.8f * frame / FRAME_COUNT;
+    truth[frame][2] = 1.0f * cosf(t);
+    generateAngles(truth[frame], LIGHTHOUSE_ANGLE_STD_DEV, frames[frame]);
+  }
+
+  lighthouseGeometryPrepared_t prepared;
+  lighthouseGeometryPrepare(geometry, &prepared);
+  bool isValid[SENSOR_COUNT];
+  for (int i = 0; i < SENSOR_COUNT; i++) {
+    isValid[i] = true;
+  }
+  float intersectionError = 0.0f;
+  float leastSquaresError = 0.0f;
+
+  clock_t start = clock();
+  for (int r = 0; r < REPEAT_COUNT; r++) {
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+      vec3d sum = {0};
+      for (int sensor = 0; sensor < SENSOR_COUNT; sensor++) {
+        vec3d position;
+        float delta;
+        float sensorAngles[4] = {frames[frame][sensor][0][0], frames[frame][sensor][0][1], frames[frame][sensor][1][0], frames[frame][sensor][1][1]};
+        lighthouseGeometryGetPosition(geometry, sensorAngles, position, &delta);
+        for (int i = 0; i < 3; i++) {
+          sum[i] += position[i] / SENSOR_COUNT;
+        }
+      }
+      if (r == 0) {
+        for (int i = 0; i < 3; i++) {
+          intersectionError += fabsf(sum[i] - truth[frame][i]);
+        }
+      }
+    }
+  }
+  const double intersectionTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start = clock();
+  for (int r = 0; r < REPEAT_COUNT; r++) {
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+      lighthouseSolution_t solution;
+      lighthouseGeometrySolve(&prepared, frames[frame], isValid, sensorPositions, SENSOR_COUNT, &solution);
+      if (r == 0) {
+        for (int i = 0; i < 3; i++) {
+          leastSquaresError += fabsf(solution.position[i] - truth[frame][i]);
+        }
+      }
+    }
+  }
+  const double leastSquaresTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("Lighthouse position (synthetic angles), intersections: %.2f us %.2f mm, least squares: %.2f us %.2f mm\n",
+    intersectionTime * 1e6 / (REPEAT_COUNT * FRAME_COUNT), intersectionError * 1000 / (3 * FRAME_COUNT),
+    leastSquaresTime * 1e6 / (REPEAT_COUNT * FRAME_COUNT), leastSquaresError * 1000 / (3 * FRAME_COUNT));
+
+  return 0;
+}
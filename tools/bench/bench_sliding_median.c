@@ -0,0 +1,69 @@
+/**
+ * bench_sliding_median.c - Sliding median vs sorting the window
+ *
+ * Prints the time per sample for the sliding median and for sorting a copy of
+ * the window, as done in proximity.c before, for a small and a full window.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sliding_median.h"
+
+#define SAMPLE_COUNT 200000
+
+static slidingMedian_t median;
+static uint32_t randomState = 1234;
+
+static uint32_t nextRandom() {
+  randomState = randomState * 1664525 + 1013904223;
+  return randomState >> 8;
+}
+
+// Insertion sort of a copy of the window
+static float sortedMedian(const float* window, const int size) {
+  float sorted[SLIDING_MEDIAN_MAX_SIZE];
+  memcpy(sorted, window, size * sizeof(float));
+
+  for (int n = 1; n < size; n++) {
+    const float value = sorted[n];
+    int m;
+    for (m = n - 1; m >= 0 && value < sorted[m]; m--) {
+      sorted[m + 1] = sorted[m];
+    }
+    sorted[m + 1] = value;
+  }
+
+  return sorted[size / 2];
+}
+
+int main() {
+  const int sizes[] = {9, SLIDING_MEDIAN_MAX_SIZE};
+  for (int s = 0; s < 2; s++) {
+    const int size = sizes[s];
+    float window[SLIDING_MEDIAN_MAX_SIZE] = {0};
+    volatile float sink = 0;
+    slidingMedianInit(&median, size);
+
+    clock_t start = clock();
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+      sink = slidingMedianAdd(&median, (float)(nextRandom() % 1000));
+    }
+    const double slidingTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+      memmove(&window[0], &window[1], (size - 1) * sizeof(float));
+      window[size - 1] = (float)(nextRandom() % 1000);
+      sink = sortedMedian(window, size);
+    }
+    const double sortTime = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("Median of %d samples, sliding: %.1f ns, sorting: %.1f ns\n", size,
+      slidingTime * 1e9 / SAMPLE_COUNT, sortTime * 1e9 / SAMPLE_COUNT);
+    (void)sink;
+  }
+
+  return 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * bench_spectrum.c - Windowed FFT spectrum of one frame
+ *
+ * Prints the time to analyze one frame of SPECTRUM_FFT_SIZE samples, and the
+ * time for the six channels (gyro and accelerometer) that the vibration
+ * analyzer handles every SPECTRUM_HOP_SIZE stabilizer loops.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "spectrum.h"
+
+#define SAMPLE_FREQ 1000.0f
+#define FRAME_COUNT 100000
+#define VIBRATION_CHANNEL_COUNT 6
+
+static const float bandEdges[SPECTRUM_BAND_COUNT + 1] = {0.0f, 50.0f, 150.0f, 300.0f, 500.0f};
+
+static spectrum_t spectrum;
+static float input[SPECTRUM_FFT_SIZE];
+static float frame[SPECTRUM_FFT_SIZE];
+
+int main() {
+  if (!spectrumInit(&spectrum, SAMPLE_FREQ, bandEdges)) {
+    printf("Failed to initialize the FFT\n");
+    return 1;
+  }
+
+  for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+    input[i] = 0.5f + sinf(2.0f * PI * 123.0f * i / SAMPLE_FREQ);
+  }
+
+  spectrumResult_t result;
+  volatile float sink = 0.0f;
+
+  clock_t start = clock();
+  for (int i = 0; i < FRAME_COUNT; i++) {
+    // spectrumAnalyze() uses the frame as work area
+    memcpy(frame, input, sizeof(frame));
+    spectrumAnalyze(&spectrum, frame, &result);
+    sink += result.peakFreq;
+  }
+  const double time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  const double frameTime = time * 1e6 / FRAME_COUNT;
+  printf("Spectrum of %d samples: %.1f us, %d channels: %.1f us every %d samples\n",
+    SPECTRUM_FFT_SIZE, frameTime, VIBRATION_CHANNEL_COUNT, frameTime * VIBRATION_CHANNEL_COUNT, SPECTRUM_HOP_SIZE);
+  (void)sink;
+
+  return 0;
+}
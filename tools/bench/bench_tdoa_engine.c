@@ -0,0 +1,162 @@
+/**
+ * bench_tdoa_engine.c - TDoA engine packet processing for a growing number of anchors
+ *
+ * Prints the time per received packet for the work done in the TDoA3 rx
+ * callback: the anchor context lookup, storing the remote anchor data and
+ * times of flight, tdoaEngineProcessPacket() (clock correction, candidate
+ * selection and TDoA) and storing the rx/tx data. The packets are generated
+ * outside of the timed part from a simulated anchor system where the tag
+ * hears all anchors. The storage is built with room for 64 anchors (see the
+ * Makefile). The time grows with the remote anchor data in the packets, up to
+ * REMOTE_ANCHOR_DATA_COUNT entries at 17 anchors, and should be roughly
+ * constant from there to 64 anchors.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "tdoaEngine.h"
+#include "physicalConstants.h"
+
+#define LOCODECK_TS_FREQ (499.2e6 * 128)
+#define MASK 0xFFFFFFFFFF // 40 bits
+#define SLOT_TIME 0.001
+#define BATCH_SIZE 256
+#define BATCH_COUNT 400
+
+typedef struct {
+  point_t position;
+  double clockRate;
+  double clockOffset; // s
+  uint8_t seqNr;
+  double latestTxTime; // s, global time
+} anchor_t;
+
+typedef struct {
+  uint8_t id;
+  uint8_t seqNr;
+  int64_t rxTime;
+  int64_t tof;
+} remoteData_t;
+
+typedef struct {
+  uint8_t anchorId;
+  uint8_t seqNr;
+  uint32_t now_ms;
+  int64_t txAn_in_cl_An;
+  int64_t rxAn_by_T_in_cl_T;
+  int remoteCount;
+  remoteData_t remoteData[REMOTE_ANCHOR_DATA_COUNT];
+} packet_t;
+
+static tdoaEngineState_t engineState;
+static anchor_t anchors[ANCHOR_STORAGE_COUNT];
+static packet_t packets[BATCH_SIZE];
+static const point_t tagPosition = {.x = 5.3f, .y = 7.1f, .z = 1.2f};
+static int measurementCount;
+
+static void sendTdoaToEstimator(tdoaMeasurement_t* tdoaMeasurement) {
+  (void)tdoaMeasurement;
+  measurementCount++;
+}
+
+static double distance(const point_t* a, const point_t* b) {
+  const double dx = a->x - b->x;
+  const double dy = a->y - b->y;
+  const double dz = a->z - b->z;
+  return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static int64_t toTicks(const double time, const double clockRate, const double clockOffset) {
+  return (int64_t)llround((time * clockRate + clockOffset) * LOCODECK_TS_FREQ) & MASK;
+}
+
+// Anchors on a 4 m grid, 8 per row, alternating between floor and ceiling
+static void setUpAnchors(const int anchorCount) {
+  for (int i = 0; i < anchorCount; i++) {
+    anchors[i] = (anchor_t){
+      .position = {.x = 4.0f * (i % 8), .y = 4.0f * (i / 8), .z = (i % 2) ? 2.8f : 0.2f},
+      .clockRate = 1.0 + 1e-6 * ((i * 37) % 17 - 8),
+      .clockOffset = 0.3 * i,
+    };
+  }
+}
+
+// The remote data is the latest packets from the anchors that transmitted
+// just before, in the round robin schedule
+static void generatePacket(packet_t* packet, const int anchorCount, const int anchorIndex, const double txTime) {
+  anchor_t* anchor = &anchors[anchorIndex];
+  anchor->seqNr = (anchor->seqNr + 1) & 0x7f;
+
+  packet->anchorId = anchorIndex;
+  packet->seqNr = anchor->seqNr;
+  packet->now_ms = (uint32_t)(txTime * 1000);
+
+  packet->remoteCount = 0;
+  for (int i = 1; i < anchorCount && packet->remoteCount < REMOTE_ANCHOR_DATA_COUNT; i++) {
+    const anchor_t* remote = &anchors[(anchorIndex + anchorCount - i) % anchorCount];
+    if (remote->latestTxTime > 0.0) {
+      const double flightTime = distance(&remote->position, &anchor->position) / SPEED_OF_LIGHT;
+      remoteData_t* data = &packet->remoteData[packet->remoteCount++];
+      data->id = remote - anchors;
+      data->seqNr = remote->seqNr;
+      data->rxTime = toTicks(remote->latestTxTime + flightTime, anchor->clockRate, anchor->clockOffset);
+      data->tof = llround(flightTime * anchor->clockRate * LOCODECK_TS_FREQ);
+    }
+  }
+
+  const double flightTime = distance(&anchor->position, &tagPosition) / SPEED_OF_LIGHT;
+  packet->txAn_in_cl_An = toTicks(txTime, anchor->clockRate, anchor->clockOffset);
+  packet->rxAn_by_T_in_cl_T = toTicks(txTime + flightTime, 1.0, 0.0);
+
+  anchor->latestTxTime = txTime;
+}
+
+// Same steps as rxcallback() in lpsTdoa3Tag.c
+static void processPacket(const packet_t* packet) {
+  tdoaAnchorContext_t anchorCtx;
+  tdoaEngineGetAnchorCtxForPacketProcessing(&engineState, packet->anchorId, packet->now_ms, &anchorCtx);
+
+  for (int i = 0; i < packet->remoteCount; i++) {
+    const remoteData_t* data = &packet->remoteData[i];
+    tdoaStorageSetRemoteRxTime(&anchorCtx, data->id, data->rxTime, data->seqNr);
+    tdoaStorageSetTimeOfFlight(&anchorCtx, data->id, data->tof);
+  }
+
+  tdoaEngineProcessPacket(&engineState, &anchorCtx, packet->txAn_in_cl_An, packet->rxAn_by_T_in_cl_T);
+  tdoaStorageSetRxTxData(&anchorCtx, packet->rxAn_by_T_in_cl_T, packet->txAn_in_cl_An, packet->seqNr);
+
+  const anchor_t* anchor = &anchors[packet->anchorId];
+  tdoaStorageSetAnchorPosition(&anchorCtx, anchor->position.x, anchor->position.y, anchor->position.z);
+}
+
+int main() {
+  for (int anchorCount = 4; anchorCount <= ANCHOR_STORAGE_COUNT; anchorCount *= 2) {
+    setUpAnchors(anchorCount);
+    tdoaEngineInit(&engineState, 0, sendTdoaToEstimator, LOCODECK_TS_FREQ);
+    measurementCount = 0;
+
+    double txTime = 0.1;
+    int anchorIndex = 0;
+    clock_t processingTime = 0;
+    for (int batch = 0; batch < BATCH_COUNT; batch++) {
+      for (int i = 0; i < BATCH_SIZE; i++) {
+        generatePacket(&packets[i], anchorCount, anchorIndex, txTime);
+        anchorIndex = (anchorIndex + 1) % anchorCount;
+        txTime += SLOT_TIME;
+      }
+
+      clock_t start = clock();
+      for (int i = 0; i < BATCH_SIZE; i++) {
+        processPacket(&packets[i]);
+      }
+      processingTime += clock() - start;
+    }
+
+    const int packetCount = BATCH_SIZE * BATCH_COUNT;
+    const double time = (double)processingTime / CLOCKS_PER_SEC;
+    printf("Packet processing, %d anchors: %.1f ns (%.0f%% to the estimator)\n", anchorCount, time * 1e9 / packetCount, 100.0 * measurementCount / packetCount);
+  }
+
+  return 0;
+}
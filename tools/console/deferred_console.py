@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+# Console for firmware built with DEBUG_PRINT_DEFERRED=1.
+#
+# DEBUG_PRINT() calls are sent as binary records on channel 1 of the console
+# port, containing the id of the format string and the raw arguments (see
+# src/utils/interface/deferred_print.h). The format strings are read from the
+# .deferred_fmt section of the ELF file the firmware was built from, it must
+# be the same build as the one running on the Crazyflie. Plain text console
+# output on channel 0 is printed as it is.
+#
+# Usage: deferred_console.py <cf2.elf> <uri>
+#
+# Requires pyelftools and cflib
+
+import re
+import struct
+import sys
+import time
+
+DEFERRED_CHANNEL = 1
+TEXT_CHANNEL = 0
+
+HEADER = struct.Struct('<BH')
+
+# eprintf conversions: flags, width, precision, length and conversion
+CONVERSION = re.compile(r'%(0?)(\d*)(?:\.(\d))?(l{0,2})([diuxXfsc%])')
+
+
+def read_format_strings(elf_file):
+    from elftools.elf.elffile import ELFFile
+
+    with open(elf_file, 'rb') as f:
+        section = ELFFile(f).get_section_by_name('.deferred_fmt')
+        if section is None:
+            raise RuntimeError('No .deferred_fmt section in {}, was the '
+                               'firmware built with DEBUG_PRINT_DEFERRED=1?'
+                               .format(elf_file))
+        return section.data()
+
+
+def format_string(format_strings, format_id):
+    end = format_strings.find(b'\0', format_id)
+    return format_strings[format_id:end].decode('ascii', errors='replace')
+
+
+def decode_record(format_strings, record):
+    """Returns the text for one record"""
+    _, format_id = HEADER.unpack_from(record)
+    if format_id >= len(format_strings):
+        return '<unknown format {}>\n'.format(format_id)
+    fmt = format_string(format_strings, format_id)
+
+    offset = HEADER.size
+    result = ''
+    pos = 0
+    for m in CONVERSION.finditer(fmt):
+        result += fmt[pos:m.start()]
+        pos = m.end()
+        pad, width, precision, length, conversion = m.groups()
+
+        if conversion == '%':
+            result += '%'
+            continue
+
+        spec = '%' + pad + width
+        try:
+            if conversion == 's':
+                size = record[offset]
+                value = bytes(record[offset + 1:offset + 1 + size]).decode(
+                    'ascii', errors='replace')
+                offset += 1 + size
+            elif conversion == 'f':
+                value, = struct.unpack_from('<f', record, offset)
+                offset += 4
+                spec += '.' + (precision or '6')
+            elif length == 'll':
+                signed = conversion in 'di'
+                value, = struct.unpack_from('<q' if signed else '<Q',
+                                            record, offset)
+                offset += 8
+            else:
+                signed = conversion in 'di'
+                value, = struct.unpack_from('<i' if signed else '<I',
+                                            record, offset)
+                offset += 4
+                if conversion == 'c':
+                    value = chr(value & 0xff)
+        except (IndexError, struct.error):
+            # The argument did not fit in the record
+            result += '?'
+            continue
+
+        result += (spec + {'i': 'd', 'u': 'd'}.get(conversion, conversion)) \
+            % value
+
+    return result + fmt[pos:]
+
+
+def decode_packet(format_strings, data):
+    """Returns the text for all records in a packet"""
+    text = ''
+    offset = 0
+    while offset < len(data):
+        size = data[offset]
+        if size < HEADER.size:
+            break
+        text += decode_record(format_strings, data[offset:offset + size])
+        offset += size
+    return text
+
+
+def main():
+    if len(sys.argv) != 3:
+        print('Usage: {} <cf2.elf> <uri>'.format(sys.argv[0]))
+        sys.exit(1)
+
+    import cflib.crtp
+    from cflib.crazyflie import Crazyflie
+    from cflib.crazyflie.syncCrazyflie import SyncCrazyflie
+    from cflib.crtp.crtpstack import CRTPPort
+
+    format_strings = read_format_strings(sys.argv[1])
+
+    def packet_received(pk):
+        if pk.channel == DEFERRED_CHANNEL:
+            text = decode_packet(format_strings, bytes(pk.data))
+        elif pk.channel == TEXT_CHANNEL:
+            text = bytes(pk.data).decode('ascii', errors='replace')
+        else:
+            return
+        sys.stdout.write(text)
+        sys.stdout.flush()
+
+    cflib.crtp.init_drivers(enable_debug_driver=False)
+    with SyncCrazyflie(sys.argv[2], cf=Crazyflie(rw_cache='./cache')) as scf:
+        scf.cf.add_port_callback(CRTPPort.CONSOLE, packet_received)
+        try:
+            while True:
+                time.sleep(1)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == '__main__':
+    main()
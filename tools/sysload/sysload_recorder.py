@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+# Records the task and queue profile stream from the Crazyflie system load
+# monitor (src/modules/src/sysload.c) to a CSV file.
+#
+# The stream is sent on channel 2 of the platform port once per second when
+# the sysload.stream parameter is set.
+#
+# Usage: sysload_recorder.py <uri> <output.csv>
+#
+# CSV columns: time, kind (task/queue), number, name, and
+#   task:  load [%], stack left [words], context switches/s
+#   queue: peak depth, sends, failed sends (per period)
+
+import csv
+import struct
+import sys
+import time
+
+import cflib.crtp
+from cflib.crazyflie import Crazyflie
+from cflib.crazyflie.syncCrazyflie import SyncCrazyflie
+from cflib.crtp.crtpstack import CRTPPacket, CRTPPort
+
+SYSLOAD_CHANNEL = 2
+
+TASK_RECORDS = 0
+QUEUE_RECORDS = 1
+TASK_NAME = 2
+QUEUE_NAME = 3
+
+CMD_GET_TASK_NAMES = 0
+CMD_GET_QUEUE_NAMES = 1
+
+TASK_RECORD = struct.Struct('<BHHH')
+QUEUE_RECORD = struct.Struct('<BBII')
+
+
+class SysLoadRecorder:
+    def __init__(self, cf, writer):
+        self._cf = cf
+        self._writer = writer
+        self._task_names = {}
+        self._queue_names = {}
+        self._queue_totals = {}
+        self._names_requested = False
+
+    def request_names(self):
+        for cmd in (CMD_GET_TASK_NAMES, CMD_GET_QUEUE_NAMES):
+            pk = CRTPPacket()
+            pk.set_header(CRTPPort.PLATFORM, SYSLOAD_CHANNEL)
+            pk.data = (cmd,)
+            self._cf.send_packet(pk)
+
+    def packet_received(self, pk):
+        if pk.channel != SYSLOAD_CHANNEL or len(pk.data) < 2:
+            return
+
+        kind = pk.data[0]
+        now = time.time()
+
+        if kind == TASK_NAME:
+            self._task_names[pk.data[1]] = bytes(pk.data[2:]).decode('ascii')
+        elif kind == QUEUE_NAME:
+            self._queue_names[pk.data[1]] = bytes(pk.data[2:]).decode('ascii')
+        elif kind == TASK_RECORDS:
+            for offset in range(2, len(pk.data), TASK_RECORD.size):
+                number, load, stack, switches = TASK_RECORD.unpack_from(
+                    pk.data, offset)
+                self._check_name(self._task_names, number)
+                self._writer.writerow(
+                    [now, 'task', number, self._task_names.get(number, ''),
+                     load / 10.0, stack, switches])
+        elif kind == QUEUE_RECORDS:
+            for offset in range(2, len(pk.data), QUEUE_RECORD.size):
+                number, peak, sent, full = QUEUE_RECORD.unpack_from(
+                    pk.data, offset)
+                self._check_name(self._queue_names, number)
+                prev_sent, prev_full = self._queue_totals.get(number,
+                                                              (sent, full))
+                self._queue_totals[number] = (sent, full)
+                self._writer.writerow(
+                    [now, 'queue', number, self._queue_names.get(number, ''),
+                     peak, sent - prev_sent, full - prev_full])
+
+    def _check_name(self, names, number):
+        # Tasks may be created after the first request, ask again once
+        if number not in names and not self._names_requested:
+            self._names_requested = True
+            self.request_names()
+
+
+def main():
+    if len(sys.argv) != 3:
+        print('Usage: {} <uri> <output.csv>'.format(sys.argv[0]))
+        sys.exit(1)
+
+    uri = sys.argv[1]
+    cflib.crtp.init_drivers(enable_debug_driver=False)
+
+    with open(sys.argv[2], 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['time', 'kind', 'number', 'name', 'a', 'b', 'c'])
+
+        with SyncCrazyflie(uri, cf=Crazyflie(rw_cache='./cache')) as scf:
+            cf = scf.cf
+            recorder = SysLoadRecorder(cf, writer)
+            cf.add_port_callback(CRTPPort.PLATFORM, recorder.packet_received)
+
+            recorder.request_names()
+            cf.param.set_value('sysload.stream', '1')
+            print('Recording, press Ctrl-C to stop')
+            try:
+                while True:
+                    time.sleep(1)
+            except KeyboardInterrupt:
+                pass
+            cf.param.set_value('sysload.stream', '0')
+
+
+if __name__ == '__main__':
+    main()
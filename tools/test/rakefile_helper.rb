@@ -10,7 +10,7 @@ module RakefileHelpers
 
   def load_configuration(config_file)
     $cfg_file = config_file
-    $cfg = YAML.load(File.read($cfg_file))
+    $cfg = YAML.load(File.read($cfg_file), aliases: true)
     $colour_output = false unless $cfg['colour']
   end
 
@@ -66,7 +66,7 @@ module RakefileHelpers
   def find_file(name, paths)
     paths.each do |dir|
       src_file = dir + name
-      if (File.exists?(src_file))
+      if (File.exist?(src_file))
         return src_file
       end
     end
@@ -0,0 +1,489 @@
+/**
+ * usdlog.c - Host side decoder for uSD-card deck binary logs
+ *
+ * See usdlog.h for the file format.
+ */
+#define _DEFAULT_SOURCE
+#include "usdlog.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CRC_RESIDUE 0xffffffff
+#define MAX_THREADS 64
+
+/* CRC32 (zlib polynomial), slice-by-8 */
+
+static uint32_t crcTable[8][256];
+static pthread_once_t crcTableOnce = PTHREAD_ONCE_INIT;
+
+static void crcTableInit(void) {
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t c = i;
+    for (int k = 0; k < 8; k++) {
+      c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+    }
+    crcTable[0][i] = c;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    for (int t = 1; t < 8; t++) {
+      crcTable[t][i] = (crcTable[t - 1][i] >> 8) ^ crcTable[0][crcTable[t - 1][i] & 0xff];
+    }
+  }
+}
+
+uint32_t usdlogCrc32(uint32_t crc, const uint8_t* data, size_t len) {
+  pthread_once(&crcTableOnce, crcTableInit);
+
+  crc = ~crc;
+  while (len >= 8) {
+    uint32_t lo = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+    uint32_t hi = (uint32_t)data[4] | (uint32_t)data[5] << 8 | (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+    crc = crcTable[7][lo & 0xff] ^ crcTable[6][(lo >> 8) & 0xff] ^
+          crcTable[5][(lo >> 16) & 0xff] ^ crcTable[4][lo >> 24] ^
+          crcTable[3][hi & 0xff] ^ crcTable[2][(hi >> 8) & 0xff] ^
+          crcTable[1][(hi >> 16) & 0xff] ^ crcTable[0][hi >> 24];
+    data += 8;
+    len -= 8;
+  }
+  while (len--) {
+    crc = crcTable[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+/* Worker threads, each one processing a contiguous range of blocks */
+
+typedef void (*blockWorker_t)(const usdlog_t* log, size_t firstBlock, size_t endBlock, void* arg);
+
+typedef struct {
+  const usdlog_t* log;
+  size_t firstBlock;
+  size_t endBlock;
+  blockWorker_t worker;
+  void* arg;
+} workerArgs_t;
+
+static void* workerEntry(void* p) {
+  workerArgs_t* args = p;
+  args->worker(args->log, args->firstBlock, args->endBlock, args->arg);
+  return NULL;
+}
+
+static int resolveThreads(int nThreads) {
+  if (nThreads <= 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nThreads = (cpus > 0) ? (int)cpus : 1;
+  }
+  return (nThreads > MAX_THREADS) ? MAX_THREADS : nThreads;
+}
+
+static void runOnBlocks(const usdlog_t* log, int nThreads, blockWorker_t worker, void* arg) {
+  nThreads = resolveThreads(nThreads);
+  if ((size_t)nThreads > log->nBlocks) {
+    nThreads = log->nBlocks ? (int)log->nBlocks : 1;
+  }
+
+  pthread_t threads[MAX_THREADS];
+  workerArgs_t args[MAX_THREADS];
+  size_t perThread = (log->nBlocks + nThreads - 1) / nThreads;
+
+  int started = 0;
+  for (int i = 0; i < nThreads; i++) {
+    size_t first = i * perThread;
+    size_t end = first + perThread;
+    if (end > log->nBlocks) {
+      end = log->nBlocks;
+    }
+    args[i] = (workerArgs_t){ log, first, end, worker, arg };
+
+    // The last range is run on the calling thread
+    if (i == nThreads - 1 || pthread_create(&threads[i], NULL, workerEntry, &args[i]) != 0) {
+      worker(log, first, end, arg);
+      if (i != nThreads - 1) {
+        // Thread creation failed, run the remaining ranges here as well
+        worker(log, end, log->nBlocks, arg);
+      }
+      break;
+    }
+    started++;
+  }
+
+  for (int i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+}
+
+/* Header and index */
+
+static uint8_t typeSize(char type) {
+  switch (type) {
+    case 'B': case 'b': return 1;
+    case 'H': case 'h': return 2;
+    case 'I': case 'i': case 'f': return 4;
+    default: return 0;
+  }
+}
+
+static int parseHeader(usdlog_t* log, size_t* headerEnd) {
+  const uint8_t* d = log->data;
+  if (log->size < 1) {
+    return USDLOG_ERR_FORMAT;
+  }
+
+  int width = d[0];
+  if (width > USDLOG_MAX_VARS) {
+    return USDLOG_ERR_FORMAT;
+  }
+
+  size_t idx = 1;
+  size_t offset = 0;
+  for (int i = 0; i < width; i++) {
+    size_t start = idx;
+    while (idx < log->size && d[idx] != ',') {
+      idx++;
+    }
+    if (idx >= log->size) {
+      return USDLOG_ERR_FORMAT;
+    }
+
+    // Entries look like "group.name(T)"
+    size_t len = idx - start;
+    if (len < 4 || d[idx - 1] != ')' || d[idx - 3] != '(' || len - 3 >= USDLOG_MAX_NAME_LEN) {
+      return USDLOG_ERR_FORMAT;
+    }
+
+    usdlogVar_t* var = &log->vars[i];
+    memcpy(var->name, &d[start], len - 3);
+    var->name[len - 3] = '\0';
+    var->type = d[idx - 2];
+    var->size = typeSize(var->type);
+    var->offset = offset;
+    if (var->size == 0) {
+      return USDLOG_ERR_FORMAT;
+    }
+    offset += var->size;
+    idx++;
+  }
+
+  if (idx + 4 > log->size) {
+    return USDLOG_ERR_FORMAT;
+  }
+
+  log->nVars = width;
+  log->setBytes = offset;
+  log->headerCrcOk = usdlogCrc32(0, d, idx + 4) == CRC_RESIDUE;
+  *headerEnd = idx + 4;
+  return USDLOG_OK;
+}
+
+static int buildIndex(usdlog_t* log, size_t offset) {
+  // Block boundaries are only known by following the count bytes, but that
+  // is a cheap hop per block. The CRC validation is done in parallel later.
+  size_t capacity = 1024;
+  log->blocks = malloc(capacity * sizeof(usdlogBlock_t));
+  if (!log->blocks) {
+    return USDLOG_ERR_MEMORY;
+  }
+
+  size_t sample = 0;
+  while (offset < log->size) {
+    uint8_t count = log->data[offset];
+    size_t blockSize = 1 + count * log->setBytes + 4;
+    if (offset + blockSize > log->size) {
+      log->truncated = true;
+      break;
+    }
+
+    if (log->nBlocks == capacity) {
+      capacity *= 2;
+      usdlogBlock_t* blocks = realloc(log->blocks, capacity * sizeof(usdlogBlock_t));
+      if (!blocks) {
+        return USDLOG_ERR_MEMORY;
+      }
+      log->blocks = blocks;
+    }
+
+    usdlogBlock_t* block = &log->blocks[log->nBlocks++];
+    block->offset = offset + 1;
+    block->firstSample = sample;
+    block->count = count;
+    block->crcOk = false;
+
+    sample += count;
+    offset += blockSize;
+  }
+
+  log->nSamples = sample;
+  return USDLOG_OK;
+}
+
+static void validateWorker(const usdlog_t* log, size_t firstBlock, size_t endBlock, void* arg) {
+  size_t* errors = arg;
+  size_t localErrors = 0;
+  usdlogBlock_t* blocks = (usdlogBlock_t*)log->blocks;
+
+  for (size_t i = firstBlock; i < endBlock; i++) {
+    usdlogBlock_t* block = &blocks[i];
+    size_t len = 1 + block->count * log->setBytes + 4;
+    block->crcOk = usdlogCrc32(0, &log->data[block->offset - 1], len) == CRC_RESIDUE;
+    if (!block->crcOk) {
+      localErrors++;
+    }
+  }
+
+  __atomic_add_fetch(errors, localErrors, __ATOMIC_RELAXED);
+}
+
+int usdlogOpen(usdlog_t* log, const char* path, int nThreads) {
+  memset(log, 0, sizeof(*log));
+  log->fd = open(path, O_RDONLY);
+  if (log->fd < 0) {
+    return USDLOG_ERR_IO;
+  }
+
+  struct stat st;
+  if (fstat(log->fd, &st) != 0 || st.st_size == 0) {
+    close(log->fd);
+    return USDLOG_ERR_IO;
+  }
+
+  log->size = st.st_size;
+  void* data = mmap(NULL, log->size, PROT_READ, MAP_PRIVATE, log->fd, 0);
+  if (data == MAP_FAILED) {
+    close(log->fd);
+    return USDLOG_ERR_IO;
+  }
+  log->data = data;
+  madvise(data, log->size, MADV_SEQUENTIAL);
+
+  size_t headerEnd;
+  int result = parseHeader(log, &headerEnd);
+  if (result == USDLOG_OK) {
+    result = buildIndex(log, headerEnd);
+  }
+  if (result != USDLOG_OK) {
+    usdlogClose(log);
+    return result;
+  }
+
+  runOnBlocks(log, nThreads, validateWorker, &log->crcErrors);
+  return USDLOG_OK;
+}
+
+void usdlogClose(usdlog_t* log) {
+  if (log->data) {
+    munmap((void*)log->data, log->size);
+    close(log->fd);
+  }
+  free(log->blocks);
+  memset(log, 0, sizeof(*log));
+}
+
+int usdlogFindVar(const usdlog_t* log, const char* name) {
+  for (int i = 0; i < log->nVars; i++) {
+    if (strcmp(log->vars[i].name, name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Sample access */
+
+static size_t findBlock(const usdlog_t* log, size_t sample) {
+  size_t lo = 0;
+  size_t hi = log->nBlocks;
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (log->blocks[mid].firstSample <= sample) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static const uint8_t* samplePtr(const usdlog_t* log, size_t block, size_t sample) {
+  const usdlogBlock_t* b = &log->blocks[block];
+  return &log->data[b->offset + (sample - b->firstSample) * log->setBytes];
+}
+
+uint32_t usdlogTick(const usdlog_t* log, size_t sample) {
+  uint32_t tick;
+  memcpy(&tick, samplePtr(log, findBlock(log, sample), sample), sizeof(tick));
+  return tick;
+}
+
+bool usdlogSampleValid(const usdlog_t* log, size_t sample) {
+  return log->blocks[findBlock(log, sample)].crcOk;
+}
+
+size_t usdlogFindTick(const usdlog_t* log, uint32_t tick) {
+  size_t lo = 0;
+  size_t hi = log->nSamples;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (usdlogTick(log, mid) < tick) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+typedef struct {
+  const usdlogVar_t* var;
+  uint8_t* out;
+} decodeArgs_t;
+
+static void decodeWorker(const usdlog_t* log, size_t firstBlock, size_t endBlock, void* arg) {
+  decodeArgs_t* args = arg;
+  const size_t size = args->var->size;
+  const size_t stride = log->setBytes;
+
+  for (size_t i = firstBlock; i < endBlock; i++) {
+    const usdlogBlock_t* block = &log->blocks[i];
+    const uint8_t* src = &log->data[block->offset + args->var->offset];
+    uint8_t* dst = &args->out[block->firstSample * size];
+    for (int n = 0; n < block->count; n++) {
+      memcpy(dst, src, size);
+      dst += size;
+      src += stride;
+    }
+  }
+}
+
+int usdlogDecodeVar(const usdlog_t* log, int var, void* out, int nThreads) {
+  if (var < 0 || var >= log->nVars) {
+    return USDLOG_ERR_ARG;
+  }
+
+  decodeArgs_t args = { &log->vars[var], out };
+  runOnBlocks(log, nThreads, decodeWorker, &args);
+  return USDLOG_OK;
+}
+
+static double toDouble(char type, const uint8_t* p) {
+  switch (type) {
+    case 'B': return *p;
+    case 'b': return (int8_t)*p;
+    case 'H': { uint16_t v; memcpy(&v, p, 2); return v; }
+    case 'h': { int16_t v; memcpy(&v, p, 2); return v; }
+    case 'I': { uint32_t v; memcpy(&v, p, 4); return v; }
+    case 'i': { int32_t v; memcpy(&v, p, 4); return v; }
+    case 'f': { float v; memcpy(&v, p, 4); return v; }
+    default: return 0.0;
+  }
+}
+
+int usdlogDecodeVarDouble(const usdlog_t* log, int var, size_t first, size_t count, double* out) {
+  if (var < 0 || var >= log->nVars || first + count > log->nSamples) {
+    return USDLOG_ERR_ARG;
+  }
+
+  const usdlogVar_t* v = &log->vars[var];
+  size_t block = count ? findBlock(log, first) : 0;
+  for (size_t i = 0; i < count; i++) {
+    size_t sample = first + i;
+    const usdlogBlock_t* b = &log->blocks[block];
+    if (sample >= b->firstSample + b->count) {
+      // Skip to the block holding the sample, empty blocks included
+      do {
+        block++;
+        b = &log->blocks[block];
+      } while (sample >= b->firstSample + b->count);
+    }
+    out[i] = toDouble(v->type, samplePtr(log, block, sample) + v->offset);
+  }
+  return USDLOG_OK;
+}
+
+/* Numpy output */
+
+static const char* npyDescr(char type) {
+  switch (type) {
+    case 'B': return "|u1";
+    case 'b': return "|i1";
+    case 'H': return "<u2";
+    case 'h': return "<i2";
+    case 'I': return "<u4";
+    case 'i': return "<i4";
+    case 'f': return "<f4";
+    default: return NULL;
+  }
+}
+
+static int writeNpy(const char* path, const char* descr, const void* data, size_t count, size_t itemSize) {
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    return USDLOG_ERR_IO;
+  }
+
+  // Version 1.0 header, padded so that the data starts 64 byte aligned
+  char header[128];
+  int len = snprintf(header, sizeof(header),
+    "{'descr': '%s', 'fortran_order': False, 'shape': (%zu,), }", descr, count);
+  int total = 10 + len + 1;
+  int padding = (64 - total % 64) % 64;
+  memset(&header[len], ' ', padding);
+  header[len + padding] = '\n';
+  uint16_t headerLen = len + padding + 1;
+
+  static const uint8_t magic[] = { 0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0 };
+  bool ok = fwrite(magic, sizeof(magic), 1, f) == 1 &&
+            fwrite(&headerLen, sizeof(headerLen), 1, f) == 1 &&
+            fwrite(header, headerLen, 1, f) == 1 &&
+            (count == 0 || fwrite(data, itemSize, count, f) == count);
+  ok = (fclose(f) == 0) && ok;
+  return ok ? USDLOG_OK : USDLOG_ERR_IO;
+}
+
+static void sanitizeName(char* dst, const char* src, size_t len) {
+  size_t i = 0;
+  for (; src[i] && i < len - 1; i++) {
+    char c = src[i];
+    dst[i] = (c == '/' || c == '\\') ? '_' : c;
+  }
+  dst[i] = '\0';
+}
+
+int usdlogWriteNpy(const usdlog_t* log, const char* dir, int nThreads) {
+  uint8_t* buffer = malloc(log->nSamples ? log->nSamples * 4 : 1);
+  if (!buffer) {
+    return USDLOG_ERR_MEMORY;
+  }
+
+  char path[4096];
+  char name[USDLOG_MAX_NAME_LEN];
+  int result = USDLOG_OK;
+
+  for (int i = 0; i < log->nVars && result == USDLOG_OK; i++) {
+    const usdlogVar_t* var = &log->vars[i];
+    usdlogDecodeVar(log, i, buffer, nThreads);
+    sanitizeName(name, var->name, sizeof(name));
+    snprintf(path, sizeof(path), "%s/%s.npy", dir, name);
+    result = writeNpy(path, npyDescr(var->type), buffer, log->nSamples, var->size);
+  }
+
+  if (result == USDLOG_OK) {
+    for (size_t b = 0; b < log->nBlocks; b++) {
+      const usdlogBlock_t* block = &log->blocks[b];
+      memset(&buffer[block->firstSample], block->crcOk ? 1 : 0, block->count);
+    }
+    snprintf(path, sizeof(path), "%s/valid.npy", dir);
+    result = writeNpy(path, "|u1", buffer, log->nSamples, 1);
+  }
+
+  free(buffer);
+  return result;
+}
@@ -0,0 +1,105 @@
+/**
+ * usdlog.h - Host side decoder for uSD-card deck binary logs
+ *
+ * The log file written by usddeck.c consists of a header and a sequence of
+ * blocks:
+ *
+ *   header: [width:1] ["name(T)," * width] [crc:4]
+ *   block:  [count:1] [count * set] [crc:4]
+ *
+ * where a set is the packed values of all variables, the first one always
+ * being the 32 bit tick. The CRC32 over a header/block including the stored
+ * CRC equals 0xffffffff.
+ *
+ * The file is memory mapped and indexed once (block offsets, first sample
+ * number and CRC state per block), after which each variable can be decoded
+ * into a contiguous array and samples can be looked up by tick.
+ */
+#ifndef __USDLOG_H__
+#define __USDLOG_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define USDLOG_MAX_VARS 256
+#define USDLOG_MAX_NAME_LEN 64
+
+typedef struct {
+  char name[USDLOG_MAX_NAME_LEN];
+  char type;          // struct module format character: B b H h I i f
+  uint8_t size;       // Bytes
+  uint16_t offset;    // Byte offset within a set
+} usdlogVar_t;
+
+typedef struct {
+  size_t offset;      // File offset of the first set in the block
+  size_t firstSample;
+  uint8_t count;
+  bool crcOk;
+} usdlogBlock_t;
+
+typedef struct {
+  const uint8_t* data;
+  size_t size;
+  int fd;
+
+  int nVars;
+  usdlogVar_t vars[USDLOG_MAX_VARS];
+  size_t setBytes;
+  bool headerCrcOk;
+
+  size_t nBlocks;
+  usdlogBlock_t* blocks;
+  size_t nSamples;
+  size_t crcErrors;
+  bool truncated;     // The last block is incomplete and has been ignored
+} usdlog_t;
+
+enum {
+  USDLOG_OK = 0,
+  USDLOG_ERR_IO = -1,
+  USDLOG_ERR_FORMAT = -2,
+  USDLOG_ERR_MEMORY = -3,
+  USDLOG_ERR_ARG = -4,
+};
+
+/**
+ * Map a log file, parse the header and index all blocks. CRCs are validated
+ * using nThreads worker threads (0 selects the number of online CPUs).
+ */
+int usdlogOpen(usdlog_t* log, const char* path, int nThreads);
+void usdlogClose(usdlog_t* log);
+
+int usdlogFindVar(const usdlog_t* log, const char* name);
+
+/**
+ * Decode one variable into out, which must hold log->nSamples values of
+ * vars[var].size bytes each (native type). Samples in blocks with a bad CRC
+ * are decoded anyway, use usdlogSampleValid() to filter them.
+ */
+int usdlogDecodeVar(const usdlog_t* log, int var, void* out, int nThreads);
+
+/**
+ * Decode a range of samples of one variable, converted to double.
+ */
+int usdlogDecodeVarDouble(const usdlog_t* log, int var, size_t first, size_t count, double* out);
+
+uint32_t usdlogTick(const usdlog_t* log, size_t sample);
+bool usdlogSampleValid(const usdlog_t* log, size_t sample);
+
+/**
+ * Index of the first sample with tick >= the given tick, nSamples if none.
+ * Ticks are assumed to be non decreasing.
+ */
+size_t usdlogFindTick(const usdlog_t* log, uint32_t tick);
+
+/**
+ * Write one <dir>/<name>.npy file per variable plus valid.npy (uint8 per
+ * sample, 0 for samples in blocks with CRC errors).
+ */
+int usdlogWriteNpy(const usdlog_t* log, const char* dir, int nThreads);
+
+uint32_t usdlogCrc32(uint32_t crc, const uint8_t* data, size_t len);
+
+#endif // __USDLOG_H__
@@ -0,0 +1,363 @@
+/**
+ * usdlog_cli.c - Command line front end for the uSD log decoder
+ *
+ * usdlog [-j threads] info <log>
+ * usdlog [-j threads] npy <log> <outdir>
+ * usdlog [-j threads] at <log> <tick>
+ * usdlog [-j threads] replay <log> <out.csv>
+ * usdlog gen <log> <megabytes>
+ * usdlog [-j threads] bench <log>
+ */
+#define _DEFAULT_SOURCE
+#include "usdlog.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int openLog(usdlog_t* log, const char* path, int nThreads) {
+  int result = usdlogOpen(log, path, nThreads);
+  if (result != USDLOG_OK) {
+    fprintf(stderr, "Failed to open %s (%d)\n", path, result);
+  }
+  return result;
+}
+
+static int cmdInfo(const char* path, int nThreads) {
+  usdlog_t log;
+  if (openLog(&log, path, nThreads) != USDLOG_OK) {
+    return 1;
+  }
+
+  printf("Header CRC: %s\n", log.headerCrcOk ? "OK" : "ERROR");
+  printf("Variables: %d (%zu bytes per set)\n", log.nVars, log.setBytes);
+  for (int i = 0; i < log.nVars; i++) {
+    printf("  %-32s %c\n", log.vars[i].name, log.vars[i].type);
+  }
+  printf("Blocks: %zu, CRC errors: %zu%s\n", log.nBlocks, log.crcErrors, log.truncated ? ", last block truncated" : "");
+  printf("Samples: %zu\n", log.nSamples);
+  if (log.nSamples > 0) {
+    printf("Ticks: %u - %u\n", usdlogTick(&log, 0), usdlogTick(&log, log.nSamples - 1));
+  }
+
+  usdlogClose(&log);
+  return 0;
+}
+
+static int cmdNpy(const char* path, const char* dir, int nThreads) {
+  usdlog_t log;
+  if (openLog(&log, path, nThreads) != USDLOG_OK) {
+    return 1;
+  }
+
+  mkdir(dir, 0755);
+  int result = usdlogWriteNpy(&log, dir, nThreads);
+  if (result != USDLOG_OK) {
+    fprintf(stderr, "Failed to write to %s (%d)\n", dir, result);
+  } else {
+    printf("Wrote %d variables, %zu samples, %zu CRC errors\n", log.nVars, log.nSamples, log.crcErrors);
+  }
+
+  usdlogClose(&log);
+  return result == USDLOG_OK ? 0 : 1;
+}
+
+static int cmdAt(const char* path, uint32_t tick, int nThreads) {
+  usdlog_t log;
+  if (openLog(&log, path, nThreads) != USDLOG_OK) {
+    return 1;
+  }
+
+  size_t sample = usdlogFindTick(&log, tick);
+  if (sample == log.nSamples) {
+    printf("No sample at or after tick %u\n", tick);
+  } else {
+    printf("Sample %zu%s\n", sample, usdlogSampleValid(&log, sample) ? "" : " (CRC error)");
+    for (int i = 0; i < log.nVars; i++) {
+      double value;
+      usdlogDecodeVarDouble(&log, i, sample, 1, &value);
+      printf("  %-32s %g\n", log.vars[i].name, value);
+    }
+  }
+
+  usdlogClose(&log);
+  return 0;
+}
+
+/* Conversion to the text log of the host estimator replay, see
+   test/testSupport/estimatorReplay.h. acc.* and gyro.* are needed, baro.*,
+   stabilizer.thrust, range.zrange and ext_pos.* are used when logged. */
+
+enum {
+  REPLAY_ACC_X, REPLAY_ACC_Y, REPLAY_ACC_Z, REPLAY_GYRO_X, REPLAY_GYRO_Y, REPLAY_GYRO_Z,
+  REPLAY_BARO_ASL, REPLAY_BARO_TEMP, REPLAY_BARO_PRESSURE, REPLAY_THRUST, REPLAY_ZRANGE,
+  REPLAY_EXT_X, REPLAY_EXT_Y, REPLAY_EXT_Z, REPLAY_NR_OF_VARS,
+};
+
+static const char* replayVars[REPLAY_NR_OF_VARS] = {
+  "acc.x", "acc.y", "acc.z", "gyro.x", "gyro.y", "gyro.z",
+  "baro.asl", "baro.temp", "baro.pressure", "stabilizer.thrust", "range.zrange",
+  "ext_pos.X", "ext_pos.Y", "ext_pos.Z",
+};
+
+// Same limit and noise model as zranger2.c
+#define REPLAY_ZRANGE_OUTLIER_LIMIT 5000
+#define REPLAY_ZRANGE_STD_A 0.0025
+#define REPLAY_ZRANGE_POINT_A 2.5
+#define REPLAY_ZRANGE_STD_B 0.2
+#define REPLAY_ZRANGE_POINT_B 4.0
+
+// The stdDev of ext_pos measurements, the default of crtp_localization_service.c
+#define REPLAY_EXT_POS_STD_DEV 0.01
+
+static double zrangeStdDev(const double distance) {
+  const double coeff = log(REPLAY_ZRANGE_STD_B / REPLAY_ZRANGE_STD_A) / (REPLAY_ZRANGE_POINT_B - REPLAY_ZRANGE_POINT_A);
+  return REPLAY_ZRANGE_STD_A * (1.0 + exp(coeff * (distance - REPLAY_ZRANGE_POINT_A)));
+}
+
+static int cmdReplay(const char* path, const char* outPath, int nThreads) {
+  usdlog_t log;
+  if (openLog(&log, path, nThreads) != USDLOG_OK) {
+    return 1;
+  }
+
+  int index[REPLAY_NR_OF_VARS];
+  for (int i = 0; i < REPLAY_NR_OF_VARS; i++) {
+    index[i] = usdlogFindVar(&log, replayVars[i]);
+  }
+  for (int i = REPLAY_ACC_X; i <= REPLAY_GYRO_Z; i++) {
+    if (index[i] < 0) {
+      fprintf(stderr, "%s is not in the log\n", replayVars[i]);
+      usdlogClose(&log);
+      return 1;
+    }
+  }
+  const bool hasBaro = index[REPLAY_BARO_ASL] >= 0 && index[REPLAY_BARO_TEMP] >= 0 && index[REPLAY_BARO_PRESSURE] >= 0;
+  const bool hasExtPos = index[REPLAY_EXT_X] >= 0 && index[REPLAY_EXT_Y] >= 0 && index[REPLAY_EXT_Z] >= 0;
+
+  FILE* out = fopen(outPath, "w");
+  if (!out) {
+    perror(outPath);
+    usdlogClose(&log);
+    return 1;
+  }
+
+  fprintf(out, "# Converted from %s by usdlog replay\n", path);
+  double lastExt[3] = {NAN, NAN, NAN};
+  uint32_t lastTick = 0;
+  size_t skipped = 0;
+
+  for (size_t sample = 0; sample < log.nSamples; sample++) {
+    const uint32_t tick = usdlogTick(&log, sample);
+    // The replay needs non decreasing ticks, samples from bad blocks are left out
+    if (!usdlogSampleValid(&log, sample) || tick < lastTick) {
+      skipped++;
+      continue;
+    }
+    lastTick = tick;
+
+    double v[REPLAY_NR_OF_VARS];
+    for (int i = 0; i < REPLAY_NR_OF_VARS; i++) {
+      v[i] = NAN;
+      if (index[i] >= 0) {
+        usdlogDecodeVarDouble(&log, index[i], sample, 1, &v[i]);
+      }
+    }
+
+    fprintf(out, "%u,imu,%.5f,%.5f,%.5f,%.4f,%.4f,%.4f\n", tick,
+      v[REPLAY_ACC_X], v[REPLAY_ACC_Y], v[REPLAY_ACC_Z], v[REPLAY_GYRO_X], v[REPLAY_GYRO_Y], v[REPLAY_GYRO_Z]);
+    if (hasBaro) {
+      fprintf(out, "%u,baro,%.4f,%.2f,%.4f\n", tick, v[REPLAY_BARO_ASL], v[REPLAY_BARO_TEMP], v[REPLAY_BARO_PRESSURE]);
+    }
+    if (index[REPLAY_THRUST] >= 0) {
+      fprintf(out, "%u,thrust,%.1f\n", tick, v[REPLAY_THRUST]);
+    }
+    if (index[REPLAY_ZRANGE] >= 0 && v[REPLAY_ZRANGE] < REPLAY_ZRANGE_OUTLIER_LIMIT) {
+      const double distance = v[REPLAY_ZRANGE] * 0.001;
+      fprintf(out, "%u,tof,%.4f,%.5f\n", tick, distance, zrangeStdDev(distance));
+    }
+    // The log holds the last received position, only new positions are measurements
+    if (hasExtPos && (v[REPLAY_EXT_X] != lastExt[0] || v[REPLAY_EXT_Y] != lastExt[1] || v[REPLAY_EXT_Z] != lastExt[2])) {
+      fprintf(out, "%u,pos,%.4f,%.4f,%.4f,%.3f\n", tick, v[REPLAY_EXT_X], v[REPLAY_EXT_Y], v[REPLAY_EXT_Z], REPLAY_EXT_POS_STD_DEV);
+      memcpy(lastExt, &v[REPLAY_EXT_X], sizeof(lastExt));
+    }
+  }
+
+  fclose(out);
+  printf("Wrote %zu samples to %s, skipped %zu\n", log.nSamples - skipped, outPath, skipped);
+
+  usdlogClose(&log);
+  return 0;
+}
+
+/* Synthetic log with the variables of tools/usdlog/config.txt */
+
+static const char* genVars[] = {
+  "tick(I)", "acc.x(f)", "acc.y(f)", "acc.z(f)", "gyro.x(f)", "gyro.y(f)", "gyro.z(f)",
+  "baro.asl(f)", "baro.temp(f)", "baro.pressure(f)", "mag.x(f)", "mag.y(f)", "mag.z(f)",
+  "stabilizer.roll(f)", "stabilizer.pitch(f)", "stabilizer.yaw(f)", "stabilizer.thrust(H)",
+  "ctrltarget.roll(f)", "ctrltarget.pitch(f)", "ctrltarget.yaw(f)", "range.zrange(H)",
+};
+#define GEN_NR_OF_VARS (sizeof(genVars) / sizeof(genVars[0]))
+#define GEN_SETS_PER_BLOCK 50
+
+static int writeWithCrc(FILE* f, const uint8_t* data, size_t len) {
+  uint32_t crc = ~usdlogCrc32(0, data, len);
+  return fwrite(data, len, 1, f) == 1 && fwrite(&crc, 4, 1, f) == 1;
+}
+
+static int cmdGen(const char* path, size_t megabytes) {
+  FILE* f = fopen(path, "wb");
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+
+  uint8_t header[1024];
+  size_t len = 0;
+  header[len++] = GEN_NR_OF_VARS;
+  size_t setBytes = 0;
+  for (size_t i = 0; i < GEN_NR_OF_VARS; i++) {
+    size_t n = strlen(genVars[i]);
+    memcpy(&header[len], genVars[i], n);
+    len += n;
+    header[len++] = ',';
+    char type = genVars[i][n - 2];
+    setBytes += (type == 'H') ? 2 : 4;
+  }
+  if (!writeWithCrc(f, header, len)) {
+    fclose(f);
+    return 1;
+  }
+
+  uint8_t block[1 + GEN_SETS_PER_BLOCK * 128];
+  size_t target = megabytes * 1024 * 1024;
+  size_t written = len + 4;
+  uint32_t tick = 0;
+  float phase = 0.0f;
+
+  while (written < target) {
+    size_t pos = 0;
+    block[pos++] = GEN_SETS_PER_BLOCK;
+    for (int s = 0; s < GEN_SETS_PER_BLOCK; s++) {
+      tick += 4;
+      phase += 0.01f;
+      memcpy(&block[pos], &tick, 4);
+      pos += 4;
+      for (size_t i = 1; i < GEN_NR_OF_VARS; i++) {
+        char type = genVars[i][strlen(genVars[i]) - 2];
+        if (type == 'H') {
+          uint16_t v = (uint16_t)(tick + i);
+          memcpy(&block[pos], &v, 2);
+          pos += 2;
+        } else {
+          float v = phase * i;
+          memcpy(&block[pos], &v, 4);
+          pos += 4;
+        }
+      }
+    }
+    if (!writeWithCrc(f, block, pos)) {
+      fclose(f);
+      return 1;
+    }
+    written += pos + 4;
+  }
+
+  fclose(f);
+  printf("Wrote %zu bytes (%zu bytes per set) to %s\n", written, setBytes, path);
+  return 0;
+}
+
+static int cmdBench(const char* path, int nThreads) {
+  double t0 = now();
+  usdlog_t log;
+  if (openLog(&log, path, nThreads) != USDLOG_OK) {
+    return 1;
+  }
+  double t1 = now();
+
+  void* buffer = malloc(log.nSamples * 4 + 1);
+  if (!buffer) {
+    usdlogClose(&log);
+    return 1;
+  }
+  for (int i = 0; i < log.nVars; i++) {
+    usdlogDecodeVar(&log, i, buffer, nThreads);
+  }
+  double t2 = now();
+
+  volatile size_t found = 0;
+  for (int i = 0; i < 100000; i++) {
+    found += usdlogFindTick(&log, (uint32_t)rand());
+  }
+  double t3 = now();
+
+  double mb = log.size / (1024.0 * 1024.0);
+  printf("File: %.1f MB, %zu samples, %zu blocks, %zu CRC errors\n", mb, log.nSamples, log.nBlocks, log.crcErrors);
+  printf("Open, index and CRC check: %.3f s (%.0f MB/s)\n", t1 - t0, mb / (t1 - t0));
+  printf("Decode all %d variables:   %.3f s (%.0f MB/s)\n", log.nVars, t2 - t1, mb / (t2 - t1));
+  printf("Tick lookup:               %.3f us\n", (t3 - t2) * 1e6 / 100000);
+
+  free(buffer);
+  usdlogClose(&log);
+  return 0;
+}
+
+static void usage(void) {
+  fprintf(stderr,
+    "usage: usdlog [-j threads] info <log>\n"
+    "       usdlog [-j threads] npy <log> <outdir>\n"
+    "       usdlog [-j threads] at <log> <tick>\n"
+    "       usdlog [-j threads] replay <log> <out.csv>\n"
+    "       usdlog gen <log> <megabytes>\n"
+    "       usdlog [-j threads] bench <log>\n");
+}
+
+int main(int argc, char* argv[]) {
+  int nThreads = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "j:")) != -1) {
+    if (opt == 'j') {
+      nThreads = atoi(optarg);
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  argc -= optind;
+  argv += optind;
+  if (argc < 2) {
+    usage();
+    return 1;
+  }
+
+  const char* cmd = argv[0];
+  if (strcmp(cmd, "info") == 0) {
+    return cmdInfo(argv[1], nThreads);
+  } else if (strcmp(cmd, "npy") == 0 && argc == 3) {
+    return cmdNpy(argv[1], argv[2], nThreads);
+  } else if (strcmp(cmd, "at") == 0 && argc == 3) {
+    return cmdAt(argv[1], strtoul(argv[2], NULL, 0), nThreads);
+  } else if (strcmp(cmd, "replay") == 0 && argc == 3) {
+    return cmdReplay(argv[1], argv[2], nThreads);
+  } else if (strcmp(cmd, "gen") == 0 && argc == 3) {
+    return cmdGen(argv[1], strtoul(argv[2], NULL, 0));
+  } else if (strcmp(cmd, "bench") == 0) {
+    return cmdBench(argv[1], nThreads);
+  }
+
+  usage();
+  return 1;
+}
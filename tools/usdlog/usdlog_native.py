@@ -0,0 +1,136 @@
+# -*- coding: utf-8 -*-
+"""
+Python bindings for the native uSD-card deck log decoder in native/.
+
+Build the library first with "make -C native". Decoding a log returns the
+same dictionary as CF_functions.decode(), but each variable is a numpy array
+of its logged type and the file is memory mapped instead of read into RAM:
+
+    import usdlog_native
+    with usdlog_native.UsdLog('log00') as log:
+        data = log.decode()             # {name: np.ndarray}
+        first = log.find_tick(10000)    # sample index of tick 10000
+        valid = log.valid()             # False for samples with CRC errors
+"""
+import ctypes
+import os
+
+import numpy as np
+
+_MAX_VARS = 256
+_MAX_NAME_LEN = 64
+
+_DTYPES = {
+    'B': np.uint8, 'b': np.int8,
+    'H': np.uint16, 'h': np.int16,
+    'I': np.uint32, 'i': np.int32,
+    'f': np.float32,
+}
+
+
+class _Var(ctypes.Structure):
+    _fields_ = [('name', ctypes.c_char * _MAX_NAME_LEN),
+                ('type', ctypes.c_char),
+                ('size', ctypes.c_uint8),
+                ('offset', ctypes.c_uint16)]
+
+
+class _Block(ctypes.Structure):
+    _fields_ = [('offset', ctypes.c_size_t),
+                ('firstSample', ctypes.c_size_t),
+                ('count', ctypes.c_uint8),
+                ('crcOk', ctypes.c_bool)]
+
+
+class _Log(ctypes.Structure):
+    _fields_ = [('data', ctypes.c_void_p),
+                ('size', ctypes.c_size_t),
+                ('fd', ctypes.c_int),
+                ('nVars', ctypes.c_int),
+                ('vars', _Var * _MAX_VARS),
+                ('setBytes', ctypes.c_size_t),
+                ('headerCrcOk', ctypes.c_bool),
+                ('nBlocks', ctypes.c_size_t),
+                ('blocks', ctypes.POINTER(_Block)),
+                ('nSamples', ctypes.c_size_t),
+                ('crcErrors', ctypes.c_size_t),
+                ('truncated', ctypes.c_bool)]
+
+
+def _load_library():
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                        'native', 'libusdlog.so')
+    lib = ctypes.CDLL(path)
+    lib.usdlogOpen.argtypes = [ctypes.POINTER(_Log), ctypes.c_char_p,
+                               ctypes.c_int]
+    lib.usdlogClose.argtypes = [ctypes.POINTER(_Log)]
+    lib.usdlogDecodeVar.argtypes = [ctypes.POINTER(_Log), ctypes.c_int,
+                                    ctypes.c_void_p, ctypes.c_int]
+    lib.usdlogFindTick.argtypes = [ctypes.POINTER(_Log), ctypes.c_uint32]
+    lib.usdlogFindTick.restype = ctypes.c_size_t
+    return lib
+
+
+_lib = _load_library()
+
+
+class UsdLog:
+    def __init__(self, filename, threads=0):
+        self._log = _Log()
+        self._threads = threads
+        result = _lib.usdlogOpen(ctypes.byref(self._log),
+                                 os.fsencode(filename), threads)
+        if result != 0:
+            raise IOError('Failed to decode {} ({})'.format(filename, result))
+
+    def close(self):
+        if self._log.data:
+            _lib.usdlogClose(ctypes.byref(self._log))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    @property
+    def names(self):
+        return [self._log.vars[i].name.decode('utf-8')
+                for i in range(self._log.nVars)]
+
+    @property
+    def samples(self):
+        return self._log.nSamples
+
+    @property
+    def crc_errors(self):
+        return self._log.crcErrors + (0 if self._log.headerCrcOk else 1)
+
+    def decode_var(self, name):
+        index = self.names.index(name)
+        var = self._log.vars[index]
+        out = np.empty(self._log.nSamples,
+                       dtype=_DTYPES[var.type.decode('ascii')])
+        _lib.usdlogDecodeVar(ctypes.byref(self._log), index,
+                             out.ctypes.data_as(ctypes.c_void_p),
+                             self._threads)
+        return out
+
+    def decode(self):
+        return {name: self.decode_var(name) for name in self.names}
+
+    def valid(self):
+        out = np.empty(self._log.nSamples, dtype=bool)
+        for i in range(self._log.nBlocks):
+            block = self._log.blocks[i]
+            out[block.firstSample:block.firstSample + block.count] = \
+                block.crcOk
+        return out
+
+    def find_tick(self, tick):
+        return _lib.usdlogFindTick(ctypes.byref(self._log), tick)
+
+
+def decode(filName):
+    with UsdLog(filName) as log:
+        return log.decode()